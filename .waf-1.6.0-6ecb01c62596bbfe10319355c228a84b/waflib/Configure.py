@@ -0,0 +1,324 @@
+#! /usr/bin/env python
+# encoding: utf-8
+# WARNING! All changes made to this file will be lost!
+
+import os,shlex,sys,time
+from waflib import ConfigSet,Utils,Options,Logs,Context,Build,Errors
+try:
+	from urllib import request
+except:
+	from urllib import urlopen
+else:
+	urlopen=request.urlopen
+BREAK='break'
+CONTINUE='continue'
+WAF_CONFIG_LOG='config.log'
+autoconfig=False
+conf_template='''# project %(app)s configured on %(now)s by
+# waf %(wafver)s (abi %(abi)s, python %(pyver)x on %(systype)s)
+# using %(args)s
+#'''
+def download_check(path):
+	Logs.warn('replace me to check %r'%path)
+def download_tool(tool,force=False):
+	for x in Utils.to_list(Context.remote_repo):
+		for sub in Utils.to_list(Context.remote_locs):
+			url='/'.join((x,sub,tool+'.py'))
+			try:
+				web=urlopen(url)
+				if web.getcode()!=200:
+					continue
+			except Exception ,e:
+				continue
+			else:
+				loc=None
+				try:
+					tmp=os.sep.join((Context.waf_dir,'waflib','extras',tool+'.py'))
+					loc=open(tmp,'wb')
+					loc.write(web.read())
+					web.close()
+				finally:
+					if loc:
+						loc.close()
+				Logs.warn('downloaded %s from %s'%(tool,url))
+				download_check(tmp)
+				try:
+					module=Context.load_tool(tool)
+				except:
+					Logs.warn('module %s from %s is unusable'%(tool,url))
+					try:
+						os.unlink(tmp)
+					except:
+						pass
+					continue
+				return module
+		else:
+			break
+		raise Errors.WafError('Could not load the tool')
+class ConfigurationContext(Context.Context):
+	'''configures the project'''
+	cmd='configure'
+	error_handlers=[]
+	def __init__(self,start_dir=None):
+		super(self.__class__,self).__init__(start_dir)
+		self.env=None
+		self.envname=''
+		self.environ=dict(os.environ)
+		self.all_envs={}
+		self.tools=[]
+		self.setenv('default')
+		self.hash=0
+		self.files=[]
+		self.tool_cache=[]
+	def execute(self):
+		top=Options.options.top
+		if not top:
+			top=getattr(Context.g_module,Context.TOP,None)
+		if not top:
+			top=os.path.abspath('.')
+		top=os.path.abspath(top)
+		out=Options.options.out
+		if not out:
+			out=getattr(Context.g_module,Context.OUT,None)
+		if not out:
+			out=Options.lockfile.replace('.lock-waf','')
+			out=os.path.abspath(out)
+		out=os.path.abspath(out)
+		try:
+			os.makedirs(out)
+		except OSError:
+			if not os.path.isdir(out):
+				conf.fatal('could not create the build directory %s'%out)
+		self.srcnode=self.root.find_dir(top)
+		self.bldnode=self.root.find_dir(out)
+		self.cachedir=os.path.join(self.bldnode.abspath(),Build.CACHE_DIR)
+		path=os.path.join(self.bldnode.abspath(),WAF_CONFIG_LOG)
+		self.logger=Logs.make_logger(path,'cfg')
+		app=getattr(Context.g_module,'APPNAME','')
+		if app:
+			ver=getattr(Context.g_module,'VERSION','')
+			if ver:
+				app="%s (%s)"%(app,ver)
+		now=time.ctime()
+		pyver=sys.hexversion
+		systype=sys.platform
+		args=" ".join(sys.argv)
+		wafver=Context.WAFVERSION
+		abi=Context.ABI
+		self.to_log(conf_template%vars())
+		self.msg('Setting top to',top)
+		self.msg('Setting out to',out)
+		if id(self.srcnode)==id(self.bldnode):
+			Logs.warn('setting top == out')
+		elif id(self.path)!=id(self.srcnode):
+			if self.srcnode.is_child_of(self.path):
+				Logs.warn('Using an uncommon top directory')
+		super(ConfigurationContext,self).execute()
+		self.store()
+		Context.top_dir=self.srcnode.abspath()
+		Context.out_dir=self.bldnode.abspath()
+		env=ConfigSet.ConfigSet()
+		env['argv']=sys.argv
+		env['options']=Options.options.__dict__
+		env.run_dir=Context.run_dir
+		env.top_dir=Context.top_dir
+		env.out_dir=Context.out_dir
+		env['hash']=self.hash
+		env['files']=self.files
+		env['environ']=dict(self.environ)
+		env.store(Context.run_dir+os.sep+Options.lockfile)
+		env.store(Context.top_dir+os.sep+Options.lockfile)
+		env.store(Context.out_dir+os.sep+Options.lockfile)
+	def prepare_env(self,env):
+		if not env.PREFIX:
+			env.PREFIX=os.path.abspath(os.path.expanduser(Options.options.prefix))
+		if not env.BINDIR:
+			env.BINDIR=Utils.subst_vars('${PREFIX}/bin',env)
+		if not env.LIBDIR:
+			env.LIBDIR=Utils.subst_vars('${PREFIX}/lib',env)
+	def store(self):
+		try:
+			os.makedirs(self.cachedir)
+		except:
+			pass
+		f=open(os.path.join(self.cachedir,'build.config.py'),'w')
+		f.write('version = 0x%x\n'%Context.HEXVERSION)
+		f.write('tools = %r\n'%self.tools)
+		f.close()
+		if not self.all_envs:
+			self.fatal('nothing to store in the configuration context!')
+		for key in self.all_envs:
+			tmpenv=self.all_envs[key]
+			tmpenv.store(os.path.join(self.cachedir,key+Build.CACHE_SUFFIX))
+	def check_tool(self,input,tooldir=None,funs=None,download=True):
+		tools=Utils.to_list(input)
+		if tooldir:tooldir=Utils.to_list(tooldir)
+		for tool in tools:
+			mag=(tool,id(self.env),funs)
+			if mag in self.tool_cache:
+				self.to_log('(tool %s is already loaded, skipping)'%tool)
+				continue
+			self.tool_cache.append(mag)
+			module=None
+			try:
+				module=Context.load_tool(tool,tooldir)
+			except ImportError ,e:
+				if Options.options.download:
+					module=download_tool(tool)
+					if not module:
+						self.fatal('Could not load the tool %r or download a suitable replacement from the repository (sys.path %r)\n%s'%(tool,sys.path,e))
+				else:
+					self.fatal('Could not load the tool %r from %r (try the --download option?):\n%s'%(tool,sys.path,e))
+			except Exception ,e:
+				self.to_log('check_tool %r (%r & %r)'%(tool,tooldir,funs))
+				self.to_log(Utils.ex_stack())
+				raise e
+			if funs is not None:
+				self.eval_rules(funs)
+			else:
+				func=getattr(module,'configure',None)
+				if func:
+					if type(func)is type(Utils.readf):func(self)
+					else:self.eval_rules(func)
+			self.tools.append({'tool':tool,'tooldir':tooldir,'funs':funs})
+	def post_recurse(self,node):
+		super(ConfigurationContext,self).post_recurse(node)
+		self.hash=hash((self.hash,node.read('rb')))
+		self.files.append(node.abspath())
+	def set_env_name(self,name,env):
+		self.all_envs[name]=env
+		return env
+	def retrieve(self,name,fromenv=None):
+		try:
+			env=self.all_envs[name]
+		except KeyError:
+			env=ConfigSet.ConfigSet()
+			self.prepare_env(env)
+			self.all_envs[name]=env
+		else:
+			if fromenv:Logs.warn("The environment %s may have been configured already"%name)
+		return env
+	def setenv(self,name):
+		self.env=self.retrieve(name)
+		self.envname=name
+	def add_os_flags(self,var,dest=None):
+		try:self.env.append_value(dest or var,Utils.to_list(self.environ[var]))
+		except KeyError:pass
+	def cmd_to_list(self,cmd):
+		if isinstance(cmd,str)and cmd.find(' '):
+			try:
+				os.stat(cmd)
+			except OSError:
+				return shlex.split(cmd)
+			else:
+				return[cmd]
+		return cmd
+	def eval_rules(self,rules):
+		self.rules=Utils.to_list(rules)
+		for x in self.rules:
+			f=getattr(self,x)
+			if not f:self.fatal("No such method '%s'."%x)
+			try:
+				f()
+			except Exception ,e:
+				ret=self.err_handler(x,e)
+				if ret==BREAK:
+					break
+				elif ret==CONTINUE:
+					continue
+				else:
+					raise e
+	def err_handler(self,fun,error):
+		pass
+def conf(f):
+	def fun(*k,**kw):
+		mandatory=True
+		if'mandatory'in kw:
+			mandatory=kw['mandatory']
+			del kw['mandatory']
+		try:
+			return f(*k,**kw)
+		except Errors.ConfigurationError ,e:
+			if mandatory:
+				raise e
+	setattr(ConfigurationContext,f.__name__,fun)
+	setattr(Build.BuildContext,f.__name__,fun)
+	return f
+def check_waf_version(self,mini='1.6.0',maxi='1.7.0'):
+	self.start_msg('Checking for waf version in %s-%s'%(str(mini),str(maxi)))
+	ver=Context.HEXVERSION
+	if Utils.num2ver(mini)>ver:
+		conf.fatal('waf version should be at least %r (%r found)'%(mini,ver))
+	if Utils.num2ver(maxi)<ver:
+		conf.fatal('waf version should be at most %r (%r found)'%(maxi,ver))
+	self.end_msg('ok')
+def fatal(self,msg):
+	self.to_log('from %s: %s'%(self.path.abspath(),msg))
+	try:
+		msg='%s\n(complete log in %s)'%(msg,self.logger.handlers[0].baseFilename)
+	except:
+		pass
+	raise self.errors.ConfigurationError(msg)
+def find_file(self,filename,path_list=[]):
+	for n in Utils.to_list(filename):
+		for d in Utils.to_list(path_list):
+			p=os.path.join(d,n)
+			if os.path.exists(p):
+				return p
+	self.fatal('Could not find %r'%filename)
+def find_program(self,filename,path_list=[],var=None,environ=None,exts=''):
+	if not environ:
+		environ=os.environ
+	ret=''
+	if var:
+		if self.env[var]:
+			ret=self.env[var]
+		elif var in environ:
+			ret=environ[var]
+	if not ret:
+		if path_list:
+			path_list=Utils.to_list(path_list)
+		else:
+			path_list=environ.get('PATH','').split(os.pathsep)
+		if not isinstance(filename,list):
+			filename=[filename]
+		if not exts:
+			if Options.platform=='win32':
+				exts='.exe,.com,.bat,.cmd'
+		for a in exts.split(','):
+			if ret:
+				break
+			for b in filename:
+				if ret:
+					break
+				for c in path_list:
+					if ret:
+						break
+					x=os.path.join(c,b+a)
+					if os.path.isfile(x):
+						ret=x
+	filename=Utils.to_list(filename)
+	self.msg('Checking for program '+','.join(filename),ret or False)
+	self.to_log('find program=%r paths=%r var=%r -> %r'%(filename,path_list,var,ret))
+	if not ret:
+		self.fatal('The program %r could not be found'%filename)
+	if var:
+		self.env[var]=ret
+	return ret
+def find_perl_program(self,filename,path_list=[],var=None,environ=None,exts=''):
+	try:
+		app=self.find_program(filename,path_list=path_list,var=var,environ=environ,exts=exts)
+	except:
+		perl=conf.find_program('perl',var='PERL')
+		app=self.find_file(filename,os.environ['PATH'].split(os.pathsep))
+		if not app:
+			raise
+		if var:
+			self.env[var]=Utils.to_list(conf.env['PERL'])+[app]
+	conf.msg('Checking for %r'%filename,app)
+
+conf(check_waf_version)
+conf(fatal)
+conf(find_file)
+conf(find_program)
+conf(find_perl_program)
\ No newline at end of file
@@ -0,0 +1,165 @@
+#! /usr/bin/env python
+# encoding: utf-8
+# WARNING! All changes made to this file will be lost!
+
+import os,sys,random
+try:
+	from queue import Queue
+except:
+	from Queue import Queue
+from waflib import Utils,Logs,Task,Errors
+GAP=15
+MAXJOBS=999
+class TaskConsumer(Utils.threading.Thread):
+	ready=Queue(0)
+	pool=[]
+	def __init__(self):
+		Utils.threading.Thread.__init__(self)
+		self.setDaemon(1)
+		self.start()
+	def run(self):
+		try:
+			self.loop()
+		except:
+			pass
+	def loop(self):
+		while 1:
+			tsk=TaskConsumer.ready.get()
+			process_task(tsk)
+def process_task(tsk):
+	m=tsk.master
+	if m.stop:
+		m.out.put(tsk)
+		return
+	try:
+		tsk.generator.bld.to_log(tsk.display())
+		if tsk.__class__.stat:ret=tsk.__class__.stat(tsk)
+		else:ret=tsk.call_run()
+	except Exception ,e:
+		tsk.err_msg=Utils.ex_stack()
+		tsk.hasrun=Task.EXCEPTION
+		m.error_handler(tsk)
+		m.out.put(tsk)
+		return
+	if ret:
+		tsk.err_code=ret
+		tsk.hasrun=Task.CRASHED
+	else:
+		try:
+			tsk.post_run()
+		except Errors.WafError:
+			pass
+		except Exception:
+			tsk.err_msg=Utils.ex_stack()
+			tsk.hasrun=Task.EXCEPTION
+		else:
+			tsk.hasrun=Task.SUCCESS
+	if tsk.hasrun!=Task.SUCCESS:
+		m.error_handler(tsk)
+	m.out.put(tsk)
+class Parallel(object):
+	def __init__(self,bld,j=2):
+		self.numjobs=j
+		self.bld=bld
+		self.total=self.bld.total()
+		self.outstanding=[]
+		self.maxjobs=MAXJOBS
+		self.frozen=[]
+		self.out=Queue(0)
+		self.count=0
+		self.processed=1
+		self.stop=False
+		self.error=[]
+		self.biter=None
+		self.dirty=False
+	def get_next_task(self):
+		if not self.outstanding:
+			return None
+		return self.outstanding.pop(0)
+	def postpone(self,tsk):
+		if random.randint(0,1):
+			self.frozen.insert(0,tsk)
+		else:
+			self.frozen.append(tsk)
+	def refill_task_list(self):
+		while self.count>self.numjobs+GAP or self.count>=self.maxjobs:
+			self.get_out()
+		while not self.outstanding:
+			if self.count:
+				self.get_out()
+			elif self.frozen:
+				try:
+					cond=self.deadlock==self.processed
+				except:
+					pass
+				else:
+					if cond:
+						raise Errors.WafError("Deadlock detected, check the build order for the tasks: %r"%self.frozen)
+				self.deadlock=self.processed
+			if self.frozen:
+				self.outstanding+=self.frozen
+				self.frozen=[]
+			elif not self.count:
+				self.outstanding.extend(self.biter.next())
+				self.total=self.bld.total()
+				break
+	def add_more_tasks(self,tsk):
+		if getattr(tsk,'more_tasks',None):
+			self.outstanding+=tsk.more_tasks
+			self.total+=len(tsk.more_tasks)
+	def get_out(self):
+		tsk=self.out.get()
+		if not self.stop:
+			self.add_more_tasks(tsk)
+		self.count-=1
+		self.dirty=True
+	def error_handler(self,tsk):
+		if not self.bld.keep:
+			self.stop=True
+		self.error.append(tsk)
+	def start(self):
+		if TaskConsumer.pool:
+			while len(TaskConsumer.pool)<self.numjobs:
+				TaskConsumer.pool.append(TaskConsumer())
+		while not self.stop:
+			self.refill_task_list()
+			tsk=self.get_next_task()
+			if not tsk:
+				if self.count:
+					continue
+				else:
+					break
+			if tsk.hasrun:
+				self.processed+=1
+				continue
+			try:
+				st=tsk.runnable_status()
+			except Exception ,e:
+				self.processed+=1
+				if self.stop and not self.bld.keep:
+					tsk.hasrun=Task.SKIPPED
+					continue
+				tsk.err_msg=Utils.ex_stack()
+				tsk.hasrun=Task.EXCEPTION
+				self.error_handler(tsk)
+				continue
+			if st==Task.ASK_LATER:
+				self.postpone(tsk)
+			elif st==Task.SKIP_ME:
+				self.processed+=1
+				tsk.hasrun=Task.SKIPPED
+				self.add_more_tasks(tsk)
+			else:
+				tsk.position=(self.processed,self.total)
+				self.count+=1
+				tsk.master=self
+				self.processed+=1
+				if self.numjobs==1:
+					process_task(tsk)
+				else:
+					TaskConsumer.ready.put(tsk)
+					if not TaskConsumer.pool:
+						TaskConsumer.pool=[TaskConsumer()for i in range(self.numjobs)]
+		while self.error and self.count:
+			self.get_out()
+		assert(self.count==0 or self.stop)
@@ -0,0 +1,17 @@
+#! /usr/bin/env python
+# encoding: utf-8
+# WARNING! All changes made to this file will be lost!
+
+import os,sys
+import waflib.Task
+from waflib.TaskGen import extension,feature
+def apply_asm_vars(self):
+	self.env.append_value('ASFLAGS',self.to_list(getattr(self,'asflags',[])))
+class asm(waflib.Task.Task):
+	color='BLUE'
+	run_str='${AS} ${ASFLAGS} ${CPPPATH_ST:INCPATHS} ${SRC} -o ${TGT}'
+def asm_hook(self,node):
+	return self.create_compiled_task('asm',node)
+
+feature('asm')(apply_asm_vars)
+extension('.s','.S','.asm','.ASM','.spp','.SPP')(asm_hook)
\ No newline at end of file
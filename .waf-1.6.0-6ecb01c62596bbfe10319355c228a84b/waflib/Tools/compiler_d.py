@@ -0,0 +1,36 @@
+#! /usr/bin/env python
+# encoding: utf-8
+# WARNING! All changes made to this file will be lost!
+
+import os,sys,imp,types
+from waflib import Utils,Configure,Options,Logs
+def configure(conf):
+	if getattr(Options.options,'check_dmd_first',None):
+		test_for_compiler=['dmd','gdc']
+	else:
+		test_for_compiler=['gdc','dmd']
+	orig=conf.env
+	for compiler in test_for_compiler:
+		try:
+			conf.start_msg('Checking for %r (d compiler)'%compiler)
+			conf.env=orig.derive()
+			conf.check_tool(compiler)
+		except conf.errors.ConfigurationError ,e:
+			conf.end_msg(False)
+			Logs.debug('compiler_cxx: %r'%e)
+		else:
+			if conf.env.D:
+				orig.table=conf.env.get_merged_dict()
+				conf.env=orig
+				conf.end_msg(True)
+				conf.env['COMPILER_D']=compiler
+				conf.env.D_COMPILER=conf.env.D
+				break
+			conf.end_msg(False)
+	else:
+		conf.fatal('no suitable d compiler was found')
+def options(opt):
+	d_compiler_opts=opt.add_option_group('D Compiler Options')
+	d_compiler_opts.add_option('--check-dmd-first',action='store_true',help='checks for the gdc compiler before dmd (default is the other way round)',dest='check_dmd_first',default=False)
+	for d_compiler in['gdc','dmd']:
+		opt.tool_options('%s'%d_compiler,option_group=d_compiler_opts)
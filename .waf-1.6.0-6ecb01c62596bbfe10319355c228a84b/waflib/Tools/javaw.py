@@ -0,0 +1,168 @@
+#! /usr/bin/env python
+# encoding: utf-8
+# WARNING! All changes made to this file will be lost!
+
+import sys
+if sys.hexversion < 0x020400f0: from sets import Set as set
+import os,re
+from waflib.Configure import conf
+from waflib import TaskGen,Task,Utils,Options,Build
+from waflib.TaskGen import feature,before
+class_check_source='''
+public class Test {
+	public static void main(String[] argv) {
+		Class lib;
+		if (argv.length < 1) {
+			System.err.println("Missing argument");
+			System.exit(77);
+		}
+		try {
+			lib = Class.forName(argv[0]);
+		} catch (ClassNotFoundException e) {
+			System.err.println("ClassNotFoundException");
+			System.exit(1);
+		}
+		lib = null;
+		System.exit(0);
+	}
+}
+'''
+def jar_files(self):
+	basedir=getattr(self,'basedir','.')
+	destfile=getattr(self,'destfile','test.jar')
+	jaropts=getattr(self,'jaropts',[])
+	jarcreate=getattr(self,'jarcreate','cf')
+	d=self.path.find_dir(basedir)
+	if not d:raise
+	tsk=self.create_task('jar_create')
+	tsk.set_outputs(self.path.find_or_declare(destfile))
+	tsk.basedir=d
+	jaropts.append('-C')
+	jaropts.append(d.bldpath())
+	jaropts.append('.')
+	tsk.env['JAROPTS']=jaropts
+	tsk.env['JARCREATE']=jarcreate
+def apply_java(self):
+	Utils.def_attrs(self,jarname='',jaropts='',classpath='',sourcepath='.',srcdir='.',source_re='**/*.java',jar_mf_attributes={},jar_mf_classpath=[])
+	nodes_lst=[]
+	if not self.classpath:
+		if not self.env['CLASSPATH']:
+			self.env['CLASSPATH']='..'+os.pathsep+'.'
+	else:
+		self.env['CLASSPATH']=self.classpath
+	srcdir_node=self.path.find_dir(self.srcdir)
+	if not srcdir_node:
+		raise Errors.WafError('could not find srcdir %r'%self.srcdir)
+	src_nodes=srcdir_node.ant_glob(self.source_re)
+	bld_nodes=[x.change_ext('.class')for x in src_nodes]
+	for x in src_nodes:
+		x.sig=Utils.h_file(x.abspath())
+	self.env['OUTDIR']=[srcdir_node.srcpath()]
+	tsk=self.create_task('javac')
+	tsk.set_inputs(src_nodes)
+	tsk.set_outputs(bld_nodes)
+	if getattr(self,'compat',None):
+		tsk.env.append_value('JAVACFLAGS',['-source',self.compat])
+	if hasattr(self,'sourcepath'):
+		fold=[self.path.find_dir(x)for x in self.to_list(self.sourcepath)]
+		names=os.pathsep.join([x.srcpath()for x in fold])
+	else:
+		names=srcdir_node.srcpath()
+	if names:
+		tsk.env.append_value('JAVACFLAGS',['-sourcepath',names])
+	if self.jarname:
+		tsk=self.create_task('jar_create')
+		tsk.set_outputs(self.path.find_or_declare(self.jarname))
+		if not self.env['JAROPTS']:
+			if self.jaropts:
+				self.env['JAROPTS']=self.jaropts
+			else:
+				dirs='.'
+				self.env['JAROPTS']=['-C',''.join(self.env['OUTDIR']),dirs]
+class jar_create(Task.Task):
+	color='GREEN'
+	run_str='${JAR} ${JARCREATE} ${TGT} ${JAROPTS}'
+	quiet=True
+	def runnable_status(self):
+		for t in self.run_after:
+			if not t.hasrun:
+				return Task.ASK_LATER
+		if not self.inputs:
+			self.inputs=[x for x in self.basedir.get_bld().ant_glob('**/*',dir=False)if id(x)!=id(self.outputs[0])]
+		return super(jar_create,self).runnable_status()
+class javac(Task.Task):
+	color='BLUE'
+	run_str='${JAVAC} -classpath ${CLASSPATH} -d ${OUTDIR} ${JAVACFLAGS} ${SRC}'
+	def post_run(self):
+		lst=set([x.parent for x in self.outputs])
+		inner=[]
+		for k in lst:
+			lst=k.listdir()
+			for u in lst:
+				if u.find('$')>=0:
+					node=k.find_or_declare(u)
+					inner.append(node)
+		to_add=set(inner)-set(self.outputs)
+		self.outputs.extend(list(to_add))
+		self.cached=True
+		return super(javac,self).post_run()
+def configure(self):
+	java_path=self.environ['PATH'].split(os.pathsep)
+	v=self.env
+	if'JAVA_HOME'in self.environ:
+		java_path=[os.path.join(self.environ['JAVA_HOME'],'bin')]+java_path
+		self.env['JAVA_HOME']=[self.environ['JAVA_HOME']]
+	for x in'javac java jar'.split():
+		self.find_program(x,var=x.upper(),path_list=java_path)
+		self.env[x.upper()]=self.cmd_to_list(self.env[x.upper()])
+	if'CLASSPATH'in self.environ:
+		v['CLASSPATH']=self.environ['CLASSPATH']
+	if not v['JAR']:self.fatal('jar is required for making java packages')
+	if not v['JAVAC']:self.fatal('javac is required for compiling java classes')
+	v['JARCREATE']='cf'
+def check_java_class(self,classname,with_classpath=None):
+	import shutil
+	javatestdir='.waf-javatest'
+	classpath=javatestdir
+	if self.env['CLASSPATH']:
+		classpath+=os.pathsep+self.env['CLASSPATH']
+	if isinstance(with_classpath,str):
+		classpath+=os.pathsep+with_classpath
+	shutil.rmtree(javatestdir,True)
+	os.mkdir(javatestdir)
+	java_file=open(os.path.join(javatestdir,'Test.java'),'w')
+	java_file.write(class_check_source)
+	java_file.close()
+	self.exec_command(self.env['JAVAC']+[os.path.join(javatestdir,'Test.java')],shell=False)
+	cmd=self.env['JAVA']+['-cp',classpath,'Test',classname]
+	self.to_log("%s\n"%str(cmd))
+	found=self.exec_command(cmd,shell=False)
+	self.msg('Checking for java class %s'%classname,not found)
+	shutil.rmtree(javatestdir,True)
+	return found
+def check_jni_headers(conf):
+	if not conf.env.CC_NAME and not conf.env.CXX_NAME:
+		conf.fatal('load a compiler first (gcc, g++, ..)')
+	if not conf.env.JAVA_HOME:
+		conf.fatal('set JAVA_HOME in the system environment')
+	javaHome=conf.env['JAVA_HOME'][0]
+	b=Build.BuildContext()
+	b.load_dirs(conf.srcdir,conf.blddir)
+	dir=b.root.find_dir(conf.env.JAVA_HOME[0]+'/include')
+	f=dir.ant_glob('**/(jni|jni_md).h')
+	incDirs=[x.parent.abspath()for x in f]
+	dir=b.root.find_dir(conf.env.JAVA_HOME[0])
+	f=dir.ant_glob('**/*jvm.(so|dll)')
+	libDirs=[x.parent.abspath()for x in f]or[javaHome]
+	for i,d in enumerate(libDirs):
+		if conf.check(header_name='jni.h',define_name='HAVE_JNI_H',lib='jvm',libpath=d,includes=incDirs,uselib_store='JAVA',uselib='JAVA'):
+			break
+	else:
+		conf.fatal('could not find lib jvm in %r (see config.log)'%libDirs)
+
+feature('jar')(jar_files)
+before('process_source')(jar_files)
+feature('javac')(apply_java)
+before('process_source')(apply_java)
+conf(check_java_class)
+conf(check_jni_headers)
\ No newline at end of file
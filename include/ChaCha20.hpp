@@ -0,0 +1,175 @@
+#ifndef H_CHACHA20
+#define H_CHACHA20
+
+//include
+#include <boost/cstdint.hpp>
+
+//standard
+#include <cassert>
+#include <cstring>
+
+/*
+ChaCha20 stream cipher, original variant with 64 bit nonce and 64 bit block
+counter so a stream never runs out of counter. Keystream is generated 4 blocks
+at a time with GCC vector extensions which compile to SSE2 on x86-64 and NEON
+on ARM.
+*/
+class ChaCha20
+{
+public:
+	static const unsigned key_size = 32;
+	static const unsigned nonce_size = 8;
+	static const unsigned block_size = 64;
+
+	ChaCha20():
+		seeded(false)
+	{}
+
+	/*
+	keystream:
+		Fills buf with size bytes of keystream.
+		Precondition: size % block_size == 0.
+	seed:
+		Seed with key_size byte key and nonce_size byte nonce. The counter is
+		the number of the first block generated.
+	*/
+	void keystream(unsigned char * buf, std::size_t size)
+	{
+		assert(seeded);
+		assert(size % block_size == 0);
+#ifdef __GNUC__
+		for(; size >= block_size * 4; size -= block_size * 4, buf += block_size * 4){
+			block_x4(buf);
+		}
+#endif
+		for(; size; size -= block_size, buf += block_size){
+			block(buf);
+		}
+	}
+
+	void seed(const unsigned char * key, const unsigned char * nonce,
+		const boost::uint64_t counter = 0)
+	{
+		seeded = true;
+		//"expand 32-byte k"
+		state[0] = 0x61707865;
+		state[1] = 0x3320646e;
+		state[2] = 0x79622d32;
+		state[3] = 0x6b206574;
+		for(int x=0; x<8; ++x){
+			state[4 + x] = load_le(key + x * 4);
+		}
+		state[12] = static_cast<boost::uint32_t>(counter);
+		state[13] = static_cast<boost::uint32_t>(counter >> 32);
+		state[14] = load_le(nonce);
+		state[15] = load_le(nonce + 4);
+	}
+
+private:
+	boost::uint32_t state[16];
+	bool seeded;
+
+	static boost::uint32_t load_le(const unsigned char * p)
+	{
+		return static_cast<boost::uint32_t>(p[0])
+			| (static_cast<boost::uint32_t>(p[1]) << 8)
+			| (static_cast<boost::uint32_t>(p[2]) << 16)
+			| (static_cast<boost::uint32_t>(p[3]) << 24);
+	}
+
+	static void store_le(unsigned char * p, const boost::uint32_t n)
+	{
+		p[0] = static_cast<unsigned char>(n);
+		p[1] = static_cast<unsigned char>(n >> 8);
+		p[2] = static_cast<unsigned char>(n >> 16);
+		p[3] = static_cast<unsigned char>(n >> 24);
+	}
+
+	//increment 64 bit block counter
+	void increment(const unsigned cnt)
+	{
+		boost::uint32_t old = state[12];
+		state[12] += cnt;
+		if(state[12] < old){
+			++state[13];
+		}
+	}
+
+	//works on both words and vectors of words
+	template<typename T>
+	static T rotate_left(const T data, const int bits)
+	{
+		return (data << bits) | (data >> (32 - bits));
+	}
+
+	template<typename T>
+	static void quarter_round(T & a, T & b, T & c, T & d)
+	{
+		a += b; d ^= a; d = rotate_left(d, 16);
+		c += d; b ^= c; b = rotate_left(b, 12);
+		a += b; d ^= a; d = rotate_left(d, 8);
+		c += d; b ^= c; b = rotate_left(b, 7);
+	}
+
+	template<typename T>
+	static void double_rounds(T * x)
+	{
+		for(int r=0; r<10; ++r){
+			//columns
+			quarter_round(x[0], x[4], x[8], x[12]);
+			quarter_round(x[1], x[5], x[9], x[13]);
+			quarter_round(x[2], x[6], x[10], x[14]);
+			quarter_round(x[3], x[7], x[11], x[15]);
+			//diagonals
+			quarter_round(x[0], x[5], x[10], x[15]);
+			quarter_round(x[1], x[6], x[11], x[12]);
+			quarter_round(x[2], x[7], x[8], x[13]);
+			quarter_round(x[3], x[4], x[9], x[14]);
+		}
+	}
+
+	//generate one block
+	void block(unsigned char * out)
+	{
+		boost::uint32_t x[16];
+		std::memcpy(x, state, sizeof(x));
+		double_rounds(x);
+		for(int y=0; y<16; ++y){
+			store_le(out + y * 4, x[y] + state[y]);
+		}
+		increment(1);
+	}
+
+#ifdef __GNUC__
+	//lane y of a vector holds a word of block y
+	typedef boost::uint32_t vec_t __attribute__((vector_size(16)));
+
+	//generate four blocks
+	void block_x4(unsigned char * out)
+	{
+		vec_t x[16], s[16];
+		for(int y=0; y<16; ++y){
+			vec_t tmp = {state[y], state[y], state[y], state[y]};
+			s[y] = tmp;
+		}
+		//counter of each block, carry in to high word
+		vec_t lane = {0, 1, 2, 3};
+		s[12] += lane;
+		for(int y=1; y<4; ++y){
+			if(s[12][y] < state[12]){
+				++s[13][y];
+			}
+		}
+		std::memcpy(x, s, sizeof(x));
+		double_rounds(x);
+		for(int y=0; y<16; ++y){
+			vec_t sum = x[y] + s[y];
+			for(int z=0; z<4; ++z){
+				store_le(out + z * block_size + y * 4, sum[z]);
+			}
+		}
+		increment(4);
+	}
+#endif
+};
+#endif
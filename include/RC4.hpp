@@ -53,6 +53,24 @@ public:
 		}
 	}
 
+	//fills buf with size bytes of keystream, same output as calling byte()
+	void keystream(unsigned char * buf, std::size_t size)
+	{
+		assert(seeded);
+		//locals so the state stays in registers
+		unsigned a = i, b = j;
+		for(std::size_t x=0; x<size; ++x){
+			a = (a + 1) & 255;
+			unsigned char temp = S[a];
+			b = (b + temp) & 255;
+			S[a] = S[b];
+			S[b] = temp;
+			buf[x] = S[(temp + S[a]) & 255];
+		}
+		i = a;
+		j = b;
+	}
+
 	unsigned char byte()
 	{
 		assert(seeded);
@@ -4,15 +4,23 @@
 
 //include
 #include <boost/cstdint.hpp>
-#include <boost/detail/endian.hpp>
 #include <convert.hpp>
 
 //standard
-#include <algorithm>
+#include <cassert>
 #include <cstring>
-#include <iostream>
 #include <string>
-#include <vector>
+
+/*
+SHA-NI and AVX2 are used when the CPU supports them. The code for them is
+compiled with function target attributes so no special compiler flags are
+needed.
+*/
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+	#define SHA1_X86
+	#include <cpuid.h>
+	#include <immintrin.h>
+#endif
 
 class SHA1
 {
@@ -29,178 +37,407 @@ public:
 	static const unsigned bin_size = 20;
 	static const unsigned hex_size = 40;
 
-	//returns generated hash
+	//size of block the compression function operates on
+	static const unsigned block_size = 64;
+
+	//implementation flags, portable C++ used for anything not set
+	enum impl_t{
+		avx2_impl = 1,  //multi() hashes 8 buffers at once
+		sha_ni_impl = 2 //SHA extensions used to hash a single buffer
+	};
+
+	/*
+	bin:
+		Returns generated hash.
+	end:
+		Must be called after all data loaded.
+	hex:
+		Returns generated hash encoded in hex.
+	init:
+		Must be called before loading data.
+	load:
+		Incremental loading of data. Whole blocks are hashed directly from data,
+		only a partial block at the end is copied.
+	*/
 	const char * bin()
 	{
-		return raw.data();
+		return raw;
 	}
 
-	//must be called after all data loaded
 	void end()
 	{
-		//append trailing 1 bit and size
-		append_tail();
-
-		//process remaining chunks
-		std::size_t ready_chunks = load_buffer.size() / 64;
-		for(std::size_t x=0; x<ready_chunks; ++x){
-			process(x*64);
+		//append trailing 1 bit, pad to 56 mod 64, append size in bits big-endian
+		unsigned char tail[block_size * 2];
+		std::memcpy(tail, block, block_used);
+		std::size_t tail_size = block_used;
+		tail[tail_size++] = 0x80;
+		std::size_t pad_to = block_used < block_size - 8 ? block_size : block_size * 2;
+		std::memset(tail + tail_size, 0, pad_to - tail_size);
+		boost::uint64_t bits = loaded_bytes * 8;
+		for(int x=0; x<8; ++x){
+			tail[pad_to - 1 - x] = static_cast<unsigned char>(bits >> (x * 8));
 		}
-		//erase processed chunks
-		load_buffer.erase(0,ready_chunks*64);
+		compress(h, tail, pad_to / block_size);
 
-		//create the final hash by concatenating the h's
-		raw.resize(bin_size);
+		//create the final hash by concatenating the h's big-endian
 		for(int x=0; x<5; ++x){
-			raw[x*4+3] = h[x].b[0];
-			raw[x*4+2] = h[x].b[1];
-			raw[x*4+1] = h[x].b[2];
-			raw[x*4+0] = h[x].b[3];
+			store_be(raw + x * 4, h[x]);
 		}
 	}
 
-	//returns generated hash encoded in hex
 	std::string hex()
 	{
-		return convert::bin_to_hex(raw);
+		return convert::bin_to_hex(std::string(raw, bin_size));
 	}
 
-	//must be called before loading data
 	void init()
 	{
-		h[0].n = 0x67452301;
-		h[1].n = 0xEFCDAB89;
-		h[2].n = 0x98BADCFE;
-		h[3].n = 0x10325476;
-		h[4].n = 0xC3D2E1F0;
+		h[0] = 0x67452301;
+		h[1] = 0xEFCDAB89;
+		h[2] = 0x98BADCFE;
+		h[3] = 0x10325476;
+		h[4] = 0xC3D2E1F0;
 		loaded_bytes = 0;
-		load_buffer.clear();
+		block_used = 0;
 	}
 
-	//incremental loading of data
 	void load(const char * data, std::size_t len)
 	{
-		//update buffer
+		const unsigned char * pos = reinterpret_cast<const unsigned char *>(data);
 		loaded_bytes += len;
-		load_buffer.append(data, len);
-		if(load_buffer.size() >= 64){
-			//process available chunks and free memory
-			std::size_t ready_chunks = (load_buffer.size() - (load_buffer.size() % 64)) / 64;
-			for(std::size_t x=0; x<ready_chunks; ++x){
-				process(x*64);
+		if(block_used != 0){
+			//finish partial block from previous load
+			std::size_t cnt = len < block_size - block_used ? len : block_size - block_used;
+			std::memcpy(block + block_used, pos, cnt);
+			block_used += cnt;
+			pos += cnt;
+			len -= cnt;
+			if(block_used < block_size){
+				return;
 			}
-			//erase processed chunks
-			load_buffer.erase(0,ready_chunks*64);
+			compress(h, block, 1);
+			block_used = 0;
 		}
+		compress(h, pos, len / block_size);
+		pos += len - len % block_size;
+		block_used = len % block_size;
+		std::memcpy(block, pos, block_used);
 	}
 
-private:
-	//holds binary hash
-	std::string raw;
+	/*
+	impl:
+		Returns reference to impl_t flags in use, detected the first time it's
+		called. Flags may be cleared (for testing) but must not be set unless the
+		CPU supports them.
+	multi:
+		Hashes cnt independent buffers. The hash of data[x] (len[x] bytes) is
+		written to hash + x * bin_size. With AVX2 runs of 8 buffers of equal size
+		are hashed at once, one per 32 bit lane. This is faster than SHA-NI on
+		some CPUs so it's preferred when available.
+		Note: Thread safe.
+	*/
+	static unsigned & impl()
+	{
+		static unsigned I = detect();
+		return I;
+	}
 
-	//used by load()
-	boost::uint64_t loaded_bytes; //total bytes input
-	std::string load_buffer;      //holds data input
+	static void multi(const char * const * data, const std::size_t * len,
+		const std::size_t cnt, char * hash)
+	{
+		std::size_t x = 0;
+#ifdef SHA1_X86
+		if(impl() & avx2_impl){
+			while(cnt - x >= 8){
+				bool same_len = true;
+				for(unsigned y=1; y<8; ++y){
+					same_len = same_len && len[x + y] == len[x];
+				}
+				if(!same_len){
+					break;
+				}
+				multi_avx2(data + x, len[x], hash + x * bin_size);
+				x += 8;
+			}
+		}
+#endif
+		SHA1 SHA;
+		for(; x<cnt; ++x){
+			SHA.init();
+			SHA.load(data[x], len[x]);
+			SHA.end();
+			std::memcpy(hash + x * bin_size, SHA.raw, bin_size);
+		}
+	}
 
-	//makes conversion from int to bytes easier
-	union uint32_byte{
-		boost::uint32_t n;
-		char b[sizeof(boost::uint32_t)];
-	};
-	union uint64_byte{
-		boost::uint64_t n;
-		unsigned char b[sizeof(boost::uint64_t)];
-	};
+private:
+	char raw[bin_size];               //holds binary hash
+	boost::uint32_t h[5];             //collected hash values
+	boost::uint64_t loaded_bytes;     //total bytes input
+	unsigned char block[block_size];  //partial block not yet hashed
+	std::size_t block_used;           //bytes in block
+
+	static boost::uint32_t load_be(const unsigned char * p)
+	{
+		return (static_cast<boost::uint32_t>(p[0]) << 24)
+			| (static_cast<boost::uint32_t>(p[1]) << 16)
+			| (static_cast<boost::uint32_t>(p[2]) << 8)
+			| static_cast<boost::uint32_t>(p[3]);
+	}
 
-	uint32_byte w[80]; //holds expansion of a chunk
-	uint32_byte h[5];  //collected hash values
+	static void store_be(char * p, const boost::uint32_t n)
+	{
+		p[0] = static_cast<char>(n >> 24);
+		p[1] = static_cast<char>(n >> 16);
+		p[2] = static_cast<char>(n >> 8);
+		p[3] = static_cast<char>(n);
+	}
 
-	void append_tail()
+	static boost::uint32_t rotate_left(boost::uint32_t data, unsigned bits)
 	{
-		load_buffer += char(128); //append bit 1
+		assert(bits <= 32);
+		return ((data << bits) | (data >> (32 - bits)));
+	}
 
-		//append k zero bits such that size (in bits) is congruent to 448 mod(512)
-		if(load_buffer.size() % 64 < 56){
-			load_buffer.append(56 - (load_buffer.size() % 64), char(0));
-		}else if(load_buffer.size() % 64 > 56){
-			load_buffer.append(64 + (load_buffer.size() % 64), char(0));
+	static unsigned detect()
+	{
+		unsigned I = 0;
+#ifdef SHA1_X86
+		unsigned a, b, c, d;
+		if(__get_cpuid(1, &a, &b, &c, &d) && (c & bit_SSSE3) && (c & bit_SSE4_1)
+			&& __get_cpuid_max(0, NULL) >= 7)
+		{
+			__cpuid_count(7, 0, a, b, c, d);
+			if(b & (1 << 29)){
+				I |= sha_ni_impl;
+			}
+		}
+		__builtin_cpu_init();
+		if(__builtin_cpu_supports("avx2")){
+			I |= avx2_impl;
 		}
+#endif
+		return I;
+	}
 
-		//append size of original message (in bits) encoded as 64bit big-endian
-		uint64_byte IC;
-		IC.n = loaded_bytes * 8;
-		load_buffer.resize(load_buffer.size() + 8);
-		#ifdef BOOST_LITTLE_ENDIAN
-		std::reverse_copy(IC.b, IC.b + sizeof(IC), load_buffer.end() - 8);
-		#elif
-		std::copy(IC.b, IC.b + sizeof(IC), load_buffer.end() - 8);
-		#endif
-	}
-
-	void process(const std::size_t chunk_start)
-	{
-		//break 512bit chunk in to 16, 32 bit pieces
-		for(int x=0; x<16; ++x){
-			std::size_t offset = chunk_start + x * 4;
-			#ifdef BOOST_LITTLE_ENDIAN
-			std::reverse_copy(load_buffer.begin() + offset,
-				load_buffer.begin() + offset + 4, w[x].b);
-			#elif
-			std::copy(load_buffer.begin() + offset,
-				load_buffer.begin() + offset + 4, w[x].b);
-			#endif
+	//hash blocks of data in to state
+	static void compress(boost::uint32_t * state, const unsigned char * data,
+		std::size_t blocks)
+	{
+		if(blocks == 0){
+			return;
+		}
+#ifdef SHA1_X86
+		if(impl() & sha_ni_impl){
+			compress_sha_ni(state, data, blocks);
+			return;
 		}
+#endif
+		compress_scalar(state, data, blocks);
+	}
+
+	static void compress_scalar(boost::uint32_t * state, const unsigned char * data,
+		std::size_t blocks)
+	{
+		boost::uint32_t w[80]; //holds expansion of a chunk
+		for(; blocks; --blocks, data += block_size){
+			//break 512bit chunk in to 16, 32 bit pieces
+			for(int x=0; x<16; ++x){
+				w[x] = load_be(data + x * 4);
+			}
 
-		//extend the 16 pieces to 80
-		for(int x=16; x<80; ++x){
-			w[x].n = rotate_left((w[x-3].n ^ w[x-8].n ^ w[x-14].n ^ w[x-16].n), 1);
+			//extend the 16 pieces to 80
+			for(int x=16; x<80; ++x){
+				w[x] = rotate_left((w[x-3] ^ w[x-8] ^ w[x-14] ^ w[x-16]), 1);
+			}
+
+			boost::uint32_t a, b, c, d, e;
+			a = state[0];
+			b = state[1];
+			c = state[2];
+			d = state[3];
+			e = state[4];
+			for(int x=0; x<20; ++x){
+				boost::uint32_t temp = rotate_left(a, 5) + ((b & c) | ((~b) & d))
+					+ e + 0x5A827999 + w[x];
+				e = d; d = c; c = rotate_left(b, 30); b = a; a = temp;
+			}
+			for(int x=20; x<40; ++x){
+				boost::uint32_t temp = rotate_left(a, 5) + (b ^ c ^ d)
+					+ e + 0x6ED9EBA1 + w[x];
+				e = d; d = c; c = rotate_left(b, 30); b = a; a = temp;
+			}
+			for(int x=40; x<60; ++x){
+				boost::uint32_t temp = rotate_left(a, 5) + ((b & c) | (b & d) | (c & d))
+					+ e + 0x8F1BBCDC + w[x];
+				e = d; d = c; c = rotate_left(b, 30); b = a; a = temp;
+			}
+			for(int x=60; x<80; ++x){
+				boost::uint32_t temp = rotate_left(a, 5) + (b ^ c ^ d)
+					+ e + 0xCA62C1D6 + w[x];
+				e = d; d = c; c = rotate_left(b, 30); b = a; a = temp;
+			}
+			state[0] += a;
+			state[1] += b;
+			state[2] += c;
+			state[3] += d;
+			state[4] += e;
 		}
+	}
+
+#ifdef SHA1_X86
+	/*
+	Each sha1rnds4 does 4 rounds. Group g (0-19) does rounds g*4 to g*4+3. The
+	message schedule for group g+4 is computed in M[g%4] by sha1msg1 in group
+	g+1, xor in group g+2, and sha1msg2 in group g+3.
+	*/
+	#define SHA1_NI_GROUP(g) \
+		E[(g)%2] = _mm_sha1nexte_epu32(E[(g)%2], M[(g)%4]); \
+		E[((g)+1)%2] = ABCD; \
+		ABCD = _mm_sha1rnds4_epu32(ABCD, E[(g)%2], (g)/5); \
+		if((g) >= 3){ M[((g)+1)%4] = _mm_sha1msg2_epu32(M[((g)+1)%4], M[(g)%4]); } \
+		if((g) >= 2){ M[((g)+2)%4] = _mm_xor_si128(M[((g)+2)%4], M[(g)%4]); } \
+		M[((g)+3)%4] = _mm_sha1msg1_epu32(M[((g)+3)%4], M[(g)%4]);
 
-		boost::uint32_t a, b, c, d, e;
-		a = h[0].n;
-		b = h[1].n;
-		c = h[2].n;
-		d = h[3].n;
-		e = h[4].n;
-		for(int x=0; x<80; ++x){
-			boost::uint32_t f, k;
-			if(0 <= x && x <= 19){
-				f = (b & c) | ((~b) & d);
-				k = 0x5A827999;
-			}else if(20 <= x && x <= 39){
-				f = b ^ c ^ d;
-				k = 0x6ED9EBA1;
-			}else if(40 <= x && x <= 59){
-				f = (b & c) | (b & d) | (c & d);
-				k = 0x8F1BBCDC;
-			}else if(60 <= x && x <= 79){
-				f = b ^ c ^ d;
-				k = 0xCA62C1D6;
+	__attribute__((target("sha,sse4.1,ssse3")))
+	static void compress_sha_ni(boost::uint32_t * state, const unsigned char * data,
+		std::size_t blocks)
+	{
+		//reverses bytes of the message and order of the words
+		const __m128i mask = _mm_set_epi64x(0x0001020304050607ULL, 0x08090a0b0c0d0e0fULL);
+		__m128i ABCD = _mm_shuffle_epi32(_mm_loadu_si128(
+			reinterpret_cast<const __m128i *>(state)), 0x1B);
+		__m128i E_save = _mm_set_epi32(state[4], 0, 0, 0);
+		__m128i E[2];
+		__m128i M[4];
+		for(; blocks; --blocks, data += block_size){
+			__m128i ABCD_save = ABCD;
+			for(int x=0; x<4; ++x){
+				M[x] = _mm_shuffle_epi8(_mm_loadu_si128(
+					reinterpret_cast<const __m128i *>(data + x * 16)), mask);
 			}
-			boost::uint32_t temp = rotate_left(a, 5) + f + e + k + w[x].n;
-			e = d;
-			d = c;
-			c = rotate_left(b, 30);
-			b = a;
-			a = temp;
+			//group 0 adds E directly since there is no previous E to rotate
+			E[0] = _mm_add_epi32(E_save, M[0]);
+			E[1] = ABCD;
+			ABCD = _mm_sha1rnds4_epu32(ABCD, E[0], 0);
+			SHA1_NI_GROUP(1) SHA1_NI_GROUP(2) SHA1_NI_GROUP(3) SHA1_NI_GROUP(4)
+			SHA1_NI_GROUP(5) SHA1_NI_GROUP(6) SHA1_NI_GROUP(7) SHA1_NI_GROUP(8)
+			SHA1_NI_GROUP(9) SHA1_NI_GROUP(10) SHA1_NI_GROUP(11) SHA1_NI_GROUP(12)
+			SHA1_NI_GROUP(13) SHA1_NI_GROUP(14) SHA1_NI_GROUP(15) SHA1_NI_GROUP(16)
+			SHA1_NI_GROUP(17) SHA1_NI_GROUP(18) SHA1_NI_GROUP(19)
+			E_save = _mm_sha1nexte_epu32(E[0], E_save);
+			ABCD = _mm_add_epi32(ABCD, ABCD_save);
 		}
-		h[0].n += a;
-		h[1].n += b;
-		h[2].n += c;
-		h[3].n += d;
-		h[4].n += e;
+		_mm_storeu_si128(reinterpret_cast<__m128i *>(state), _mm_shuffle_epi32(ABCD, 0x1B));
+		state[4] = _mm_extract_epi32(E_save, 3);
 	}
+	#undef SHA1_NI_GROUP
 
-	//bit rotation
-	boost::uint32_t rotate_right(boost::uint32_t data, unsigned bits)
+	__attribute__((target("avx2")))
+	static __m256i rotate_left_x8(const __m256i data, const int bits)
 	{
-		assert(bits <= 32);
-		return ((data >> bits) | (data << (32 - bits)));
+		return _mm256_or_si256(_mm256_slli_epi32(data, bits),
+			_mm256_srli_epi32(data, 32 - bits));
 	}
-	boost::uint32_t rotate_left(boost::uint32_t data, unsigned bits)
+
+	/*
+	Hash blocks of 8 messages at once. Lane y of state[x] holds h[x] of
+	message y. The block offset is the same for all messages.
+	*/
+	__attribute__((target("avx2")))
+	static void compress_avx2(__m256i * state, const unsigned char * const * data,
+		const std::size_t offset, std::size_t blocks)
 	{
-		assert(bits <= 32);
-		return ((data << bits) | (data >> (32 - bits)));
+		__m256i w[16];
+		for(std::size_t b_off = offset; blocks; --blocks, b_off += block_size){
+			for(int x=0; x<16; ++x){
+				w[x] = _mm256_set_epi32(
+					load_be(data[7] + b_off + x * 4), load_be(data[6] + b_off + x * 4),
+					load_be(data[5] + b_off + x * 4), load_be(data[4] + b_off + x * 4),
+					load_be(data[3] + b_off + x * 4), load_be(data[2] + b_off + x * 4),
+					load_be(data[1] + b_off + x * 4), load_be(data[0] + b_off + x * 4));
+			}
+			__m256i a = state[0], b = state[1], c = state[2], d = state[3], e = state[4];
+			for(int x=0; x<80; ++x){
+				if(x >= 16){
+					//expand in place, w is a ring of the last 16 words
+					w[x & 15] = rotate_left_x8(_mm256_xor_si256(
+						_mm256_xor_si256(w[(x-3) & 15], w[(x-8) & 15]),
+						_mm256_xor_si256(w[(x-14) & 15], w[x & 15])), 1);
+				}
+				__m256i f, k;
+				if(x <= 19){
+					f = _mm256_or_si256(_mm256_and_si256(b, c), _mm256_andnot_si256(b, d));
+					k = _mm256_set1_epi32(0x5A827999);
+				}else if(x <= 39){
+					f = _mm256_xor_si256(_mm256_xor_si256(b, c), d);
+					k = _mm256_set1_epi32(0x6ED9EBA1);
+				}else if(x <= 59){
+					f = _mm256_or_si256(_mm256_and_si256(b, c),
+						_mm256_and_si256(d, _mm256_or_si256(b, c)));
+					k = _mm256_set1_epi32(0x8F1BBCDC);
+				}else{
+					f = _mm256_xor_si256(_mm256_xor_si256(b, c), d);
+					k = _mm256_set1_epi32(0xCA62C1D6);
+				}
+				__m256i temp = _mm256_add_epi32(_mm256_add_epi32(rotate_left_x8(a, 5), f),
+					_mm256_add_epi32(_mm256_add_epi32(e, k), w[x & 15]));
+				e = d;
+				d = c;
+				c = rotate_left_x8(b, 30);
+				b = a;
+				a = temp;
+			}
+			state[0] = _mm256_add_epi32(state[0], a);
+			state[1] = _mm256_add_epi32(state[1], b);
+			state[2] = _mm256_add_epi32(state[2], c);
+			state[3] = _mm256_add_epi32(state[3], d);
+			state[4] = _mm256_add_epi32(state[4], e);
+		}
+	}
+
+	//hash 8 messages of len bytes, hashes written contiguously to hash
+	__attribute__((target("avx2")))
+	static void multi_avx2(const char * const * data, const std::size_t len, char * hash)
+	{
+		const unsigned char * msg[8];
+		for(int x=0; x<8; ++x){
+			msg[x] = reinterpret_cast<const unsigned char *>(data[x]);
+		}
+		__m256i state[5] = {
+			_mm256_set1_epi32(0x67452301),
+			_mm256_set1_epi32(0xEFCDAB89),
+			_mm256_set1_epi32(0x98BADCFE),
+			_mm256_set1_epi32(0x10325476),
+			_mm256_set1_epi32(0xC3D2E1F0)
+		};
+		compress_avx2(state, msg, 0, len / block_size);
+
+		//padding, same number of tail blocks for all since lengths are equal
+		unsigned char tail[8][block_size * 2];
+		const unsigned char * tail_ptr[8];
+		std::size_t used = len % block_size;
+		std::size_t pad_to = used < block_size - 8 ? block_size : block_size * 2;
+		boost::uint64_t bits = static_cast<boost::uint64_t>(len) * 8;
+		for(int x=0; x<8; ++x){
+			std::memcpy(tail[x], msg[x] + len - used, used);
+			tail[x][used] = 0x80;
+			std::memset(tail[x] + used + 1, 0, pad_to - used - 1);
+			for(int y=0; y<8; ++y){
+				tail[x][pad_to - 1 - y] = static_cast<unsigned char>(bits >> (y * 8));
+			}
+			tail_ptr[x] = tail[x];
+		}
+		compress_avx2(state, tail_ptr, 0, pad_to / block_size);
+
+		boost::uint32_t lane[8];
+		for(int x=0; x<5; ++x){
+			_mm256_storeu_si256(reinterpret_cast<__m256i *>(lane), state[x]);
+			for(int y=0; y<8; ++y){
+				store_be(hash + y * bin_size + x * 4, lane[y]);
+			}
+		}
 	}
+#endif
 };
 #endif
@@ -2,12 +2,18 @@
 #define H_CHANNEL
 
 //include
+#include <boost/atomic.hpp>
+#include <boost/function.hpp>
 #include <boost/optional.hpp>
+#include <boost/scoped_array.hpp>
 #include <boost/shared_ptr.hpp>
 #include <boost/thread.hpp>
+#include <boost/utility.hpp>
 #include <logger.hpp>
 
 //std
+#include <cassert>
+#include <cstddef>
 #include <list>
 #include <set>
 
@@ -21,72 +27,51 @@ template<typename T> class promise;
 Channel primitive. Generally this should not be used directly because everyone
 who has a copy can send and receive. However, this might be desired in some
 situations.
+
+A bounded channel uses a lock-free ring buffer. The mutex is only taken when a
+thread has to block (queue empty or full) or when a call back is registered.
+An unbounded channel uses a list protected by a mutex.
 */
 template<typename T>
 class primitive
 {
 public:
 	//0 buf_size means unbounded buffer size
-	explicit primitive(const unsigned buf_size = 0):
-		Wrap(new wrap(buf_size))
-	{}
-
-	//call back when ready to recv
-	bool call_back_recv(const boost::function<void ()> & func) const
+	explicit primitive(const unsigned buf_size = 0)
 	{
-		boost::mutex::scoped_lock lock(Wrap->mutex);
-		assert(!Wrap->recv_call_back);
-		if(Wrap->queue.empty()){
-			Wrap->recv_call_back = func;
-			return false;
+		if(buf_size == 0){
+			Wrap.reset(new list_wrap());
 		}else{
-			return true;
+			Wrap.reset(new ring_wrap(buf_size));
 		}
 	}
 
-	//call back when ready to send
+	/*
+	call_back_recv:
+		Call back when ready to recv. Returns true (and doesn't register call
+		back) if already ready.
+	call_back_send:
+		Call back when ready to send. Returns true (and doesn't register call
+		back) if already ready.
+	*/
+	bool call_back_recv(const boost::function<void ()> & func) const
+	{
+		return Wrap->call_back_recv(func);
+	}
+
 	bool call_back_send(const boost::function<void ()> & func) const
 	{
-		boost::mutex::scoped_lock lock(Wrap->mutex);
-		assert(!Wrap->send_call_back);
-		if(Wrap->queue.size() >= Wrap->buf_size){
-			Wrap->send_call_back = func;
-			return false;
-		}else{
-			return true;
-		}
+		return Wrap->call_back_send(func);
 	}
 
 	T recv() const
 	{
-		boost::mutex::scoped_lock lock(Wrap->mutex);
-		while(Wrap->queue.empty()){
-			Wrap->producer_cond.wait(Wrap->mutex);
-		}
-		T tmp = Wrap->queue.front();
-		Wrap->queue.pop_front();
-		Wrap->consumer_cond.notify_one();
-		if(Wrap->send_call_back){
-			Wrap->send_call_back();
-			Wrap->send_call_back.clear();
-		}
-		return tmp;
+		return Wrap->recv();
 	}
 
 	void send(T t) const
 	{
-		boost::mutex::scoped_lock lock(Wrap->mutex);
-		if(Wrap->buf_size != 0){
-			while(Wrap->queue.size() >= Wrap->buf_size){
-				Wrap->consumer_cond.wait(Wrap->mutex);
-			}
-		}
-		Wrap->queue.push_back(t);
-		Wrap->producer_cond.notify_one();
-		if(Wrap->recv_call_back){
-			Wrap->recv_call_back();
-			Wrap->recv_call_back.clear();
-		}
+		Wrap->send(t);
 	}
 
 	bool operator < (const primitive & rval) const
@@ -95,20 +80,341 @@ public:
 	}
 
 private:
-	class wrap
+	class wrap : private boost::noncopyable
 	{
 	public:
-		explicit wrap(const unsigned buf_size_in):
-			buf_size(buf_size_in)
-		{}
+		virtual ~wrap(){}
+		virtual bool call_back_recv(const boost::function<void ()> & func) = 0;
+		virtual bool call_back_send(const boost::function<void ()> & func) = 0;
+		virtual T recv() = 0;
+		virtual void send(const T & t) = 0;
+	};
+
+	//unbounded
+	class list_wrap : public wrap
+	{
+	public:
+		virtual bool call_back_recv(const boost::function<void ()> & func)
+		{
+			boost::mutex::scoped_lock lock(mutex);
+			assert(!recv_call_back);
+			if(queue.empty()){
+				recv_call_back = func;
+				return false;
+			}else{
+				return true;
+			}
+		}
+
+		//send never blocks so always ready
+		virtual bool call_back_send(const boost::function<void ()> & func)
+		{
+			return true;
+		}
+
+		virtual T recv()
+		{
+			boost::mutex::scoped_lock lock(mutex);
+			while(queue.empty()){
+				producer_cond.wait(mutex);
+			}
+			T tmp = queue.front();
+			queue.pop_front();
+			return tmp;
+		}
+
+		virtual void send(const T & t)
+		{
+			boost::mutex::scoped_lock lock(mutex);
+			queue.push_back(t);
+			producer_cond.notify_one();
+			if(recv_call_back){
+				recv_call_back();
+				recv_call_back.clear();
+			}
+		}
+
+	private:
 		boost::mutex mutex;
-		unsigned buf_size;
-		boost::condition_variable_any consumer_cond;
 		boost::condition_variable_any producer_cond;
 		typename std::list<T> queue;
 		boost::function<void ()> recv_call_back;
+	};
+
+	/*
+	Bounded MPMC ring buffer (Dmitry Vyukov's algorithm). Each cell has a
+	sequence number which tells producers and consumers whether it's their turn
+	to use the cell. Threads only block on the condition variables after
+	spinning, and only notify when a thread is known to be waiting.
+
+	The algorithm needs at least 2 cells (with 1 cell a full cell's sequence
+	number equals the next enqueue position) so the ring is rounded up to a
+	power of two >= 2. The buf_size bound is enforced by the slots counter.
+	*/
+	class ring_wrap : public wrap
+	{
+		//times to retry before blocking
+		static const unsigned spin = 64;
+	public:
+		explicit ring_wrap(const unsigned buf_size):
+			ring_size(round_ring_size(buf_size)),
+			Cell(new cell[ring_size]),
+			slots(buf_size),
+			enqueue_pos(0),
+			dequeue_pos(0),
+			recv_waiting(0),
+			send_waiting(0),
+			call_back_cnt(0)
+		{
+			for(std::size_t x=0; x<ring_size; ++x){
+				Cell[x].seq.store(x, boost::memory_order_relaxed);
+			}
+		}
+
+		virtual bool call_back_recv(const boost::function<void ()> & func)
+		{
+			boost::mutex::scoped_lock lock(mutex);
+			assert(!recv_call_back);
+			recv_call_back = func;
+			++call_back_cnt;
+			//pairs with fence in notify_recv
+			boost::atomic_thread_fence(boost::memory_order_seq_cst);
+			if(!empty()){
+				recv_call_back.clear();
+				--call_back_cnt;
+				return true;
+			}
+			return false;
+		}
+
+		virtual bool call_back_send(const boost::function<void ()> & func)
+		{
+			boost::mutex::scoped_lock lock(mutex);
+			assert(!send_call_back);
+			send_call_back = func;
+			++call_back_cnt;
+			//pairs with fence in notify_send
+			boost::atomic_thread_fence(boost::memory_order_seq_cst);
+			if(!full()){
+				send_call_back.clear();
+				--call_back_cnt;
+				return true;
+			}
+			return false;
+		}
+
+		virtual T recv()
+		{
+			boost::optional<T> t;
+			for(unsigned x=0; x<spin; ++x){
+				if(t = try_recv()){
+					notify_send();
+					return *t;
+				}
+			}
+			{//BEGIN lock scope
+			boost::mutex::scoped_lock lock(mutex);
+			++recv_waiting;
+			//pairs with fence in notify_recv
+			boost::atomic_thread_fence(boost::memory_order_seq_cst);
+			while(!(t = try_recv())){
+				producer_cond.wait(mutex);
+			}
+			--recv_waiting;
+			}//END lock scope
+			notify_send();
+			return *t;
+		}
+
+		virtual void send(const T & t)
+		{
+			for(unsigned x=0; x<spin; ++x){
+				if(try_send(t)){
+					notify_recv();
+					return;
+				}
+			}
+			{//BEGIN lock scope
+			boost::mutex::scoped_lock lock(mutex);
+			++send_waiting;
+			//pairs with fence in notify_send
+			boost::atomic_thread_fence(boost::memory_order_seq_cst);
+			while(!try_send(t)){
+				consumer_cond.wait(mutex);
+			}
+			--send_waiting;
+			}//END lock scope
+			notify_recv();
+		}
+
+	private:
+		class cell
+		{
+		public:
+			boost::atomic<std::size_t> seq;
+			boost::optional<T> val;
+		};
+
+		const std::size_t ring_size; //power of 2 >= 2
+		boost::scoped_array<cell> Cell;
+		boost::atomic<unsigned> slots; //elements that may be sent before full
+		//positions on separate cache lines so producers and consumers don't share
+		char pad_0[64];
+		boost::atomic<std::size_t> enqueue_pos;
+		char pad_1[64];
+		boost::atomic<std::size_t> dequeue_pos;
+		char pad_2[64];
+		boost::atomic<unsigned> recv_waiting;  //threads blocked in recv
+		boost::atomic<unsigned> send_waiting;  //threads blocked in send
+		boost::atomic<unsigned> call_back_cnt; //registered call backs
+
+		boost::mutex mutex; //locks condition variables and call backs
+		boost::condition_variable_any consumer_cond; //notified when cell freed
+		boost::condition_variable_any producer_cond; //notified when cell filled
+		boost::function<void ()> recv_call_back;
 		boost::function<void ()> send_call_back;
+
+		//returns smallest power of 2 that is >= buf_size and >= 2
+		static std::size_t round_ring_size(const unsigned buf_size)
+		{
+			std::size_t size = 2;
+			while(size < buf_size){
+				size <<= 1;
+			}
+			return size;
+		}
+
+		/*
+		empty:
+			Returns true if no cell ready to recv.
+		full:
+			Returns true if buf_size elements already in the ring.
+		*/
+		bool empty()
+		{
+			std::size_t pos = dequeue_pos.load(boost::memory_order_relaxed);
+			return Cell[pos & (ring_size - 1)].seq.load(boost::memory_order_acquire)
+				!= pos + 1;
+		}
+
+		bool full()
+		{
+			return slots.load(boost::memory_order_acquire) == 0;
+		}
+
+		/*
+		notify_recv:
+			Called after send. Wakes a blocked receiver and does recv call back.
+		notify_send:
+			Called after recv. Wakes a blocked sender and does send call back.
+		*/
+		void notify_recv()
+		{
+			boost::atomic_thread_fence(boost::memory_order_seq_cst);
+			if(recv_waiting.load(boost::memory_order_relaxed) == 0
+				&& call_back_cnt.load(boost::memory_order_relaxed) == 0)
+			{
+				return;
+			}
+			boost::mutex::scoped_lock lock(mutex);
+			producer_cond.notify_one();
+			if(recv_call_back){
+				recv_call_back();
+				recv_call_back.clear();
+				--call_back_cnt;
+			}
+		}
+
+		void notify_send()
+		{
+			boost::atomic_thread_fence(boost::memory_order_seq_cst);
+			if(send_waiting.load(boost::memory_order_relaxed) == 0
+				&& call_back_cnt.load(boost::memory_order_relaxed) == 0)
+			{
+				return;
+			}
+			boost::mutex::scoped_lock lock(mutex);
+			consumer_cond.notify_one();
+			if(send_call_back){
+				send_call_back();
+				send_call_back.clear();
+				--call_back_cnt;
+			}
+		}
+
+		/*
+		try_recv:
+			Returns element if one recv'd, or empty optional if empty.
+		try_send:
+			Returns true if t sent, false if full.
+		release_slot:
+			Called after a cell is freed. Allows another element to be sent.
+		*/
+		boost::optional<T> try_recv()
+		{
+			std::size_t pos = dequeue_pos.load(boost::memory_order_relaxed);
+			while(true){
+				cell & C = Cell[pos & (ring_size - 1)];
+				std::size_t seq = C.seq.load(boost::memory_order_acquire);
+				if(seq == pos + 1){
+					if(dequeue_pos.compare_exchange_weak(pos, pos + 1,
+						boost::memory_order_relaxed))
+					{
+						boost::optional<T> t;
+						t.swap(C.val);
+						C.seq.store(pos + ring_size, boost::memory_order_release);
+						release_slot();
+						return t;
+					}
+				}else if(seq < pos + 1){
+					return boost::optional<T>();
+				}else{
+					pos = dequeue_pos.load(boost::memory_order_relaxed);
+				}
+			}
+		}
+
+		bool try_send(const T & t)
+		{
+			//reserve a slot so no more than buf_size elements are in the ring
+			unsigned avail = slots.load(boost::memory_order_relaxed);
+			do{
+				if(avail == 0){
+					return false;
+				}
+			}while(!slots.compare_exchange_weak(avail, avail - 1,
+				boost::memory_order_acquire));
+			std::size_t pos = enqueue_pos.load(boost::memory_order_relaxed);
+			while(true){
+				cell & C = Cell[pos & (ring_size - 1)];
+				std::size_t seq = C.seq.load(boost::memory_order_acquire);
+				if(seq == pos){
+					if(enqueue_pos.compare_exchange_weak(pos, pos + 1,
+						boost::memory_order_relaxed))
+					{
+						C.val = t;
+						C.seq.store(pos + 1, boost::memory_order_release);
+						return true;
+					}
+				}else if(seq < pos){
+					/*
+					Cell still being recv'd by a consumer which hasn't freed it yet.
+					Give back the slot. The consumer will notify when done.
+					*/
+					release_slot();
+					return false;
+				}else{
+					pos = enqueue_pos.load(boost::memory_order_relaxed);
+				}
+			}
+		}
+
+		void release_slot()
+		{
+			slots.fetch_add(1, boost::memory_order_release);
+		}
 	};
+
 	boost::shared_ptr<wrap> Wrap;
 };
 
@@ -258,8 +564,9 @@ private:
 	class wrap
 	{
 	public:
+		//only one value sent so a buffer of 1 never blocks
 		explicit wrap():
-			Source(source<T>(0)),
+			Source(source<T>(1)),
 			fulfilled(false)
 		{}
 		boost::mutex mutex;
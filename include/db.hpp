@@ -15,6 +15,17 @@ boost::bind can also be used to bind extra parameters to the call back:
 	DB.query("SELECT ...", boost::bind(&call_back, _1, _2, _3, boost::ref(extra)));
 	Note: boost::ref must be used to pass the reference.
 
+************************** Prepared Statements: ********************************
+Parameters are bound instead of put in the query string so nothing needs to be
+escaped. Prepared statements are cached by the connection so the same query is
+only parsed once.
+	db::statement Stmt(*DB, "SELECT test FROM test WHERE key = ?");
+	Stmt.bind(1, key);
+	while(Stmt.step()){
+		std::string test = Stmt.column_text(0);
+	}
+Note: The statement holds a lock on the connection until destroyed.
+
 ************************** Blobs: **********************************************
 Create table with blob field:
 	DB.query("CREATE TABLE test(blob BLOB)");
@@ -44,16 +55,27 @@ Read blob:
 #include <boost/function.hpp>
 #include <boost/shared_ptr.hpp>
 #include <boost/thread.hpp>
+#include <boost/utility.hpp>
 #include <logger.hpp>
 
+//standard
+#include <cassert>
+#include <list>
+#include <map>
+#include <sstream>
+#include <string>
+
 namespace db{
 
 //predecl for PIMPL
 #ifndef _SQLITE3_H_
 class sqlite3;
 class sqlite3_blob;
+class sqlite3_stmt;
 #endif
 
+class statement;
+
 //object needed for reading/writing a blob
 class blob
 {
@@ -76,8 +98,17 @@ public:
 
 class connection : private boost::noncopyable
 {
+	friend class statement;
 public:
-	connection(const std::string & path_in);
+	/*
+	read_only:
+		Open database read only. The database must already exist.
+	mmap_size:
+		Bytes of database to memory map for reads. Ignored if sqlite is too old
+		to support it.
+	*/
+	connection(const std::string & path_in, const bool read_only_in = false,
+		const boost::uint64_t mmap_size_in = 0);
 	~connection();
 
 	/*
@@ -94,6 +125,8 @@ public:
 	blob_write:
 		Write data to blob. Returns true if success else false. Refer to blob_read
 		documentation to see what paramters do.
+	connect:
+		Connects if not already connected. Done automatically on first query.
 	query:
 		Execute a query. The func is used to call back with results.
 	*/
@@ -101,6 +134,7 @@ public:
 	bool blob_read(const blob & Blob, char * const buf, const int size, const int offset);
 	bool blob_size(const blob & Blob, boost::uint64_t & size);
 	bool blob_write(const blob & Blob, const char * const buf, const int size, const int offset);
+	void connect();
 	int query(const std::string & query, boost::function<int (int, char **, char **)>
 		func = boost::function<int (int, char **, char **)>());
 
@@ -113,12 +147,26 @@ private:
 	sqlite3 * DB_handle;
 
 	//used for lazy connect
+	const std::string path;
+	const bool read_only;
+	const boost::uint64_t mmap_size;
 	bool connected;
-	std::string path;
 
 	/*
-	connect:
-		Does lazy connection on first query.
+	Prepared statements not in use. Statement_LRU is ordered by last use with
+	the most recently used at the front. Statement_Cache maps queries to
+	elements of Statement_LRU.
+	*/
+	static const unsigned statement_cache_size = 32;
+	std::list<std::pair<std::string, sqlite3_stmt *> > Statement_LRU;
+	std::map<std::string, std::list<std::pair<std::string, sqlite3_stmt *> >::iterator>
+		Statement_Cache;
+
+	/*
+	backoff:
+		Sleeps longer for higher count. Used when database locked.
+	busy_handler:
+		Called by sqlite when database locked.
 	call_back_wrapper:
 		Function with C signature needed to wrap call backs.
 	blob_close:
@@ -126,15 +174,69 @@ private:
 	blob_open:
 		Open a database blob.
 	*/
-	void connect();
+	static void backoff(const int count);
+	static int busy_handler(void * ptr, int count);
 	static int call_back_wrapper(void * ptr, int columns, char ** response,
 		char ** column_name);
 	bool blob_close(sqlite3_blob * blob_handle);
 	bool blob_open(const blob & Blob, const bool writeable, sqlite3_blob *& blob_handle);
+
+	/*
+	pragma:
+		Runs pragma on connect. Exits program on error.
+	statement_get:
+		Removes prepared statement for query from cache and returns it, or
+		prepares it if not cached. Returns NULL on error.
+	statement_put:
+		Resets statement and returns it to cache. The least recently used
+		statement is finalized if the cache is full.
+	*/
+	void pragma(const std::string & query);
+	sqlite3_stmt * statement_get(const std::string & query);
+	void statement_put(const std::string & query, sqlite3_stmt * stmt);
 };
 
-//function to return std::string with control characters escaped
-std::string escape(const std::string & str);
+class statement : private boost::noncopyable
+{
+public:
+	statement(connection & Connection_in, const std::string & query_in);
+	~statement();
+
+	/*
+	bind:
+		Binds value to parameter. Parameters start at 1. A std::string is bound
+		as text.
+	bind_blob:
+		Binds size bytes at buf to parameter.
+	column_blob:
+		Returns column of current row as bytes. Columns start at 0.
+	column_int64:
+		Returns column of current row as integer.
+	column_text:
+		Returns column of current row as text.
+	error:
+		Returns true if preparing, binding, or stepping failed.
+	step:
+		Steps statement. Returns true if a row is available. Returns false when
+		done or on error.
+	*/
+	bool bind(const int index, const boost::int64_t value);
+	bool bind(const int index, const std::string & value);
+	bool bind_blob(const int index, const char * buf, const int size);
+	std::string column_blob(const int index);
+	boost::int64_t column_int64(const int index);
+	std::string column_text(const int index);
+	bool error() const;
+	bool step();
+
+private:
+	connection & Connection;
+	boost::recursive_mutex::scoped_lock lock;
+	const std::string query;
+	sqlite3_stmt * stmt;
+	bool err;
+	bool stepped; //true if step returned a row
+};
 
 }//end of namespace db
 #endif
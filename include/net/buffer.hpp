@@ -1,7 +1,11 @@
 #ifndef H_NET_BUFFER
 #define H_NET_BUFFER
 
+//custom
+#include "buffer_pool.hpp"
+
 //include
+#include <boost/config.hpp>
 #include <logger.hpp>
 
 //standard
@@ -14,13 +18,23 @@
 #include <string>
 
 namespace net{
+/*
+Bytes up to small_size are stored inside the object without a heap allocation.
+Larger buffers grow geometrically so appends are amortized constant time, their
+storage comes from buffer_pool.
+Erasing from the front advances a head offset instead of moving the bytes.
+*/
 class buffer
 {
+	static const unsigned small_size = 24;
 public:
 	buffer();
 	buffer(const std::string & str);
 	buffer(const unsigned char * buf_append, const unsigned size);
 	buffer(const buffer & B);
+	#ifndef BOOST_NO_CXX11_RVALUE_REFERENCES
+	buffer(buffer && B);
+	#endif
 	~buffer();
 
 	class iterator : public std::iterator<std::random_access_iterator_tag, unsigned char>
@@ -67,6 +81,10 @@ public:
 		Return iterator to beginning of buffer.
 	clear:
 		Clears buffer.
+	consume_front:
+		Erase size bytes from the front of the buffer without moving the
+		remaining bytes.
+		Precondition: size <= size()
 	data:
 		Returns pointer to internal buffer. Both const and non const versions
 		available.
@@ -79,6 +97,7 @@ public:
 	erase (two parameters):
 		Erase bytes in buffer starting at idx and size chars long.
 		Note: If idx + len > buf suze the remainder of the buf erased.
+		Note: Erasing from idx 0 is the same as consume_front.
 	reserve:
 		Specified amount of memory will be left allocated.
 	resize:
@@ -109,6 +128,7 @@ public:
 	buffer & append(const buffer & buf_append);
 	iterator begin() const;
 	void clear();
+	void consume_front(const unsigned size);
 	const unsigned char * data() const;
 	unsigned char * data();
 	bool empty() const;
@@ -131,6 +151,9 @@ public:
 	const unsigned char operator [] (const unsigned idx) const;
 	unsigned char & operator [] (const unsigned idx);
 	buffer & operator = (const buffer & B);
+	#ifndef BOOST_NO_CXX11_RVALUE_REFERENCES
+	buffer & operator = (buffer && B);
+	#endif
 	buffer & operator = (const std::string & str);
 	bool operator == (const buffer & B) const;
 	bool operator == (const std::string & str) const;
@@ -145,20 +168,28 @@ public:
 	}
 
 private:
-	unsigned reserved;   //minimum bytes to be left allocated
-	unsigned bytes;      //how many bytes are currently allocated to buf
-	unsigned char * buf; //what the buffer stores
+	unsigned reserved;   //minimum bytes to be left allocated (from head)
+	unsigned bytes;      //how many bytes are in the buffer
+	unsigned head;       //offset of first byte in buf
+	unsigned capacity;   //bytes allocated to buf
+	unsigned char * buf; //what the buffer stores, points to inline_buf if not on heap
+	unsigned char inline_buf[small_size];
 
 	/*
-	allocate:
-		Resizes or reserves the buffer. To resize pass in bytes for the var
-		parameter. To reserve pass in reserved for the var parameter. The size
-		parameter is the size to resize to or reserve.
 	ctor_initialize:
 		Called by all ctor's to initialize data members.
+	grow:
+		Make sure there is room for size bytes after head. Existing bytes are
+		kept.
+	release:
+		Free heap memory and go back to using inline_buf. Bytes are discarded.
+	take:
+		Take contents of B without copying heap memory. B is left empty.
 	*/
-	void allocate(unsigned & var, const unsigned size);
 	void ctor_initialize();
+	void grow(const unsigned size);
+	void release();
+	void take(buffer & B);
 };
 }//end of namespace net
 #endif
@@ -0,0 +1,67 @@
+/*
+Size classed memory pool for net::buffer storage. Each thread caches freed
+blocks so most allocations don't touch the system allocator or take a lock.
+Memory freed by a different thread than allocated it goes in to the freeing
+thread's cache. When a thread's cache for a class fills, half of it is moved to
+a central free list shared by all threads. A thread whose cache is empty refills
+from the central list before using malloc. This returns blocks to threads that
+allocate more than they free (the proactor allocates, the dispatcher frees).
+*/
+#ifndef H_NET_BUFFER_POOL
+#define H_NET_BUFFER_POOL
+
+//include
+#include <boost/atomic.hpp>
+#include <boost/cstdint.hpp>
+#include <boost/thread.hpp>
+#include <boost/thread/tss.hpp>
+#include <boost/utility.hpp>
+
+//standard
+#include <cassert>
+#include <cstddef>
+#include <cstdlib>
+#include <set>
+#include <vector>
+
+namespace net{
+class buffer_pool : private boost::noncopyable
+{
+public:
+	static const unsigned min_size = 64;    //smallest size class
+	static const unsigned max_size = 65536; //largest size class, above this malloc used
+	static const unsigned classes = 11;     //number of size classes (powers of 2)
+	static const unsigned max_class_bytes = 1024 * 1024; //max cached per class per thread
+	static const unsigned max_central_bytes = 8 * 1024 * 1024; //max in central list per class
+
+	class class_stats
+	{
+	public:
+		class_stats();
+		unsigned size;          //size of blocks in class
+		boost::uint64_t hits;   //allocations that reused a cached block
+		boost::uint64_t misses; //allocations that needed malloc
+		unsigned high_water;    //most blocks cached by one thread at once
+		unsigned central;       //blocks in central free list
+	};
+
+	/*
+	allocate:
+		Returns memory of at least size bytes. The size is rounded up to the size
+		class and the rounded size is stored in size.
+	deallocate:
+		Return memory allocated with allocate. The size must be the rounded size.
+	stats:
+		Returns statistics for each size class, smallest first. Includes threads
+		that have exited. Counters of running threads are atomics read without
+		locking so they may be slightly stale.
+	*/
+	static unsigned char * allocate(unsigned & size);
+	static void deallocate(unsigned char * buf, const unsigned size);
+	static std::vector<class_stats> stats();
+
+private:
+	buffer_pool(){}
+};
+}//end namespace net
+#endif
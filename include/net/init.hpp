@@ -5,6 +5,9 @@
 #include <logger.hpp>
 #include <portable.hpp>
 
+//standard
+#include <csignal>
+
 namespace net{
 class init
 {
@@ -18,6 +21,8 @@ public:
 
 	/*
 	For every call to start() there must be exactly one call to stop().
+	Note: On POSIX systems start() ignores SIGPIPE because sendfile() has no
+		MSG_NOSIGNAL equivalent.
 	*/
 	static void start();
 	static void stop();
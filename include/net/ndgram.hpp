@@ -4,10 +4,25 @@
 //custom
 #include "socket_base.hpp"
 
+//standard
+#include <deque>
+
 namespace net{
 class ndgram : public socket_base
 {
 public:
+	//max datagrams to send/recv in one system call
+	static const unsigned max_batch = 64;
+
+	//datagram and the endpoint it came from, or is going to
+	class datagram
+	{
+	public:
+		explicit datagram(const endpoint & ep_in);
+		endpoint ep;
+		buffer buf;
+	};
+
 	ndgram();                   //don't bind to local port (used for send only)
 	ndgram(const endpoint & E); //open and bind to local port (used for send/recv)
 
@@ -22,14 +37,31 @@ public:
 	recv:
 		Receive data. Returns number of bytes received or 0 if the host
 		disconnected. E is set to the endpoint of the host that sent the data. E
-		may be empty if error.
+		may be empty if error. If non-blocking returns -1 without closing the
+		socket if no datagram to recv.
 	send:
 		Writes bytes from buffer. Returns the number of bytes sent or 0 if the
-		host disconnected. The sent bytes are erased from the buffer.
+		host disconnected. The sent bytes are erased from the buffer. If
+		non-blocking returns -1 without closing the socket if OS buffer full.
+		Errors about one host (unreachable, datagram too big) don't close the
+		socket. The datagram is dropped as if lost in the network.
+	recv (batch):
+		Receive up to max_cnt datagrams (at most max_batch) with one system call
+		and append them to batch. Returns the number of datagrams received, 0
+		if error (socket closed), or -1 without closing the socket if
+		non-blocking and no datagram to recv.
+	send (batch):
+		Send datagrams from the front of batch (at most max_batch) with one
+		system call. Returns the number of datagrams sent, 0 if error (socket
+		closed), or -1 without closing the socket if non-blocking and OS buffer
+		full. The caller erases the sent datagrams from the front of batch.
+		Datagrams which can't reach their host are counted as sent (see send).
 	*/
 	virtual void open(const endpoint & E);
 	int recv(net::buffer & buf, boost::optional<endpoint> & E);
 	int send(net::buffer & buf, const endpoint & E);
+	int recv(std::deque<datagram> & batch, const unsigned max_cnt = max_batch);
+	int send(const std::deque<datagram> & batch);
 };
 }//end namespace net
 #endif
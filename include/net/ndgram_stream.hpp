@@ -4,18 +4,126 @@
 //custom
 #include "ndgram.hpp"
 
+//include
+#include <boost/cstdint.hpp>
+#include <boost/date_time/posix_time/posix_time.hpp>
+#include <boost/function.hpp>
+#include <boost/shared_ptr.hpp>
+#include <boost/utility.hpp>
+#include <portable.hpp>
+#include <timer_wheel.hpp>
+
+//standard
+#include <cstdlib>
+#include <ctime>
+#include <deque>
+#include <map>
+#include <set>
+
 namespace net{
 /*
-ndgram_stream multiplexes connections on the same port. It handles reassembling
-streams that arrive from multiple hosts.
+ndgram_stream multiplexes reliable, ordered streams to many hosts on the same
+UDP socket. It handles reassembling streams that arrive from multiple hosts.
+
+Lost packets are found with selective ACKs and retransmitted. Sending is paced
+over the round trip time. Congestion control is LEDBAT (RFC 6817), it backs off
+when one-way delay rises above base delay. Bulk transfers yield to TCP and to
+interactive traffic sharing a bottleneck instead of filling its queue.
+
+Not thread safe. All functions must be called by the thread that calls
+Timer_Wheel.expire().
 */
-class ndgram_stream : public socket_base
+class ndgram_stream : private boost::noncopyable
 {
 public:
-	ndgram_stream()
+	enum event_t{
+		accept_event,  //remote host opened stream to us
+		connect_event, //stream we opened was accepted by remote host
+		recv_event,    //in order bytes received (in buf)
+		send_event,    //bytes in send buffer acknowledged (count in n_bytes)
+		close_event,   //remote host closed stream, or stream timed out
+		write_event,   //OS buffer full, call write() when socket writeable
+		error_event    //socket closed because of error, all streams dropped
+	};
+
+	class event
 	{
+	public:
+		event(
+			const boost::uint32_t ID_in,
+			const event_t type_in,
+			const bool connected_in = true
+		);
+		boost::uint32_t ID; //stream ID (not used for write_event or error_event)
+		event_t type;
+		bool connected;     //false if close_event before stream connected
+		unsigned n_bytes;   //bytes acknowledged (send_event)
+		buffer buf;         //bytes received (recv_event)
+	};
 
-	}
+	/*
+	Timers are armed in Timer_Wheel_in. Events are passed to call_back_in after
+	each call to a function below returns (never during), so the call back may
+	call any of the functions below.
+	*/
+	ndgram_stream(
+		timer_wheel & Timer_Wheel_in,
+		const boost::function<void (event &)> & call_back_in
+	);
+	~ndgram_stream();
+
+	/* Socket
+	close:
+		Close socket. Streams are dropped without notifying remote hosts.
+	impair:
+		Simulate a bad network for testing. Drop loss_percent of datagrams we
+		send and delay the rest by delay_ms. If rate is non-zero datagrams also
+		queue at a bottleneck which sends rate bytes/second.
+	is_open:
+		Returns true if socket open.
+	local_ep:
+		Returns local endpoint or nothing if error.
+	open:
+		Open non-blocking UDP socket bound to ep. Port "0" picks random port.
+	read:
+		Recv all available datagrams. Call when socket readable.
+	socket:
+		Returns socket file descriptor.
+	want_write:
+		Returns true if datagrams waiting for OS buffer space.
+	write:
+		Send datagrams waiting for OS buffer space. Call when socket writeable.
+	*/
+	void close();
+	void impair(const unsigned loss_percent_in, const unsigned delay_ms_in,
+		const unsigned rate_in = 0);
+	bool is_open() const;
+	boost::optional<endpoint> local_ep();
+	void open(const endpoint & ep);
+	void read();
+	int socket();
+	bool want_write();
+	void write();
+
+	/* Streams
+	close:
+		Close stream. Bytes in send buffer are still sent. No more events are
+		done for the stream.
+	connect:
+		Open stream to remote host. Returns ID of the stream. A connect_event
+		or close_event will follow.
+	remote_ep:
+		Returns endpoint of remote host or nothing if no stream with ID.
+	send:
+		Append buf to stream send buffer. Buf is empty after the call.
+	send_buf_size:
+		Returns bytes in send buffer, including sent bytes not yet acknowledged.
+	*/
+	void close(const boost::uint32_t ID);
+	boost::uint32_t connect(const endpoint & ep);
+	boost::optional<endpoint> remote_ep(const boost::uint32_t ID);
+	void send(const boost::uint32_t ID, buffer & buf);
+	unsigned send_buf_size(const boost::uint32_t ID);
 
 private:
 	/* Max IPv4/UDP MTU
@@ -45,36 +153,277 @@ private:
 	/* Headers
 	We encapsulate the RUDP header inside the IP/UDP header. So basically this is
 	the IP/UDP/RUDP header. This first byte is treated as an unsigned integer.
-	This byte specifies what kind of header will follow.
+	This byte specifies what kind of header will follow. All integers are
+	big-endian. Type 0 is reserved for unreliable datagrams.
 
-	Unreliable Datagram
-	+---+---+---+---+
-	| 0 |    data   |
-	+---+---+---+---+
-	  0   1  ...  n
+	Each end picks a random 4 byte ID for the stream. Packets are addressed to
+	the ID chosen by the receiver (dst_ID). The seq_num counts packets, not
+	bytes. The first seq_num is chosen at random. Each end numbers the packets
+	it sends.
 
 	Connect (like TCP SYN)
-	+---+---+---+---+---+---+---+
-	| 1 |  conn_ID  |  seq_num  |
-	+---+---+---+---+---+---+---+
+	+---+---+---+---+---+---+---+---+---+
+	| 1 |    src_ID     |    seq_num    |
+	+---+---+---+---+---+---+---+---+---+
 	  0   1  ...  4   5  ...  8
 
 	Accept Connect (like TCP SYN+ACK)
-	+---+---+---+---+---+---+---+
-	| 1 |  conn_ID  |  seq_num  |
-	+---+---+---+---+---+---+---+
-	  0   1  ...  4   5  ...  8
-	note: conn_ID must equal conn_ID in Connect message
-	note: seq_num must equal seq_num in Connect message
+	+---+---+---+---+---+---+---+---+---+---+---+---+---+
+	| 2 |    dst_ID     |    src_ID     |    seq_num    |
+	+---+---+---+---+---+---+---+---+---+---+---+---+---+
+	  0   1  ...  4   5  ...  8   9  ...  12
+	note: dst_ID must equal src_ID in Connect message
 
 	Stream
-	+---+---+---+---+---+---+
-	| 1 |seq_num|    data   |
-	+---+---+---+---+---+---+
-	  0   1   2   4  ...  n
+	+---+---+---+---+---+---+---+---+---+---+---+---+---+---+---+
+	| 3 |    dst_ID     |    seq_num    |   timestamp   |  data |
+	+---+---+---+---+---+---+---+---+---+---+---+---+---+---+---+
+	  0   1  ...  4   5  ...  8   9  ...  12  13  ...  n
+	note: timestamp is sender's clock in microseconds (low 32 bits)
+
+	ACK
+	+---+---+---+---+---+---+---+---+---+---+---+---+---+---+---+---+---+
+	| 4 |    dst_ID     |    ack_num    |     SACK      |     delay     |
+	+---+---+---+---+---+---+---+---+---+---+---+---+---+---+---+---+---+
+	  0   1  ...  4   5  ...  8   9  ...  12  13  ...  16
+	note: ack_num is the next seq_num expected, all before it were received
+	note: bit x of SACK (least significant first) set if ack_num + 1 + x received
+	note: delay is receiver's clock minus timestamp of newest stream packet, it
+		is one-way delay plus an unknown clock offset
+
+	Close (like TCP FIN), sent in order after all stream data
+	+---+---+---+---+---+---+---+---+---+---+---+---+---+
+	| 5 |    dst_ID     |    seq_num    |   timestamp   |
+	+---+---+---+---+---+---+---+---+---+---+---+---+---+
+	  0   1  ...  4   5  ...  8   9  ...  12
+
+	Reset (like TCP RST), sent in reply to packet for stream that doesn't exist
+	+---+---+---+---+---+
+	| 6 |      ID       |
+	+---+---+---+---+---+
+	  0   1  ...  4
+	note: ID is the dst_ID of the packet that had no stream
 	*/
+	enum type_t{
+		syn_type = 1,
+		syn_ack_type = 2,
+		data_type = 3,
+		ack_type = 4,
+		fin_type = 5,
+		reset_type = 6
+	};
+	static const unsigned syn_size = 9;
+	static const unsigned syn_ack_size = 13;
+	static const unsigned data_header_size = 13;
+	static const unsigned ack_size = 17;
+	static const unsigned reset_size = 5;
+
+	//max stream bytes in a packet (maximum segment size)
+	static const unsigned MSS = socket_base::MTU - data_header_size;
+
+	//max packets between oldest unacknowledged packet and newest sent packet
+	static const unsigned max_window = 256;
+
+	//packets sent after a packet that must be acknowledged before it's lost
+	static const unsigned dup_thresh = 3;
+
+	//retransmissions of oldest packet before stream times out
+	static const unsigned max_retransmit = 8;
+
+	//LEDBAT target queuing delay (RFC 6817 section 2.5)
+	static const unsigned target_us = 100 * 1000;
+
+	//minutes of base delay history (RFC 6817 section 2.5)
+	static const unsigned base_history = 10;
 
+	//delay samples to filter noise from current delay (RFC 6817 section 2.5)
+	static const unsigned current_filter = 4;
+
+	//how far ahead of pacing schedule packets may be sent, timers aren't precise
+	//enough to pace each packet
+	static const unsigned pace_burst_us = 10 * 1000;
+
+	//retransmission timeout bounds and initial value
+	static const unsigned min_rto_us = 200 * 1000;
+	static const unsigned max_rto_us = 60 * 1000 * 1000;
+	static const unsigned init_rto_us = 1000 * 1000;
+
+	//sent stream packet waiting to be acknowledged
+	class packet
+	{
+	public:
+		packet();
+		buffer payload;
+		bool fin;                      //true if close packet
+		boost::posix_time::ptime sent; //time of last transmission
+		unsigned transmits;            //times sent
+		bool sacked;                   //true if selectively acknowledged
+		bool lost;                     //true if needs retransmit
+		bool in_flight;                //true if counted in stream::in_flight
+	};
+
+	class stream
+	{
+	public:
+		stream(
+			const boost::uint32_t local_ID_in,
+			const endpoint & ep_in
+		);
+		const boost::uint32_t local_ID;
+		boost::uint32_t remote_ID;
+		const endpoint ep;
+		bool established;   //false until accept received (outgoing)
+		bool local_closed;  //close() called
+		bool remote_closed; //close packet received in order
+
+		//send
+		buffer Send_Buf;                           //bytes not yet put in packets
+		std::map<boost::uint64_t, packet> Unacked; //sent packets
+		boost::uint64_t next_seq;                  //seq_num of next new packet
+		boost::uint64_t highest_acked;             //highest seq_num acked or sacked
+		boost::posix_time::ptime latest_acked_sent; //newest send time acked or sacked
+		unsigned unacked_bytes;                    //payload bytes in Unacked
+		unsigned in_flight;                        //payload bytes in network
+		bool fin_queued;                           //close packet put in Unacked
+		boost::posix_time::ptime syn_sent;         //time connect sent (for RTT)
+		unsigned syn_transmits;                    //times connect sent
+
+		//congestion control
+		unsigned cwnd;                    //congestion window (bytes)
+		unsigned ssthresh;                //slow start threshold (bytes)
+		boost::uint64_t recovery_seq;     //no cwnd cut for losses before this
+		boost::int64_t srtt_us;           //smoothed RTT, 0 if no sample yet
+		boost::int64_t rttvar_us;         //RTT variation
+		boost::int64_t rto_us;            //retransmission timeout
+		unsigned rto_cnt;                 //consecutive timeouts
+		bool delay_ref_set;               //true if delay_ref holds first sample
+		boost::uint32_t delay_ref;        //delays are relative to first sample
+		std::deque<std::pair<boost::int64_t, boost::int64_t> > Base_Delay; //minute, min delay
+		std::deque<boost::int64_t> Current_Delay; //newest delay samples
+		boost::posix_time::ptime next_send; //pacing, time next packet may be sent
+		timer_wheel::handle RTO_Timer;
+		timer_wheel::handle Pace_Timer;
+
+		//recv
+		boost::uint64_t recv_next;        //next seq_num expected
+		std::map<boost::uint64_t, std::pair<buffer, bool> > Recv_OOO; //out of order, true if close
+		boost::uint32_t ack_delay;        //delay to put in next ACK
+	};
+
+	//datagram waiting to be sent
+	class datagram
+	{
+	public:
+		datagram(
+			const endpoint & ep_in,
+			const boost::posix_time::ptime & release_in
+		);
+		endpoint ep;
+		boost::posix_time::ptime release; //time to send (impair delay)
+		buffer buf;
+	};
+
+	timer_wheel & Timer_Wheel;
+	const boost::function<void (event &)> call_back;
 	ndgram N;
+
+	//local ID mapped to stream
+	std::map<boost::uint32_t, boost::shared_ptr<stream> > Stream;
+
+	//remote endpoint and remote ID mapped to local ID
+	std::map<std::pair<endpoint, boost::uint32_t>, boost::uint32_t> Remote;
+
+	//streams which received stream packets and need to send ACK
+	std::set<boost::uint32_t> Ack_Pending;
+
+	//events waiting to be passed to call back
+	std::deque<event> Event;
+	bool delivering; //true if in deliver()
+	bool opened;     //true if socket opened and error_event not yet queued
+
+	//datagrams waiting for OS buffer space
+	std::deque<datagram> Out_Queue;
+
+	//network impairment for testing, see impair()
+	unsigned loss_percent;
+	unsigned delay_ms;
+	unsigned rate;
+	boost::posix_time::ptime bottleneck_free; //time bottleneck done sending
+	std::deque<datagram> Delay_Queue;
+	timer_wheel::handle Delay_Timer;
+
+	/*
+	ack_recv:
+		Process ACK.
+	check_socket:
+		Queue error_event if socket was closed because of an error.
+	congestion_control:
+		Update cwnd after bytes acked, delay is from the ACK.
+	data_recv:
+		Process stream or close packet.
+	deliver:
+		Pass queued events to call back.
+	expand:
+		Returns 64 bit seq_num nearest ref with low 32 bits equal to seq_num.
+	new_ID:
+		Returns unused random stream ID.
+	now_us:
+		Returns low 32 bits of our clock in microseconds.
+	packet_acked:
+		Account packet acknowledged (cumulatively or selectively). Adds bytes to
+		acked and sets rtt_us if RTT can be measured.
+	pace_timeout:
+		Timer call back when pacing allows sending.
+	process:
+		Process datagram.
+	raw_send:
+		Send datagram, or queue if OS buffer full.
+	release_delayed:
+		Timer call back to send datagrams delayed by impair().
+	remove:
+		Remove stream and cancel its timers.
+	rto_timeout:
+		Timer call back for retransmission timeout.
+	rtt_sample:
+		Update RTT estimate.
+	send_ack:
+		Send ACK for stream.
+	send_datagram:
+		Send datagram through impairment (if any).
+	send_reset:
+		Send reset to remote host.
+	send_some:
+		Send (or retransmit) packets allowed by cwnd and pacing.
+	send_syn:
+		Send connect.
+	send_syn_ack:
+		Send accept.
+	*/
+	void ack_recv(stream & S, const buffer & buf);
+	void check_socket();
+	void congestion_control(stream & S, const unsigned acked,
+		const unsigned flight, const boost::uint32_t delay);
+	void data_recv(stream & S, const buffer & buf);
+	void deliver();
+	static boost::uint64_t expand(const boost::uint32_t seq_num,
+		const boost::uint64_t ref);
+	boost::uint32_t new_ID();
+	static boost::uint32_t now_us();
+	void packet_acked(stream & S, const boost::uint64_t seq, packet & P,
+		const boost::posix_time::ptime & t, unsigned & acked, boost::int64_t & rtt_us);
+	void pace_timeout(const boost::uint32_t ID);
+	void process(const buffer & buf, const endpoint & from);
+	void raw_send(const endpoint & ep, buffer & buf);
+	void release_delayed();
+	void remove(const boost::uint32_t ID);
+	void rto_timeout(const boost::uint32_t ID);
+	void rtt_sample(stream & S, const boost::int64_t rtt_us);
+	void send_ack(stream & S);
+	void send_datagram(const endpoint & ep, buffer & buf);
+	void send_reset(const endpoint & ep, const boost::uint32_t ID);
+	void send_some(stream & S);
+	void send_syn(stream & S);
+	void send_syn_ack(stream & S);
 };
 }//end namespace net
 #endif
@@ -27,18 +27,36 @@ public:
 		socket connected, or failed to connect.
 		Postcondition: local_ep() will return endpoint if no error.
 	recv:
-		Read bytes in to buffer. Returns the number of bytes read, 0 if the host
-		disconnected, or -1 on error.
+		Append up to max_transfer bytes to buffer. Returns the number of bytes
+		read, 0 if the host disconnected, or -1 on error.
+		Note: If the socket is non-blocking and the recv would block -1 is
+			returned but the socket is left open (is_open() returns true).
 	send:
 		Write bytes from buffer. Returns the number of bytes sent, 0 if the
 		host disconnected, or -1 on error. The sent bytes are erased from the
 		buffer.
+		Note: If the socket is non-blocking and the send would block -1 is
+			returned but the socket is left open (is_open() returns true).
+	send (iovec):
+		Write bytes from iov_cnt buffers with one system call (writev). Returns
+		the number of bytes sent, 0 if the host disconnected, or -1 on error. The
+		buffers are not modified.
+		Note: Same non-blocking behavior as send.
+	send_file:
+		Write up to max_transfer bytes from file_FD starting at offset. On linux
+		sendfile() is used so the bytes are not copied through user space.
+		Returns the number of bytes sent, 0 if the host disconnected or the end
+		of the file was reached, or -1 on error. The offset is advanced by the
+		number of bytes sent. The file position of file_FD is not changed.
+		Note: Same non-blocking behavior as send.
 	*/
 	bool is_open_async();
 	virtual void open(const endpoint & ep);
 	void open_async(const endpoint & ep);
 	int recv(buffer & buf, const int max_transfer = MTU);
 	int send(buffer & buf, int max_transfer = MTU);
+	int send(const iovec * iov, const int iov_cnt);
+	int send_file(const int file_FD, boost::uint64_t & offset, int max_transfer = MTU);
 };
 }//end of namespace net
 #endif
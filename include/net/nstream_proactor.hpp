@@ -5,20 +5,30 @@
 #include "buffer.hpp"
 #include "init.hpp"
 #include "listener.hpp"
+#include "ndgram_stream.hpp"
 #include "nstream.hpp"
 #include "rate_limit.hpp"
 #include "select.hpp"
+#include "speed_calc.hpp"
+#include "token_bucket.hpp"
 
 //include
+#include <boost/enable_shared_from_this.hpp>
 #include <boost/shared_ptr.hpp>
+#include <boost/weak_ptr.hpp>
 #include <channel.hpp>
 #include <portable.hpp>
 #include <thread_pool.hpp>
+#include <timer_wheel.hpp>
 
 //standard
+#include <algorithm>
+#include <deque>
+#include <limits>
 #include <map>
 #include <queue>
 #include <string>
+#include <vector>
 
 namespace net{
 class nstream_proactor : private boost::noncopyable
@@ -46,9 +56,11 @@ public:
 
 	//transport type (what type of connection)
 	enum tran_t{
-		nstream_tran,        //TCP (nstream)
-		nstream_listen_tran, //listener for incoming TCP (nstream)
-		ndgram_tran          //UDP (ndgram)
+		nstream_tran,              //TCP (nstream)
+		nstream_listen_tran,       //listener for incoming TCP (nstream)
+		ndgram_tran,               //UDP (ndgram)
+		ndgram_stream_tran,        //reliable stream over UDP (ndgram_stream)
+		ndgram_stream_listen_tran  //UDP socket ndgram_streams are multiplexed on
 	};
 
 	//information to describe the connection, included with each event
@@ -90,9 +102,10 @@ public:
 	class recv_event
 	{
 	public:
+		//buf_in swapped in to buf, it is empty after construction
 		recv_event(
 			const boost::shared_ptr<const conn_info> & info_in,
-			const buffer & buf_in
+			buffer & buf_in
 		);
 		boost::shared_ptr<const conn_info> info;
 		buffer buf;
@@ -108,51 +121,135 @@ public:
 		);
 		boost::shared_ptr<const conn_info> info;
 		unsigned last_send;     //bytes sent in last send
-		unsigned send_buf_size; //size of send_buf
+		unsigned send_buf_size; //bytes waiting to be sent (includes file ranges)
 	};
 
+	//range of an open file, sent with send_file()
+	class file_range
+	{
+	public:
+		file_range(
+			const int file_FD_in,
+			const boost::uint64_t offset_in,
+			const boost::uint64_t size_in,
+			const boost::shared_ptr<void> & owner_in = boost::shared_ptr<void>(),
+			const unsigned max_rate_in = 0
+		);
+		int file_FD;                   //file to read, must stay open until range sent
+		boost::uint64_t offset;        //offset of first byte to send
+		boost::uint64_t size;          //number of bytes to send
+		boost::shared_ptr<void> owner; //released after range sent (may own file_FD)
+		unsigned max_rate;             //max bytes/second to send range at, 0 unlimited
+	};
+
+	//default number of threads doing call backs
+	static const unsigned default_dispatch_shards = 4;
+
+	//default max bytes read from a connection per recv_event
+	static const unsigned default_max_recv = 256 * 1024;
+
+	/*
+	The backend determines how socket readyness is monitored. See
+	net::select::backend_t. The dispatch_shards is the number of threads which
+	do call backs. Call backs for a connection are always done in order by the
+	same thread. The max_recv is the most bytes read from a connection before a
+	recv_event is dispatched. Everything read from a connection in one readiness
+	cycle (up to max_recv) is passed to a single recv call back.
+	*/
 	nstream_proactor(
 		const boost::function<void (connect_event)> & connect_call_back_in,
 		const boost::function<void (disconnect_event)> & disconnect_call_back_in,
 		const boost::function<void (recv_event)> & recv_call_back_in,
-		const boost::function<void (send_event)> & send_call_back_in
+		const boost::function<void (send_event)> & send_call_back_in,
+		const select::backend_t backend = select::default_backend,
+		const unsigned dispatch_shards = default_dispatch_shards,
+		const unsigned max_recv = default_max_recv
 	);
+	/*
+	Stops the internal thread. The main loop may be waiting on a long timer
+	timeout so select is interrupted.
+	*/
+	~nstream_proactor();
 
 	/* All of these functions are asynchronous.
 	connect:
-		Connect to specified endpoint.
+		Connect to specified endpoint. The tran is nstream_tran or
+		ndgram_stream_tran. A ndgram_stream is multiplexed on the UDP socket
+		started by listen() for the endpoint's IP version, or on a UDP socket
+		bound to a random port if listen() not called.
 	disconnect:
 		Disconnect a connection.
 	listen:
 		Start listener on local endpoint. Returns endpoint listening on or nothing
-		if listen failed.
+		if listen failed. The tran is nstream_tran or ndgram_stream_tran.
 	send:
-		Send buf to specified connection. If close_on_empty is true the
-		connection will be closed when the send_buf becomes empty.
+		Send buf to specified connection. The contents of buf are swapped in to
+		the send queue without copying, buf is empty after the call. If
+		close_on_empty is true the connection will be closed when the send_buf
+		becomes empty.
+	send_file:
+		Send a range of a file to specified connection. Bytes are sent in order
+		with bytes given to send(). The file is not read in to user space (see
+		nstream::send_file) so this should only be used when the bytes don't need
+		to be transformed (encrypted) before sending. If close_on_empty is true
+		the connection will be closed when the send_buf becomes empty.
 	*/
-	void connect(const endpoint & ep);
+	void connect(const endpoint & ep, const tran_t tran = nstream_tran);
 	void disconnect(const boost::uint64_t conn_ID);
-	channel::future<boost::optional<endpoint> > listen(const endpoint & ep);
-	void send(const boost::uint64_t conn_ID, const buffer & buf,
+	channel::future<boost::optional<endpoint> > listen(const endpoint & ep,
+		const tran_t tran = nstream_tran);
+	void send(const boost::uint64_t conn_ID, buffer & buf,
+		const bool close_on_empty = false);
+	void send_file(const boost::uint64_t conn_ID, const file_range & FR,
 		const bool close_on_empty = false);
 
+	/* Rate Limits
+	Limits apply in a hierarchy, a transfer is limited by the global limit, the
+	connection limit, and (for send_file) the file_range limit. The global limit
+	is shared fairly between connections which are ready to transfer.
+	Note: Limits are not enforced on ndgram_stream_tran connections, their
+		congestion control yields to other traffic. Their bytes are counted in the
+		rates.
+	download_rate:
+		Returns average download rate (bytes/second) of all connections.
+	upload_rate:
+		Returns average upload rate (bytes/second) of all connections.
+	set_max_connection_rate:
+		Set max download and upload rates (bytes/second) for a connection. 0 is
+		unlimited.
+	set_max_download_rate:
+		Set max download rate (bytes/second) of all connections. 0 is unlimited.
+	set_max_upload_rate:
+		Set max upload rate (bytes/second) of all connections. 0 is unlimited.
+	*/
+	unsigned download_rate();
+	unsigned upload_rate();
+	void set_max_connection_rate(const boost::uint64_t conn_ID,
+		const unsigned download, const unsigned upload);
+	void set_max_download_rate(const unsigned rate);
+	void set_max_upload_rate(const unsigned rate);
+
 private:
 	/* Call Back Dispatcher
 	Does multiple concurrent call backs but does not do concurrent call backs on
-	the same connection. Will block the proactor internal thread if there is a
-	backlog of jobs. This stops unbounded memory usage on systems with slow disk
+	the same connection. Connections are hashed on to shards, each shard has its
+	own job queue and thread, so call backs for a connection are done in order
+	without a global lock. Will block the proactor internal thread if a shard has
+	a backlog of jobs. This stops unbounded memory usage on systems with slow disk
 	I/O that can't keep up with network I/O.
+	Note: Jobs are swapped in and out of the queue, never copied, because
+		copying a job copies the event (and buffer) bound to it.
 	*/
 	class dispatcher
 	{
-		static const unsigned threads = 4;
-		static const unsigned max_buf = 8192;
+		static const unsigned max_buf = 8192; //max jobs queued over all shards
 	public:
 		dispatcher(
 			const boost::function<void (connect_event)> & connect_call_back_in,
 			const boost::function<void (disconnect_event)> & disconnect_call_back_in,
 			const boost::function<void (recv_event)> & recv_call_back_in,
-			const boost::function<void (send_event)> & send_call_back_in
+			const boost::function<void (send_event)> & send_call_back_in,
+			const unsigned shards
 		);
 		~dispatcher();
 
@@ -171,30 +268,61 @@ private:
 		void connect(const connect_event & CE);
 		void disconnect(const disconnect_event & DE);
 		void join();
-		void recv(const recv_event & RE);
+		void recv(const boost::shared_ptr<const recv_event> & RE);
 		void send(const send_event & SE);
 
 	private:
+		//job queue and thread for a subset of connections
+		class shard : private boost::noncopyable
+		{
+		public:
+			explicit shard(const unsigned max_buf_in);
+			~shard();
+
+			/*
+			enqueue:
+				Swap job in to queue, func is empty after call. Blocks if max_buf
+				reached.
+			join:
+				Block until no jobs queued or running.
+			*/
+			void enqueue(boost::function<void ()> & func);
+			void join();
+
+		private:
+			const unsigned max_buf;                      //max queued jobs
+			boost::mutex mutex;                          //lock for all data members
+			boost::thread worker;                        //thread in dispatch() function
+			boost::condition_variable_any consumer_cond; //notify_one when job taken from queue
+			boost::condition_variable_any producer_cond; //notify_one when job added to queue
+			boost::condition_variable_any empty_cond;    //notify_all when no jobs scheduled or running
+			unsigned job_cnt;                            //queued + running jobs
+			std::deque<boost::function<void ()> > Job;
+
+			/*
+			dispatch:
+				Shard thread waits in this function for jobs.
+			*/
+			void dispatch();
+		};
+
 		const boost::function<void (connect_event)> connect_call_back;
 		const boost::function<void (disconnect_event)> disconnect_call_back;
 		const boost::function<void (recv_event)> recv_call_back;
 		const boost::function<void (send_event)> send_call_back;
 
-		boost::mutex mutex;                          //lock for all data members
-		boost::thread_group workers;                 //threads in dispatch() function
-		boost::condition_variable_any consumer_cond; //notify_one when job taken from queue
-		boost::condition_variable_any producer_cond; //notify_one when job added to queue
-		boost::condition_variable_any empty_cond;    //notify_all when no jobs scheduled or running
-		std::set<boost::uint64_t> memoize;           //memoize for conn_IDs
-		boost::uint64_t producer_cnt;                //number of jobs produced
-		unsigned job_cnt;                            //queued + running jobs
-		std::list<std::pair<boost::uint64_t, boost::function<void()> > > Job;
+		//all jobs for a connection go to the same shard
+		std::vector<boost::shared_ptr<shard> > Shard;
 
 		/*
-		dispatch:
-			Dispatcher threads wait in this function for jobs.
+		get_shard:
+			Returns shard for connection.
+		recv_relay:
+			Does recv call back. The event is held by shared_ptr until the call
+			back so the buffer isn't copied when the job is queued.
 		*/
-		void dispatch();
+		shard & get_shard(const boost::uint64_t conn_ID);
+		void recv_relay(const boost::shared_ptr<const recv_event> & RE);
 	};
 
 	/*
@@ -213,43 +341,72 @@ private:
 		read:
 			Perform read operation.
 			Precondition: select must say socket needs read.
+		schedule_send:
+			Queue bytes to be sent.
+		schedule_send_file:
+			Queue file range to be sent.
 		set_error:
 			Set error to be passed to disconnect call back.
+		set_max_rate:
+			Set max download and upload rates for connection, 0 is unlimited.
 		socket:
 			Returns socket file descriptor.
-		timed_out:
-			Called once per second. If returns true the connection is removed.
+		timeout_ms:
+			Returns milliseconds until connection times out, 0 if timed out, or -1
+			if connection never times out. Called when the connection's timeout
+			timer expires, the timer is rearmed if the timeout has been pushed back.
+		unpark_read:
+			Resume reading after rate limit wait (see conn_container::park).
+		unpark_write:
+			Resume writing after rate limit wait (see conn_container::park).
 		write:
 			Perform write operation.
 			Precondition: select must say socket can write.
 		*/
 		virtual boost::shared_ptr<const conn_info> info() = 0;
 		virtual void read() = 0;
-		virtual void schedule_send(const buffer & buf, const bool close_on_empty);
+		virtual void schedule_send(const boost::shared_ptr<buffer> & buf,
+			const bool close_on_empty);
+		virtual void schedule_send_file(const file_range & FR, const bool close_on_empty);
 		virtual void set_error(const error_t error_in) = 0;
+		virtual void set_max_rate(const unsigned download, const unsigned upload);
 		virtual int socket() = 0;
-		virtual bool timed_out();
+		virtual int timeout_ms();
+		virtual void unpark_read();
+		virtual void unpark_write();
 		virtual void write();
 	};
 
 	/*
 	Holds all connections. Contains functions to add/remove connections. The
-	connections tell this container when they're ready to read or write. This
-	container allocates conn_IDs.
+	connections tell this container when they're ready to read or write, which
+	is passed on to select as an incremental registration. This container
+	allocates conn_IDs.
 	*/
 	class conn_container
 	{
 	public:
-		conn_container();
+		conn_container(select & Select_in, const unsigned max_recv_in);
+		//removes connections one at a time, their dtors may use container
+		~conn_container();
 		/*
 		add:
-			Add connection.
-		check_timeouts:
-			Check timeouts on all connections. Remove timed out.
+			Add connection. Arms the connection's timeout timer. Connections
+			without a socket (socket() returns -1) are not read or written.
 		new_conn_ID:
 			Returns new unique conn_ID.
-		read_set:
-			Returns socket set that needs to be monitored for read readyness.
+		edge_triggered:
+			Returns true if connections must read/write until they would block.
+		max_recv:
+			Returns max bytes to read from a connection per recv_event.
+		park:
+			Arm timer to unpark connection read (or write if write is true) after
+			wait_ms milliseconds. Used when rate limited.
+		expire_timers:
+			Do call backs for expired park and timeout timers.
+		timer_ms:
+			Returns milliseconds until expire_timers needs to be called, or -1 if
+			no timers armed. Used as the select timeout.
 		monitor_read:
 			Add socket to set of sockets to monitor for read readyness.
 		monitor_write:
@@ -261,46 +418,150 @@ private:
 		process_sched_remove:
 			Remove connections that want themselves removed.
 		remove:
-			Remove connection that corresponds to conn_ID.
+			Remove connection that corresponds to conn_ID. The connection is
+			destroyed after the container is updated so it's destructor may remove
+			other connections.
+		schedule_send:
+			Queue bytes to be sent on connection.
+		schedule_send_file:
+			Queue file range to be sent on connection.
+		timers:
+			Returns timer wheel. Used by connections which need timers.
 		unmonitor_read:
 			Remove socket from set of sockets to monitor for read readyness.
 		unmonitor_write:
 			Remove socket from set of sockets to monitor for write readyness.
-		write_set:
-			Returns socket set that needs tob e monitored for write readyness.
 		*/
 		void add(const boost::shared_ptr<conn> & C);
-		void check_timeouts();
+		bool edge_triggered();
+		void expire_timers();
+		unsigned max_recv();
 		boost::uint64_t new_conn_ID();
-		std::set<int> read_set();
+		void park(const boost::uint64_t conn_ID, const bool write,
+			const unsigned wait_ms);
+		int timer_ms();
 		void monitor_read(const int socket_FD);
 		void monitor_write(const int socket_FD);
 		void perform_reads(const std::set<int> & read_set_in);
 		void perform_writes(const std::set<int> & write_set_in);
 		void process_sched_remove();
 		void remove(const boost::uint64_t conn_ID);
-		void schedule_send(const boost::uint64_t conn_ID, const buffer & buf,
+		void schedule_send(const boost::uint64_t conn_ID,
+			const boost::shared_ptr<buffer> & buf, const bool close_on_empty);
+		void schedule_send_file(const boost::uint64_t conn_ID, const file_range & FR,
 			const bool close_on_empty);
+		timer_wheel & timers();
 		void unmonitor_read(const int socket_FD);
 		void unmonitor_write(const int socket_FD);
-		std::set<int> write_set();
+
+		/* Rate Limits
+		add_download:
+			Account bytes read by a connection against the global limit.
+		add_upload:
+			Account bytes written by a connection against the global limit.
+		download_quota:
+			Returns max bytes a connection may read now. This is the connection's
+			share of the global limit for this perform_reads.
+		download_wait_ms:
+			Returns milliseconds until global download limit allows reading.
+		upload_quota:
+			Returns max bytes a connection may write now. This is the connection's
+			share of the global limit for this perform_writes.
+		upload_wait_ms:
+			Returns milliseconds until global upload limit allows writing.
+		set_max_connection_rate:
+			See nstream_proactor::set_max_connection_rate.
+		set_max_download_rate:
+			See nstream_proactor::set_max_download_rate.
+		set_max_upload_rate:
+			See nstream_proactor::set_max_upload_rate.
+		*/
+		void add_download(const unsigned n_bytes);
+		void add_upload(const unsigned n_bytes);
+		unsigned download_quota();
+		unsigned download_wait_ms();
+		unsigned upload_quota();
+		unsigned upload_wait_ms();
+		void set_max_connection_rate(const boost::uint64_t conn_ID,
+			const unsigned download, const unsigned upload);
+		void set_max_download_rate(const unsigned rate);
+		void set_max_upload_rate(const unsigned rate);
+
+		/*
+		These may be called from any thread.
+		download_rate:
+			See nstream_proactor::download_rate.
+		upload_rate:
+			See nstream_proactor::upload_rate.
+		*/
+		unsigned download_rate();
+		unsigned upload_rate();
 
 	private:
+		select & Select;
+		const unsigned _max_recv;
 		boost::uint64_t unused_conn_ID;
-		std::time_t last_time;             //used to check timeouts once per second
-
-//DEBUG, these sets should be moved outside this class, they should be passed
-//to each connection object.
-//There should be separate container for listeners and nstreams.
-//Also the nstream class should have access to these.
-		std::set<int> _read_set;           //read set for select
-		std::set<int> _write_set;          //write set for select
+		timer_wheel Timer_Wheel;           //park and timeout timers
+
+//DEBUG, there should be separate container for listeners and nstreams.
 		std::map<boost::uint64_t, boost::shared_ptr<conn> > ID;
 		std::map<int, boost::shared_ptr<conn> > Socket;
 		unsigned incoming_conn_limit;
 		unsigned outgoing_conn_limit;
 		unsigned incoming_conns;
 		unsigned outgoing_conns;
+
+		//conn_ID mapped to timeout timer, canceled when connection removed
+		std::map<boost::uint64_t, timer_wheel::handle> Timeout_Timer;
+
+		token_bucket Download_Bucket; //global download limit
+		token_bucket Upload_Bucket;   //global upload limit
+		unsigned download_share;      //per-connection share of Download_Bucket
+		unsigned upload_share;        //per-connection share of Upload_Bucket
+		speed_calc Download_Speed;
+		speed_calc Upload_Speed;
+
+		/*
+		arm_timeout:
+			Arm timeout timer to call check_timeout after ms milliseconds.
+		check_timeout:
+			Timeout timer call back. Removes connection if timed out, else rearms.
+		unpark:
+			Park timer call back. Resumes connection read (or write).
+		share:
+			Returns fair share of available bytes when conn_cnt connections are
+			ready. Never less than the MTU (unless nothing available) so a
+			connection can always make progress, the bucket is left in debt.
+		*/
+		void arm_timeout(const boost::uint64_t conn_ID, const int ms);
+		void check_timeout(const boost::uint64_t conn_ID);
+		void unpark(const boost::uint64_t conn_ID, const bool write);
+		static unsigned share(const unsigned available, const unsigned conn_cnt);
+	};
+
+	/*
+	Element of send queue, either a buffer or a file range. Buffers are never
+	modified once queued, bytes sent are tracked by offset so a partial send
+	doesn't move the unsent bytes.
+	*/
+	class send_segment
+	{
+	public:
+		explicit send_segment(const boost::shared_ptr<buffer> & buf_in);
+		explicit send_segment(const file_range & FR_in);
+		boost::shared_ptr<buffer> buf;
+		unsigned offset;                //bytes of buf already sent
+		boost::optional<file_range> FR;
+		token_bucket FR_Bucket;         //file range rate limit
+		/*
+		consume:
+			Mark n_bytes as sent. Returns number of n_bytes not used by this
+			segment (non-zero when segment becomes empty).
+		empty:
+			Returns true if no bytes left to send.
+		*/
+		unsigned consume(const unsigned n_bytes);
+		bool empty() const;
 	};
 
 	//wraps nstream
@@ -322,19 +583,35 @@ private:
 		virtual ~conn_nstream();
 		virtual boost::shared_ptr<const conn_info> info();
 		virtual void read();
-		virtual void schedule_send(const buffer & buf, const bool close_on_empty_in);
+		virtual void schedule_send(const boost::shared_ptr<buffer> & buf,
+			const bool close_on_empty_in);
+		virtual void schedule_send_file(const file_range & FR, const bool close_on_empty_in);
 		virtual void set_error(const error_t error_in);
+		virtual void set_max_rate(const unsigned download, const unsigned upload);
 		virtual int socket();
-		virtual bool timed_out();
+		virtual int timeout_ms();
+		virtual void unpark_read();
+		virtual void unpark_write();
 		virtual void write();
 	private:
+		//max bytes to send from a file range per send_file() call
+		static const unsigned send_file_chunk = 65536;
+
+		//max buffer segments to send per writev() call
+		static const int send_iov_max = 64;
+
 		dispatcher & Dispatcher;
 		conn_container & Conn_Container;
 		boost::shared_ptr<nstream> N;
 		int socket_FD;                   //keep copy so we know this after nstream close
-		buffer send_buf;                 //stores bytes that need to be sent
-		bool close_on_empty;             //when true close when send_buf becomes empty
+		unsigned recv_chunk;             //bytes to try to read per recv() call, adapts
+		std::deque<send_segment> Send_Queue; //stores bytes/file ranges that need to be sent
+		boost::uint64_t send_queue_size; //bytes in Send_Queue
+		bool close_on_empty;             //when true close when Send_Queue becomes empty
 		bool half_open;                  //if true async connect in progress
+		bool write_parked;               //if true waiting for upload rate limit
+		token_bucket Download_Bucket;    //connection download limit
+		token_bucket Upload_Bucket;      //connection upload limit
 		std::time_t timeout;             //time at which this conn times out
 		error_t error;                   //holds error for disconnect
 		boost::shared_ptr<const conn_info> _info; //info passed to call backs
@@ -373,23 +650,164 @@ private:
 		boost::shared_ptr<const conn_info> _info; //info passed to call backs
 	};
 
+	class conn_ndgram_stream;
+
+	//wraps ndgram_stream, adds conn_ndgram_streams to conn_container
+	class conn_ndgram_stream_socket : public conn,
+		public boost::enable_shared_from_this<conn_ndgram_stream_socket>
+	{
+	public:
+		conn_ndgram_stream_socket(
+			dispatcher & Dispatcher_in,
+			conn_container & Conn_Container_in,
+			const endpoint & ep
+		);
+		//removes conn_ndgram_streams multiplexed on socket
+		virtual ~conn_ndgram_stream_socket();
+		virtual boost::shared_ptr<const conn_info> info();
+		virtual void read();
+		virtual void set_error(const error_t error_in);
+		virtual int socket();
+		virtual void write();
+		/*
+		close:
+			Close stream (called by conn_ndgram_stream when removed). Bytes in the
+			stream's send buffer are still sent.
+		connect:
+			Open stream to endpoint and add conn_ndgram_stream for it.
+		ep:
+			Returns endpoint socket bound to or nothing if not open.
+		remote_ep:
+			Returns endpoint of remote host for stream.
+		send:
+			Append bytes to stream's send buffer, buf is empty after call.
+		send_buf_size:
+			Returns bytes in stream's send buffer (not yet acknowledged).
+		*/
+		void close(const boost::uint32_t stream_ID);
+		void connect(const endpoint & ep);
+		boost::optional<net::endpoint> ep();
+		boost::optional<net::endpoint> remote_ep(const boost::uint32_t stream_ID);
+		void send(const boost::uint32_t stream_ID, buffer & buf);
+		unsigned send_buf_size(const boost::uint32_t stream_ID);
+	private:
+		dispatcher & Dispatcher;
+		conn_container & Conn_Container;
+		ndgram_stream Engine;
+		int socket_FD;                            //keep copy so we know this after close
+		error_t error;                            //holds error for disconnect
+		boost::shared_ptr<const conn_info> _info; //info passed to call backs
+
+		//stream_ID mapped to connection
+		std::map<boost::uint32_t, boost::weak_ptr<conn_ndgram_stream> > Stream;
+
+		/*
+		add:
+			Create and add conn_ndgram_stream for stream.
+		call_back:
+			Call back for ndgram_stream events.
+		check_open:
+			Remove socket (and streams on it) if socket closed because of error.
+		*/
+		void add(const boost::uint32_t stream_ID, const dir_t dir);
+		void call_back(ndgram_stream::event & E);
+		void check_open();
+	};
+
+	//stream multiplexed on a conn_ndgram_stream_socket
+	class conn_ndgram_stream : public conn
+	{
+	public:
+		conn_ndgram_stream(
+			dispatcher & Dispatcher_in,
+			conn_container & Conn_Container_in,
+			const boost::shared_ptr<conn_ndgram_stream_socket> & Socket_in,
+			const boost::uint32_t stream_ID_in,
+			const dir_t dir
+		);
+		virtual ~conn_ndgram_stream();
+		virtual boost::shared_ptr<const conn_info> info();
+		virtual void read();
+		virtual void schedule_send(const boost::shared_ptr<buffer> & buf,
+			const bool close_on_empty_in);
+		virtual void schedule_send_file(const file_range & FR, const bool close_on_empty_in);
+		virtual void set_error(const error_t error_in);
+		virtual int socket();
+		virtual int timeout_ms();
+		/* Called by conn_ndgram_stream_socket.
+		closed:
+			Stream closed by remote host, or connect failed.
+		connected:
+			Outgoing stream established.
+		recv:
+			Bytes received on stream, buf is empty after call.
+		sent:
+			Bytes acknowledged by remote host.
+		*/
+		void closed();
+		void connected();
+		void recv(buffer & buf);
+		void sent(const unsigned n_bytes);
+	private:
+		//stop feeding stream when this many bytes unacknowledged
+		static const unsigned send_buf_high = 256 * 1024;
+
+		//max bytes to read from a file range per feed
+		static const unsigned send_file_chunk = 65536;
+
+		dispatcher & Dispatcher;
+		conn_container & Conn_Container;
+		boost::weak_ptr<conn_ndgram_stream_socket> Socket;
+		const boost::uint32_t stream_ID;
+		std::deque<send_segment> Send_Queue; //bytes/file ranges not yet given to stream
+		boost::uint64_t send_queue_size; //bytes in Send_Queue
+		bool close_on_empty;             //when true close when Send_Queue becomes empty
+		bool half_open;                  //if true connect in progress
+		std::time_t timeout;             //time at which this conn times out
+		error_t error;                   //holds error for disconnect
+		boost::shared_ptr<const conn_info> _info; //info passed to call backs
+		/*
+		feed:
+			Move bytes from Send_Queue to stream until send_buf_high reached.
+		touch:
+			Updates timeout timer.
+		*/
+		void feed();
+		void touch();
+	};
+
 	//relay functions called by Internal_TP
-	void connect_relay(const endpoint & ep);
+	void connect_relay(const endpoint & ep, const tran_t tran);
 	void disconnect_relay(const boost::uint64_t conn_ID);
-	void listen_relay(const endpoint ep,
+	void listen_relay(const endpoint ep, const tran_t tran,
 		channel::promise<boost::optional<endpoint> > promise);
-	void send_relay(const boost::uint64_t conn_ID, const buffer buf,
+	void send_relay(const boost::uint64_t conn_ID,
+		const boost::shared_ptr<buffer> buf, const bool close_on_empty);
+	void send_file_relay(const boost::uint64_t conn_ID, const file_range FR,
 		const bool close_on_empty);
+	void set_max_connection_rate_relay(const boost::uint64_t conn_ID,
+		const unsigned download, const unsigned upload);
+	void set_max_download_rate_relay(const unsigned rate);
+	void set_max_upload_rate_relay(const unsigned rate);
 
 	/*
 	main_loop:
 		Main network processing loop.
+	ndgram_stream_socket:
+		Returns socket to multiplex outgoing ndgram_stream on. Starts socket on
+		random port if none for IP version.
 	*/
 	void main_loop();
+	boost::shared_ptr<conn_ndgram_stream_socket> ndgram_stream_socket(
+		const version_t version);
 
 	select Select;
 	dispatcher Dispatcher;
 	conn_container Conn_Container;
+
+	//IP version mapped to socket outgoing ndgram_streams multiplexed on
+	std::map<version_t, boost::weak_ptr<conn_ndgram_stream_socket> > Ndgram_Stream_Socket;
+
 	thread_pool Internal_TP;
 };
 }//end namespace net
@@ -5,30 +5,117 @@
 #include "listener.hpp"
 #include "nstream.hpp"
 
+//include
+#include <boost/scoped_ptr.hpp>
+#include <boost/utility.hpp>
+
 //standard
+#include <map>
 #include <set>
+#include <vector>
 
 namespace net{
-class select
+class select : private boost::noncopyable
 {
 public:
-	select();
+	//readiness notification mechanism used by wait()
+	enum backend_t{
+		default_backend,  //epoll_backend on linux, select_backend elsewhere
+		select_backend,   //select() system call, limited to FD_SETSIZE sockets
+		epoll_backend,    //edge-triggered epoll (linux only)
+		io_uring_backend  //io_uring poll (linux only, requires liburing)
+	};
+
+	explicit select(const backend_t type = default_backend);
 	~select();
 
-	//causes a thread blocked on operator () to return immediately
+	/*
+	edge_triggered:
+		Returns true if the backend only reports a socket once per readiness
+		change. When true the caller must read (or write) until the operation
+		would block, otherwise it will not be told about the socket again.
+	interrupt:
+		Causes a thread blocked on wait() or operator () to return immediately.
+	monitor_read:
+		Start monitoring socket for read readyness.
+	monitor_write:
+		Start monitoring socket for write readyness.
+	remove:
+		Stop monitoring socket. Must be called before the socket is closed.
+	unmonitor_read:
+		Stop monitoring socket for read readyness.
+	unmonitor_write:
+		Stop monitoring socket for write readyness.
+	wait:
+		Wait for activity on monitored sockets. When the call returns the read
+		set contains sockets that need to read and the write set contains
+		sockets ready to write. If timeout not specified then block until
+		activity. The cost of this call does not depend on the number of
+		monitored sockets (except for select_backend).
+	*/
+	bool edge_triggered() const;
 	void interrupt();
+	void monitor_read(const int socket_FD);
+	void monitor_write(const int socket_FD);
+	void remove(const int socket_FD);
+	void unmonitor_read(const int socket_FD);
+	void unmonitor_write(const int socket_FD);
+	void wait(std::set<int> & read, std::set<int> & write, int timeout_ms = -1);
 
 	/*
 	Works like the select() system call. The read and write sets contain sockets
 	to monitor. When the call returns the read set contains sockets that need to
 	read and the write set contains sockets ready to write. If a timeout not
 	specified then block until activity.
+	Note: This always uses select() and ignores sockets registered with
+		monitor_read/monitor_write.
 	*/
 	void operator () (std::set<int> & read, std::set<int> & write, int timeout_ms = -1);
+
+	//readiness backend interface, implementations in select.cpp
+	class backend : private boost::noncopyable
+	{
+	public:
+		enum{
+			read_flag = 1,
+			write_flag = 2
+		};
+		virtual ~backend();
+		/*
+		edge_triggered:
+			See select::edge_triggered.
+		set_interest:
+			Change the events monitored for socket. A old_mask of 0 means the
+			socket is not yet registered. A new_mask of 0 means the socket should
+			be unregistered.
+		wait:
+			See select::wait. The interrupt socket is always monitored for read
+			(level-triggered) and is returned in the read set like any other
+			socket.
+		*/
+		virtual bool edge_triggered() const;
+		virtual void set_interest(const int socket_FD, const int old_mask,
+			const int new_mask) = 0;
+		virtual void wait(std::set<int> & read, std::set<int> & write,
+			const int timeout_ms) = 0;
+	};
+
 private:
 	//self-pipe
 	boost::shared_ptr<nstream> sp_read;
 	boost::shared_ptr<nstream> sp_write;
+
+	boost::scoped_ptr<backend> Backend;
+	std::map<int, int> Interest; //socket_FD mapped to backend::*_flag bits
+
+	/*
+	drain_interrupt:
+		Read bytes sent by interrupt() so the self-pipe stops being readable.
+	update_interest:
+		Set interest for socket and tell backend if it changed.
+	*/
+	void drain_interrupt();
+	void update_interest(const int socket_FD, const int mask);
 };
 }//end namespace net
 #endif
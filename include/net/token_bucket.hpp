@@ -0,0 +1,60 @@
+/*
+Token bucket used to limit transfer rate. Tokens (bytes) accumulate at the rate
+up to a small burst. Not thread safe, the nstream_proactor only uses these
+from its internal thread.
+*/
+#ifndef H_NET_TOKEN_BUCKET
+#define H_NET_TOKEN_BUCKET
+
+//include
+#include <boost/cstdint.hpp>
+#include <boost/date_time/posix_time/posix_time.hpp>
+
+//standard
+#include <limits>
+
+namespace net{
+class token_bucket
+{
+	//max tokens saved up, in milliseconds worth of rate
+	static const unsigned burst_ms = 250;
+public:
+	//0 rate is unlimited
+	explicit token_bucket(const unsigned rate_in = 0);
+
+	/*
+	available:
+		Returns bytes which may be transferred now. If unlimited returns
+		std::numeric_limits<unsigned>::max().
+	consume:
+		Remove tokens for bytes transferred. More may be consumed than available,
+		the debt is paid off before more tokens become available.
+	rate:
+		Returns rate (bytes/second), 0 if unlimited.
+	set_rate:
+		Set rate (bytes/second), 0 for unlimited.
+	wait_ms:
+		Returns milliseconds until a token will be available, 0 if one available.
+	*/
+	unsigned available();
+	void consume(const unsigned n_bytes);
+	unsigned rate() const;
+	void set_rate(const unsigned rate_in);
+	unsigned wait_ms();
+
+private:
+	unsigned _rate;
+	boost::int64_t tokens;
+	boost::posix_time::ptime last_refill;
+
+	/*
+	capacity:
+		Returns max tokens which can accumulate.
+	refill:
+		Add tokens for time elapsed since last refill.
+	*/
+	boost::int64_t capacity() const;
+	void refill();
+};
+}//end namespace net
+#endif
@@ -21,8 +21,19 @@
 	#define ENOTCONN WSAENOTCONN       //socket not connected
 	#define EINPROGRESS WSAEINPROGRESS //connect in progress
 	#define EWOULDBLOCK WSAEWOULDBLOCK //the operation would block
+	#define ENETUNREACH WSAENETUNREACH //network unreachable
+	#define EHOSTUNREACH WSAEHOSTUNREACH //host unreachable
+	#define ECONNREFUSED WSAECONNREFUSED //connection refused (ICMP port unreachable)
+	#define ECONNRESET WSAECONNRESET   //connection reset (ICMP port unreachable on UDP)
+	#define EMSGSIZE WSAEMSGSIZE       //datagram too big
 	//END winsock stuff
 
+	//scatter/gather element, same layout as POSIX but no readv/writev
+	struct iovec{
+		void * iov_base;
+		size_t iov_len;
+	};
+
 	#include <process.h>
 	#include <wincrypt.h>
 
@@ -45,9 +56,17 @@
 	#include <fcntl.h>
 	#include <netdb.h>
 	#include <netinet/in.h>
+	#include <sys/mman.h>
 	#include <sys/socket.h>
+	#include <sys/stat.h>
 	#include <sys/types.h>
+	#include <sys/uio.h>
 	#include <unistd.h>
+
+	#ifdef __linux__
+	#include <sys/epoll.h>
+	#include <sys/sendfile.h>
+	#endif
 #endif
 
 //include
@@ -61,6 +61,7 @@ public:
 			job_queue.push_back(func);
 			++job_cnt;
 			producer_cond.notify_one();
+			return true;
 		}
 	}
 
@@ -0,0 +1,236 @@
+/*
+Hierarchical timing wheel. Timers are put in a slot of a wheel according to
+when they expire. Timers far in the future go in coarser wheels and are moved
+down to finer wheels as their time approaches. Arming and canceling a timer
+is O(1).
+
+Not thread safe. Timers should be armed, canceled, and expired by the thread
+which owns the timer_wheel.
+*/
+#ifndef H_TIMER_WHEEL
+#define H_TIMER_WHEEL
+
+//include
+#include <boost/cstdint.hpp>
+#include <boost/date_time/posix_time/posix_time.hpp>
+#include <boost/function.hpp>
+#include <boost/shared_ptr.hpp>
+#include <boost/utility.hpp>
+#include <boost/weak_ptr.hpp>
+
+//standard
+#include <cstddef>
+#include <list>
+
+class timer_wheel : private boost::noncopyable
+{
+	static const unsigned slot_bits = 6;
+	static const unsigned slots = 1 << slot_bits; //slots per wheel
+	static const unsigned levels = 4;             //number of wheels
+
+	class node;
+	typedef std::list<boost::shared_ptr<node> > slot_t;
+
+	class node
+	{
+	public:
+		boost::uint64_t expire_tick;
+		boost::function<void ()> call_back;
+		slot_t * slot;     //slot node is in, NULL if not armed
+		slot_t::iterator it; //position in slot
+	};
+
+public:
+	//returned by arm(), used to cancel timer
+	class handle
+	{
+		friend class timer_wheel;
+	public:
+		handle(){}
+
+		//returns true if timer armed and hasn't expired or been canceled
+		bool armed() const
+		{
+			boost::shared_ptr<node> N = Node.lock();
+			return N && N->slot;
+		}
+
+	private:
+		explicit handle(const boost::shared_ptr<node> & N):
+			Node(N)
+		{}
+		boost::weak_ptr<node> Node;
+	};
+
+	//tick_ms is the resolution of the timer
+	explicit timer_wheel(const unsigned tick_ms_in = 10):
+		tick_ms(tick_ms_in == 0 ? 1 : tick_ms_in),
+		start(boost::posix_time::microsec_clock::universal_time()),
+		current_tick(0),
+		armed_cnt(0)
+	{
+
+	}
+
+	/*
+	arm:
+		Do call back after ms milliseconds (rounded up to tick). Returns handle
+		which can be used to cancel the timer.
+	cancel:
+		Cancel timer. Does nothing if timer already expired or canceled.
+	expire:
+		Do call backs for expired timers. Returns number of call backs done. Call
+		backs are allowed to arm and cancel timers.
+	next_ms:
+		Returns milliseconds until expire() needs to be called, or max_ms if no
+		timer before then. A max_ms of -1 means no maximum, -1 is returned if no
+		timers armed.
+	size:
+		Returns number of armed timers.
+	*/
+	handle arm(const unsigned ms, const boost::function<void ()> & call_back)
+	{
+		boost::shared_ptr<node> N(new node());
+		N->expire_tick = now_tick() + (ms + tick_ms - 1) / tick_ms;
+		if(N->expire_tick <= current_tick){
+			N->expire_tick = current_tick + 1;
+		}
+		N->call_back = call_back;
+		insert(N);
+		++armed_cnt;
+		return handle(N);
+	}
+
+	void cancel(handle & H)
+	{
+		boost::shared_ptr<node> N = H.Node.lock();
+		if(N && N->slot){
+			N->slot->erase(N->it);
+			N->slot = NULL;
+			--armed_cnt;
+		}
+		H.Node.reset();
+	}
+
+	unsigned expire()
+	{
+		const boost::uint64_t now = now_tick();
+		if(armed_cnt == 0){
+			current_tick = now;
+			return 0;
+		}
+		unsigned cnt = 0;
+		while(current_tick < now){
+			++current_tick;
+			//move timers down from coarser wheels when finer wheel wraps
+			for(unsigned L=1; L<levels; ++L){
+				if((current_tick & ((boost::uint64_t(1) << (slot_bits * L)) - 1)) != 0){
+					break;
+				}
+				slot_t tmp;
+				tmp.swap(Wheel[L][(current_tick >> (slot_bits * L)) & (slots - 1)]);
+				for(slot_t::iterator it_cur = tmp.begin(), it_end = tmp.end();
+					it_cur != it_end; ++it_cur)
+				{
+					insert(*it_cur);
+				}
+			}
+			slot_t tmp;
+			tmp.swap(Wheel[0][current_tick & (slots - 1)]);
+			while(!tmp.empty()){
+				boost::shared_ptr<node> N = tmp.front();
+				tmp.pop_front();
+				if(N->expire_tick > current_tick){
+					//beyond range of wheels when armed, not yet expired
+					insert(N);
+					continue;
+				}
+				N->slot = NULL;
+				--armed_cnt;
+				++cnt;
+				boost::function<void ()> call_back;
+				call_back.swap(N->call_back);
+				call_back();
+			}
+			if(armed_cnt == 0){
+				current_tick = now;
+			}
+		}
+		return cnt;
+	}
+
+	int next_ms(const int max_ms = -1)
+	{
+		if(armed_cnt == 0){
+			return max_ms;
+		}
+		//find soonest tick at which expire() has work to do
+		boost::uint64_t next_tick = 0;
+		for(unsigned L=0; L<levels; ++L){
+			const boost::uint64_t base = current_tick >> (slot_bits * L);
+			for(unsigned x=1; x<=slots; ++x){
+				if(!Wheel[L][(base + x) & (slots - 1)].empty()){
+					boost::uint64_t tick = (base + x) << (slot_bits * L);
+					if(next_tick == 0 || tick < next_tick){
+						next_tick = tick;
+					}
+					break;
+				}
+			}
+		}
+		boost::int64_t ms = static_cast<boost::int64_t>(next_tick * tick_ms)
+			- elapsed_ms();
+		if(ms < 0){
+			return 0;
+		}else if(max_ms != -1 && ms > max_ms){
+			return max_ms;
+		}else{
+			return ms;
+		}
+	}
+
+	std::size_t size() const
+	{
+		return armed_cnt;
+	}
+
+private:
+	const unsigned tick_ms;
+	const boost::posix_time::ptime start; //time at tick 0
+	boost::uint64_t current_tick;         //tick expire() has processed up to
+	std::size_t armed_cnt;                //number of armed timers
+	slot_t Wheel[levels][slots];
+
+	//returns milliseconds since start
+	boost::int64_t elapsed_ms() const
+	{
+		boost::int64_t ms = (boost::posix_time::microsec_clock::universal_time()
+			- start).total_milliseconds();
+		return ms < 0 ? 0 : ms;
+	}
+
+	//put node in slot for it's expire_tick
+	void insert(const boost::shared_ptr<node> & N)
+	{
+		boost::uint64_t delta = N->expire_tick - current_tick;
+		unsigned L = 0;
+		while(L < levels - 1 && delta >= (boost::uint64_t(1) << (slot_bits * (L + 1)))){
+			++L;
+		}
+		boost::uint64_t tick = N->expire_tick;
+		if(delta >= (boost::uint64_t(1) << (slot_bits * levels))){
+			//beyond range of wheels, put in furthest slot and reinsert later
+			tick = current_tick + (boost::uint64_t(1) << (slot_bits * levels)) - 1;
+		}
+		slot_t & S = Wheel[L][(tick >> (slot_bits * L)) & (slots - 1)];
+		N->slot = &S;
+		N->it = S.insert(S.end(), N);
+	}
+
+	//returns current tick
+	boost::uint64_t now_tick() const
+	{
+		return elapsed_ms() / tick_ms;
+	}
+};
+#endif
@@ -0,0 +1,82 @@
+//include
+#include <ChaCha20.hpp>
+#include <convert.hpp>
+#include <logger.hpp>
+#include <SHA1.hpp>
+#include <unit_test.hpp>
+
+//standard
+#include <string>
+#include <vector>
+
+int fail(0);
+
+int main()
+{
+	unit_test::timeout();
+
+	unsigned char key[ChaCha20::key_size];
+	for(unsigned x=0; x<ChaCha20::key_size; ++x){
+		key[x] = x;
+	}
+
+	//RFC 7539 section 2.4.2 test vector (counter 1, nonce in high word of counter)
+	{//BEGIN test scope
+	const unsigned char nonce[ChaCha20::nonce_size] = {0, 0, 0, 0x4a, 0, 0, 0, 0};
+	ChaCha20 PRNG;
+	PRNG.seed(key, nonce, 1);
+	std::string data = "Ladies and Gentlemen of the class of '99: If I could offer you "
+		"only one tip for the future, sunscreen would be it.";
+	unsigned char stream[ChaCha20::block_size * 2];
+	PRNG.keystream(stream, sizeof(stream));
+	for(unsigned x=0; x<data.size(); ++x){
+		data[x] ^= stream[x];
+	}
+	if(convert::bin_to_hex(data) != "6E2E359A2568F98041BA0728DD0D6981E97E7AEC1D4360C2"
+		"0A27AFCCFD9FAE0BF91B65C5524733AB8F593DABCD62B3571639D624E65152AB8F530C359F08"
+		"61D807CA0DBF500D6A6156A38E088A22B65E52BC514D16CCF806818CE91AB77937365AF90BBF"
+		"74A35BE6B40B8EEDF2785E42874D")
+	{
+		LOG; ++fail;
+	}
+	}//END test scope
+
+	//keystream same when generated in 4 block and 1 block pieces
+	{//BEGIN test scope
+	const unsigned char nonce[ChaCha20::nonce_size] = {0, 0, 0, 0, 0xa0, 0xb0, 0xc0, 0xd0};
+	ChaCha20 PRNG_A, PRNG_B;
+	PRNG_A.seed(key, nonce);
+	PRNG_B.seed(key, nonce);
+	std::vector<unsigned char> stream_A(ChaCha20::block_size * 16);
+	std::vector<unsigned char> stream_B(ChaCha20::block_size * 16);
+	PRNG_A.keystream(&stream_A[0], stream_A.size());
+	for(unsigned x=0; x<stream_B.size(); x+=ChaCha20::block_size){
+		PRNG_B.keystream(&stream_B[x], ChaCha20::block_size);
+	}
+	if(stream_A != stream_B){
+		LOG; ++fail;
+	}
+	SHA1 SHA(reinterpret_cast<const char *>(&stream_A[0]), 1000);
+	if(SHA.hex() != "0003945B9DD9CFF566AAE9A9A02A15859D250861"){
+		LOG; ++fail;
+	}
+	}//END test scope
+
+	//carry from low to high word of counter
+	{//BEGIN test scope
+	const unsigned char nonce[ChaCha20::nonce_size] = {0};
+	ChaCha20 PRNG_A, PRNG_B;
+	PRNG_A.seed(key, nonce, 0xFFFFFFFEULL);
+	PRNG_B.seed(key, nonce, 0xFFFFFFFEULL);
+	std::vector<unsigned char> stream_A(ChaCha20::block_size * 4);
+	std::vector<unsigned char> stream_B(ChaCha20::block_size * 4);
+	PRNG_A.keystream(&stream_A[0], stream_A.size());
+	for(unsigned x=0; x<stream_B.size(); x+=ChaCha20::block_size){
+		PRNG_B.keystream(&stream_B[x], ChaCha20::block_size);
+	}
+	if(stream_A != stream_B){
+		LOG; ++fail;
+	}
+	}//END test scope
+	return fail;
+}
@@ -22,5 +22,19 @@ int main()
 	if(convert::bin_to_hex(data) != "857047028B192029FD"){
 		LOG; ++fail;
 	}
+
+	//keystream in blocks same as byte at a time
+	RC4 PRNG_A, PRNG_B;
+	PRNG_A.seed((unsigned char *)"Key", 3);
+	PRNG_B.seed((unsigned char *)"Key", 3);
+	unsigned char buf[1000];
+	PRNG_A.keystream(buf, 1);
+	PRNG_A.keystream(buf + 1, 999);
+	for(int x=0; x<1000; ++x){
+		if(buf[x] != PRNG_B.byte()){
+			LOG; ++fail;
+			break;
+		}
+	}
 	return fail;
 }
@@ -3,28 +3,87 @@
 #include <SHA1.hpp>
 #include <unit_test.hpp>
 
+//standard
+#include <vector>
+
 int fail(0);
 
-int main()
+void known(const std::string & text, const std::string & hash)
 {
-	unit_test::timeout();
-
-	//test string plugged in to known working implementation
-	SHA1 SHA;
-	std::string text = "I am a working SHA-1 hash function!";
-	SHA.init();
-	SHA.load(text.data(), text.size());
-	SHA.end();
-	if(SHA.hex() != "0F31DE89A79556B8AA85B35763A4A7655193828B"){
+	SHA1 SHA(text.data(), text.size());
+	if(SHA.hex() != hash){
 		LOG; ++fail;
 	}
+}
+
+void test(const unsigned impl)
+{
+	SHA1::impl() = impl;
+
+	//test string plugged in to known working implementation
+	known("I am a working SHA-1 hash function!",
+		"0F31DE89A79556B8AA85B35763A4A7655193828B");
 
 	//test empty string
-	SHA.init();
-	SHA.load("", 0);
-	SHA.end();
-	if(SHA.hex() != "DA39A3EE5E6B4B0D3255BFEF95601890AFD80709"){
-		LOG; ++fail;
+	known("", "DA39A3EE5E6B4B0D3255BFEF95601890AFD80709");
+
+	//sizes around block boundary, 56 to 63 need an extra block for padding
+	known(std::string(55, 'a'), "C1C8BBDC22796E28C0E15163D20899B65621D65A");
+	known(std::string(56, 'a'), "C2DB330F6083854C99D4B5BFB6E8F29F201BE699");
+	known(std::string(62, 'a'), "67B4B3923FA178D788A9611B76446C96431071F2");
+	known(std::string(64, 'a'), "0098BA824B5C16427BD7A1122A5A442A25EC644D");
+	known(std::string(119, 'a'), "EE971065AAA017E0632A8CA6C77BB3BF8B1DFC56");
+	known(std::string(10240, 'a'), "35F7EA75845F4EE55440B2E9489702882A7CF458");
+
+	//incremental loading in sizes that don't line up with blocks
+	std::string data;
+	for(unsigned x=0; x<10240 * 8 + 13; ++x){
+		data += static_cast<char>(x % 251);
+	}
+	for(unsigned step=1; step<=128; step+=9){
+		SHA1 SHA;
+		SHA.init();
+		for(std::size_t x=0; x<data.size(); x+=step){
+			SHA.load(data.data() + x, std::min<std::size_t>(step, data.size() - x));
+		}
+		SHA.end();
+		if(SHA.hex() != "A14236A9511DB0E0FDDC76F2A9E6129722060580"){
+			LOG; ++fail;
+		}
+	}
+
+	//multi-buffer, 8 equal sized buffers then buffers of different sizes
+	std::vector<const char *> buf;
+	std::vector<std::size_t> len;
+	for(unsigned x=0; x<8; ++x){
+		buf.push_back(data.data() + x * 10240);
+		len.push_back(10240);
+	}
+	for(unsigned x=0; x<8; ++x){
+		buf.push_back(data.data() + x);
+		len.push_back(x * 9);
+	}
+	std::vector<char> hash(buf.size() * SHA1::bin_size);
+	SHA1::multi(&buf[0], &len[0], buf.size(), &hash[0]);
+	for(unsigned x=0; x<buf.size(); ++x){
+		SHA1 SHA(buf[x], len[x]);
+		if(std::memcmp(SHA.bin(), &hash[x * SHA1::bin_size], SHA1::bin_size) != 0){
+			LOG; ++fail;
+		}
+	}
+}
+
+int main()
+{
+	unit_test::timeout();
+
+	//test every combination of implementations the CPU supports
+	const unsigned detected = SHA1::impl();
+	for(unsigned impl=0; impl<=detected; ++impl){
+		if((impl & ~detected) == 0){
+			test(impl);
+		}
 	}
+	SHA1::impl() = detected;
 	return fail;
 }
@@ -3,6 +3,10 @@
 #include <logger.hpp>
 #include <unit_test.hpp>
 
+//standard
+#include <algorithm>
+#include <vector>
+
 int fail(0);
 
 void primitive()
@@ -42,6 +46,100 @@ void future_promise()
 	}
 }
 
+void increment(int & cnt)
+{
+	++cnt;
+}
+
+void bounded_producer(channel::primitive<int> ch, const int start, const int cnt)
+{
+	for(int x=start; x<start + cnt; ++x){
+		ch.send(x);
+	}
+}
+
+void bounded_consumer(channel::primitive<int> ch, const int cnt,
+	boost::mutex & mutex, std::vector<int> & recvd)
+{
+	std::vector<int> tmp;
+	for(int x=0; x<cnt; ++x){
+		tmp.push_back(ch.recv());
+	}
+	boost::mutex::scoped_lock lock(mutex);
+	recvd.insert(recvd.end(), tmp.begin(), tmp.end());
+}
+
+void bounded()
+{
+	{//fifo, full and empty call backs
+	channel::primitive<int> ch(2);
+	int call_backs = 0;
+	if(ch.call_back_recv(boost::bind(&increment, boost::ref(call_backs)))){
+		LOG; ++fail;
+	}
+	ch.send(1);
+	ch.send(2);
+	if(call_backs != 1){
+		LOG; ++fail;
+	}
+	if(ch.call_back_send(boost::bind(&increment, boost::ref(call_backs)))){
+		LOG; ++fail;
+	}
+	if(ch.recv() != 1 || ch.recv() != 2){
+		LOG; ++fail;
+	}
+	if(call_backs != 2){
+		LOG; ++fail;
+	}
+	if(!ch.call_back_send(boost::bind(&increment, boost::ref(call_backs)))){
+		LOG; ++fail;
+	}
+	}
+
+	{//buffer of 1 is full after one send
+	channel::primitive<int> ch(1);
+	int call_backs = 0;
+	ch.send(1);
+	if(ch.call_back_send(boost::bind(&increment, boost::ref(call_backs)))){
+		LOG; ++fail;
+	}
+	if(ch.recv() != 1 || call_backs != 1){
+		LOG; ++fail;
+	}
+	ch.send(2);
+	if(ch.recv() != 2){
+		LOG; ++fail;
+	}
+	}
+
+	{//multiple producers and consumers, small buffer so threads block
+	const int threads = 4;
+	const int per_thread = 10000;
+	channel::primitive<int> ch(3);
+	boost::mutex mutex;
+	std::vector<int> recvd;
+	boost::thread_group TG;
+	for(int x=0; x<threads; ++x){
+		TG.create_thread(boost::bind(&bounded_producer, ch, x * per_thread,
+			per_thread));
+		TG.create_thread(boost::bind(&bounded_consumer, ch, per_thread,
+			boost::ref(mutex), boost::ref(recvd)));
+	}
+	TG.join_all();
+	std::sort(recvd.begin(), recvd.end());
+	if(recvd.size() != threads * per_thread){
+		LOG; ++fail;
+	}else{
+		for(int x=0; x<threads * per_thread; ++x){
+			if(recvd[x] != x){
+				LOG; ++fail;
+				break;
+			}
+		}
+	}
+	}
+}
+
 void producer(channel::source<int> Source)
 {
 	std::set<channel::source<int> > complete_set, ready_set;
@@ -76,6 +174,7 @@ int main()
 	primitive();
 	source_sink();
 	future_promise();
+	bounded();
 	select();
 	return fail;
 }
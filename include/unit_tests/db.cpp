@@ -25,5 +25,57 @@ int main()
 	DB.query("CREATE TABLE sqlite3_wrapper(test TEXT)");
 	DB.query("INSERT INTO sqlite3_wrapper VALUES ('abc')");
 	DB.query("SELECT test FROM sqlite3_wrapper", &call_back);
+
+	//prepared statements
+	DB.query("DROP TABLE IF EXISTS statement");
+	DB.query("CREATE TABLE statement(num INTEGER, str TEXT, bin BLOB)");
+	const std::string bin("A\0B'", 4);
+	for(int x=0; x<3; ++x){
+		db::statement Stmt(DB, "INSERT INTO statement VALUES(?, ?, ?)");
+		Stmt.bind(1, static_cast<boost::int64_t>(x) << 40);
+		Stmt.bind(2, "it's");
+		Stmt.bind_blob(3, bin.data(), bin.size());
+		if(Stmt.step() || Stmt.error()){
+			LOG; ++fail;
+		}
+	}
+	{//BEGIN lock scope
+	db::statement Stmt(DB, "SELECT num, str, bin FROM statement WHERE num >= ? ORDER BY num");
+	Stmt.bind(1, static_cast<boost::int64_t>(1) << 40);
+	int rows = 0;
+	while(Stmt.step()){
+		if(Stmt.column_int64(0) != (static_cast<boost::int64_t>(rows + 1) << 40)
+			|| Stmt.column_text(1) != "it's" || Stmt.column_blob(2) != bin)
+		{
+			LOG; ++fail;
+		}
+		//nested use of same query while first in use
+		db::statement Nested(DB, "SELECT num, str, bin FROM statement WHERE num >= ? ORDER BY num");
+		Nested.bind(1, static_cast<boost::int64_t>(0));
+		if(!Nested.step() || Nested.column_int64(0) != 0){
+			LOG; ++fail;
+		}
+		++rows;
+	}
+	if(rows != 2 || Stmt.error()){
+		LOG; ++fail;
+	}
+	}//END lock scope
+
+	//bad query
+	{//BEGIN lock scope
+	db::statement Stmt(DB, "SELECT nonexistent FROM statement");
+	if(Stmt.step() || !Stmt.error()){
+		LOG; ++fail;
+	}
+	}//END lock scope
+
+	//more queries than fit in cache
+	for(int x=0; x<100; ++x){
+		db::statement Stmt(DB, "SELECT " + std::string(x % 50 + 1, '1'));
+		if(!Stmt.step()){
+			LOG; ++fail;
+		}
+	}
 	return fail;
 }
@@ -0,0 +1,86 @@
+//include
+#include <logger.hpp>
+#include <timer_wheel.hpp>
+#include <unit_test.hpp>
+
+//standard
+#include <vector>
+
+int fail(0);
+boost::posix_time::ptime start;
+
+//records timer number and milliseconds since start
+void fired(std::vector<std::pair<int, boost::int64_t> > & order, const int num)
+{
+	order.push_back(std::make_pair(num, (boost::posix_time::microsec_clock::universal_time()
+		- start).total_milliseconds()));
+}
+
+void rearm(timer_wheel & TW, std::vector<std::pair<int, boost::int64_t> > & order)
+{
+	fired(order, 3);
+	TW.arm(20, boost::bind(&fired, boost::ref(order), 4));
+}
+
+int main()
+{
+	unit_test::timeout();
+
+	{//timers fire in order, not early, cancel works
+	timer_wheel TW(1);
+	std::vector<std::pair<int, boost::int64_t> > order;
+	start = boost::posix_time::microsec_clock::universal_time();
+	//one timer in each wheel level that will be reached
+	TW.arm(4200, boost::bind(&fired, boost::ref(order), 6));
+	TW.arm(300, boost::bind(&fired, boost::ref(order), 5));
+	TW.arm(70, boost::bind(&rearm, boost::ref(TW), boost::ref(order)));
+	TW.arm(10, boost::bind(&fired, boost::ref(order), 1));
+	TW.arm(30, boost::bind(&fired, boost::ref(order), 2));
+	timer_wheel::handle H = TW.arm(50, boost::bind(&fired, boost::ref(order), 0));
+	if(!H.armed() || TW.size() != 6){
+		LOG; ++fail;
+	}
+	TW.cancel(H);
+	if(H.armed() || TW.size() != 5){
+		LOG; ++fail;
+	}
+	while(TW.size() != 0){
+		boost::this_thread::sleep(boost::posix_time::milliseconds(TW.next_ms()));
+		TW.expire();
+	}
+	const int expected_num[] = {1, 2, 3, 4, 5, 6};
+	const boost::int64_t expected_ms[] = {10, 30, 70, 90, 300, 4200};
+	if(order.size() != 6){
+		LOG; ++fail;
+	}else{
+		for(unsigned x=0; x<order.size(); ++x){
+			if(order[x].first != expected_num[x]){
+				LOG; ++fail;
+			}
+			if(order[x].second < expected_ms[x]
+				|| order[x].second > expected_ms[x] + 100)
+			{
+				LOG << order[x].first << " " << order[x].second; ++fail;
+			}
+		}
+	}
+	if(TW.next_ms(1000) != 1000 || TW.next_ms() != -1){
+		LOG; ++fail;
+	}
+	}
+
+	{//timer beyond range of wheels
+	timer_wheel TW(1);
+	std::vector<std::pair<int, boost::int64_t> > order;
+	TW.arm(24 * 60 * 60 * 1000, boost::bind(&fired, boost::ref(order), 0));
+	int ms = TW.next_ms();
+	if(ms <= 0 || ms > 24 * 60 * 60 * 1000){
+		LOG; ++fail;
+	}
+	if(TW.expire() != 0 || TW.size() != 1){
+		LOG; ++fail;
+	}
+	}
+
+	return fail;
+}
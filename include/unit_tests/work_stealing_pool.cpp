@@ -0,0 +1,92 @@
+//include
+#include <atomic_int.hpp>
+#include <logger.hpp>
+#include <unit_test.hpp>
+#include <work_stealing_pool.hpp>
+
+int fail(0);
+
+void inc(atomic_int<unsigned> & cnt)
+{
+	++cnt;
+}
+
+//enqueue jobs from within a worker, exercises per-worker deques and stealing
+void fan_out(work_stealing_pool & TP, atomic_int<unsigned> & cnt,
+	const unsigned depth)
+{
+	++cnt;
+	if(depth != 0){
+		TP.enqueue(boost::bind(&fan_out, boost::ref(TP), boost::ref(cnt), depth - 1));
+		TP.enqueue(boost::bind(&fan_out, boost::ref(TP), boost::ref(cnt), depth - 1));
+	}
+}
+
+void block(boost::mutex & mutex)
+{
+	boost::mutex::scoped_lock lock(mutex);
+}
+
+int main()
+{
+	unit_test::timeout();
+
+	{//jobs from outside pool
+	work_stealing_pool TP;
+	atomic_int<unsigned> cnt(0);
+	for(unsigned x=0; x<32; ++x){
+		TP.enqueue(boost::bind(&inc, boost::ref(cnt)));
+	}
+	TP.join();
+	if(cnt != 32){
+		LOG; ++fail;
+	}
+	}
+
+	{//jobs from inside pool
+	work_stealing_pool TP(4);
+	atomic_int<unsigned> cnt(0);
+	TP.enqueue(boost::bind(&fan_out, boost::ref(TP), boost::ref(cnt), 12));
+	TP.join();
+	if(cnt != (1 << 13) - 1){
+		LOG; ++fail;
+	}
+	}
+
+	{//clear and stop
+	work_stealing_pool TP(1);
+	atomic_int<unsigned> cnt(0);
+	boost::mutex mutex;
+	{//BEGIN lock scope
+	boost::mutex::scoped_lock lock(mutex);
+	//worker blocks until we unlock, other jobs stay queued
+	TP.enqueue(boost::bind(&block, boost::ref(mutex)));
+	for(unsigned x=0; x<32; ++x){
+		TP.enqueue(boost::bind(&inc, boost::ref(cnt)));
+	}
+	TP.stop();
+	if(TP.enqueue(boost::bind(&inc, boost::ref(cnt)))){
+		LOG; ++fail;
+	}
+	TP.clear();
+	}//END lock scope
+	TP.join();
+	if(cnt != 0){
+		LOG; ++fail;
+	}
+	}
+
+	{//max_buf
+	work_stealing_pool TP(2, 4);
+	atomic_int<unsigned> cnt(0);
+	for(unsigned x=0; x<1000; ++x){
+		TP.enqueue(boost::bind(&inc, boost::ref(cnt)));
+	}
+	TP.join();
+	if(cnt != 1000){
+		LOG; ++fail;
+	}
+	}
+
+	return fail;
+}
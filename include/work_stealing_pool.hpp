@@ -0,0 +1,443 @@
+/*
+Drop-in replacement for thread_pool which gives each worker its own job deque.
+Jobs enqueued by a worker go on that worker's deque without taking a lock.
+Jobs enqueued by other threads go on a shared queue. Idle workers steal jobs
+from the other workers' deques.
+
+Job order is not FIFO (a worker runs its own most recently enqueued job first)
+so thread_pool should be used when job order matters.
+*/
+#ifndef H_WORK_STEALING_POOL
+#define H_WORK_STEALING_POOL
+
+//include
+#include <boost/atomic.hpp>
+#include <boost/bind.hpp>
+#include <boost/function.hpp>
+#include <boost/scoped_array.hpp>
+#include <boost/thread.hpp>
+#include <boost/thread/tss.hpp>
+#include <boost/utility.hpp>
+
+//standard
+#include <cassert>
+#include <deque>
+#include <vector>
+
+class work_stealing_pool : private boost::noncopyable
+{
+	typedef boost::function<void ()> job;
+
+	//a worker checks the shared queue first every this many jobs (fairness)
+	static const unsigned shared_check_interval = 61;
+public:
+	//0 max_buf is unlimited job queue size
+	work_stealing_pool(
+		const unsigned threads = boost::thread::hardware_concurrency(),
+		const unsigned max_buf_in = 0
+	):
+		stopped(false),
+		max_buf(max_buf_in),
+		job_cnt(0),
+		queued_cnt(0),
+		sleeping(0),
+		producers_waiting(0),
+		Current_Worker(&no_cleanup)
+	{
+		const unsigned thread_cnt = threads == 0 ? 1 : threads;
+		for(unsigned x=0; x<thread_cnt; ++x){
+			Worker.push_back(new worker(x));
+		}
+		for(unsigned x=0; x<thread_cnt; ++x){
+			workers.create_thread(boost::bind(&work_stealing_pool::dispatcher,
+				this, Worker[x]));
+		}
+	}
+
+	~work_stealing_pool()
+	{
+		stop();
+		join();
+		workers.interrupt_all();
+		workers.join_all();
+		for(std::vector<worker *>::iterator it_cur = Worker.begin(),
+			it_end = Worker.end(); it_cur != it_end; ++it_cur)
+		{
+			delete *it_cur;
+		}
+	}
+
+	//clear jobs
+	void clear()
+	{
+		unsigned cleared = 0;
+		for(std::vector<worker *>::iterator it_cur = Worker.begin(),
+			it_end = Worker.end(); it_cur != it_end; ++it_cur)
+		{
+			//steal until empty, take() may only be called by owner
+			while(!(*it_cur)->Deque.empty()){
+				if(job * J = (*it_cur)->Deque.steal()){
+					delete J;
+					++cleared;
+				}
+			}
+		}
+		{//BEGIN lock scope
+		boost::mutex::scoped_lock lock(mutex);
+		for(std::deque<job *>::iterator it_cur = shared_queue.begin(),
+			it_end = shared_queue.end(); it_cur != it_end; ++it_cur)
+		{
+			delete *it_cur;
+			++cleared;
+		}
+		shared_queue.clear();
+		}//END lock scope
+		dequeued(cleared);
+		done(cleared);
+	}
+
+	/*
+	Enqueue job. If max_buf reached blocks, unless called from a worker (which
+	would deadlock).
+	*/
+	bool enqueue(const boost::function<void ()> & func)
+	{
+		if(stopped.load()){
+			return false;
+		}
+		worker * W = Current_Worker.get();
+		if(W == NULL && max_buf != 0 && queued_cnt.load() >= max_buf){
+			boost::mutex::scoped_lock lock(mutex);
+			++producers_waiting;
+			while(queued_cnt.load() >= max_buf){
+				consumer_cond.wait(mutex);
+			}
+			--producers_waiting;
+		}
+		++job_cnt;
+		++queued_cnt;
+		job * J = new job(func);
+		if(W == NULL){
+			boost::mutex::scoped_lock lock(mutex);
+			shared_queue.push_back(J);
+		}else{
+			W->Deque.push(J);
+		}
+		//pairs with fence in dispatcher so a sleeping worker can't miss the job
+		boost::atomic_thread_fence(boost::memory_order_seq_cst);
+		if(sleeping.load() > 0){
+			boost::mutex::scoped_lock lock(mutex);
+			producer_cond.notify_one();
+		}
+		return true;
+	}
+
+	//block until all jobs done
+	void join()
+	{
+		boost::mutex::scoped_lock lock(mutex);
+		while(job_cnt.load() > 0){
+			empty_cond.wait(mutex);
+		}
+	}
+
+	//stops new jobs from being enqueued
+	void stop()
+	{
+		stopped.store(true);
+	}
+
+	//allows new jobs to be enqueued
+	void start()
+	{
+		stopped.store(false);
+	}
+
+private:
+	/*
+	Chase-Lev work stealing deque. The owner pushes and takes from the bottom,
+	other threads steal from the top. Based on "Correct and Efficient
+	Work-Stealing for Weak Memory Models" (Le, Pop, Cohen, Nardelli).
+	*/
+	class ws_deque : private boost::noncopyable
+	{
+	public:
+		ws_deque():
+			top(0),
+			bottom(0),
+			Array(new array(64))
+		{
+			Retired.push_back(Array.load());
+		}
+
+		~ws_deque()
+		{
+			while(job * J = steal()){
+				delete J;
+			}
+			for(std::vector<array *>::iterator it_cur = Retired.begin(),
+				it_end = Retired.end(); it_cur != it_end; ++it_cur)
+			{
+				delete *it_cur;
+			}
+		}
+
+		/*
+		empty:
+			Returns true if deque appears empty.
+		push:
+			Add job to bottom. Only called by owner.
+		steal:
+			Remove job from top. Returns NULL if empty or lost race with another
+			thread.
+		take:
+			Remove job from bottom. Only called by owner. Returns NULL if empty.
+		*/
+		bool empty()
+		{
+			return top.load(boost::memory_order_acquire)
+				>= bottom.load(boost::memory_order_acquire);
+		}
+
+		void push(job * J)
+		{
+			long b = bottom.load(boost::memory_order_relaxed);
+			long t = top.load(boost::memory_order_acquire);
+			array * A = Array.load(boost::memory_order_relaxed);
+			if(b - t > A->size - 1){
+				A = grow(A, t, b);
+			}
+			A->put(b, J);
+			bottom.store(b + 1, boost::memory_order_release);
+		}
+
+		job * steal()
+		{
+			long t = top.load(boost::memory_order_acquire);
+			boost::atomic_thread_fence(boost::memory_order_seq_cst);
+			long b = bottom.load(boost::memory_order_acquire);
+			if(t < b){
+				array * A = Array.load(boost::memory_order_acquire);
+				job * J = A->get(t);
+				if(!top.compare_exchange_strong(t, t + 1,
+					boost::memory_order_seq_cst, boost::memory_order_relaxed))
+				{
+					return NULL;
+				}
+				return J;
+			}
+			return NULL;
+		}
+
+		job * take()
+		{
+			long b = bottom.load(boost::memory_order_relaxed) - 1;
+			array * A = Array.load(boost::memory_order_relaxed);
+			bottom.store(b, boost::memory_order_relaxed);
+			boost::atomic_thread_fence(boost::memory_order_seq_cst);
+			long t = top.load(boost::memory_order_relaxed);
+			job * J = NULL;
+			if(t <= b){
+				J = A->get(b);
+				if(t == b){
+					//last job, race with thieves
+					if(!top.compare_exchange_strong(t, t + 1,
+						boost::memory_order_seq_cst, boost::memory_order_relaxed))
+					{
+						J = NULL;
+					}
+					bottom.store(b + 1, boost::memory_order_relaxed);
+				}
+			}else{
+				bottom.store(b + 1, boost::memory_order_relaxed);
+			}
+			return J;
+		}
+
+	private:
+		//circular array, size is a power of 2
+		class array : private boost::noncopyable
+		{
+		public:
+			explicit array(const long size_in):
+				size(size_in),
+				buf(new boost::atomic<job *>[size_in])
+			{}
+			const long size;
+			boost::scoped_array<boost::atomic<job *> > buf;
+			job * get(const long idx)
+			{
+				return buf[idx & (size - 1)].load(boost::memory_order_relaxed);
+			}
+			void put(const long idx, job * J)
+			{
+				buf[idx & (size - 1)].store(J, boost::memory_order_relaxed);
+			}
+		};
+
+		boost::atomic<long> top;
+		boost::atomic<long> bottom;
+		boost::atomic<array *> Array;
+		//thieves may still read old arrays, freed in dtor
+		std::vector<array *> Retired;
+
+		array * grow(array * A, const long t, const long b)
+		{
+			array * tmp = new array(A->size * 2);
+			for(long x=t; x<b; ++x){
+				tmp->put(x, A->get(x));
+			}
+			Retired.push_back(tmp);
+			Array.store(tmp, boost::memory_order_release);
+			return tmp;
+		}
+	};
+
+	class worker : private boost::noncopyable
+	{
+	public:
+		explicit worker(const unsigned idx_in):
+			idx(idx_in),
+			rand_state(idx_in * 2654435761u + 1)
+		{}
+		const unsigned idx;
+		ws_deque Deque;
+		unsigned rand_state; //xorshift state for picking steal victim
+
+		unsigned rand()
+		{
+			rand_state ^= rand_state << 13;
+			rand_state ^= rand_state >> 17;
+			rand_state ^= rand_state << 5;
+			return rand_state;
+		}
+	};
+
+	boost::atomic<bool> stopped;                 //if true new jobs not allowed to be enqueued
+	const unsigned max_buf;                      //max allowed queued jobs
+	boost::atomic<unsigned> job_cnt;             //cnt of queue'd + running jobs
+	boost::atomic<unsigned> queued_cnt;          //cnt of queue'd jobs
+	boost::atomic<unsigned> sleeping;            //workers waiting on producer_cond
+	unsigned producers_waiting;                  //producers waiting on consumer_cond (locked by mutex)
+	boost::thread_group workers;                 //all dispatcher threads
+	std::vector<worker *> Worker;                //one per dispatcher thread
+	boost::thread_specific_ptr<worker> Current_Worker; //set in dispatcher threads
+
+	boost::mutex mutex;                          //locks shared_queue and condition variables
+	boost::condition_variable_any consumer_cond; //notify_all when job taken and producers_waiting
+	boost::condition_variable_any producer_cond; //notify_one when job added and sleeping workers
+	boost::condition_variable_any empty_cond;    //notify_all when no jobs scheduled or running
+	std::deque<job *> shared_queue;              //jobs enqueued from non-worker threads
+
+	//Current_Worker points to pool owned object, don't delete it
+	static void no_cleanup(worker *){}
+
+	//find job for worker, returns NULL if none
+	job * find_job(worker * W, const unsigned job_num)
+	{
+		job * J = NULL;
+		if(job_num % shared_check_interval == 0){
+			J = pop_shared();
+		}
+		if(J == NULL){
+			J = W->Deque.take();
+		}
+		if(J == NULL){
+			J = pop_shared();
+		}
+		if(J == NULL && Worker.size() > 1){
+			//try to steal, start at random victim
+			unsigned start = W->rand() % Worker.size();
+			for(unsigned x=0; x<Worker.size() && J == NULL; ++x){
+				worker * victim = Worker[(start + x) % Worker.size()];
+				if(victim != W){
+					J = victim->Deque.steal();
+				}
+			}
+		}
+		return J;
+	}
+
+	/*
+	dequeued:
+		Called when jobs removed from queues (to run or because cleared).
+	done:
+		Called when jobs finished running or cleared.
+	*/
+	void dequeued(const unsigned cnt)
+	{
+		if(cnt == 0){
+			return;
+		}
+		queued_cnt.fetch_sub(cnt);
+		if(max_buf != 0){
+			boost::mutex::scoped_lock lock(mutex);
+			if(producers_waiting != 0){
+				consumer_cond.notify_all();
+			}
+		}
+	}
+
+	void done(const unsigned cnt)
+	{
+		if(cnt != 0 && job_cnt.fetch_sub(cnt) == cnt){
+			boost::mutex::scoped_lock lock(mutex);
+			empty_cond.notify_all();
+		}
+	}
+
+	//returns true if any deque or shared queue has a job
+	bool have_job()
+	{
+		for(std::vector<worker *>::iterator it_cur = Worker.begin(),
+			it_end = Worker.end(); it_cur != it_end; ++it_cur)
+		{
+			if(!(*it_cur)->Deque.empty()){
+				return true;
+			}
+		}
+		return !shared_queue.empty();
+	}
+
+	job * pop_shared()
+	{
+		boost::mutex::scoped_lock lock(mutex);
+		if(shared_queue.empty()){
+			return NULL;
+		}
+		job * J = shared_queue.front();
+		shared_queue.pop_front();
+		return J;
+	}
+
+	//threads which consume jobs reside here
+	void dispatcher(worker * W)
+	{
+		Current_Worker.reset(W);
+		unsigned job_num = 0;
+		while(true){
+			job * J = find_job(W, ++job_num);
+			if(J == NULL){
+				boost::mutex::scoped_lock lock(mutex);
+				++sleeping;
+				//pairs with fence in enqueue
+				boost::atomic_thread_fence(boost::memory_order_seq_cst);
+				while(!have_job()){
+					try{
+						producer_cond.wait(mutex);
+					}catch(const boost::thread_interrupted &){
+						--sleeping;
+						throw;
+					}
+				}
+				--sleeping;
+				continue;
+			}
+			dequeued(1);
+			(*J)();
+			delete J;
+			done(1);
+		}
+	}
+};
+#endif
@@ -158,24 +158,39 @@ net::buffer::buffer(const buffer & B)
 	*this = B;
 }
 
+#ifndef BOOST_NO_CXX11_RVALUE_REFERENCES
+net::buffer::buffer(buffer && B)
+{
+	ctor_initialize();
+	take(B);
+}
+#endif
+
 net::buffer::~buffer()
 {
-	if(buf != NULL){
-		free(buf);
-	}
+	release();
 }
 
 net::buffer & net::buffer::append(const unsigned char ch)
 {
-	allocate(bytes, bytes + 1);
-	buf[bytes - 1] = ch;
+	grow(bytes + 1);
+	buf[head + bytes] = ch;
+	++bytes;
 	return *this;
 }
 
 net::buffer & net::buffer::append(const unsigned char * buf_append, const unsigned size)
 {
-	allocate(bytes, bytes + size);
-	std::memcpy(buf + bytes - size, buf_append, size);
+	if(buf_append >= buf && buf_append < buf + capacity){
+		//appending part of self, grow might move bytes
+		unsigned offset = buf_append - (buf + head);
+		grow(bytes + size);
+		buf_append = buf + head + offset;
+	}else{
+		grow(bytes + size);
+	}
+	std::memcpy(buf + head + bytes, buf_append, size);
+	bytes += size;
 	return *this;
 }
 
@@ -195,22 +210,34 @@ net::buffer & net::buffer::append(const buffer & buf_append)
 
 net::buffer::iterator net::buffer::begin() const
 {
-	return iterator(0, buf);
+	return iterator(0, buf + head);
 }
 
 void net::buffer::clear()
 {
-	allocate(bytes, 0);
+	resize(0);
+}
+
+void net::buffer::consume_front(const unsigned size)
+{
+	assert(size <= bytes);
+	if(size == bytes){
+		resize(0);
+	}else{
+		head += size;
+		bytes -= size;
+		reserved = reserved > size ? reserved - size : 0;
+	}
 }
 
 const unsigned char * net::buffer::data() const
 {
-	return buf;
+	return buf + head;
 }
 
 unsigned char * net::buffer::data()
 {
-	return buf;
+	return buf + head;
 }
 
 bool net::buffer::empty() const
@@ -220,13 +247,13 @@ bool net::buffer::empty() const
 
 net::buffer::iterator net::buffer::end() const
 {
-	return iterator(bytes, buf);
+	return iterator(bytes, buf + head);
 }
 
 void net::buffer::erase(const unsigned idx)
 {
 	assert(idx < bytes);
-	allocate(bytes, idx);
+	resize(idx);
 }
 
 void net::buffer::erase(const unsigned idx, unsigned size)
@@ -235,18 +262,34 @@ void net::buffer::erase(const unsigned idx, unsigned size)
 	if(idx + size > bytes){
 		size = bytes - idx;
 	}
-	std::memmove(buf + idx, buf + idx + size, bytes - idx - size);
-	allocate(bytes, bytes - size);
+	if(idx == 0){
+		consume_front(size);
+	}else{
+		std::memmove(buf + head + idx, buf + head + idx + size, bytes - idx - size);
+		resize(bytes - size);
+	}
 }
 
 void net::buffer::reserve(const unsigned size)
 {
-	allocate(reserved, size);
+	reserved = size;
+	if(reserved == 0 && bytes == 0){
+		release();
+	}else{
+		grow(reserved);
+	}
 }
 
 void net::buffer::resize(const unsigned size)
 {
-	allocate(bytes, size);
+	grow(size);
+	bytes = size;
+	if(bytes == 0){
+		head = 0;
+		if(reserved == 0){
+			release();
+		}
+	}
 }
 
 unsigned net::buffer::size() const
@@ -256,13 +299,13 @@ unsigned net::buffer::size() const
 
 std::string net::buffer::str() const
 {
-	return std::string(reinterpret_cast<const char *>(buf), bytes);
+	return std::string(reinterpret_cast<const char *>(buf + head), bytes);
 }
 
 std::string net::buffer::str(const unsigned idx) const
 {
 	assert(idx <= bytes);
-	return std::string(reinterpret_cast<const char *>(buf + idx), bytes - idx);
+	return std::string(reinterpret_cast<const char *>(buf + head + idx), bytes - idx);
 }
 
 std::string net::buffer::str(const unsigned idx, unsigned size) const
@@ -272,41 +315,41 @@ std::string net::buffer::str(const unsigned idx, unsigned size) const
 		size = bytes - idx;
 	}
 	assert(idx + size <= bytes);
-	return std::string(reinterpret_cast<const char *>(buf + idx), size);
+	return std::string(reinterpret_cast<const char *>(buf + head + idx), size);
 }
 
 void net::buffer::swap(buffer & rval)
 {
-	//save current lval
-	unsigned tmp_reserved = reserved;
-	unsigned tmp_bytes = bytes;
-	unsigned char * tmp_buf = buf;
-
-	//copy rval to lval
-	reserved = rval.reserved;
-	bytes = rval.bytes;
-	buf = rval.buf;
-
-	//copy old lval to rval
-	rval.reserved = tmp_reserved;
-	rval.bytes = tmp_bytes;
-	rval.buf = tmp_buf;
+	if(buf != inline_buf && rval.buf != inline_buf){
+		//both on heap, swap pointers
+		std::swap(reserved, rval.reserved);
+		std::swap(bytes, rval.bytes);
+		std::swap(head, rval.head);
+		std::swap(capacity, rval.capacity);
+		std::swap(buf, rval.buf);
+	}else{
+		//at least one stored inline, bytes in inline_buf must be copied
+		buffer tmp;
+		tmp.take(*this);
+		take(rval);
+		rval.take(tmp);
+	}
 }
 
 unsigned char * net::buffer::tail_start() const
 {
 	assert(reserved > bytes);
-	return buf + bytes;
+	return buf + head + bytes;
 }
 
 void net::buffer::tail_reserve(const unsigned size)
 {
-	allocate(reserved, bytes + size);
+	reserve(bytes + size);
 }
 
 void net::buffer::tail_resize(const unsigned size)
 {
-	allocate(bytes, bytes + size);
+	resize(bytes + size);
 }
 
 unsigned net::buffer::tail_size() const
@@ -318,26 +361,40 @@ unsigned net::buffer::tail_size() const
 const unsigned char net::buffer::operator [] (const unsigned idx) const
 {
 	assert(idx < bytes);
-	return buf[idx];
+	return buf[head + idx];
 }
 
 unsigned char & net::buffer::operator [] (const unsigned idx)
 {
 	assert(idx < bytes);
-	return buf[idx];
+	return buf[head + idx];
 }
 
 net::buffer & net::buffer::operator = (const buffer & B)
 {
-	allocate(bytes, B.bytes);
-	std::memcpy(buf, B.buf, bytes);
+	if(this != &B){
+		bytes = 0;
+		head = 0;
+		append(B.buf + B.head, B.bytes);
+	}
+	return *this;
+}
+
+#ifndef BOOST_NO_CXX11_RVALUE_REFERENCES
+net::buffer & net::buffer::operator = (buffer && B)
+{
+	if(this != &B){
+		take(B);
+	}
 	return *this;
 }
+#endif
 
 net::buffer & net::buffer::operator = (const std::string & str)
 {
-	allocate(bytes, str.size());
-	std::memcpy(buf, str.data(), bytes);
+	bytes = 0;
+	head = 0;
+	append(str);
 	return *this;
 }
 
@@ -346,7 +403,7 @@ bool net::buffer::operator == (const buffer & B) const
 	if(bytes != B.bytes){
 		return false;
 	}else{
-		return std::memcmp(buf, B.buf, bytes) == 0;
+		return std::memcmp(buf + head, B.buf + B.head, bytes) == 0;
 	}
 }
 
@@ -355,7 +412,7 @@ bool net::buffer::operator == (const std::string & str) const
 	if(bytes != str.size()){
 		return false;
 	}else{
-		return std::memcmp(buf, str.data(), bytes) == 0;
+		return std::memcmp(buf + head, str.data(), bytes) == 0;
 	}
 }
 
@@ -376,7 +433,7 @@ bool net::buffer::operator < (const buffer & B) const
 	}else if(bytes > B.bytes){
 		return false;
 	}else{
-		return std::memcmp(buf, B.buf, bytes) < 0;
+		return std::memcmp(buf + head, B.buf + B.head, bytes) < 0;
 	}
 }
 
@@ -387,42 +444,66 @@ bool net::buffer::operator < (const std::string & str) const
 	}else if(bytes > str.size()){
 		return false;
 	}else{
-		return std::memcmp(buf, str.data(), bytes) < 0;
+		return std::memcmp(buf + head, str.data(), bytes) < 0;
 	}
 }
 
-void net::buffer::allocate(unsigned & var, const unsigned size)
+void net::buffer::ctor_initialize()
 {
-	if(var == size){
-		//requested allocation is equal to what's already allocated
+	reserved = 0;
+	bytes = 0;
+	head = 0;
+	capacity = small_size;
+	buf = inline_buf;
+}
+
+void net::buffer::grow(const unsigned size)
+{
+	if(head + size <= capacity){
 		return;
-	}else{
-		var = size;
-		if(reserved == 0 && bytes == 0){
-			//no reserve, nothing in buffer, set buf = NULL to signify empty
-			if(buf != NULL){
-				//free any memory currently in buffer
-				std::free(buf);
-				buf = NULL;
-			}
-		}else if(buf == NULL){
-			//requested allocation non-zero and currently nothing is allocated
-			buf = static_cast<unsigned char *>(std::malloc(var));
-			assert(buf);
-		}else if(var >= reserved){
-			/*
-			Either reserve needs to be increased, or bytes are above what is
-			reserved so we need to allocate beyond what is reserved.
-			*/
-			buf = static_cast<unsigned char *>(std::realloc(buf, var));
-			assert(buf);
-		}
+	}else if(size <= capacity / 2){
+		//enough room if bytes moved to front, leaves at least half free
+		std::memmove(buf, buf + head, bytes);
+		head = 0;
+		return;
+	}
+	//double capacity so appends are amortized constant time
+	unsigned new_capacity = capacity * 2;
+	if(new_capacity < size){
+		new_capacity = size;
 	}
+	unsigned char * new_buf = buffer_pool::allocate(new_capacity);
+	std::memcpy(new_buf, buf + head, bytes);
+	if(buf != inline_buf){
+		buffer_pool::deallocate(buf, capacity);
+	}
+	buf = new_buf;
+	head = 0;
+	capacity = new_capacity;
 }
 
-void net::buffer::ctor_initialize()
+void net::buffer::release()
 {
-	reserved = 0;
+	if(buf != inline_buf){
+		buffer_pool::deallocate(buf, capacity);
+		buf = inline_buf;
+		capacity = small_size;
+	}
+	head = 0;
 	bytes = 0;
-	buf = NULL;
+}
+
+void net::buffer::take(buffer & B)
+{
+	release();
+	reserved = B.reserved;
+	bytes = B.bytes;
+	if(B.buf == B.inline_buf){
+		std::memcpy(inline_buf, B.inline_buf + B.head, B.bytes);
+	}else{
+		buf = B.buf;
+		head = B.head;
+		capacity = B.capacity;
+	}
+	B.ctor_initialize();
 }
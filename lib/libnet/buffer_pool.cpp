@@ -0,0 +1,293 @@
+#include <net/buffer_pool.hpp>
+
+namespace{
+
+//returns index of smallest size class >= size
+unsigned size_class(const unsigned size)
+{
+	unsigned idx = 0;
+	unsigned class_size = net::buffer_pool::min_size;
+	while(class_size < size){
+		class_size <<= 1;
+		++idx;
+	}
+	return idx;
+}
+
+//max blocks of size cached per class by a thread
+unsigned thread_cap(const unsigned size)
+{
+	return net::buffer_pool::max_class_bytes / size;
+}
+
+//blocks moved between a thread cache and the central list at once
+unsigned batch(const unsigned size)
+{
+	unsigned cnt = thread_cap(size) / 2;
+	return cnt == 0 ? 1 : cnt;
+}
+
+/*
+Increment counter only written by the owning thread. A load and store is
+cheaper than an atomic add and other threads still see a valid value.
+*/
+template<typename T>
+void increment(boost::atomic<T> & counter)
+{
+	counter.store(counter.load(boost::memory_order_relaxed) + 1,
+		boost::memory_order_relaxed);
+}
+
+/*
+Free blocks cached by one thread. Free only accessed by that thread. Counters
+written by that thread and read by stats().
+*/
+class thread_cache : private boost::noncopyable
+{
+public:
+	thread_cache();
+	~thread_cache();
+
+	std::vector<unsigned char *> Free[net::buffer_pool::classes];
+	boost::atomic<boost::uint64_t> hits[net::buffer_pool::classes];
+	boost::atomic<boost::uint64_t> misses[net::buffer_pool::classes];
+	boost::atomic<unsigned> high_water[net::buffer_pool::classes];
+};
+
+//free blocks shared by all threads for one size class
+class central_list : private boost::noncopyable
+{
+public:
+	boost::mutex Mutex;                //locks Free
+	std::vector<unsigned char *> Free;
+};
+
+//tracks all thread caches so stats can be gathered
+class registry : private boost::noncopyable
+{
+public:
+	registry();
+
+	boost::thread_specific_ptr<thread_cache> TSS;
+
+	/*
+	add:
+		Register thread cache.
+	pull:
+		Move up to batch() blocks of class idx from central list to Free.
+		Returns false if central list empty.
+	push:
+		Move blocks from the back of Free to the central list, until Free has
+		keep blocks. Blocks over max_central_bytes are freed.
+	remove:
+		Unregister thread cache, keep its stats.
+	stats:
+		See buffer_pool::stats.
+	*/
+	void add(thread_cache * TC);
+	bool pull(const unsigned idx, std::vector<unsigned char *> & Free);
+	void push(const unsigned idx, std::vector<unsigned char *> & Free,
+		const std::size_t keep);
+	void remove(thread_cache * TC);
+	std::vector<net::buffer_pool::class_stats> stats();
+
+private:
+	boost::mutex Mutex;                //locks all data members
+	std::set<thread_cache *> Cache;    //caches of running threads
+	std::vector<net::buffer_pool::class_stats> Exited; //stats of exited threads
+	central_list Central[net::buffer_pool::classes];   //has own lock
+};
+
+registry * Registry = NULL;
+boost::once_flag Registry_once_flag = BOOST_ONCE_INIT;
+
+void init_registry()
+{
+	/*
+	Intentionally never deleted. Buffers in static objects may be freed after
+	all other statics have been destroyed.
+	*/
+	Registry = new registry();
+}
+
+registry & get_registry()
+{
+	boost::call_once(&init_registry, Registry_once_flag);
+	return *Registry;
+}
+
+thread_cache & get_thread_cache()
+{
+	thread_cache * TC = get_registry().TSS.get();
+	if(TC == NULL){
+		TC = new thread_cache();
+		get_registry().TSS.reset(TC);
+	}
+	return *TC;
+}
+
+thread_cache::thread_cache()
+{
+	for(unsigned x=0; x<net::buffer_pool::classes; ++x){
+		hits[x] = 0;
+		misses[x] = 0;
+		high_water[x] = 0;
+	}
+	get_registry().add(this);
+}
+
+thread_cache::~thread_cache()
+{
+	get_registry().remove(this);
+	//other threads may use our cached blocks
+	for(unsigned x=0; x<net::buffer_pool::classes; ++x){
+		get_registry().push(x, Free[x], 0);
+	}
+}
+
+registry::registry():
+	Exited(net::buffer_pool::classes)
+{
+	for(unsigned x=0; x<net::buffer_pool::classes; ++x){
+		Exited[x].size = net::buffer_pool::min_size << x;
+	}
+}
+
+void registry::add(thread_cache * TC)
+{
+	boost::mutex::scoped_lock lock(Mutex);
+	Cache.insert(TC);
+}
+
+bool registry::pull(const unsigned idx, std::vector<unsigned char *> & Free)
+{
+	central_list & CL = Central[idx];
+	boost::mutex::scoped_lock lock(CL.Mutex);
+	if(CL.Free.empty()){
+		return false;
+	}
+	std::size_t cnt = batch(net::buffer_pool::min_size << idx);
+	cnt = cnt < CL.Free.size() ? cnt : CL.Free.size();
+	Free.insert(Free.end(), CL.Free.end() - cnt, CL.Free.end());
+	CL.Free.erase(CL.Free.end() - cnt, CL.Free.end());
+	return true;
+}
+
+void registry::push(const unsigned idx, std::vector<unsigned char *> & Free,
+	const std::size_t keep)
+{
+	if(Free.size() <= keep){
+		return;
+	}
+	const std::size_t cap = net::buffer_pool::max_central_bytes
+		/ (net::buffer_pool::min_size << idx);
+	central_list & CL = Central[idx];
+	{//BEGIN lock scope
+	boost::mutex::scoped_lock lock(CL.Mutex);
+	while(Free.size() > keep && CL.Free.size() < cap){
+		CL.Free.push_back(Free.back());
+		Free.pop_back();
+	}
+	}//END lock scope
+	while(Free.size() > keep){
+		std::free(Free.back());
+		Free.pop_back();
+	}
+}
+
+void registry::remove(thread_cache * TC)
+{
+	boost::mutex::scoped_lock lock(Mutex);
+	Cache.erase(TC);
+	for(unsigned x=0; x<net::buffer_pool::classes; ++x){
+		Exited[x].hits += TC->hits[x].load(boost::memory_order_relaxed);
+		Exited[x].misses += TC->misses[x].load(boost::memory_order_relaxed);
+		unsigned high_water = TC->high_water[x].load(boost::memory_order_relaxed);
+		if(high_water > Exited[x].high_water){
+			Exited[x].high_water = high_water;
+		}
+	}
+}
+
+std::vector<net::buffer_pool::class_stats> registry::stats()
+{
+	boost::mutex::scoped_lock lock(Mutex);
+	std::vector<net::buffer_pool::class_stats> S = Exited;
+	for(std::set<thread_cache *>::iterator it_cur = Cache.begin(),
+		it_end = Cache.end(); it_cur != it_end; ++it_cur)
+	{
+		for(unsigned x=0; x<net::buffer_pool::classes; ++x){
+			S[x].hits += (*it_cur)->hits[x].load(boost::memory_order_relaxed);
+			S[x].misses += (*it_cur)->misses[x].load(boost::memory_order_relaxed);
+			unsigned high_water = (*it_cur)->high_water[x].load(
+				boost::memory_order_relaxed);
+			if(high_water > S[x].high_water){
+				S[x].high_water = high_water;
+			}
+		}
+	}
+	for(unsigned x=0; x<net::buffer_pool::classes; ++x){
+		boost::mutex::scoped_lock lock(Central[x].Mutex);
+		S[x].central = Central[x].Free.size();
+	}
+	return S;
+}
+
+}//end unnamed namespace
+
+net::buffer_pool::class_stats::class_stats():
+	size(0),
+	hits(0),
+	misses(0),
+	high_water(0),
+	central(0)
+{
+
+}
+
+unsigned char * net::buffer_pool::allocate(unsigned & size)
+{
+	if(size > max_size){
+		unsigned char * buf = static_cast<unsigned char *>(std::malloc(size));
+		assert(buf);
+		return buf;
+	}
+	unsigned idx = size_class(size);
+	size = min_size << idx;
+	thread_cache & TC = get_thread_cache();
+	if(TC.Free[idx].empty() && !get_registry().pull(idx, TC.Free[idx])){
+		increment(TC.misses[idx]);
+		unsigned char * buf = static_cast<unsigned char *>(std::malloc(size));
+		assert(buf);
+		return buf;
+	}else{
+		increment(TC.hits[idx]);
+		unsigned char * buf = TC.Free[idx].back();
+		TC.Free[idx].pop_back();
+		return buf;
+	}
+}
+
+void net::buffer_pool::deallocate(unsigned char * buf, const unsigned size)
+{
+	if(size > max_size){
+		std::free(buf);
+		return;
+	}
+	unsigned idx = size_class(size);
+	assert(size == min_size << idx);
+	thread_cache & TC = get_thread_cache();
+	if(TC.Free[idx].size() >= thread_cap(size)){
+		//cache full, move half to central list for other threads
+		get_registry().push(idx, TC.Free[idx], TC.Free[idx].size() - batch(size));
+	}
+	TC.Free[idx].push_back(buf);
+	if(TC.Free[idx].size() > TC.high_water[idx].load(boost::memory_order_relaxed)){
+		TC.high_water[idx].store(TC.Free[idx].size(), boost::memory_order_relaxed);
+	}
+}
+
+std::vector<net::buffer_pool::class_stats> net::buffer_pool::stats()
+{
+	return get_registry().stats();
+}
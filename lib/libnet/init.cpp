@@ -20,6 +20,8 @@ void net::init::start()
 		LOG << "winsock error " << err;
 		exit(1);
 	}
+	#else
+	std::signal(SIGPIPE, SIG_IGN);
 	#endif
 }
 
@@ -1,5 +1,29 @@
 #include <net/ndgram.hpp>
 
+namespace{
+
+/*
+Returns true if the error is about one remote host (ICMP error from a previous
+send, or datagram too big for the path) and not about the socket. One socket
+may be shared by many hosts so these must not close it.
+*/
+bool host_error(const int error)
+{
+	return error == EHOSTUNREACH || error == ENETUNREACH || error == ECONNREFUSED
+		|| error == ECONNRESET || error == EMSGSIZE || error == EPERM
+		|| error == EACCES;
+}
+
+}//end of unnamed namespace
+
+//BEGIN datagram
+net::ndgram::datagram::datagram(const endpoint & ep_in):
+	ep(ep_in)
+{
+
+}
+//END datagram
+
 net::ndgram::ndgram()
 {
 
@@ -32,11 +56,18 @@ int net::ndgram::recv(net::buffer & buf, boost::optional<endpoint> & ep)
 	ai.ai_addr = reinterpret_cast<sockaddr *>(&sas);
 	ai.ai_addrlen = sizeof(sockaddr_storage);
 	buf.tail_reserve(MTU);
-	int n_bytes = recvfrom(socket_FD, reinterpret_cast<char *>(buf.tail_start()),
-		buf.tail_size(), 0, ai.ai_addr, reinterpret_cast<socklen_t *>(&ai.ai_addrlen));
+	int n_bytes;
+	do{
+		//error from a previous send to one host, try next datagram
+		ai.ai_addrlen = sizeof(sockaddr_storage);
+		n_bytes = recvfrom(socket_FD, reinterpret_cast<char *>(buf.tail_start()),
+			buf.tail_size(), 0, ai.ai_addr, reinterpret_cast<socklen_t *>(&ai.ai_addrlen));
+	}while(n_bytes == -1 && host_error(errno));
 	if(n_bytes == -1 || n_bytes == 0){
-		LOG << strerror(errno);
-		close();
+		if(n_bytes == 0 || errno != EWOULDBLOCK){
+			LOG << strerror(errno);
+			close();
+		}
 		buf.tail_reserve(0);
 	}else{
 		ep = endpoint(&ai);
@@ -49,11 +80,138 @@ int net::ndgram::send(net::buffer & buf, const endpoint & ep)
 {
 	int n_bytes = sendto(socket_FD, reinterpret_cast<char *>(buf.data()),
 		buf.size(), 0, ep.ai.ai_addr, ep.ai.ai_addrlen);
-	if(n_bytes == -1 || n_bytes == 0){
+	if(n_bytes == -1 && host_error(errno)){
+		//can't reach host, drop datagram as if lost in network
 		LOG << strerror(errno);
-		close();
+		n_bytes = buf.size();
+	}
+	if(n_bytes == -1 || n_bytes == 0){
+		if(n_bytes == 0 || errno != EWOULDBLOCK){
+			LOG << strerror(errno);
+			close();
+		}
 	}else{
 		buf.erase(0, n_bytes);
 	}
 	return n_bytes;
 }
+
+int net::ndgram::recv(std::deque<datagram> & batch, const unsigned max_cnt)
+{
+	const unsigned cnt = max_cnt < max_batch ? max_cnt : max_batch;
+	if(cnt == 0){
+		return 0;
+	}
+#ifdef __linux__
+	buffer buf[max_batch];
+	sockaddr_storage sas[max_batch];
+	iovec iov[max_batch];
+	mmsghdr msg[max_batch];
+	std::memset(msg, 0, sizeof(mmsghdr) * cnt);
+	for(unsigned x=0; x<cnt; ++x){
+		buf[x].tail_reserve(MTU);
+		iov[x].iov_base = buf[x].tail_start();
+		iov[x].iov_len = buf[x].tail_size();
+		msg[x].msg_hdr.msg_name = &sas[x];
+		msg[x].msg_hdr.msg_namelen = sizeof(sockaddr_storage);
+		msg[x].msg_hdr.msg_iov = &iov[x];
+		msg[x].msg_hdr.msg_iovlen = 1;
+	}
+	int n_msg;
+	do{
+		//error from a previous send to one host, try next datagrams
+		n_msg = ::recvmmsg(socket_FD, msg, cnt, 0, NULL);
+	}while(n_msg == -1 && host_error(errno));
+	if(n_msg == -1 || n_msg == 0){
+		if(n_msg == 0 || errno != EWOULDBLOCK){
+			LOG << strerror(errno);
+			close();
+		}
+		return n_msg;
+	}
+	for(int x=0; x<n_msg; ++x){
+		addrinfo ai;
+		ai.ai_addr = reinterpret_cast<sockaddr *>(&sas[x]);
+		ai.ai_addrlen = msg[x].msg_hdr.msg_namelen;
+		buf[x].tail_resize(msg[x].msg_len);
+		batch.push_back(datagram(endpoint(&ai)));
+		batch.back().buf.swap(buf[x]);
+	}
+	return n_msg;
+#else
+	int n_msg = 0;
+	while(n_msg < static_cast<int>(cnt)){
+		boost::optional<endpoint> ep;
+		buffer buf;
+		int n_bytes = recv(buf, ep);
+		if(n_bytes <= 0){
+			//datagrams already received are returned, error seen on next call
+			return n_msg == 0 ? n_bytes : n_msg;
+		}
+		batch.push_back(datagram(*ep));
+		batch.back().buf.swap(buf);
+		++n_msg;
+	}
+	return n_msg;
+#endif
+}
+
+int net::ndgram::send(const std::deque<datagram> & batch)
+{
+	const unsigned cnt = batch.size() < max_batch ? batch.size() : max_batch;
+	if(cnt == 0){
+		return 0;
+	}
+#ifdef __linux__
+	iovec iov[max_batch];
+	mmsghdr msg[max_batch];
+	std::memset(msg, 0, sizeof(mmsghdr) * cnt);
+	for(unsigned x=0; x<cnt; ++x){
+		iov[x].iov_base = const_cast<unsigned char *>(batch[x].buf.data());
+		iov[x].iov_len = batch[x].buf.size();
+		msg[x].msg_hdr.msg_name = batch[x].ep.ai.ai_addr;
+		msg[x].msg_hdr.msg_namelen = batch[x].ep.ai.ai_addrlen;
+		msg[x].msg_hdr.msg_iov = &iov[x];
+		msg[x].msg_hdr.msg_iovlen = 1;
+	}
+	int n_msg = ::sendmmsg(socket_FD, msg, cnt, 0);
+	if(n_msg == -1 && host_error(errno)){
+		//first datagram can't reach host, drop it as if lost in network
+		LOG << strerror(errno);
+		n_msg = 1;
+	}
+	if(n_msg == -1 || n_msg == 0){
+		if(n_msg == 0 || errno != EWOULDBLOCK){
+			LOG << strerror(errno);
+			close();
+		}
+	}
+	return n_msg;
+#else
+	int n_msg = 0;
+	while(n_msg < static_cast<int>(cnt)){
+		const datagram & D = batch[n_msg];
+		int n_bytes = sendto(socket_FD, reinterpret_cast<const char *>(D.buf.data()),
+			D.buf.size(), 0, D.ep.ai.ai_addr, D.ep.ai.ai_addrlen);
+		if(n_bytes == -1 && host_error(errno)){
+			//can't reach host, drop datagram as if lost in network
+			LOG << strerror(errno);
+			++n_msg;
+			continue;
+		}
+		if(n_bytes == -1 || n_bytes == 0){
+			if(n_msg != 0){
+				//datagrams already sent are returned, error seen on next call
+				return n_msg;
+			}
+			if(n_bytes == 0 || errno != EWOULDBLOCK){
+				LOG << strerror(errno);
+				close();
+			}
+			return n_bytes;
+		}
+		++n_msg;
+	}
+	return n_msg;
+#endif
+}
@@ -0,0 +1,956 @@
+#include <net/ndgram_stream.hpp>
+
+namespace{
+
+void append_uint32(net::buffer & buf, const boost::uint32_t num)
+{
+	buf.append(static_cast<unsigned char>(num >> 24));
+	buf.append(static_cast<unsigned char>(num >> 16));
+	buf.append(static_cast<unsigned char>(num >> 8));
+	buf.append(static_cast<unsigned char>(num));
+}
+
+boost::uint32_t read_uint32(const net::buffer & buf, const unsigned idx)
+{
+	return (static_cast<boost::uint32_t>(buf[idx]) << 24)
+		| (static_cast<boost::uint32_t>(buf[idx + 1]) << 16)
+		| (static_cast<boost::uint32_t>(buf[idx + 2]) << 8)
+		| static_cast<boost::uint32_t>(buf[idx + 3]);
+}
+
+boost::uint32_t random_uint32()
+{
+	unsigned char buf[4];
+	portable::urandom(buf, sizeof(buf));
+	return (static_cast<boost::uint32_t>(buf[0]) << 24)
+		| (static_cast<boost::uint32_t>(buf[1]) << 16)
+		| (static_cast<boost::uint32_t>(buf[2]) << 8)
+		| static_cast<boost::uint32_t>(buf[3]);
+}
+
+boost::posix_time::ptime now()
+{
+	return boost::posix_time::microsec_clock::universal_time();
+}
+
+//returns milliseconds until t (rounded up), 0 if t has passed
+unsigned ms_until(const boost::posix_time::ptime & t)
+{
+	boost::int64_t us = (t - now()).total_microseconds();
+	return us <= 0 ? 0 : (us + 999) / 1000;
+}
+
+}//end of unnamed namespace
+
+//BEGIN event
+net::ndgram_stream::event::event(
+	const boost::uint32_t ID_in,
+	const event_t type_in,
+	const bool connected_in
+):
+	ID(ID_in),
+	type(type_in),
+	connected(connected_in),
+	n_bytes(0)
+{
+
+}
+//END event
+
+//BEGIN packet
+net::ndgram_stream::packet::packet():
+	fin(false),
+	transmits(0),
+	sacked(false),
+	lost(false),
+	in_flight(false)
+{
+
+}
+//END packet
+
+//BEGIN stream
+net::ndgram_stream::stream::stream(
+	const boost::uint32_t local_ID_in,
+	const endpoint & ep_in
+):
+	local_ID(local_ID_in),
+	remote_ID(0),
+	ep(ep_in),
+	established(false),
+	local_closed(false),
+	remote_closed(false),
+	//high bit set so seq_num near start can be expanded without underflow
+	next_seq((boost::uint64_t(1) << 32) | random_uint32()),
+	highest_acked(0),
+	latest_acked_sent(boost::posix_time::neg_infin),
+	unacked_bytes(0),
+	in_flight(0),
+	fin_queued(false),
+	syn_transmits(0),
+	cwnd(2 * MSS),
+	ssthresh(max_window * MSS),
+	recovery_seq(0),
+	srtt_us(0),
+	rttvar_us(0),
+	rto_us(init_rto_us),
+	rto_cnt(0),
+	delay_ref_set(false),
+	delay_ref(0),
+	next_send(boost::posix_time::neg_infin),
+	recv_next(0),
+	ack_delay(0)
+{
+
+}
+//END stream
+
+//BEGIN datagram
+net::ndgram_stream::datagram::datagram(
+	const endpoint & ep_in,
+	const boost::posix_time::ptime & release_in
+):
+	ep(ep_in),
+	release(release_in)
+{
+
+}
+//END datagram
+
+net::ndgram_stream::ndgram_stream(
+	timer_wheel & Timer_Wheel_in,
+	const boost::function<void (event &)> & call_back_in
+):
+	Timer_Wheel(Timer_Wheel_in),
+	call_back(call_back_in),
+	delivering(false),
+	opened(false),
+	loss_percent(0),
+	delay_ms(0),
+	rate(0),
+	bottleneck_free(boost::posix_time::neg_infin)
+{
+
+}
+
+net::ndgram_stream::~ndgram_stream()
+{
+	close();
+}
+
+void net::ndgram_stream::ack_recv(stream & S, const buffer & buf)
+{
+	const boost::uint64_t ack_num = expand(read_uint32(buf, 5), S.next_seq);
+	const boost::uint32_t sack = read_uint32(buf, 9);
+	const boost::uint32_t delay = read_uint32(buf, 13);
+	if(ack_num > S.next_seq){
+		//acks packet we haven't sent
+		return;
+	}
+	const boost::posix_time::ptime t = now();
+	const unsigned flight = S.in_flight;
+	unsigned acked = 0;    //bytes newly acked or sacked
+	unsigned released = 0; //bytes removed from send buffer
+	boost::int64_t rtt_us = -1;
+	while(!S.Unacked.empty() && S.Unacked.begin()->first < ack_num){
+		packet & P = S.Unacked.begin()->second;
+		if(!P.sacked){
+			packet_acked(S, S.Unacked.begin()->first, P, t, acked, rtt_us);
+		}
+		released += P.payload.size();
+		S.unacked_bytes -= P.payload.size();
+		S.Unacked.erase(S.Unacked.begin());
+	}
+	for(unsigned x=0; x<32; ++x){
+		if(sack & (boost::uint32_t(1) << x)){
+			std::map<boost::uint64_t, packet>::iterator
+				it = S.Unacked.find(ack_num + 1 + x);
+			if(it != S.Unacked.end() && !it->second.sacked){
+				it->second.sacked = true;
+				packet_acked(S, it->first, it->second, t, acked, rtt_us);
+			}
+		}
+	}
+	if(rtt_us >= 0){
+		rtt_sample(S, rtt_us);
+	}
+
+	/*
+	A packet is lost if dup_thresh packets after it, and a packet sent after it,
+	have been acknowledged. The second condition stops a retransmitted packet
+	from being marked lost again before its retransmission could be acked.
+	*/
+	bool loss = false;
+	for(std::map<boost::uint64_t, packet>::iterator it_cur = S.Unacked.begin(),
+		it_end = S.Unacked.end(); it_cur != it_end; ++it_cur)
+	{
+		if(it_cur->first + dup_thresh > S.highest_acked){
+			break;
+		}
+		packet & P = it_cur->second;
+		if(!P.sacked && P.in_flight && P.sent < S.latest_acked_sent){
+			P.lost = true;
+			P.in_flight = false;
+			S.in_flight -= P.payload.size();
+			if(it_cur->first >= S.recovery_seq){
+				loss = true;
+			}
+		}
+	}
+	if(loss){
+		//halve cwnd once per window of losses (RFC 6817 section 2.4.2)
+		S.ssthresh = S.cwnd / 2 > 2 * MSS ? S.cwnd / 2 : 2 * MSS;
+		S.cwnd = S.ssthresh;
+		S.recovery_seq = S.next_seq;
+	}else if(acked != 0){
+		congestion_control(S, acked, flight, delay);
+	}
+	if(acked != 0 || released != 0){
+		//progress, restart retransmission timer
+		S.rto_cnt = 0;
+		Timer_Wheel.cancel(S.RTO_Timer);
+	}
+	if(released != 0 && !S.local_closed){
+		Event.push_back(event(S.local_ID, send_event));
+		Event.back().n_bytes = released;
+	}
+	if(S.local_closed && S.fin_queued && S.Unacked.empty()){
+		//close acknowledged, done with stream
+		remove(S.local_ID);
+		return;
+	}
+	send_some(S);
+}
+
+void net::ndgram_stream::check_socket()
+{
+	if(opened && !N.is_open()){
+		opened = false;
+		Event.push_back(event(0, error_event));
+	}
+}
+
+void net::ndgram_stream::close()
+{
+	opened = false;
+	for(std::map<boost::uint32_t, boost::shared_ptr<stream> >::iterator
+		it_cur = Stream.begin(), it_end = Stream.end(); it_cur != it_end; ++it_cur)
+	{
+		Timer_Wheel.cancel(it_cur->second->RTO_Timer);
+		Timer_Wheel.cancel(it_cur->second->Pace_Timer);
+	}
+	Timer_Wheel.cancel(Delay_Timer);
+	Stream.clear();
+	Remote.clear();
+	Ack_Pending.clear();
+	Event.clear();
+	Out_Queue.clear();
+	Delay_Queue.clear();
+	N.close();
+}
+
+void net::ndgram_stream::close(const boost::uint32_t ID)
+{
+	std::map<boost::uint32_t, boost::shared_ptr<stream> >::iterator
+		it = Stream.find(ID);
+	if(it == Stream.end()){
+		return;
+	}
+	stream & S = *it->second;
+	S.local_closed = true;
+	if(!S.established || S.remote_closed){
+		//remote host won't read any more bytes
+		remove(ID);
+	}else{
+		//close packet sent after send buffer
+		send_some(S);
+	}
+	deliver();
+}
+
+void net::ndgram_stream::congestion_control(stream & S, const unsigned acked,
+	const unsigned flight, const boost::uint32_t delay)
+{
+	//delays are relative to first sample, the clock offset cancels out
+	if(!S.delay_ref_set){
+		S.delay_ref = delay;
+		S.delay_ref_set = true;
+	}
+	const boost::int64_t sample = static_cast<boost::int32_t>(delay - S.delay_ref);
+
+	//base delay is min delay over base_history minutes
+	const boost::int64_t minute = std::time(NULL) / 60;
+	if(S.Base_Delay.empty() || S.Base_Delay.back().first != minute){
+		S.Base_Delay.push_back(std::make_pair(minute, sample));
+		if(S.Base_Delay.size() > base_history){
+			S.Base_Delay.pop_front();
+		}
+	}else if(sample < S.Base_Delay.back().second){
+		S.Base_Delay.back().second = sample;
+	}
+	boost::int64_t base = sample;
+	for(std::deque<std::pair<boost::int64_t, boost::int64_t> >::iterator
+		it_cur = S.Base_Delay.begin(), it_end = S.Base_Delay.end();
+		it_cur != it_end; ++it_cur)
+	{
+		base = it_cur->second < base ? it_cur->second : base;
+	}
+
+	//current delay is min of newest samples to filter noise
+	S.Current_Delay.push_back(sample);
+	if(S.Current_Delay.size() > current_filter){
+		S.Current_Delay.pop_front();
+	}
+	boost::int64_t current = sample;
+	for(std::deque<boost::int64_t>::iterator it_cur = S.Current_Delay.begin(),
+		it_end = S.Current_Delay.end(); it_cur != it_end; ++it_cur)
+	{
+		current = *it_cur < current ? *it_cur : current;
+	}
+
+	const boost::int64_t queuing = current - base;
+	if(flight + MSS < S.cwnd && queuing < target_us){
+		//not using cwnd, don't grow it (RFC 6817 section 2.4.1)
+		return;
+	}
+	boost::int64_t cwnd = S.cwnd;
+	if(S.cwnd < S.ssthresh && queuing < target_us / 2){
+		//slow start
+		cwnd += acked;
+	}else{
+		if(S.cwnd < S.ssthresh){
+			//delay building, leave slow start
+			S.ssthresh = S.cwnd;
+		}
+		//grow or shrink in proportion to distance from target, gain of 1
+		cwnd += (static_cast<boost::int64_t>(target_us) - queuing) * acked * MSS
+			/ (static_cast<boost::int64_t>(target_us) * S.cwnd);
+	}
+	if(cwnd < 2 * MSS){
+		cwnd = 2 * MSS;
+	}else if(cwnd > max_window * MSS){
+		cwnd = max_window * MSS;
+	}
+	S.cwnd = cwnd;
+}
+
+boost::uint32_t net::ndgram_stream::connect(const endpoint & ep)
+{
+	boost::shared_ptr<stream> S(new stream(new_ID(), ep));
+	Stream.insert(std::make_pair(S->local_ID, S));
+	send_syn(*S);
+	S->RTO_Timer = Timer_Wheel.arm(S->rto_us / 1000, boost::bind(
+		&ndgram_stream::rto_timeout, this, S->local_ID));
+	deliver();
+	return S->local_ID;
+}
+
+void net::ndgram_stream::data_recv(stream & S, const buffer & buf)
+{
+	const bool fin = buf[0] == fin_type;
+	const boost::uint64_t seq = expand(read_uint32(buf, 5), S.recv_next);
+	S.ack_delay = now_us() - read_uint32(buf, 9);
+	Ack_Pending.insert(S.local_ID);
+	if(S.remote_closed || seq < S.recv_next || seq >= S.recv_next + max_window){
+		//duplicate, or beyond window
+		return;
+	}
+	if(S.Recv_OOO.find(seq) == S.Recv_OOO.end()){
+		std::pair<buffer, bool> & P = S.Recv_OOO[seq];
+		P.first.append(buf.data() + data_header_size, buf.size() - data_header_size);
+		P.second = fin;
+	}
+
+	//pass on bytes now in order
+	buffer recv_buf;
+	while(!S.Recv_OOO.empty() && S.Recv_OOO.begin()->first == S.recv_next){
+		std::pair<buffer, bool> & P = S.Recv_OOO.begin()->second;
+		if(P.second){
+			S.remote_closed = true;
+		}else if(recv_buf.empty()){
+			recv_buf.swap(P.first);
+		}else{
+			recv_buf.append(P.first);
+		}
+		S.Recv_OOO.erase(S.Recv_OOO.begin());
+		++S.recv_next;
+		if(S.remote_closed){
+			S.Recv_OOO.clear();
+			break;
+		}
+	}
+	if(!recv_buf.empty() && !S.local_closed){
+		//coalesce with recv_event already queued for stream
+		if(!Event.empty() && Event.back().ID == S.local_ID
+			&& Event.back().type == recv_event)
+		{
+			Event.back().buf.append(recv_buf);
+		}else{
+			Event.push_back(event(S.local_ID, recv_event));
+			Event.back().buf.swap(recv_buf);
+		}
+	}
+	if(S.remote_closed){
+		if(S.local_closed){
+			//both ends closed, ACK close now since stream is removed
+			send_ack(S);
+			remove(S.local_ID);
+		}else{
+			Event.push_back(event(S.local_ID, close_event));
+		}
+	}
+}
+
+void net::ndgram_stream::deliver()
+{
+	if(delivering){
+		//call back called function which called this
+		return;
+	}
+	delivering = true;
+	while(!Event.empty()){
+		event E(Event.front().ID, Event.front().type, Event.front().connected);
+		E.n_bytes = Event.front().n_bytes;
+		E.buf.swap(Event.front().buf);
+		Event.pop_front();
+		call_back(E);
+	}
+	delivering = false;
+}
+
+boost::uint64_t net::ndgram_stream::expand(const boost::uint32_t seq_num,
+	const boost::uint64_t ref)
+{
+	return ref + static_cast<boost::int32_t>(seq_num - static_cast<boost::uint32_t>(ref));
+}
+
+void net::ndgram_stream::impair(const unsigned loss_percent_in,
+	const unsigned delay_ms_in, const unsigned rate_in)
+{
+	loss_percent = loss_percent_in;
+	delay_ms = delay_ms_in;
+	rate = rate_in;
+}
+
+bool net::ndgram_stream::is_open() const
+{
+	return N.is_open();
+}
+
+boost::optional<net::endpoint> net::ndgram_stream::local_ep()
+{
+	return N.local_ep();
+}
+
+boost::uint32_t net::ndgram_stream::new_ID()
+{
+	while(true){
+		boost::uint32_t ID = random_uint32();
+		if(ID != 0 && Stream.find(ID) == Stream.end()){
+			return ID;
+		}
+	}
+}
+
+boost::uint32_t net::ndgram_stream::now_us()
+{
+	static const boost::posix_time::ptime epoch(boost::gregorian::date(1970, 1, 1));
+	return static_cast<boost::uint32_t>((now() - epoch).total_microseconds());
+}
+
+void net::ndgram_stream::open(const endpoint & ep)
+{
+	close();
+	N.open(ep);
+	N.set_non_blocking(true);
+	opened = N.is_open();
+}
+
+void net::ndgram_stream::pace_timeout(const boost::uint32_t ID)
+{
+	std::map<boost::uint32_t, boost::shared_ptr<stream> >::iterator
+		it = Stream.find(ID);
+	if(it != Stream.end()){
+		send_some(*it->second);
+	}
+	deliver();
+}
+
+void net::ndgram_stream::packet_acked(stream & S, const boost::uint64_t seq,
+	packet & P, const boost::posix_time::ptime & t, unsigned & acked,
+	boost::int64_t & rtt_us)
+{
+	if(P.in_flight){
+		S.in_flight -= P.payload.size();
+		P.in_flight = false;
+	}
+	//original may arrive after being marked lost, don't retransmit it
+	P.lost = false;
+	acked += P.payload.size();
+	if(P.transmits == 1){
+		//Karn's algorithm, RTT ambiguous if retransmitted
+		rtt_us = (t - P.sent).total_microseconds();
+	}
+	if(seq > S.highest_acked){
+		S.highest_acked = seq;
+	}
+	if(P.sent > S.latest_acked_sent){
+		S.latest_acked_sent = P.sent;
+	}
+}
+
+void net::ndgram_stream::process(const buffer & buf, const endpoint & from)
+{
+	if(buf.empty()){
+		return;
+	}
+	const unsigned char type = buf[0];
+	if(type == syn_type){
+		if(buf.size() < syn_size){
+			return;
+		}
+		const boost::uint32_t remote_ID = read_uint32(buf, 1);
+		std::map<std::pair<endpoint, boost::uint32_t>, boost::uint32_t>::iterator
+			it = Remote.find(std::make_pair(from, remote_ID));
+		if(it != Remote.end()){
+			//accept lost, send again
+			std::map<boost::uint32_t, boost::shared_ptr<stream> >::iterator
+				it_stream = Stream.find(it->second);
+			if(it_stream != Stream.end()){
+				send_syn_ack(*it_stream->second);
+			}
+			return;
+		}
+		boost::shared_ptr<stream> S(new stream(new_ID(), from));
+		S->remote_ID = remote_ID;
+		S->recv_next = (boost::uint64_t(1) << 32) | read_uint32(buf, 5);
+		S->established = true;
+		Stream.insert(std::make_pair(S->local_ID, S));
+		Remote.insert(std::make_pair(std::make_pair(from, remote_ID), S->local_ID));
+		send_syn_ack(*S);
+		Event.push_back(event(S->local_ID, accept_event));
+		return;
+	}
+	if(buf.size() < reset_size){
+		return;
+	}
+	const boost::uint32_t ID = read_uint32(buf, 1);
+	if(type == reset_type){
+		std::map<std::pair<endpoint, boost::uint32_t>, boost::uint32_t>::iterator
+			it = Remote.find(std::make_pair(from, ID));
+		if(it != Remote.end()){
+			std::map<boost::uint32_t, boost::shared_ptr<stream> >::iterator
+				it_stream = Stream.find(it->second);
+			if(it_stream != Stream.end() && !it_stream->second->local_closed){
+				Event.push_back(event(it_stream->first, close_event));
+			}
+			remove(it->second);
+		}
+		return;
+	}
+	std::map<boost::uint32_t, boost::shared_ptr<stream> >::iterator
+		it = Stream.find(ID);
+	if(it == Stream.end() || it->second->ep != from){
+		send_reset(from, ID);
+		return;
+	}
+	stream & S = *it->second;
+	if(type == syn_ack_type){
+		if(buf.size() < syn_ack_size || S.established){
+			return;
+		}
+		S.remote_ID = read_uint32(buf, 5);
+		S.recv_next = (boost::uint64_t(1) << 32) | read_uint32(buf, 9);
+		S.established = true;
+		S.rto_cnt = 0;
+		S.rto_us = init_rto_us;
+		Remote.insert(std::make_pair(std::make_pair(S.ep, S.remote_ID), S.local_ID));
+		Timer_Wheel.cancel(S.RTO_Timer);
+		if(S.syn_transmits == 1){
+			rtt_sample(S, (now() - S.syn_sent).total_microseconds());
+		}
+		if(!S.local_closed){
+			Event.push_back(event(S.local_ID, connect_event));
+		}
+		send_some(S);
+	}else if(!S.established){
+		//stream packets sent before accept arrived will be retransmitted
+		return;
+	}else if(type == data_type || type == fin_type){
+		if(buf.size() >= data_header_size){
+			data_recv(S, buf);
+		}
+	}else if(type == ack_type){
+		if(buf.size() >= ack_size){
+			ack_recv(S, buf);
+		}
+	}
+}
+
+void net::ndgram_stream::raw_send(const endpoint & ep, buffer & buf)
+{
+	if(Out_Queue.empty()){
+		int n_bytes = N.send(buf, ep);
+		if(n_bytes > 0){
+			return;
+		}else if(!N.is_open()){
+			check_socket();
+			return;
+		}
+		//OS buffer full
+		Event.push_back(event(0, write_event));
+	}
+	Out_Queue.push_back(datagram(ep, boost::posix_time::ptime()));
+	Out_Queue.back().buf.swap(buf);
+}
+
+void net::ndgram_stream::read()
+{
+	while(N.is_open()){
+		buffer buf;
+		boost::optional<endpoint> from;
+		if(N.recv(buf, from) <= 0 || !from){
+			break;
+		}
+		process(buf, *from);
+	}
+	check_socket();
+	//one ACK per stream per read
+	for(std::set<boost::uint32_t>::iterator it_cur = Ack_Pending.begin(),
+		it_end = Ack_Pending.end(); it_cur != it_end; ++it_cur)
+	{
+		std::map<boost::uint32_t, boost::shared_ptr<stream> >::iterator
+			it = Stream.find(*it_cur);
+		if(it != Stream.end()){
+			send_ack(*it->second);
+		}
+	}
+	Ack_Pending.clear();
+	deliver();
+}
+
+void net::ndgram_stream::release_delayed()
+{
+	const boost::posix_time::ptime t = now();
+	while(!Delay_Queue.empty() && Delay_Queue.front().release <= t){
+		raw_send(Delay_Queue.front().ep, Delay_Queue.front().buf);
+		Delay_Queue.pop_front();
+	}
+	if(!Delay_Queue.empty()){
+		Delay_Timer = Timer_Wheel.arm(ms_until(Delay_Queue.front().release),
+			boost::bind(&ndgram_stream::release_delayed, this));
+	}
+	deliver();
+}
+
+boost::optional<net::endpoint> net::ndgram_stream::remote_ep(const boost::uint32_t ID)
+{
+	std::map<boost::uint32_t, boost::shared_ptr<stream> >::iterator
+		it = Stream.find(ID);
+	if(it == Stream.end()){
+		return boost::optional<endpoint>();
+	}
+	return it->second->ep;
+}
+
+void net::ndgram_stream::remove(const boost::uint32_t ID)
+{
+	std::map<boost::uint32_t, boost::shared_ptr<stream> >::iterator
+		it = Stream.find(ID);
+	if(it != Stream.end()){
+		Timer_Wheel.cancel(it->second->RTO_Timer);
+		Timer_Wheel.cancel(it->second->Pace_Timer);
+		if(it->second->remote_ID != 0){
+			Remote.erase(std::make_pair(it->second->ep, it->second->remote_ID));
+		}
+		Stream.erase(it);
+	}
+}
+
+void net::ndgram_stream::rto_timeout(const boost::uint32_t ID)
+{
+	std::map<boost::uint32_t, boost::shared_ptr<stream> >::iterator
+		it = Stream.find(ID);
+	if(it == Stream.end()){
+		return;
+	}
+	stream & S = *it->second;
+	if(!S.established){
+		if(++S.rto_cnt > max_retransmit){
+			if(!S.local_closed){
+				Event.push_back(event(ID, close_event, false));
+			}
+			remove(ID);
+		}else{
+			S.rto_us = S.rto_us * 2 < max_rto_us ? S.rto_us * 2 : max_rto_us;
+			send_syn(S);
+			S.RTO_Timer = Timer_Wheel.arm(S.rto_us / 1000, boost::bind(
+				&ndgram_stream::rto_timeout, this, ID));
+		}
+		deliver();
+		return;
+	}
+	if(S.Unacked.empty()){
+		return;
+	}
+	if(++S.rto_cnt > max_retransmit){
+		if(!S.local_closed){
+			Event.push_back(event(ID, close_event));
+		}
+		remove(ID);
+		deliver();
+		return;
+	}
+	//assume everything in flight lost (RFC 6817 section 2.4.2)
+	for(std::map<boost::uint64_t, packet>::iterator it_cur = S.Unacked.begin(),
+		it_end = S.Unacked.end(); it_cur != it_end; ++it_cur)
+	{
+		packet & P = it_cur->second;
+		if(!P.sacked){
+			if(P.in_flight){
+				S.in_flight -= P.payload.size();
+				P.in_flight = false;
+			}
+			P.lost = true;
+		}
+	}
+	S.ssthresh = S.cwnd / 2 > 2 * MSS ? S.cwnd / 2 : 2 * MSS;
+	S.cwnd = MSS;
+	S.recovery_seq = S.next_seq;
+	S.rto_us = S.rto_us * 2 < max_rto_us ? S.rto_us * 2 : max_rto_us;
+	S.next_send = now();
+	send_some(S);
+	deliver();
+}
+
+void net::ndgram_stream::rtt_sample(stream & S, boost::int64_t rtt_us)
+{
+	if(rtt_us <= 0){
+		rtt_us = 1;
+	}
+	//RFC 6298
+	if(S.srtt_us == 0){
+		S.srtt_us = rtt_us;
+		S.rttvar_us = rtt_us / 2;
+	}else{
+		boost::int64_t err = S.srtt_us - rtt_us;
+		S.rttvar_us = (3 * S.rttvar_us + (err < 0 ? -err : err)) / 4;
+		S.srtt_us = (7 * S.srtt_us + rtt_us) / 8;
+	}
+	S.rto_us = S.srtt_us + 4 * S.rttvar_us;
+	if(S.rto_us < min_rto_us){
+		S.rto_us = min_rto_us;
+	}else if(S.rto_us > max_rto_us){
+		S.rto_us = max_rto_us;
+	}
+}
+
+void net::ndgram_stream::send(const boost::uint32_t ID, buffer & buf)
+{
+	std::map<boost::uint32_t, boost::shared_ptr<stream> >::iterator
+		it = Stream.find(ID);
+	if(it == Stream.end() || it->second->local_closed){
+		buf.clear();
+		return;
+	}
+	stream & S = *it->second;
+	if(S.Send_Buf.empty()){
+		S.Send_Buf.swap(buf);
+	}else{
+		S.Send_Buf.append(buf);
+	}
+	buf.clear();
+	send_some(S);
+	deliver();
+}
+
+void net::ndgram_stream::send_ack(stream & S)
+{
+	boost::uint32_t sack = 0;
+	for(std::map<boost::uint64_t, std::pair<buffer, bool> >::iterator
+		it_cur = S.Recv_OOO.begin(), it_end = S.Recv_OOO.end();
+		it_cur != it_end; ++it_cur)
+	{
+		boost::uint64_t x = it_cur->first - S.recv_next - 1;
+		if(x >= 32){
+			break;
+		}
+		sack |= boost::uint32_t(1) << x;
+	}
+	buffer buf;
+	buf.append(static_cast<unsigned char>(ack_type));
+	append_uint32(buf, S.remote_ID);
+	append_uint32(buf, static_cast<boost::uint32_t>(S.recv_next));
+	append_uint32(buf, sack);
+	append_uint32(buf, S.ack_delay);
+	send_datagram(S.ep, buf);
+}
+
+unsigned net::ndgram_stream::send_buf_size(const boost::uint32_t ID)
+{
+	std::map<boost::uint32_t, boost::shared_ptr<stream> >::iterator
+		it = Stream.find(ID);
+	if(it == Stream.end()){
+		return 0;
+	}
+	return it->second->Send_Buf.size() + it->second->unacked_bytes;
+}
+
+void net::ndgram_stream::send_datagram(const endpoint & ep, buffer & buf)
+{
+	if(loss_percent == 0 && delay_ms == 0 && rate == 0){
+		raw_send(ep, buf);
+		return;
+	}
+	if(loss_percent != 0 && static_cast<unsigned>(std::rand() % 100) < loss_percent){
+		return;
+	}
+	boost::posix_time::ptime release = now();
+	if(rate != 0){
+		//datagrams serialized at bottleneck, queue builds when sending faster
+		if(bottleneck_free < release){
+			bottleneck_free = release;
+		}
+		bottleneck_free += boost::posix_time::microseconds(
+			static_cast<boost::int64_t>(buf.size()) * 1000000 / rate);
+		release = bottleneck_free;
+	}
+	release += boost::posix_time::milliseconds(delay_ms);
+	Delay_Queue.push_back(datagram(ep, release));
+	Delay_Queue.back().buf.swap(buf);
+	if(!Delay_Timer.armed()){
+		Delay_Timer = Timer_Wheel.arm(ms_until(Delay_Queue.front().release),
+			boost::bind(&ndgram_stream::release_delayed, this));
+	}
+}
+
+void net::ndgram_stream::send_reset(const endpoint & ep, const boost::uint32_t ID)
+{
+	buffer buf;
+	buf.append(static_cast<unsigned char>(reset_type));
+	append_uint32(buf, ID);
+	send_datagram(ep, buf);
+}
+
+void net::ndgram_stream::send_some(stream & S)
+{
+	if(!S.established || !N.is_open()){
+		return;
+	}
+	const boost::posix_time::ptime t = now();
+	const boost::posix_time::time_duration burst = boost::posix_time::microseconds(
+		static_cast<boost::int64_t>(pace_burst_us));
+	while(true){
+		//retransmit lost packets before sending new ones
+		std::map<boost::uint64_t, packet>::iterator it = S.Unacked.begin();
+		while(it != S.Unacked.end() && !it->second.lost){
+			++it;
+		}
+		unsigned size;
+		if(it != S.Unacked.end()){
+			size = it->second.payload.size();
+		}else if(!S.Unacked.empty() && S.next_seq - S.Unacked.begin()->first >= max_window){
+			//remote host won't accept packets this far ahead
+			break;
+		}else if(!S.Send_Buf.empty()){
+			size = S.Send_Buf.size() < MSS ? S.Send_Buf.size() : MSS;
+		}else if(S.local_closed && !S.fin_queued){
+			size = 0;
+		}else{
+			break;
+		}
+		if(S.in_flight != 0 && S.in_flight + size > S.cwnd){
+			break;
+		}
+		if(S.next_send > t + burst){
+			if(!S.Pace_Timer.armed()){
+				S.Pace_Timer = Timer_Wheel.arm(ms_until(S.next_send - burst),
+					boost::bind(&ndgram_stream::pace_timeout, this, S.local_ID));
+			}
+			break;
+		}
+		if(it == S.Unacked.end()){
+			//put new packet in Unacked
+			it = S.Unacked.insert(std::make_pair(S.next_seq++, packet())).first;
+			if(size == 0){
+				it->second.fin = true;
+				S.fin_queued = true;
+			}else{
+				it->second.payload.append(S.Send_Buf.data(), size);
+				S.Send_Buf.consume_front(size);
+				S.unacked_bytes += size;
+			}
+		}
+		packet & P = it->second;
+		buffer buf;
+		buf.append(static_cast<unsigned char>(P.fin ? fin_type : data_type));
+		append_uint32(buf, S.remote_ID);
+		append_uint32(buf, static_cast<boost::uint32_t>(it->first));
+		append_uint32(buf, now_us());
+		buf.append(P.payload);
+		P.sent = t;
+		++P.transmits;
+		P.lost = false;
+		P.in_flight = true;
+		S.in_flight += size;
+		send_datagram(S.ep, buf);
+		if(S.srtt_us != 0){
+			//pace cwnd over RTT, faster in slow start so cwnd can grow
+			boost::int64_t interval_us = S.srtt_us * (size == 0 ? 1 : size) / S.cwnd;
+			interval_us = S.cwnd < S.ssthresh ? interval_us / 2 : interval_us * 4 / 5;
+			if(S.next_send < t){
+				S.next_send = t;
+			}
+			S.next_send += boost::posix_time::microseconds(interval_us);
+		}
+	}
+	if(!S.Unacked.empty() && !S.RTO_Timer.armed()){
+		S.RTO_Timer = Timer_Wheel.arm(S.rto_us / 1000, boost::bind(
+			&ndgram_stream::rto_timeout, this, S.local_ID));
+	}
+}
+
+void net::ndgram_stream::send_syn(stream & S)
+{
+	buffer buf;
+	buf.append(static_cast<unsigned char>(syn_type));
+	append_uint32(buf, S.local_ID);
+	append_uint32(buf, static_cast<boost::uint32_t>(S.next_seq));
+	S.syn_sent = now();
+	++S.syn_transmits;
+	send_datagram(S.ep, buf);
+}
+
+void net::ndgram_stream::send_syn_ack(stream & S)
+{
+	buffer buf;
+	buf.append(static_cast<unsigned char>(syn_ack_type));
+	append_uint32(buf, S.remote_ID);
+	append_uint32(buf, S.local_ID);
+	append_uint32(buf, static_cast<boost::uint32_t>(S.next_seq));
+	send_datagram(S.ep, buf);
+}
+
+int net::ndgram_stream::socket()
+{
+	return N.socket();
+}
+
+bool net::ndgram_stream::want_write()
+{
+	return !Out_Queue.empty();
+}
+
+void net::ndgram_stream::write()
+{
+	while(!Out_Queue.empty()){
+		int n_bytes = N.send(Out_Queue.front().buf, Out_Queue.front().ep);
+		if(n_bytes <= 0 && N.is_open()){
+			//OS buffer still full
+			break;
+		}
+		Out_Queue.pop_front();
+	}
+	check_socket();
+	deliver();
+}
@@ -81,11 +81,7 @@ void net::nstream::open_async(const endpoint & ep)
 int net::nstream::recv(buffer & buf, const int max_transfer)
 {
 	assert(max_transfer > 0);
-	if(max_transfer > MTU){
-		buf.tail_reserve(MTU);
-	}else{
-		buf.tail_reserve(max_transfer);
-	}
+	buf.tail_reserve(max_transfer);
 	if(socket_FD == -1){
 		//socket previously disconnected, errno might not be valid here
 		return 0;
@@ -93,8 +89,11 @@ int net::nstream::recv(buffer & buf, const int max_transfer)
 		int n_bytes = ::recv(socket_FD, reinterpret_cast<char *>(buf.tail_start()),
 			buf.tail_size(), MSG_NOSIGNAL);
 		if(n_bytes == -1){
-			LOG << strerror(errno);
-			close();
+			if(errno != EWOULDBLOCK){
+				LOG << strerror(errno);
+				close();
+			}
+			buf.tail_reserve(0);
 		}else if(n_bytes == 0){
 			close();
 			buf.tail_reserve(0);
@@ -121,8 +120,10 @@ int net::nstream::send(buffer & buf, int max_transfer)
 		int n_bytes = ::send(socket_FD, reinterpret_cast<char *>(buf.data()),
 			max_transfer, MSG_NOSIGNAL);
 		if(n_bytes == -1){
-			LOG << strerror(errno);
-			close();
+			if(errno != EWOULDBLOCK){
+				LOG << strerror(errno);
+				close();
+			}
 		}else if(n_bytes == 0){
 			close();
 		}else{
@@ -131,3 +132,80 @@ int net::nstream::send(buffer & buf, int max_transfer)
 		return n_bytes;
 	}
 }
+
+int net::nstream::send(const iovec * iov, const int iov_cnt)
+{
+	assert(iov_cnt > 0);
+	if(socket_FD == -1){
+		//socket previously disconnected, errno might not be valid here
+		return 0;
+	}
+	#ifdef _WIN32
+	//no sendmsg, only send first buffer
+	int n_bytes = ::send(socket_FD, reinterpret_cast<const char *>(iov[0].iov_base),
+		iov[0].iov_len, MSG_NOSIGNAL);
+	#else
+	msghdr msg;
+	std::memset(&msg, 0, sizeof(msg));
+	msg.msg_iov = const_cast<iovec *>(iov);
+	msg.msg_iovlen = iov_cnt;
+	int n_bytes = ::sendmsg(socket_FD, &msg, MSG_NOSIGNAL);
+	#endif
+	if(n_bytes == -1){
+		if(errno != EWOULDBLOCK){
+			LOG << strerror(errno);
+			close();
+		}
+	}else if(n_bytes == 0){
+		close();
+	}
+	return n_bytes;
+}
+
+int net::nstream::send_file(const int file_FD, boost::uint64_t & offset,
+	int max_transfer)
+{
+	assert(max_transfer > 0);
+	if(socket_FD == -1){
+		//socket previously disconnected, errno might not be valid here
+		return 0;
+	}
+	#ifdef __linux__
+	off_t off = offset;
+	int n_bytes = ::sendfile(socket_FD, file_FD, &off, max_transfer);
+	if(n_bytes == -1){
+		if(errno != EWOULDBLOCK){
+			LOG << strerror(errno);
+			close();
+		}
+	}else{
+		offset += n_bytes;
+	}
+	return n_bytes;
+	#else
+	//no sendfile, copy through buffer
+	if(max_transfer > MTU){
+		max_transfer = MTU;
+	}
+	char buf[MTU];
+	int n_read = ::pread(file_FD, buf, max_transfer, offset);
+	if(n_read <= 0){
+		if(n_read == -1){
+			LOG << strerror(errno);
+		}
+		return 0;
+	}
+	int n_bytes = ::send(socket_FD, buf, n_read, MSG_NOSIGNAL);
+	if(n_bytes == -1){
+		if(errno != EWOULDBLOCK){
+			LOG << strerror(errno);
+			close();
+		}
+	}else if(n_bytes == 0){
+		close();
+	}else{
+		offset += n_bytes;
+	}
+	return n_bytes;
+	#endif
+}
@@ -37,12 +37,11 @@ net::nstream_proactor::disconnect_event::disconnect_event(
 
 net::nstream_proactor::recv_event::recv_event(
 	const boost::shared_ptr<const conn_info> & info_in,
-	const buffer & buf_in
+	buffer & buf_in
 ):
-	info(info_in),
-	buf(buf_in)
+	info(info_in)
 {
-
+	buf.swap(buf_in);
 }
 
 net::nstream_proactor::send_event::send_event(
@@ -55,6 +54,22 @@ net::nstream_proactor::send_event::send_event(
 	send_buf_size(send_buf_size_in)
 {
 
+}
+
+net::nstream_proactor::file_range::file_range(
+	const int file_FD_in,
+	const boost::uint64_t offset_in,
+	const boost::uint64_t size_in,
+	const boost::shared_ptr<void> & owner_in,
+	const unsigned max_rate_in
+):
+	file_FD(file_FD_in),
+	offset(offset_in),
+	size(size_in),
+	owner(owner_in),
+	max_rate(max_rate_in)
+{
+
 }
 //END events
 
@@ -64,15 +79,37 @@ net::nstream_proactor::conn::~conn()
 
 }
 
-void net::nstream_proactor::conn::schedule_send(const buffer & buf,
+void net::nstream_proactor::conn::schedule_send(
+	const boost::shared_ptr<buffer> & buf, const bool close_on_empty)
+{
+
+}
+
+void net::nstream_proactor::conn::schedule_send_file(const file_range & FR,
 	const bool close_on_empty)
 {
 
 }
 
-bool net::nstream_proactor::conn::timed_out()
+void net::nstream_proactor::conn::set_max_rate(const unsigned download,
+	const unsigned upload)
+{
+
+}
+
+int net::nstream_proactor::conn::timeout_ms()
 {
-	return false;
+	return -1;
+}
+
+void net::nstream_proactor::conn::unpark_read()
+{
+
+}
+
+void net::nstream_proactor::conn::unpark_write()
+{
+
 }
 
 void net::nstream_proactor::conn::write()
@@ -82,67 +119,145 @@ void net::nstream_proactor::conn::write()
 //END conn
 
 //BEGIN conn_container
-net::nstream_proactor::conn_container::conn_container():
+net::nstream_proactor::conn_container::conn_container(select & Select_in,
+	const unsigned max_recv_in
+):
+	Select(Select_in),
+	_max_recv(max_recv_in == 0 ? socket_base::MTU : max_recv_in),
 	unused_conn_ID(0),
-	last_time(std::time(NULL)),
 	incoming_conn_limit(0),
 	outgoing_conn_limit(0),
 	incoming_conns(0),
-	outgoing_conns(0)
+	outgoing_conns(0),
+	download_share(std::numeric_limits<unsigned>::max()),
+	upload_share(std::numeric_limits<unsigned>::max())
 {
 
 }
 
+net::nstream_proactor::conn_container::~conn_container()
+{
+	while(!ID.empty()){
+		remove(ID.begin()->first);
+	}
+}
+
 void net::nstream_proactor::conn_container::add(const boost::shared_ptr<conn> & C)
 {
-	Socket.insert(std::make_pair(C->socket(), C));
+	if(C->socket() != -1){
+		Socket.insert(std::make_pair(C->socket(), C));
+	}
 	ID.insert(std::make_pair(C->info()->conn_ID, C));
+	arm_timeout(C->info()->conn_ID, C->timeout_ms());
 }
 
-void net::nstream_proactor::conn_container::check_timeouts()
+void net::nstream_proactor::conn_container::add_download(const unsigned n_bytes)
 {
-	if(last_time != std::time(NULL)){
-		last_time = std::time(NULL);
-		std::list<boost::uint64_t> timed_out;
-		for(std::map<boost::uint64_t, boost::shared_ptr<conn> >::iterator
-			it_cur = ID.begin(), it_end = ID.end(); it_cur != it_end; ++it_cur)
-		{
-			if(it_cur->second->timed_out()){
-				timed_out.push_back(it_cur->second->info()->conn_ID);
-				it_cur->second->set_error(timeout_error);
-			}
-		}
-		for(std::list<boost::uint64_t>::iterator it_cur = timed_out.begin(),
-			it_end = timed_out.end(); it_cur != it_end; ++it_cur)
-		{
-			remove(*it_cur);
-		}
+	if(n_bytes != 0){
+		Download_Bucket.consume(n_bytes);
+		Download_Speed.add(n_bytes);
 	}
 }
 
-boost::uint64_t net::nstream_proactor::conn_container::new_conn_ID()
+void net::nstream_proactor::conn_container::add_upload(const unsigned n_bytes)
 {
-	return unused_conn_ID++;
+	if(n_bytes != 0){
+		Upload_Bucket.consume(n_bytes);
+		Upload_Speed.add(n_bytes);
+	}
+}
+
+void net::nstream_proactor::conn_container::arm_timeout(
+	const boost::uint64_t conn_ID, const int ms)
+{
+	if(ms < 0){
+		//connection never times out
+		Timeout_Timer.erase(conn_ID);
+	}else{
+		Timeout_Timer[conn_ID] = Timer_Wheel.arm(ms, boost::bind(
+			&conn_container::check_timeout, this, conn_ID));
+	}
+}
+
+void net::nstream_proactor::conn_container::check_timeout(
+	const boost::uint64_t conn_ID)
+{
+	std::map<boost::uint64_t, boost::shared_ptr<conn> >::iterator
+		it = ID.find(conn_ID);
+	if(it == ID.end()){
+		return;
+	}
+	/*
+	Connections don't rearm their timer each time they're touched. When the
+	timer expires we check if the timeout was pushed back and rearm.
+	*/
+	int ms = it->second->timeout_ms();
+	if(ms == 0){
+		it->second->set_error(timeout_error);
+		remove(conn_ID);
+	}else{
+		arm_timeout(conn_ID, ms);
+	}
+}
+
+unsigned net::nstream_proactor::conn_container::download_quota()
+{
+	return download_share;
+}
+
+unsigned net::nstream_proactor::conn_container::download_rate()
+{
+	return Download_Speed.speed();
+}
+
+unsigned net::nstream_proactor::conn_container::download_wait_ms()
+{
+	return Download_Bucket.wait_ms();
+}
+
+bool net::nstream_proactor::conn_container::edge_triggered()
+{
+	return Select.edge_triggered();
 }
 
-std::set<int> net::nstream_proactor::conn_container::read_set()
+void net::nstream_proactor::conn_container::expire_timers()
 {
-	return _read_set;
+	Timer_Wheel.expire();
+}
+
+unsigned net::nstream_proactor::conn_container::max_recv()
+{
+	return _max_recv;
+}
+
+boost::uint64_t net::nstream_proactor::conn_container::new_conn_ID()
+{
+	return unused_conn_ID++;
 }
 
 void net::nstream_proactor::conn_container::monitor_read(const int socket_FD)
 {
-	_read_set.insert(socket_FD);
+	Select.monitor_read(socket_FD);
 }
 
 void net::nstream_proactor::conn_container::monitor_write(const int socket_FD)
 {
-	_write_set.insert(socket_FD);
+	Select.monitor_write(socket_FD);
+}
+
+void net::nstream_proactor::conn_container::park(const boost::uint64_t conn_ID,
+	const bool write, const unsigned wait_ms)
+{
+	Timer_Wheel.arm(wait_ms, boost::bind(&conn_container::unpark, this, conn_ID,
+		write));
 }
 
 void net::nstream_proactor::conn_container::perform_reads(
 	const std::set<int> & read_set_in)
 {
+	if(!read_set_in.empty()){
+		download_share = share(Download_Bucket.available(), read_set_in.size());
+	}
 	for(std::set<int>::const_iterator it_cur = read_set_in.begin(),
 		it_end = read_set_in.end(); it_cur != it_end; ++it_cur)
 	{
@@ -157,6 +272,9 @@ void net::nstream_proactor::conn_container::perform_reads(
 void net::nstream_proactor::conn_container::perform_writes(
 	const std::set<int> & write_set_in)
 {
+	if(!write_set_in.empty()){
+		upload_share = share(Upload_Bucket.available(), write_set_in.size());
+	}
 	for(std::set<int>::const_iterator it_cur = write_set_in.begin(),
 		it_end = write_set_in.end(); it_cur != it_end; ++it_cur)
 	{
@@ -173,15 +291,25 @@ void net::nstream_proactor::conn_container::remove(const boost::uint64_t conn_ID
 	std::map<boost::uint64_t, boost::shared_ptr<conn> >::iterator
 		it = ID.find(conn_ID);
 	if(it != ID.end()){
-		_read_set.erase(it->second->socket());
-		_write_set.erase(it->second->socket());
-		Socket.erase(it->second->socket());
-		ID.erase(it->second->info()->conn_ID);
+		//destroyed when function returns, dtor may remove other conns
+		boost::shared_ptr<conn> C = it->second;
+		if(C->socket() != -1){
+			Select.remove(C->socket());
+			Socket.erase(C->socket());
+		}
+		ID.erase(it);
+		std::map<boost::uint64_t, timer_wheel::handle>::iterator
+			it_timer = Timeout_Timer.find(conn_ID);
+		if(it_timer != Timeout_Timer.end()){
+			Timer_Wheel.cancel(it_timer->second);
+			Timeout_Timer.erase(it_timer);
+		}
 	}
 }
 
 void net::nstream_proactor::conn_container::schedule_send(
-	const boost::uint64_t conn_ID, const buffer & buf, const bool close_on_empty)
+	const boost::uint64_t conn_ID, const boost::shared_ptr<buffer> & buf,
+	const bool close_on_empty)
 {
 	std::map<boost::uint64_t, boost::shared_ptr<conn> >::iterator
 		it = ID.find(conn_ID);
@@ -190,22 +318,144 @@ void net::nstream_proactor::conn_container::schedule_send(
 	}
 }
 
+void net::nstream_proactor::conn_container::schedule_send_file(
+	const boost::uint64_t conn_ID, const file_range & FR, const bool close_on_empty)
+{
+	std::map<boost::uint64_t, boost::shared_ptr<conn> >::iterator
+		it = ID.find(conn_ID);
+	if(it != ID.end()){
+		it->second->schedule_send_file(FR, close_on_empty);
+	}
+}
+
+void net::nstream_proactor::conn_container::set_max_connection_rate(
+	const boost::uint64_t conn_ID, const unsigned download, const unsigned upload)
+{
+	std::map<boost::uint64_t, boost::shared_ptr<conn> >::iterator
+		it = ID.find(conn_ID);
+	if(it != ID.end()){
+		it->second->set_max_rate(download, upload);
+	}
+}
+
+void net::nstream_proactor::conn_container::set_max_download_rate(
+	const unsigned rate)
+{
+	Download_Bucket.set_rate(rate);
+}
+
+void net::nstream_proactor::conn_container::set_max_upload_rate(
+	const unsigned rate)
+{
+	Upload_Bucket.set_rate(rate);
+}
+
+unsigned net::nstream_proactor::conn_container::share(const unsigned available,
+	const unsigned conn_cnt)
+{
+	if(available == 0){
+		return 0;
+	}else if(available / conn_cnt < socket_base::MTU){
+		return socket_base::MTU;
+	}else{
+		return available / conn_cnt;
+	}
+}
+
+int net::nstream_proactor::conn_container::timer_ms()
+{
+	return Timer_Wheel.next_ms();
+}
+
+timer_wheel & net::nstream_proactor::conn_container::timers()
+{
+	return Timer_Wheel;
+}
+
 void net::nstream_proactor::conn_container::unmonitor_read(const int socket_FD)
 {
-	_read_set.erase(socket_FD);
+	Select.unmonitor_read(socket_FD);
 }
 
 void net::nstream_proactor::conn_container::unmonitor_write(const int socket_FD)
 {
-	_write_set.erase(socket_FD);
+	Select.unmonitor_write(socket_FD);
 }
 
-std::set<int> net::nstream_proactor::conn_container::write_set()
+void net::nstream_proactor::conn_container::unpark(const boost::uint64_t conn_ID,
+	const bool write)
 {
-	return _write_set;
+	std::map<boost::uint64_t, boost::shared_ptr<conn> >::iterator
+		it = ID.find(conn_ID);
+	if(it != ID.end()){
+		if(write){
+			it->second->unpark_write();
+		}else{
+			it->second->unpark_read();
+		}
+	}
+}
+
+unsigned net::nstream_proactor::conn_container::upload_quota()
+{
+	return upload_share;
+}
+
+unsigned net::nstream_proactor::conn_container::upload_rate()
+{
+	return Upload_Speed.speed();
+}
+
+unsigned net::nstream_proactor::conn_container::upload_wait_ms()
+{
+	return Upload_Bucket.wait_ms();
 }
 //END conn_container
 
+//BEGIN send_segment
+net::nstream_proactor::send_segment::send_segment(
+	const boost::shared_ptr<buffer> & buf_in
+):
+	buf(buf_in),
+	offset(0)
+{
+
+}
+
+net::nstream_proactor::send_segment::send_segment(
+	const file_range & FR_in
+):
+	offset(0),
+	FR(FR_in),
+	FR_Bucket(FR_in.max_rate)
+{
+
+}
+
+unsigned net::nstream_proactor::send_segment::consume(
+	const unsigned n_bytes)
+{
+	assert(!FR);
+	unsigned remaining = buf->size() - offset;
+	if(n_bytes >= remaining){
+		offset = buf->size();
+		return n_bytes - remaining;
+	}else{
+		offset += n_bytes;
+		return 0;
+	}
+}
+
+bool net::nstream_proactor::send_segment::empty() const
+{
+	if(FR){
+		return FR->size == 0;
+	}else{
+		return offset == buf->size();
+	}
+}
+//END send_segment
+
 //BEGIN conn_nstream
 net::nstream_proactor::conn_nstream::conn_nstream(
 	dispatcher & Dispatcher_in,
@@ -215,8 +465,11 @@ net::nstream_proactor::conn_nstream::conn_nstream(
 	Dispatcher(Dispatcher_in),
 	Conn_Container(Conn_Container_in),
 	N(new nstream()),
+	recv_chunk(socket_base::MTU),
+	send_queue_size(0),
 	close_on_empty(false),
 	half_open(true),
+	write_parked(false),
 	timeout(std::time(NULL) + connect_timeout),
 	error(no_error)
 {
@@ -240,13 +493,18 @@ net::nstream_proactor::conn_nstream::conn_nstream(
 	Dispatcher(Dispatcher_in),
 	Conn_Container(Conn_Container_in),
 	N(N_in),
+	recv_chunk(socket_base::MTU),
+	send_queue_size(0),
 	close_on_empty(false),
 	half_open(false),
+	write_parked(false),
 	timeout(std::time(NULL) + idle_timeout),
 	error(no_error)
 {
 	socket_FD = N->socket();
 	assert(N->is_open());
+	//accepted sockets don't inherit non-blocking from the listener
+	N->set_non_blocking(true);
 	_info.reset(new conn_info(
 		Conn_Container.new_conn_ID(),
 		incoming_dir,
@@ -272,27 +530,93 @@ boost::shared_ptr<const net::nstream_proactor::conn_info>
 void net::nstream_proactor::conn_nstream::read()
 {
 	touch();
-	buffer buf;
-	int n_bytes = N->recv(buf);
-	if(n_bytes <= 0){
-		//assume connection reset (may not be)
-		error = connection_reset_error;
+	const unsigned quota = std::min(Download_Bucket.available(),
+		Conn_Container.download_quota());
+	unsigned total = 0;
+	bool would_block = false;
+	do{
+		//coalesce everything readable (up to max_recv) in to one recv_event
+		const unsigned max_recv = std::min(Conn_Container.max_recv(), quota - total);
+		buffer buf;
+		while(buf.size() < max_recv){
+			const unsigned chunk = std::min(recv_chunk, max_recv - buf.size());
+			int n_bytes = N->recv(buf, chunk);
+			if(n_bytes == -1 && N->is_open()){
+				//would block, wait for socket to become readable again
+				would_block = true;
+				break;
+			}else if(n_bytes <= 0){
+				//assume connection reset (may not be)
+				total += buf.size();
+				Download_Bucket.consume(total);
+				Conn_Container.add_download(total);
+				if(!buf.empty()){
+					Dispatcher.recv(boost::shared_ptr<const recv_event>(
+						new recv_event(_info, buf)));
+				}
+				error = connection_reset_error;
+				Conn_Container.remove(_info->conn_ID);
+				return;
+			}
+			//grow read size while reads fill it, shrink when mostly unused
+			if(n_bytes == chunk && recv_chunk < Conn_Container.max_recv()){
+				recv_chunk = std::min(recv_chunk * 2, Conn_Container.max_recv());
+			}else if(n_bytes < recv_chunk / 4 && recv_chunk / 2 >= socket_base::MTU){
+				recv_chunk /= 2;
+			}
+			if(n_bytes < chunk && !Conn_Container.edge_triggered()){
+				//socket drained, level triggered select will tell us if more
+				would_block = true;
+				break;
+			}
+		}
+		total += buf.size();
+		if(!buf.empty()){
+			Dispatcher.recv(boost::shared_ptr<const recv_event>(
+				new recv_event(_info, buf)));
+		}
+	}while(!would_block && total < quota && Conn_Container.edge_triggered());
+	//account in one batch
+	Download_Bucket.consume(total);
+	Conn_Container.add_download(total);
+	if(!would_block && total >= quota){
+		//rate limited, stop monitoring until bytes available
+		Conn_Container.unmonitor_read(socket_FD);
+		Conn_Container.park(_info->conn_ID, false, std::max(
+			Download_Bucket.wait_ms(), Conn_Container.download_wait_ms()));
+	}
+}
+
+void net::nstream_proactor::conn_nstream::schedule_send(
+	const boost::shared_ptr<buffer> & buf, const bool close_on_empty_in)
+{
+	if(close_on_empty_in){
+		close_on_empty = true;
+	}
+	if(!buf->empty()){
+		Send_Queue.push_back(send_segment(buf));
+		send_queue_size += buf->size();
+	}
+	if(Send_Queue.empty() && close_on_empty){
 		Conn_Container.remove(_info->conn_ID);
-	}else{
-		Dispatcher.recv(recv_event(_info, buf));
+	}else if(!write_parked){
+		Conn_Container.monitor_write(socket_FD);
 	}
 }
 
-void net::nstream_proactor::conn_nstream::schedule_send(const buffer & buf,
-	const bool close_on_empty_in)
+void net::nstream_proactor::conn_nstream::schedule_send_file(
+	const file_range & FR, const bool close_on_empty_in)
 {
 	if(close_on_empty_in){
 		close_on_empty = true;
 	}
-	send_buf.append(buf);
-	if(send_buf.empty() && close_on_empty){
+	if(FR.size != 0){
+		Send_Queue.push_back(send_segment(FR));
+		send_queue_size += FR.size;
+	}
+	if(Send_Queue.empty() && close_on_empty){
 		Conn_Container.remove(_info->conn_ID);
-	}else{
+	}else if(!write_parked){
 		Conn_Container.monitor_write(socket_FD);
 	}
 }
@@ -302,14 +626,22 @@ void net::nstream_proactor::conn_nstream::set_error(const error_t error_in)
 	error = error_in;
 }
 
+void net::nstream_proactor::conn_nstream::set_max_rate(const unsigned download,
+	const unsigned upload)
+{
+	Download_Bucket.set_rate(download);
+	Upload_Bucket.set_rate(upload);
+}
+
 int net::nstream_proactor::conn_nstream::socket()
 {
 	return socket_FD;
 }
 
-bool net::nstream_proactor::conn_nstream::timed_out()
+int net::nstream_proactor::conn_nstream::timeout_ms()
 {
-	return timeout > std::time(NULL);
+	std::time_t now = std::time(NULL);
+	return now > timeout ? 0 : (timeout - now + 1) * 1000;
 }
 
 void net::nstream_proactor::conn_nstream::touch()
@@ -317,6 +649,19 @@ void net::nstream_proactor::conn_nstream::touch()
 	timeout = std::time(NULL) + idle_timeout;
 }
 
+void net::nstream_proactor::conn_nstream::unpark_read()
+{
+	Conn_Container.monitor_read(socket_FD);
+}
+
+void net::nstream_proactor::conn_nstream::unpark_write()
+{
+	write_parked = false;
+	if(!Send_Queue.empty()){
+		Conn_Container.monitor_write(socket_FD);
+	}
+}
+
 void net::nstream_proactor::conn_nstream::write()
 {
 	touch();
@@ -324,25 +669,109 @@ void net::nstream_proactor::conn_nstream::write()
 		if(N->is_open_async()){
 			half_open = false;
 			Dispatcher.connect(connect_event(_info));
-			//send_buf always empty after connect
-			Conn_Container.unmonitor_write(socket_FD);
+			//sends may have been scheduled while connecting
+			if(Send_Queue.empty()){
+				Conn_Container.unmonitor_write(socket_FD);
+			}
 			Conn_Container.monitor_read(socket_FD);
 		}else{
 			error = connect_error;
 			Conn_Container.remove(_info->conn_ID);
 		}
 	}else{
-		int n_bytes = N->send(send_buf);
-		if(send_buf.empty()){
+		//edge-triggered select requires we send until we would block
+		const unsigned quota = std::min(Upload_Bucket.available(),
+			Conn_Container.upload_quota());
+		unsigned n_bytes = 0;
+		bool would_block = false;
+		unsigned FR_wait_ms = 0; //non-zero if file range rate limited
+		while(!Send_Queue.empty() && n_bytes < quota){
+			const unsigned allowed = quota - n_bytes;
+			int n;
+			if(Send_Queue.front().FR){
+				file_range & FR = *Send_Queue.front().FR;
+				token_bucket & FR_Bucket = Send_Queue.front().FR_Bucket;
+				unsigned max_transfer = std::min(allowed, FR_Bucket.available());
+				if(max_transfer == 0){
+					FR_wait_ms = FR_Bucket.wait_ms();
+					break;
+				}
+				if(FR.size < max_transfer){
+					max_transfer = FR.size;
+				}
+				if(max_transfer > send_file_chunk){
+					max_transfer = send_file_chunk;
+				}
+				n = N->send_file(FR.file_FD, FR.offset, max_transfer);
+				if(n > 0){
+					FR.size -= n;
+					FR_Bucket.consume(n);
+				}
+			}else{
+				//gather buffers up to the next file range, up to allowed bytes
+				iovec iov[send_iov_max];
+				int iov_cnt = 0;
+				unsigned iov_bytes = 0;
+				for(std::deque<send_segment>::iterator it_cur = Send_Queue.begin(),
+					it_end = Send_Queue.end(); it_cur != it_end && !it_cur->FR
+					&& iov_cnt < send_iov_max && iov_bytes < allowed; ++it_cur, ++iov_cnt)
+				{
+					iov[iov_cnt].iov_base = it_cur->buf->data() + it_cur->offset;
+					iov[iov_cnt].iov_len = std::min(it_cur->buf->size() - it_cur->offset,
+						allowed - iov_bytes);
+					iov_bytes += iov[iov_cnt].iov_len;
+				}
+				n = N->send(iov, iov_cnt);
+			}
+			if(n == -1 && N->is_open()){
+				//would block, wait for socket to become writeable again
+				would_block = true;
+				break;
+			}else if(n <= 0){
+				//connection reset, or file range past end of file
+				error = connection_reset_error;
+				Upload_Bucket.consume(n_bytes);
+				Conn_Container.add_upload(n_bytes);
+				Conn_Container.remove(_info->conn_ID);
+				return;
+			}
+			n_bytes += n;
+			send_queue_size -= n;
+			if(Send_Queue.front().FR){
+				if(Send_Queue.front().empty()){
+					Send_Queue.pop_front();
+				}
+			}else{
+				//release fully sent buffers
+				unsigned remaining = n;
+				while(remaining != 0){
+					remaining = Send_Queue.front().consume(remaining);
+					if(Send_Queue.front().empty()){
+						Send_Queue.pop_front();
+					}
+				}
+			}
+			if(!Conn_Container.edge_triggered()){
+				break;
+			}
+		}
+		//account in one batch
+		Upload_Bucket.consume(n_bytes);
+		Conn_Container.add_upload(n_bytes);
+		if(!Send_Queue.empty() && !would_block && (n_bytes >= quota || FR_wait_ms != 0)){
+			//rate limited, stop monitoring until bytes available
 			Conn_Container.unmonitor_write(socket_FD);
+			write_parked = true;
+			Conn_Container.park(_info->conn_ID, true, std::max(FR_wait_ms, std::max(
+				Upload_Bucket.wait_ms(), Conn_Container.upload_wait_ms())));
 		}
-		if(n_bytes <= 0){
-			error = connection_reset_error;
-			Conn_Container.remove(_info->conn_ID);
-		}else if(close_on_empty && send_buf.empty()){
+		if(Send_Queue.empty()){
+			Conn_Container.unmonitor_write(socket_FD);
+		}
+		if(close_on_empty && Send_Queue.empty()){
 			Conn_Container.remove(_info->conn_ID);
-		}else{
-			Dispatcher.send(send_event(_info, n_bytes, send_buf.size()));
+		}else if(n_bytes > 0){
+			Dispatcher.send(send_event(_info, n_bytes, send_queue_size));
 		}
 	}
 };
@@ -411,128 +840,503 @@ int net::nstream_proactor::conn_listener::socket()
 }
 //END conn_listener
 
+//BEGIN conn_ndgram_stream_socket
+net::nstream_proactor::conn_ndgram_stream_socket::conn_ndgram_stream_socket(
+	dispatcher & Dispatcher_in,
+	conn_container & Conn_Container_in,
+	const endpoint & ep
+):
+	Dispatcher(Dispatcher_in),
+	Conn_Container(Conn_Container_in),
+	Engine(Conn_Container.timers(), boost::bind(
+		&conn_ndgram_stream_socket::call_back, this, _1)),
+	error(no_error)
+{
+	Engine.open(ep);
+	socket_FD = Engine.socket();
+	_info.reset(new conn_info(
+		Conn_Container.new_conn_ID(),
+		outgoing_dir,
+		ndgram_stream_listen_tran,
+		Engine.local_ep()
+	));
+	if(Engine.is_open()){
+		Dispatcher.connect(connect_event(_info));
+		Conn_Container.monitor_read(socket_FD);
+	}else{
+		error = listen_error;
+	}
+}
+
+net::nstream_proactor::conn_ndgram_stream_socket::~conn_ndgram_stream_socket()
+{
+	//close without call backs, then remove streams that were on socket
+	Engine.close();
+	std::map<boost::uint32_t, boost::weak_ptr<conn_ndgram_stream> > tmp;
+	tmp.swap(Stream);
+	for(std::map<boost::uint32_t, boost::weak_ptr<conn_ndgram_stream> >::iterator
+		it_cur = tmp.begin(), it_end = tmp.end(); it_cur != it_end; ++it_cur)
+	{
+		if(boost::shared_ptr<conn_ndgram_stream> CS = it_cur->second.lock()){
+			CS->set_error(connection_reset_error);
+			Conn_Container.remove(CS->info()->conn_ID);
+		}
+	}
+	Dispatcher.disconnect(disconnect_event(_info, error));
+}
+
+void net::nstream_proactor::conn_ndgram_stream_socket::add(
+	const boost::uint32_t stream_ID, const dir_t dir)
+{
+	boost::shared_ptr<conn_ndgram_stream> CS(new conn_ndgram_stream(Dispatcher,
+		Conn_Container, shared_from_this(), stream_ID, dir));
+	Stream.insert(std::make_pair(stream_ID, CS));
+	Conn_Container.add(CS);
+}
+
+void net::nstream_proactor::conn_ndgram_stream_socket::call_back(
+	ndgram_stream::event & E)
+{
+	if(E.type == ndgram_stream::accept_event){
+		add(E.ID, incoming_dir);
+		return;
+	}else if(E.type == ndgram_stream::write_event){
+		Conn_Container.monitor_write(socket_FD);
+		return;
+	}else if(E.type == ndgram_stream::error_event){
+		/*
+		Socket closed by a send from a timer or a stream. We're inside a call to
+		Engine so removal (which destroys Engine) is deferred to a timer.
+		*/
+		error = connection_reset_error;
+		Conn_Container.timers().arm(0, boost::bind(&conn_container::remove,
+			&Conn_Container, _info->conn_ID));
+		return;
+	}
+	std::map<boost::uint32_t, boost::weak_ptr<conn_ndgram_stream> >::iterator
+		it = Stream.find(E.ID);
+	if(it == Stream.end()){
+		return;
+	}
+	//hold reference, call back may remove connection
+	boost::shared_ptr<conn_ndgram_stream> CS = it->second.lock();
+	if(!CS){
+		Stream.erase(it);
+	}else if(E.type == ndgram_stream::connect_event){
+		CS->connected();
+	}else if(E.type == ndgram_stream::recv_event){
+		CS->recv(E.buf);
+	}else if(E.type == ndgram_stream::send_event){
+		CS->sent(E.n_bytes);
+	}else if(E.type == ndgram_stream::close_event){
+		Stream.erase(it);
+		CS->closed();
+	}
+}
+
+void net::nstream_proactor::conn_ndgram_stream_socket::close(
+	const boost::uint32_t stream_ID)
+{
+	Stream.erase(stream_ID);
+	Engine.close(stream_ID);
+}
+
+void net::nstream_proactor::conn_ndgram_stream_socket::connect(const endpoint & ep)
+{
+	add(Engine.connect(ep), outgoing_dir);
+}
+
+void net::nstream_proactor::conn_ndgram_stream_socket::check_open()
+{
+	if(!Engine.is_open()){
+		//dtor does disconnect for socket and all streams on it
+		error = connection_reset_error;
+		Conn_Container.remove(_info->conn_ID);
+	}
+}
+
+boost::optional<net::endpoint> net::nstream_proactor::conn_ndgram_stream_socket::ep()
+{
+	return Engine.local_ep();
+}
+
+boost::shared_ptr<const net::nstream_proactor::conn_info>
+	net::nstream_proactor::conn_ndgram_stream_socket::info()
+{
+	return _info;
+}
+
+void net::nstream_proactor::conn_ndgram_stream_socket::read()
+{
+	Engine.read();
+	check_open();
+}
+
+boost::optional<net::endpoint>
+	net::nstream_proactor::conn_ndgram_stream_socket::remote_ep(
+	const boost::uint32_t stream_ID)
+{
+	return Engine.remote_ep(stream_ID);
+}
+
+void net::nstream_proactor::conn_ndgram_stream_socket::send(
+	const boost::uint32_t stream_ID, buffer & buf)
+{
+	Engine.send(stream_ID, buf);
+}
+
+unsigned net::nstream_proactor::conn_ndgram_stream_socket::send_buf_size(
+	const boost::uint32_t stream_ID)
+{
+	return Engine.send_buf_size(stream_ID);
+}
+
+void net::nstream_proactor::conn_ndgram_stream_socket::set_error(
+	const error_t error_in)
+{
+	error = error_in;
+}
+
+int net::nstream_proactor::conn_ndgram_stream_socket::socket()
+{
+	return socket_FD;
+}
+
+void net::nstream_proactor::conn_ndgram_stream_socket::write()
+{
+	Engine.write();
+	if(!Engine.want_write()){
+		Conn_Container.unmonitor_write(socket_FD);
+	}
+	check_open();
+}
+//END conn_ndgram_stream_socket
+
+//BEGIN conn_ndgram_stream
+net::nstream_proactor::conn_ndgram_stream::conn_ndgram_stream(
+	dispatcher & Dispatcher_in,
+	conn_container & Conn_Container_in,
+	const boost::shared_ptr<conn_ndgram_stream_socket> & Socket_in,
+	const boost::uint32_t stream_ID_in,
+	const dir_t dir
+):
+	Dispatcher(Dispatcher_in),
+	Conn_Container(Conn_Container_in),
+	Socket(Socket_in),
+	stream_ID(stream_ID_in),
+	send_queue_size(0),
+	close_on_empty(false),
+	half_open(dir == outgoing_dir),
+	timeout(std::time(NULL) + (dir == outgoing_dir ? connect_timeout : idle_timeout)),
+	error(no_error)
+{
+	_info.reset(new conn_info(
+		Conn_Container.new_conn_ID(),
+		dir,
+		ndgram_stream_tran,
+		Socket_in->ep(),
+		Socket_in->remote_ep(stream_ID)
+	));
+	if(!half_open){
+		Dispatcher.connect(connect_event(_info));
+	}
+}
+
+net::nstream_proactor::conn_ndgram_stream::~conn_ndgram_stream()
+{
+	if(boost::shared_ptr<conn_ndgram_stream_socket> S = Socket.lock()){
+		S->close(stream_ID);
+	}
+	Dispatcher.disconnect(disconnect_event(_info, error));
+}
+
+void net::nstream_proactor::conn_ndgram_stream::closed()
+{
+	error = half_open ? connect_error : connection_reset_error;
+	Conn_Container.remove(_info->conn_ID);
+}
+
+void net::nstream_proactor::conn_ndgram_stream::connected()
+{
+	touch();
+	half_open = false;
+	Dispatcher.connect(connect_event(_info));
+	//sends may have been scheduled while connecting
+	feed();
+}
+
+void net::nstream_proactor::conn_ndgram_stream::feed()
+{
+	boost::shared_ptr<conn_ndgram_stream_socket> S = Socket.lock();
+	if(!S){
+		return;
+	}
+	while(!Send_Queue.empty() && S->send_buf_size(stream_ID) < send_buf_high){
+		send_segment & SS = Send_Queue.front();
+		buffer buf;
+		if(SS.FR){
+			//stream needs bytes in user space, no sendfile
+			file_range & FR = *SS.FR;
+			const unsigned n = FR.size < send_file_chunk ? FR.size : send_file_chunk;
+			buf.tail_reserve(n);
+			int n_read = ::pread(FR.file_FD, buf.tail_start(), n, FR.offset);
+			if(n_read <= 0){
+				//file range past end of file
+				if(n_read == -1){
+					LOG << strerror(errno);
+				}
+				error = connection_reset_error;
+				Conn_Container.remove(_info->conn_ID);
+				return;
+			}
+			buf.tail_resize(n_read);
+			FR.offset += n_read;
+			FR.size -= n_read;
+		}else if(SS.offset == 0){
+			//buffer was swapped in to queue, no need to copy
+			buf.swap(*SS.buf);
+		}else{
+			buf.append(SS.buf->data() + SS.offset, SS.buf->size() - SS.offset);
+			SS.offset = SS.buf->size();
+		}
+		send_queue_size -= buf.size();
+		if(SS.empty()){
+			Send_Queue.pop_front();
+		}
+		S->send(stream_ID, buf);
+	}
+	if(close_on_empty && Send_Queue.empty()){
+		//stream sends bytes in send buffer before close
+		Conn_Container.remove(_info->conn_ID);
+	}
+}
+
+boost::shared_ptr<const net::nstream_proactor::conn_info>
+	net::nstream_proactor::conn_ndgram_stream::info()
+{
+	return _info;
+}
+
+void net::nstream_proactor::conn_ndgram_stream::read()
+{
+	//no socket, bytes passed to recv() by conn_ndgram_stream_socket
+}
+
+void net::nstream_proactor::conn_ndgram_stream::recv(buffer & buf)
+{
+	touch();
+	Conn_Container.add_download(buf.size());
+	//stream coalesces everything read from socket, split at max_recv
+	while(!buf.empty()){
+		buffer tmp;
+		if(buf.size() > Conn_Container.max_recv()){
+			tmp.append(buf.data(), Conn_Container.max_recv());
+			buf.consume_front(Conn_Container.max_recv());
+		}else{
+			tmp.swap(buf);
+		}
+		Dispatcher.recv(boost::shared_ptr<const recv_event>(new recv_event(_info, tmp)));
+	}
+}
+
+void net::nstream_proactor::conn_ndgram_stream::schedule_send(
+	const boost::shared_ptr<buffer> & buf, const bool close_on_empty_in)
+{
+	if(close_on_empty_in){
+		close_on_empty = true;
+	}
+	if(!buf->empty()){
+		Send_Queue.push_back(send_segment(buf));
+		send_queue_size += buf->size();
+	}
+	if(half_open){
+		if(Send_Queue.empty() && close_on_empty){
+			Conn_Container.remove(_info->conn_ID);
+		}
+	}else{
+		feed();
+	}
+}
+
+void net::nstream_proactor::conn_ndgram_stream::schedule_send_file(
+	const file_range & FR, const bool close_on_empty_in)
+{
+	if(close_on_empty_in){
+		close_on_empty = true;
+	}
+	if(FR.size != 0){
+		Send_Queue.push_back(send_segment(FR));
+		send_queue_size += FR.size;
+	}
+	if(half_open){
+		if(Send_Queue.empty() && close_on_empty){
+			Conn_Container.remove(_info->conn_ID);
+		}
+	}else{
+		feed();
+	}
+}
+
+void net::nstream_proactor::conn_ndgram_stream::sent(const unsigned n_bytes)
+{
+	touch();
+	Conn_Container.add_upload(n_bytes);
+	feed();
+	if(!close_on_empty || !Send_Queue.empty()){
+		boost::shared_ptr<conn_ndgram_stream_socket> S = Socket.lock();
+		Dispatcher.send(send_event(_info, n_bytes, send_queue_size
+			+ (S ? S->send_buf_size(stream_ID) : 0)));
+	}
+}
+
+void net::nstream_proactor::conn_ndgram_stream::set_error(const error_t error_in)
+{
+	error = error_in;
+}
+
+int net::nstream_proactor::conn_ndgram_stream::socket()
+{
+	return -1;
+}
+
+int net::nstream_proactor::conn_ndgram_stream::timeout_ms()
+{
+	std::time_t now = std::time(NULL);
+	return now > timeout ? 0 : (timeout - now + 1) * 1000;
+}
+
+void net::nstream_proactor::conn_ndgram_stream::touch()
+{
+	timeout = std::time(NULL) + idle_timeout;
+}
+//END conn_ndgram_stream
+
 //BEGIN dispatcher
 net::nstream_proactor::dispatcher::dispatcher(
 	const boost::function<void (connect_event)> & connect_call_back_in,
 	const boost::function<void (disconnect_event)> & disconnect_call_back_in,
 	const boost::function<void (recv_event)> & recv_call_back_in,
-	const boost::function<void (send_event)> & send_call_back_in
+	const boost::function<void (send_event)> & send_call_back_in,
+	const unsigned shards
 ):
 	connect_call_back(connect_call_back_in),
 	disconnect_call_back(disconnect_call_back_in),
 	recv_call_back(recv_call_back_in),
-	send_call_back(send_call_back_in),
-	producer_cnt(1),
-	job_cnt(0)
+	send_call_back(send_call_back_in)
 {
-	for(unsigned x=0; x<threads; ++x){
-		workers.create_thread(boost::bind(&dispatcher::dispatch, this));
+	const unsigned shard_cnt = shards == 0 ? 1 : shards;
+	const unsigned shard_max_buf = max_buf / shard_cnt == 0 ? 1 : max_buf / shard_cnt;
+	for(unsigned x=0; x<shard_cnt; ++x){
+		Shard.push_back(boost::shared_ptr<shard>(new shard(shard_max_buf)));
 	}
 }
 
 net::nstream_proactor::dispatcher::~dispatcher()
 {
 	join();
-	workers.interrupt_all();
-	workers.join_all();
 }
 
 void net::nstream_proactor::dispatcher::connect(const connect_event & CE)
 {
-	boost::mutex::scoped_lock lock(mutex);
-	while(Job.size() >= max_buf){
-		consumer_cond.wait(mutex);
-	}
 	boost::function<void ()> func = boost::bind(connect_call_back, CE);
-	Job.push_back(std::make_pair(CE.info->conn_ID, func));
-	++producer_cnt;
-	++job_cnt;
-	producer_cond.notify_one();
+	get_shard(CE.info->conn_ID).enqueue(func);
 }
 
 void net::nstream_proactor::dispatcher::disconnect(const disconnect_event & DE)
 {
-	boost::mutex::scoped_lock lock(mutex);
-	while(Job.size() >= max_buf){
-		consumer_cond.wait(mutex);
-	}
 	boost::function<void ()> func = boost::bind(disconnect_call_back, DE);
-	Job.push_back(std::make_pair(DE.info->conn_ID, func));
-	++producer_cnt;
-	++job_cnt;
-	producer_cond.notify_one();
+	get_shard(DE.info->conn_ID).enqueue(func);
+}
+
+net::nstream_proactor::dispatcher::shard &
+	net::nstream_proactor::dispatcher::get_shard(const boost::uint64_t conn_ID)
+{
+	return *Shard[conn_ID % Shard.size()];
 }
 
 void net::nstream_proactor::dispatcher::join()
 {
-	boost::mutex::scoped_lock lock(mutex);
-	while(job_cnt > 0){
-		empty_cond.wait(mutex);
+	for(std::vector<boost::shared_ptr<shard> >::iterator it_cur = Shard.begin(),
+		it_end = Shard.end(); it_cur != it_end; ++it_cur)
+	{
+		(*it_cur)->join();
 	}
 }
 
-void net::nstream_proactor::dispatcher::recv(const recv_event & RE)
+void net::nstream_proactor::dispatcher::recv(
+	const boost::shared_ptr<const recv_event> & RE)
 {
-	boost::mutex::scoped_lock lock(mutex);
-	while(Job.size() >= max_buf){
-		consumer_cond.wait(mutex);
-	}
-	boost::function<void ()> func = boost::bind(recv_call_back, RE);
-	Job.push_back(std::make_pair(RE.info->conn_ID, func));
-	++producer_cnt;
-	++job_cnt;
-	producer_cond.notify_one();
+	boost::function<void ()> func = boost::bind(&dispatcher::recv_relay, this, RE);
+	get_shard(RE->info->conn_ID).enqueue(func);
+}
+
+void net::nstream_proactor::dispatcher::recv_relay(
+	const boost::shared_ptr<const recv_event> & RE)
+{
+	recv_call_back(*RE);
 }
 
 void net::nstream_proactor::dispatcher::send(const send_event & SE)
 {
-	boost::mutex::scoped_lock lock(mutex);
-	while(Job.size() >= max_buf){
-		consumer_cond.wait(mutex);
-	}
 	boost::function<void ()> func = boost::bind(send_call_back, SE);
-	Job.push_back(std::make_pair(SE.info->conn_ID, func));
-	++producer_cnt;
-	++job_cnt;
-	producer_cond.notify_one();
+	get_shard(SE.info->conn_ID).enqueue(func);
+}
+
+net::nstream_proactor::dispatcher::shard::shard(const unsigned max_buf_in):
+	max_buf(max_buf_in),
+	job_cnt(0)
+{
+	worker = boost::thread(boost::bind(&shard::dispatch, this));
+}
+
+net::nstream_proactor::dispatcher::shard::~shard()
+{
+	join();
+	worker.interrupt();
+	worker.join();
 }
 
-void net::nstream_proactor::dispatcher::dispatch()
+void net::nstream_proactor::dispatcher::shard::dispatch()
 {
-	//when no job to run we wait until producer_cnt greater than this
-	boost::uint64_t wait_until = 0;
 	while(true){
-		std::pair<boost::uint64_t, boost::function<void ()> > p;
+		boost::function<void ()> func;
 		{//BEGIN lock scope
 		boost::mutex::scoped_lock lock(mutex);
-		while(Job.empty() || wait_until > producer_cnt){
+		while(Job.empty()){
 			producer_cond.wait(mutex);
 		}
-		for(std::list<std::pair<boost::uint64_t, boost::function<void ()> > >::iterator
-			it_cur = Job.begin(), it_end = Job.end(); it_cur != it_end; ++it_cur)
-		{
-			if(memoize.insert(it_cur->first).second){
-				p = *it_cur;
-				Job.erase(it_cur);
-				break;
-			}
-		}
-		if(!p.second){
-			//no job we can currently run, wait until a job added to check again
-			wait_until = producer_cnt + 1;
-			continue;
-		}
+		func.swap(Job.front());
+		Job.pop_front();
 		}//END lock scope
-		p.second();
+		consumer_cond.notify_one();
+		func();
 		{//BEGIN lock scope
 		boost::mutex::scoped_lock lock(mutex);
-		memoize.erase(p.first);
 		--job_cnt;
 		if(job_cnt == 0){
 			empty_cond.notify_all();
 		}
 		}//END lock scope
-		consumer_cond.notify_one();
+	}
+}
+
+void net::nstream_proactor::dispatcher::shard::enqueue(boost::function<void ()> & func)
+{
+	boost::mutex::scoped_lock lock(mutex);
+	while(Job.size() >= max_buf){
+		consumer_cond.wait(mutex);
+	}
+	Job.push_back(boost::function<void ()>());
+	Job.back().swap(func);
+	++job_cnt;
+	producer_cond.notify_one();
+}
+
+void net::nstream_proactor::dispatcher::shard::join()
+{
+	boost::mutex::scoped_lock lock(mutex);
+	while(job_cnt > 0){
+		empty_cond.wait(mutex);
 	}
 }
 //END dispatcher
@@ -541,27 +1345,60 @@ net::nstream_proactor::nstream_proactor(
 	const boost::function<void (connect_event)> & connect_call_back_in,
 	const boost::function<void (disconnect_event)> & disconnect_call_back_in,
 	const boost::function<void (recv_event)> & recv_call_back_in,
-	const boost::function<void (send_event)> & send_call_back_in
+	const boost::function<void (send_event)> & send_call_back_in,
+	const select::backend_t backend,
+	const unsigned dispatch_shards,
+	const unsigned max_recv
 ):
+	Select(backend),
 	Dispatcher(
 		connect_call_back_in,
 		disconnect_call_back_in,
 		recv_call_back_in,
-		send_call_back_in
+		send_call_back_in,
+		dispatch_shards
 	),
+	Conn_Container(Select, max_recv),
 	Internal_TP(1, 1024)
 {
 	Internal_TP.enqueue(boost::bind(&nstream_proactor::main_loop, this));
 }
 
-void net::nstream_proactor::connect(const endpoint & ep)
+net::nstream_proactor::~nstream_proactor()
 {
-	Internal_TP.enqueue(boost::bind(&nstream_proactor::connect_relay, this, ep));
+	//main_loop won't be enqueued again once stopped
+	Internal_TP.stop();
 	Select.interrupt();
+	Internal_TP.join();
 }
 
-void net::nstream_proactor::connect_relay(const endpoint & ep)
+void net::nstream_proactor::connect(const endpoint & ep, const tran_t tran)
 {
+	Internal_TP.enqueue(boost::bind(&nstream_proactor::connect_relay, this, ep,
+		tran));
+	Select.interrupt();
+}
+
+void net::nstream_proactor::connect_relay(const endpoint & ep, const tran_t tran)
+{
+	if(tran == ndgram_stream_tran){
+		boost::shared_ptr<conn_ndgram_stream_socket> S = ndgram_stream_socket(
+			ep.version());
+		if(S){
+			S->connect(ep);
+		}else{
+			//no socket to open stream on, connect failed
+			boost::shared_ptr<const conn_info> info(new conn_info(
+				Conn_Container.new_conn_ID(),
+				outgoing_dir,
+				ndgram_stream_tran,
+				boost::optional<endpoint>(),
+				ep
+			));
+			Dispatcher.disconnect(disconnect_event(info, connect_error));
+		}
+		return;
+	}
 	boost::shared_ptr<conn_nstream> CL(new conn_nstream(Dispatcher,
 		Conn_Container, ep));
 	if(CL->socket() != -1){
@@ -569,6 +1406,11 @@ void net::nstream_proactor::connect_relay(const endpoint & ep)
 	}
 }
 
+unsigned net::nstream_proactor::download_rate()
+{
+	return Conn_Container.download_rate();
+}
+
 void net::nstream_proactor::disconnect(const boost::uint64_t conn_ID)
 {
 	Internal_TP.enqueue(boost::bind(&nstream_proactor::disconnect_relay, this, conn_ID));
@@ -581,17 +1423,29 @@ void net::nstream_proactor::disconnect_relay(const boost::uint64_t conn_ID)
 }
 
 channel::future<boost::optional<net::endpoint> > net::nstream_proactor::listen(
-	const endpoint & ep)
+	const endpoint & ep, const tran_t tran)
 {
 	channel::promise<boost::optional<net::endpoint> > promise;
-	Internal_TP.enqueue(boost::bind(&nstream_proactor::listen_relay, this, ep, promise));
+	Internal_TP.enqueue(boost::bind(&nstream_proactor::listen_relay, this, ep,
+		tran, promise));
 	Select.interrupt();
 	return promise.get_future();
 }
 
-void net::nstream_proactor::listen_relay(const endpoint ep,
+void net::nstream_proactor::listen_relay(const endpoint ep, const tran_t tran,
 	channel::promise<boost::optional<net::endpoint> > promise)
 {
+	if(tran == ndgram_stream_tran){
+		boost::shared_ptr<conn_ndgram_stream_socket> S(new conn_ndgram_stream_socket(
+			Dispatcher, Conn_Container, ep));
+		if(S->socket() != -1){
+			Conn_Container.add(S);
+			//outgoing streams use listening socket so remote hosts can reply
+			Ndgram_Stream_Socket[ep.version()] = S;
+		}
+		promise = S->ep();
+		return;
+	}
 	boost::shared_ptr<conn_listener> CL(new conn_listener(Dispatcher,
 		Conn_Container, ep));
 	if(CL->socket() != -1){
@@ -602,25 +1456,107 @@ void net::nstream_proactor::listen_relay(const endpoint ep,
 
 void net::nstream_proactor::main_loop()
 {
-	std::set<int> read_set = Conn_Container.read_set();
-	std::set<int> write_set = Conn_Container.write_set();
-	Select(read_set, write_set, 1000);
+	std::set<int> read_set, write_set;
+	Select.wait(read_set, write_set, Conn_Container.timer_ms());
+	Conn_Container.expire_timers();
 	Conn_Container.perform_reads(read_set);
 	Conn_Container.perform_writes(write_set);
-	Conn_Container.check_timeouts();
 	Internal_TP.enqueue(boost::bind(&nstream_proactor::main_loop, this));
 }
 
+boost::shared_ptr<net::nstream_proactor::conn_ndgram_stream_socket>
+	net::nstream_proactor::ndgram_stream_socket(const version_t version)
+{
+	std::map<version_t, boost::weak_ptr<conn_ndgram_stream_socket> >::iterator
+		it = Ndgram_Stream_Socket.find(version);
+	if(it != Ndgram_Stream_Socket.end()){
+		if(boost::shared_ptr<conn_ndgram_stream_socket> S = it->second.lock()){
+			return S;
+		}
+	}
+	std::set<endpoint> E = get_endpoint(version == IPv4 ? "0.0.0.0" : "::", "0");
+	if(E.empty()){
+		return boost::shared_ptr<conn_ndgram_stream_socket>();
+	}
+	boost::shared_ptr<conn_ndgram_stream_socket> S(new conn_ndgram_stream_socket(
+		Dispatcher, Conn_Container, *E.begin()));
+	if(S->socket() == -1){
+		return boost::shared_ptr<conn_ndgram_stream_socket>();
+	}
+	Conn_Container.add(S);
+	Ndgram_Stream_Socket[version] = S;
+	return S;
+}
+
 void net::nstream_proactor::send(const boost::uint64_t conn_ID,
-	const buffer & buf, const bool close_on_empty)
+	buffer & buf, const bool close_on_empty)
 {
+	boost::shared_ptr<buffer> B(new buffer());
+	B->swap(buf);
 	Internal_TP.enqueue(boost::bind(&nstream_proactor::send_relay, this, conn_ID,
-		buf, close_on_empty));
+		B, close_on_empty));
 	Select.interrupt();
 }
 
 void net::nstream_proactor::send_relay(const boost::uint64_t conn_ID,
-	const buffer buf, const bool close_on_empty)
+	const boost::shared_ptr<buffer> buf, const bool close_on_empty)
 {
 	Conn_Container.schedule_send(conn_ID, buf, close_on_empty);
 }
+
+void net::nstream_proactor::send_file(const boost::uint64_t conn_ID,
+	const file_range & FR, const bool close_on_empty)
+{
+	Internal_TP.enqueue(boost::bind(&nstream_proactor::send_file_relay, this,
+		conn_ID, FR, close_on_empty));
+	Select.interrupt();
+}
+
+void net::nstream_proactor::send_file_relay(const boost::uint64_t conn_ID,
+	const file_range FR, const bool close_on_empty)
+{
+	Conn_Container.schedule_send_file(conn_ID, FR, close_on_empty);
+}
+
+void net::nstream_proactor::set_max_connection_rate(const boost::uint64_t conn_ID,
+	const unsigned download, const unsigned upload)
+{
+	Internal_TP.enqueue(boost::bind(&nstream_proactor::set_max_connection_rate_relay,
+		this, conn_ID, download, upload));
+	Select.interrupt();
+}
+
+void net::nstream_proactor::set_max_connection_rate_relay(
+	const boost::uint64_t conn_ID, const unsigned download, const unsigned upload)
+{
+	Conn_Container.set_max_connection_rate(conn_ID, download, upload);
+}
+
+void net::nstream_proactor::set_max_download_rate(const unsigned rate)
+{
+	Internal_TP.enqueue(boost::bind(&nstream_proactor::set_max_download_rate_relay,
+		this, rate));
+	Select.interrupt();
+}
+
+void net::nstream_proactor::set_max_download_rate_relay(const unsigned rate)
+{
+	Conn_Container.set_max_download_rate(rate);
+}
+
+void net::nstream_proactor::set_max_upload_rate(const unsigned rate)
+{
+	Internal_TP.enqueue(boost::bind(&nstream_proactor::set_max_upload_rate_relay,
+		this, rate));
+	Select.interrupt();
+}
+
+void net::nstream_proactor::set_max_upload_rate_relay(const unsigned rate)
+{
+	Conn_Container.set_max_upload_rate(rate);
+}
+
+unsigned net::nstream_proactor::upload_rate()
+{
+	return Conn_Container.upload_rate();
+}
@@ -1,6 +1,407 @@
 #include <net/select.hpp>
 
-net::select::select()
+#ifdef HAVE_LIBURING
+#include <liburing.h>
+#include <poll.h>
+#endif
+
+namespace{
+
+//BEGIN select_impl
+//portable backend, rebuilds nothing per call but limited to FD_SETSIZE
+class select_impl : public net::select::backend
+{
+public:
+	explicit select_impl(const int interrupt_FD)
+	{
+		FD_ZERO(&read_FDS);
+		FD_ZERO(&write_FDS);
+		set_interest(interrupt_FD, 0, read_flag);
+	}
+
+	virtual void set_interest(const int socket_FD, const int old_mask,
+		const int new_mask)
+	{
+		if(socket_FD >= FD_SETSIZE){
+			LOG << "socket " << socket_FD << " exceeds FD_SETSIZE";
+			return;
+		}
+		if(new_mask & read_flag){
+			FD_SET(socket_FD, &read_FDS);
+		}else{
+			FD_CLR(socket_FD, &read_FDS);
+		}
+		if(new_mask & write_flag){
+			FD_SET(socket_FD, &write_FDS);
+		}else{
+			FD_CLR(socket_FD, &write_FDS);
+		}
+		if(new_mask == 0){
+			Sockets.erase(socket_FD);
+		}else{
+			Sockets.insert(socket_FD);
+		}
+	}
+
+	virtual void wait(std::set<int> & read, std::set<int> & write,
+		const int timeout_ms)
+	{
+		read.clear();
+		write.clear();
+		if(Sockets.empty()){
+			return;
+		}
+		int end_FD = *Sockets.rbegin() + 1;
+		fd_set tmp_read_FDS = read_FDS, tmp_write_FDS = write_FDS;
+		timeval tv;
+		if(timeout_ms >= 0){
+			tv.tv_sec = timeout_ms / 1000;
+			tv.tv_usec = (timeout_ms % 1000) * 1000;
+		}
+		int service = ::select(end_FD, &tmp_read_FDS, &tmp_write_FDS, NULL,
+			timeout_ms < 0 ? NULL : &tv);
+		if(service == -1){
+			//ignore interrupt signal, profilers can cause this
+			if(errno != EINTR){
+				LOG << strerror(errno);
+				exit(1);
+			}
+		}else if(service > 0){
+			for(std::set<int>::iterator it_cur = Sockets.begin(),
+				it_end = Sockets.end(); it_cur != it_end; ++it_cur)
+			{
+				if(FD_ISSET(*it_cur, &tmp_read_FDS)){
+					read.insert(*it_cur);
+				}
+				if(FD_ISSET(*it_cur, &tmp_write_FDS)){
+					write.insert(*it_cur);
+				}
+			}
+		}
+	}
+
+private:
+	fd_set read_FDS;
+	fd_set write_FDS;
+	std::set<int> Sockets; //all monitored sockets, last element used for end_FD
+};
+//END select_impl
+
+#ifdef __linux__
+//BEGIN epoll_impl
+class epoll_impl : public net::select::backend
+{
+	static const int max_events = 1024;
+public:
+	explicit epoll_impl(const int interrupt_FD):
+		epoll_FD(epoll_create1(EPOLL_CLOEXEC)),
+		Events(max_events)
+	{
+		if(epoll_FD == -1){
+			LOG << strerror(errno);
+			exit(1);
+		}
+		//level-triggered so interrupt bytes can be read in more than one go
+		epoll_event ev;
+		std::memset(&ev, 0, sizeof(ev));
+		ev.events = EPOLLIN;
+		ev.data.fd = interrupt_FD;
+		if(epoll_ctl(epoll_FD, EPOLL_CTL_ADD, interrupt_FD, &ev) == -1){
+			LOG << strerror(errno);
+			exit(1);
+		}
+	}
+
+	virtual ~epoll_impl()
+	{
+		::close(epoll_FD);
+	}
+
+	virtual bool edge_triggered() const
+	{
+		return true;
+	}
+
+	virtual void set_interest(const int socket_FD, const int old_mask,
+		const int new_mask)
+	{
+		epoll_event ev;
+		std::memset(&ev, 0, sizeof(ev));
+		ev.events = EPOLLET
+			| (new_mask & read_flag ? EPOLLIN | EPOLLRDHUP : 0)
+			| (new_mask & write_flag ? EPOLLOUT : 0);
+		ev.data.fd = socket_FD;
+		/*
+		EPOLL_CTL_MOD re-checks readiness. This is what we want when write
+		interest is added to a socket that is already writeable.
+		*/
+		int op = old_mask == 0 ? EPOLL_CTL_ADD :
+			new_mask == 0 ? EPOLL_CTL_DEL : EPOLL_CTL_MOD;
+		if(epoll_ctl(epoll_FD, op, socket_FD, &ev) == -1){
+			//socket may already be closed, it is removed from epoll on close
+			if(op != EPOLL_CTL_DEL){
+				LOG << strerror(errno);
+			}
+		}
+	}
+
+	virtual void wait(std::set<int> & read, std::set<int> & write,
+		const int timeout_ms)
+	{
+		read.clear();
+		write.clear();
+		int n_events = epoll_wait(epoll_FD, &Events[0], Events.size(),
+			timeout_ms);
+		if(n_events == -1){
+			//ignore interrupt signal, profilers can cause this
+			if(errno != EINTR){
+				LOG << strerror(errno);
+				exit(1);
+			}
+			return;
+		}
+		for(int x=0; x<n_events; ++x){
+			/*
+			Errors and hangups are reported as readable (and writeable if
+			connecting) so the connection notices the failure on the next
+			recv/send.
+			*/
+			boost::uint32_t events = Events[x].events;
+			if(events & (EPOLLIN | EPOLLRDHUP | EPOLLERR | EPOLLHUP)){
+				read.insert(Events[x].data.fd);
+			}
+			if(events & (EPOLLOUT | EPOLLERR | EPOLLHUP)){
+				write.insert(Events[x].data.fd);
+			}
+		}
+	}
+
+private:
+	const int epoll_FD;
+	std::vector<epoll_event> Events;
+};
+//END epoll_impl
+#endif
+
+#ifdef HAVE_LIBURING
+//BEGIN uring_impl
+/*
+Uses one-shot IORING_OP_POLL_ADD. Each completed poll is re-armed on the
+following wait() so the caller has a chance to service the socket first. Each
+armed poll is identified by a token so completions for polls that were
+cancelled can be ignored.
+*/
+class uring_impl : public net::select::backend
+{
+	static const unsigned queue_depth = 4096;
+public:
+	explicit uring_impl(const int interrupt_FD):
+		latest_token(0),
+		initialized(false)
+	{
+		int ret = io_uring_queue_init(queue_depth, &ring, 0);
+		if(ret < 0){
+			LOG << "io_uring unavailable: " << strerror(-ret);
+			return;
+		}
+		initialized = true;
+		set_interest(interrupt_FD, 0, read_flag);
+	}
+
+	virtual ~uring_impl()
+	{
+		if(initialized){
+			io_uring_queue_exit(&ring);
+		}
+	}
+
+	//returns false if io_uring could not be setup (kernel too old, seccomp)
+	bool is_open() const
+	{
+		return initialized;
+	}
+
+	virtual void set_interest(const int socket_FD, const int old_mask,
+		const int new_mask)
+	{
+		std::map<int, state>::iterator it = Socket.find(socket_FD);
+		if(it != Socket.end()){
+			if(it->second.token != 0){
+				cancel(it->second.token);
+			}
+			if(new_mask == 0){
+				Socket.erase(it);
+				return;
+			}
+		}else if(new_mask == 0){
+			return;
+		}else{
+			it = Socket.insert(std::make_pair(socket_FD, state())).first;
+		}
+		it->second.mask = new_mask;
+		arm(socket_FD, it->second);
+	}
+
+	virtual void wait(std::set<int> & read, std::set<int> & write,
+		const int timeout_ms)
+	{
+		read.clear();
+		write.clear();
+
+		//re-arm polls that completed during last wait
+		for(std::set<int>::iterator it_cur = Rearm.begin(), it_end = Rearm.end();
+			it_cur != it_end; ++it_cur)
+		{
+			std::map<int, state>::iterator it = Socket.find(*it_cur);
+			if(it != Socket.end() && it->second.token == 0){
+				arm(*it_cur, it->second);
+			}
+		}
+		Rearm.clear();
+		io_uring_submit(&ring);
+
+		io_uring_cqe * cqe;
+		int ret;
+		if(timeout_ms < 0){
+			ret = io_uring_wait_cqe(&ring, &cqe);
+		}else{
+			__kernel_timespec ts;
+			ts.tv_sec = timeout_ms / 1000;
+			ts.tv_nsec = (timeout_ms % 1000) * 1000000;
+			ret = io_uring_wait_cqe_timeout(&ring, &cqe, &ts);
+		}
+		if(ret < 0){
+			if(ret != -ETIME && ret != -EINTR){
+				LOG << strerror(-ret);
+				exit(1);
+			}
+			return;
+		}
+		while(io_uring_peek_cqe(&ring, &cqe) == 0){
+			complete(cqe->user_data, cqe->res, read, write);
+			io_uring_cqe_seen(&ring, cqe);
+		}
+	}
+
+private:
+	class state
+	{
+	public:
+		state(): mask(0), token(0) {}
+		int mask;              //read_flag/write_flag bits
+		boost::uint64_t token; //token of armed poll, 0 if not armed
+	};
+
+	io_uring ring;
+	boost::uint64_t latest_token;
+	bool initialized;
+	std::map<int, state> Socket;            //socket_FD mapped to poll state
+	std::map<boost::uint64_t, int> Token;   //token mapped to socket_FD
+	std::set<int> Rearm;                    //sockets to re-arm on next wait
+
+	//submit poll for socket
+	void arm(const int socket_FD, state & S)
+	{
+		io_uring_sqe * sqe = get_sqe();
+		io_uring_prep_poll_add(sqe, socket_FD,
+			(S.mask & read_flag ? POLLIN : 0) | (S.mask & write_flag ? POLLOUT : 0));
+		S.token = ++latest_token;
+		sqe->user_data = S.token;
+		Token.insert(std::make_pair(S.token, socket_FD));
+	}
+
+	//cancel armed poll
+	void cancel(const boost::uint64_t token)
+	{
+		Token.erase(token);
+		io_uring_sqe * sqe = get_sqe();
+		io_uring_prep_rw(IORING_OP_POLL_REMOVE, sqe, -1, NULL, 0, 0);
+		sqe->addr = token;
+		sqe->user_data = 0;
+	}
+
+	//process completion
+	void complete(const boost::uint64_t token, const int res,
+		std::set<int> & read, std::set<int> & write)
+	{
+		std::map<boost::uint64_t, int>::iterator it = Token.find(token);
+		if(it == Token.end()){
+			//poll_remove completion, or poll that was cancelled
+			return;
+		}
+		int socket_FD = it->second;
+		Token.erase(it);
+		std::map<int, state>::iterator it_state = Socket.find(socket_FD);
+		assert(it_state != Socket.end());
+		it_state->second.token = 0;
+		Rearm.insert(socket_FD);
+		if(res < 0){
+			read.insert(socket_FD);
+			write.insert(socket_FD);
+			return;
+		}
+		if(res & (POLLIN | POLLERR | POLLHUP)){
+			read.insert(socket_FD);
+		}
+		if(res & (POLLOUT | POLLERR | POLLHUP)){
+			write.insert(socket_FD);
+		}
+	}
+
+	//get submission queue entry, submitting pending entries if queue full
+	io_uring_sqe * get_sqe()
+	{
+		io_uring_sqe * sqe;
+		while((sqe = io_uring_get_sqe(&ring)) == NULL){
+			io_uring_submit(&ring);
+		}
+		return sqe;
+	}
+};
+//END uring_impl
+#endif
+
+net::select::backend * make_backend(net::select::backend_t type,
+	const int interrupt_FD)
+{
+	#ifdef __linux__
+	if(type == net::select::default_backend){
+		type = net::select::epoll_backend;
+	}
+	#ifdef HAVE_LIBURING
+	if(type == net::select::io_uring_backend){
+		uring_impl * U = new uring_impl(interrupt_FD);
+		if(U->is_open()){
+			return U;
+		}
+		delete U;
+		LOG << "falling back to epoll";
+	}
+	#endif
+	if(type == net::select::epoll_backend
+		|| type == net::select::io_uring_backend)
+	{
+		return new epoll_impl(interrupt_FD);
+	}
+	#endif
+	return new select_impl(interrupt_FD);
+}
+
+}//end of unnamed namespace
+
+//BEGIN backend
+net::select::backend::~backend()
+{
+
+}
+
+bool net::select::backend::edge_triggered() const
+{
+	return false;
+}
+//END backend
+
+net::select::select(const backend_t type)
 {
 	net::init::start();
 	/*
@@ -23,19 +424,96 @@ net::select::select()
 	//accept write_only connection
 	sp_write = L.accept();
 	assert(sp_write);
+
+	Backend.reset(make_backend(type, sp_read->socket()));
 }
 
 net::select::~select()
 {
+	Backend.reset();
 	net::init::stop();
 }
 
+void net::select::drain_interrupt()
+{
+	net::buffer buf;
+	sp_read->recv(buf);
+}
+
+bool net::select::edge_triggered() const
+{
+	return Backend->edge_triggered();
+}
+
 void net::select::interrupt()
 {
 	buffer B("0");
 	sp_write->send(B);
 }
 
+void net::select::monitor_read(const int socket_FD)
+{
+	std::map<int, int>::iterator it = Interest.find(socket_FD);
+	update_interest(socket_FD, (it == Interest.end() ? 0 : it->second)
+		| backend::read_flag);
+}
+
+void net::select::monitor_write(const int socket_FD)
+{
+	std::map<int, int>::iterator it = Interest.find(socket_FD);
+	update_interest(socket_FD, (it == Interest.end() ? 0 : it->second)
+		| backend::write_flag);
+}
+
+void net::select::remove(const int socket_FD)
+{
+	update_interest(socket_FD, 0);
+}
+
+void net::select::unmonitor_read(const int socket_FD)
+{
+	std::map<int, int>::iterator it = Interest.find(socket_FD);
+	if(it != Interest.end()){
+		update_interest(socket_FD, it->second & ~backend::read_flag);
+	}
+}
+
+void net::select::unmonitor_write(const int socket_FD)
+{
+	std::map<int, int>::iterator it = Interest.find(socket_FD);
+	if(it != Interest.end()){
+		update_interest(socket_FD, it->second & ~backend::write_flag);
+	}
+}
+
+void net::select::update_interest(const int socket_FD, const int mask)
+{
+	assert(socket_FD != sp_read->socket());
+	std::map<int, int>::iterator it = Interest.find(socket_FD);
+	int old_mask = (it == Interest.end() ? 0 : it->second);
+	if(old_mask == mask){
+		return;
+	}
+	if(mask == 0){
+		Interest.erase(it);
+	}else if(it == Interest.end()){
+		Interest.insert(std::make_pair(socket_FD, mask));
+	}else{
+		it->second = mask;
+	}
+	Backend->set_interest(socket_FD, old_mask, mask);
+}
+
+void net::select::wait(std::set<int> & read, std::set<int> & write,
+	int timeout_ms)
+{
+	assert(sp_read->is_open());
+	Backend->wait(read, write, timeout_ms);
+	if(read.erase(sp_read->socket()) == 1){
+		drain_interrupt();
+	}
+}
+
 void net::select::operator () (std::set<int> & read, std::set<int> & write,
 	int timeout_ms)
 {
@@ -56,12 +534,12 @@ void net::select::operator () (std::set<int> & read, std::set<int> & write,
 	fd_set read_FDS, write_FDS;
 	FD_ZERO(&read_FDS);
 	FD_ZERO(&write_FDS);
-	for(std::set<int>::iterator it_cur = read.begin(), it_end = read.end();	
+	for(std::set<int>::iterator it_cur = read.begin(), it_end = read.end();
 		it_cur != it_end; ++it_cur)
 	{
 		FD_SET(*it_cur, &read_FDS);
 	}
-	for(std::set<int>::iterator it_cur = write.begin(), it_end = write.end();	
+	for(std::set<int>::iterator it_cur = write.begin(), it_end = write.end();
 		it_cur != it_end; ++it_cur)
 	{
 		FD_SET(*it_cur, &write_FDS);
@@ -93,11 +571,10 @@ void net::select::operator () (std::set<int> & read, std::set<int> & write,
 	}else{
 		read.erase(sp_read->socket());
 		if(FD_ISSET(sp_read->socket(), &read_FDS)){
-			net::buffer buf;
-			sp_read->recv(buf);
+			drain_interrupt();
 		}
 		//remove sockets that don't need attention
-		for(std::set<int>::iterator it_cur = read.begin(), it_end = read.end();	
+		for(std::set<int>::iterator it_cur = read.begin(), it_end = read.end();
 			it_cur != it_end;)
 		{
 			if(!FD_ISSET(*it_cur, &read_FDS)){
@@ -106,7 +583,7 @@ void net::select::operator () (std::set<int> & read, std::set<int> & write,
 				++it_cur;
 			}
 		}
-		for(std::set<int>::iterator it_cur = write.begin(), it_end = write.end();	
+		for(std::set<int>::iterator it_cur = write.begin(), it_end = write.end();
 			it_cur != it_end;)
 		{
 			if(!FD_ISSET(*it_cur, &write_FDS)){
@@ -0,0 +1,77 @@
+#include <net/token_bucket.hpp>
+
+net::token_bucket::token_bucket(const unsigned rate_in):
+	_rate(rate_in),
+	last_refill(boost::posix_time::microsec_clock::universal_time())
+{
+	tokens = capacity();
+}
+
+unsigned net::token_bucket::available()
+{
+	if(_rate == 0){
+		return std::numeric_limits<unsigned>::max();
+	}
+	refill();
+	return tokens > 0 ? tokens : 0;
+}
+
+boost::int64_t net::token_bucket::capacity() const
+{
+	boost::int64_t cap = static_cast<boost::int64_t>(_rate) * burst_ms / 1000;
+	return cap == 0 ? 1 : cap;
+}
+
+void net::token_bucket::consume(const unsigned n_bytes)
+{
+	if(_rate != 0){
+		tokens -= n_bytes;
+	}
+}
+
+unsigned net::token_bucket::rate() const
+{
+	return _rate;
+}
+
+void net::token_bucket::refill()
+{
+	boost::posix_time::ptime now = boost::posix_time::microsec_clock::universal_time();
+	if(now < last_refill){
+		//clock went backwards
+		last_refill = now;
+		return;
+	}
+	boost::int64_t add = static_cast<boost::int64_t>(_rate)
+		* (now - last_refill).total_microseconds() / 1000000;
+	if(add > 0){
+		//only move last_refill when tokens added so short intervals aren't lost
+		last_refill = now;
+		tokens += add;
+		if(tokens > capacity()){
+			tokens = capacity();
+		}
+	}
+}
+
+void net::token_bucket::set_rate(const unsigned rate_in)
+{
+	refill();
+	_rate = rate_in;
+	if(tokens > capacity()){
+		tokens = capacity();
+	}
+}
+
+unsigned net::token_bucket::wait_ms()
+{
+	if(_rate == 0){
+		return 0;
+	}
+	refill();
+	if(tokens > 0){
+		return 0;
+	}
+	//round up
+	return ((1 - tokens) * 1000 + _rate - 1) / _rate;
+}
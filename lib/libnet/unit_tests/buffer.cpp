@@ -131,6 +131,67 @@ int main()
 	}
 	}
 
+	{//swap inline with heap
+	std::string large(1024, 'X');
+	net::buffer B0("123"), B1(large);
+	B0.swap(B1);
+	if(B0 != large){
+		LOG; ++fail;
+	}
+	if(B1 != "123"){
+		LOG; ++fail;
+	}
+	}
+
+	{//consume_front
+	net::buffer B("ABCDEF");
+	B.consume_front(2);
+	if(B != "CDEF"){
+		LOG; ++fail;
+	}
+	B.append('G');
+	if(B != "CDEFG"){
+		LOG; ++fail;
+	}
+	B.erase(0, 1);
+	if(B != "DEFG"){
+		LOG; ++fail;
+	}
+	B.consume_front(4);
+	if(!B.empty()){
+		LOG; ++fail;
+	}
+	}
+
+	{//append many chars, append self
+	net::buffer B;
+	std::string expected;
+	for(unsigned x=0; x<100000; ++x){
+		B.append(static_cast<unsigned char>(x));
+		expected += static_cast<char>(x);
+		if(x % 1000 == 0){
+			B.consume_front(1);
+			expected.erase(0, 1);
+		}
+	}
+	if(B != expected){
+		LOG; ++fail;
+	}
+	B.append(B);
+	if(B != expected + expected){
+		LOG; ++fail;
+	}
+	}
+
+	{//copy
+	net::buffer B0(std::string(1024, 'X'));
+	net::buffer B1(B0);
+	B0.clear();
+	if(B1 != std::string(1024, 'X')){
+		LOG; ++fail;
+	}
+	}
+
 	{//tail reserve
 	net::buffer B;
 	B.append('A');
@@ -0,0 +1,126 @@
+//include
+#include <net/net.hpp>
+#include <unit_test.hpp>
+
+int fail(0);
+
+//allocate and free many blocks from one thread
+void churn()
+{
+	for(unsigned x=0; x<1000; ++x){
+		unsigned size = 1000;
+		unsigned char * buf = net::buffer_pool::allocate(size);
+		buf[size - 1] = 0;
+		net::buffer_pool::deallocate(buf, size);
+	}
+}
+
+//free blocks allocated by another thread
+void free_blocks(std::vector<unsigned char *> & blocks, const unsigned size)
+{
+	for(std::vector<unsigned char *>::iterator it_cur = blocks.begin(),
+		it_end = blocks.end(); it_cur != it_end; ++it_cur)
+	{
+		net::buffer_pool::deallocate(*it_cur, size);
+	}
+	blocks.clear();
+}
+
+int main()
+{
+	unit_test::timeout();
+
+	{//size rounding
+	unsigned size = 1;
+	unsigned char * buf = net::buffer_pool::allocate(size);
+	if(size != net::buffer_pool::min_size){
+		LOG; ++fail;
+	}
+	net::buffer_pool::deallocate(buf, size);
+	size = net::buffer_pool::min_size + 1;
+	buf = net::buffer_pool::allocate(size);
+	if(size != net::buffer_pool::min_size * 2){
+		LOG; ++fail;
+	}
+	net::buffer_pool::deallocate(buf, size);
+	size = net::buffer_pool::max_size + 1;
+	buf = net::buffer_pool::allocate(size);
+	if(size != net::buffer_pool::max_size + 1){
+		LOG; ++fail;
+	}
+	net::buffer_pool::deallocate(buf, size);
+	}
+
+	{//freed block reused
+	unsigned size = 4096;
+	unsigned char * buf_0 = net::buffer_pool::allocate(size);
+	net::buffer_pool::deallocate(buf_0, size);
+	unsigned char * buf_1 = net::buffer_pool::allocate(size);
+	if(buf_0 != buf_1){
+		LOG; ++fail;
+	}
+	net::buffer_pool::deallocate(buf_1, size);
+	}
+
+	{//stats, include threads that exited
+	boost::thread_group TG;
+	for(unsigned x=0; x<4; ++x){
+		TG.create_thread(&churn);
+	}
+	TG.join_all();
+	std::vector<net::buffer_pool::class_stats> S = net::buffer_pool::stats();
+	if(S.size() != net::buffer_pool::classes){
+		LOG; ++fail;
+	}
+	//1000 bytes is in the 1024 byte class
+	net::buffer_pool::class_stats & CS = S[4];
+	if(CS.size != 1024){
+		LOG; ++fail;
+	}
+	//threads may reuse blocks left in central list by threads that exited
+	if(CS.hits < 4 * 999 || CS.misses == 0){
+		LOG; ++fail;
+	}
+	if(CS.high_water != 1){
+		LOG; ++fail;
+	}
+	}
+
+	{//blocks freed by another thread come back through central list
+	const unsigned cnt = 2 * net::buffer_pool::max_class_bytes / 2048;
+	std::vector<unsigned char *> blocks;
+	unsigned size = 2048;
+	for(unsigned x=0; x<cnt; ++x){
+		blocks.push_back(net::buffer_pool::allocate(size));
+	}
+	boost::thread T(boost::bind(&free_blocks, boost::ref(blocks), size));
+	T.join();
+	std::vector<net::buffer_pool::class_stats> before = net::buffer_pool::stats();
+	//2048 bytes is in the 2048 byte class
+	if(before[5].central == 0){
+		LOG; ++fail;
+	}
+	for(unsigned x=0; x<cnt; ++x){
+		blocks.push_back(net::buffer_pool::allocate(size));
+	}
+	std::vector<net::buffer_pool::class_stats> after = net::buffer_pool::stats();
+	if(after[5].misses != before[5].misses){
+		LOG; ++fail;
+	}
+	free_blocks(blocks, size);
+	}
+
+	{//buffer storage comes from pool
+	std::vector<net::buffer_pool::class_stats> before = net::buffer_pool::stats();
+	for(unsigned x=0; x<100; ++x){
+		net::buffer B(std::string(10240, 'X'));
+	}
+	std::vector<net::buffer_pool::class_stats> after = net::buffer_pool::stats();
+	//10240 bytes is in the 16384 byte class
+	if(after[8].hits - before[8].hits < 99){
+		LOG; ++fail;
+	}
+	}
+
+	return fail;
+}
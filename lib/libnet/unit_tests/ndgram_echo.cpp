@@ -34,4 +34,37 @@ int main()
 	N_client.recv(buf, from);
 	assert(buf.str() == "x");
 	assert(from);
+
+	//send batch larger than max_batch from client to server
+	const unsigned batch_size = net::ndgram::max_batch + 16;
+	std::deque<net::ndgram::datagram> batch;
+	for(unsigned x=0; x<batch_size; ++x){
+		batch.push_back(net::ndgram::datagram(*E.begin()));
+		batch.back().buf.append(static_cast<unsigned char>(x));
+	}
+	while(!batch.empty()){
+		int n_msg = N_client.send(batch);
+		assert(n_msg > 0);
+		batch.erase(batch.begin(), batch.begin() + n_msg);
+	}
+
+	//recv batch on server, datagrams should arrive in order
+	if(!N_serv.set_non_blocking(true)){
+		LOG; exit(1);
+	}
+	net::select Select;
+	while(batch.size() < batch_size){
+		std::set<int> read, write;
+		read.insert(N_serv.socket());
+		Select(read, write, 1000);
+		assert(!read.empty());
+		while(N_serv.recv(batch) > 0);
+		assert(N_serv.is_open());
+	}
+	assert(batch.size() == batch_size);
+	for(unsigned x=0; x<batch_size; ++x){
+		assert(batch[x].buf.size() == 1);
+		assert(batch[x].buf[0] == static_cast<unsigned char>(x));
+		assert(batch[x].ep.port() == N_client.local_ep()->port());
+	}
 }
@@ -2,8 +2,166 @@
 #include <net/net.hpp>
 #include <unit_test.hpp>
 
+int fail(0);
+timer_wheel Timer_Wheel(1);
+boost::shared_ptr<net::ndgram_stream> Client;
+boost::shared_ptr<net::ndgram_stream> Server;
+net::buffer expected;
+net::buffer received;
+bool done(false);
+
+//interactive stream, used to measure RTT while bulk transfer running
+boost::uint32_t ping_ID(0);
+boost::posix_time::ptime ping_sent;
+boost::int64_t max_ping_ms(0);
+unsigned ping_cnt(0);
+timer_wheel::handle Ping_Timer;
+
+boost::posix_time::ptime now()
+{
+	return boost::posix_time::microsec_clock::universal_time();
+}
+
+void client_call_back(net::ndgram_stream::event & E)
+{
+	if(E.type == net::ndgram_stream::write_event){
+		return;
+	}else if(E.ID == ping_ID){
+		if(E.type == net::ndgram_stream::recv_event){
+			boost::int64_t ms = (now() - ping_sent).total_milliseconds();
+			if(ms > max_ping_ms){
+				max_ping_ms = ms;
+			}
+			++ping_cnt;
+		}
+	}else if(E.type == net::ndgram_stream::connect_event){
+		//send everything at once, test depends on flow control
+		net::buffer buf(expected);
+		Client->send(E.ID, buf);
+	}else if(E.type == net::ndgram_stream::recv_event){
+		received.append(E.buf);
+		if(received.size() >= expected.size()){
+			Client->close(E.ID);
+			done = true;
+		}
+	}else if(E.type == net::ndgram_stream::close_event){
+		LOG; ++fail;
+		done = true;
+	}
+}
+
+void server_call_back(net::ndgram_stream::event & E)
+{
+	if(E.type == net::ndgram_stream::recv_event){
+		//echo
+		Server->send(E.ID, E.buf);
+	}else if(E.type == net::ndgram_stream::close_event){
+		Server->close(E.ID);
+	}
+}
+
+void send_ping()
+{
+	if(!done){
+		ping_sent = now();
+		net::buffer buf("P");
+		Client->send(ping_ID, buf);
+		Ping_Timer = Timer_Wheel.arm(100, &send_ping);
+	}
+}
+
+void run()
+{
+	net::select Select;
+	while(!done){
+		std::set<int> read, write;
+		read.insert(Client->socket());
+		read.insert(Server->socket());
+		if(Client->want_write()){
+			write.insert(Client->socket());
+		}
+		if(Server->want_write()){
+			write.insert(Server->socket());
+		}
+		Select(read, write, Timer_Wheel.next_ms(100));
+		if(read.find(Client->socket()) != read.end()){
+			Client->read();
+		}
+		if(read.find(Server->socket()) != read.end()){
+			Server->read();
+		}
+		if(write.find(Client->socket()) != write.end()){
+			Client->write();
+		}
+		if(write.find(Server->socket()) != write.end()){
+			Server->write();
+		}
+		Timer_Wheel.expire();
+	}
+}
+
+void setup(const unsigned size)
+{
+	Client.reset(new net::ndgram_stream(Timer_Wheel, &client_call_back));
+	Server.reset(new net::ndgram_stream(Timer_Wheel, &server_call_back));
+	std::set<net::endpoint> E = net::get_endpoint("127.0.0.1", "0");
+	assert(!E.empty());
+	Client->open(*E.begin());
+	Server->open(*E.begin());
+	if(!Client->is_open() || !Server->is_open()){
+		LOG; exit(1);
+	}
+	expected.clear();
+	for(unsigned x=0; x<size; ++x){
+		expected.append(static_cast<unsigned char>(x % 251));
+	}
+	received.clear();
+	done = false;
+}
+
+void teardown()
+{
+	if(received != expected){
+		LOG; ++fail;
+	}
+	Client.reset();
+	Server.reset();
+	if(Timer_Wheel.size() != 0){
+		//streams must cancel their timers
+		LOG; ++fail;
+	}
+}
+
 int main()
 {
 	unit_test::timeout();
 
+	//reliable in order delivery with loss and delay both ways
+	setup(256 * 1024);
+	Client->impair(10, 20);
+	Server->impair(10, 20);
+	Client->connect(*Server->local_ep());
+	run();
+	teardown();
+
+	/*
+	Bulk transfer through a 512 KiB/s bottleneck with a large queue. The RTT of
+	an interactive stream sharing the bottleneck should stay near the 100ms
+	LEDBAT target instead of growing to the queue a full window would cause
+	(about 700ms).
+	*/
+	setup(1024 * 1024);
+	Client->impair(0, 10, 512 * 1024);
+	Client->connect(*Server->local_ep());
+	ping_ID = Client->connect(*Server->local_ep());
+	max_ping_ms = 0;
+	ping_cnt = 0;
+	Ping_Timer = Timer_Wheel.arm(100, &send_ping);
+	run();
+	Timer_Wheel.cancel(Ping_Timer);
+	if(ping_cnt < 10 || max_ping_ms > 400){
+		LOG << "pings: " << ping_cnt << " max RTT: " << max_ping_ms << "ms"; ++fail;
+	}
+	teardown();
+	return fail;
 }
@@ -11,14 +11,16 @@ unsigned echo_cnt(0);
 boost::shared_ptr<net::nstream_proactor> Proactor;
 boost::mutex mutex;
 boost::condition_variable_any cond;
+net::nstream_proactor::tran_t tran(net::nstream_proactor::nstream_tran);
 
 void connect_call_back(net::nstream_proactor::connect_event CE)
 {
-	if(CE.info->tran != net::nstream_proactor::nstream_tran){
+	if(CE.info->tran != tran){
 		return;
 	}
 	if(CE.info->dir == net::nstream_proactor::outgoing_dir){
-		Proactor->send(CE.info->conn_ID, net::buffer("x"));
+		net::buffer buf("x");
+		Proactor->send(CE.info->conn_ID, buf);
 	}
 }
 
@@ -33,6 +35,7 @@ void recv_call_back(net::nstream_proactor::recv_event RE)
 	assert(RE.buf[0] == 'x');
 	if(RE.info->dir == net::nstream_proactor::outgoing_dir){
 		//this byte was echo'd back to us
+		Proactor->disconnect(RE.info->conn_ID);
 		{//BEGIN lock scope
 		boost::mutex::scoped_lock lock(mutex);
 		++echo_cnt;
@@ -40,7 +43,6 @@ void recv_call_back(net::nstream_proactor::recv_event RE)
 			cond.notify_one();
 		}
 		}//END lock scope
-		Proactor->disconnect(RE.info->conn_ID);
 	}else{
 		//byte we need to echo back
 		Proactor->send(RE.info->conn_ID, RE.buf, true);
@@ -52,23 +54,26 @@ void send_call_back(net::nstream_proactor::send_event SE)
 
 }
 
-int main()
+void echo_test(const net::select::backend_t backend,
+	const net::nstream_proactor::tran_t tran_in = net::nstream_proactor::nstream_tran)
 {
-	unit_test::timeout();
+	tran = tran_in;
+	echo_cnt = 0;
 	Proactor.reset(new net::nstream_proactor(
 		&connect_call_back,
 		&disconnect_call_back,
 		&recv_call_back,
-		&send_call_back
+		&send_call_back,
+		backend
 	));
 	std::set<net::endpoint> E = net::get_endpoint("127.0.0.1", "0");
 	assert(!E.empty());
-	boost::optional<net::endpoint> ep = *Proactor->listen(*E.begin());
+	boost::optional<net::endpoint> ep = *Proactor->listen(*E.begin(), tran);
 	if(!ep){
 		LOG; exit(1);
 	}
 	for(int x=0; x<echo; ++x){
-		Proactor->connect(*ep);
+		Proactor->connect(*ep, tran);
 	}
 	{//BEGIN lock scope
 	boost::mutex::scoped_lock lock(mutex);
@@ -77,5 +82,14 @@ int main()
 	}
 	}//END lock scope
 	Proactor.reset();
+}
+
+int main()
+{
+	unit_test::timeout();
+	echo_test(net::select::select_backend);
+	echo_test(net::select::epoll_backend);
+	echo_test(net::select::io_uring_backend);
+	echo_test(net::select::epoll_backend, net::nstream_proactor::ndgram_stream_tran);
 	return fail;
 }
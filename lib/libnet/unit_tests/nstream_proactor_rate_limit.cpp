@@ -0,0 +1,97 @@
+//include
+#include <net/net.hpp>
+#include <unit_test.hpp>
+
+int fail(0);
+const unsigned send_size = 512 * 1024;
+const unsigned rate = 256 * 1024;
+boost::shared_ptr<net::nstream_proactor> Proactor;
+boost::mutex mutex;
+boost::condition_variable_any cond;
+unsigned received(0);
+bool done(false);
+
+void connect_call_back(net::nstream_proactor::connect_event CE)
+{
+	if(CE.info->tran != net::nstream_proactor::nstream_tran){
+		return;
+	}
+	if(CE.info->dir == net::nstream_proactor::incoming_dir){
+		net::buffer buf(std::string(send_size, 'x'));
+		Proactor->send(CE.info->conn_ID, buf, true);
+	}
+}
+
+void disconnect_call_back(net::nstream_proactor::disconnect_event DE)
+{
+	if(DE.info->tran == net::nstream_proactor::nstream_tran
+		&& DE.info->dir == net::nstream_proactor::outgoing_dir)
+	{
+		boost::mutex::scoped_lock lock(mutex);
+		done = true;
+		cond.notify_one();
+	}
+}
+
+void recv_call_back(net::nstream_proactor::recv_event RE)
+{
+	boost::mutex::scoped_lock lock(mutex);
+	received += RE.buf.size();
+}
+
+void send_call_back(net::nstream_proactor::send_event SE)
+{
+
+}
+
+void rate_limit_test(const net::select::backend_t backend, const bool upload)
+{
+	received = 0;
+	done = false;
+	Proactor.reset(new net::nstream_proactor(
+		&connect_call_back,
+		&disconnect_call_back,
+		&recv_call_back,
+		&send_call_back,
+		backend
+	));
+	if(upload){
+		Proactor->set_max_upload_rate(rate);
+	}else{
+		Proactor->set_max_download_rate(rate);
+	}
+	std::set<net::endpoint> E = net::get_endpoint("127.0.0.1", "0");
+	assert(!E.empty());
+	boost::optional<net::endpoint> ep = *Proactor->listen(*E.begin());
+	if(!ep){
+		LOG; exit(1);
+	}
+	boost::posix_time::ptime start = boost::posix_time::microsec_clock::universal_time();
+	Proactor->connect(*ep);
+	{//BEGIN lock scope
+	boost::mutex::scoped_lock lock(mutex);
+	while(!done){
+		cond.wait(mutex);
+	}
+	}//END lock scope
+	boost::int64_t ms = (boost::posix_time::microsec_clock::universal_time()
+		- start).total_milliseconds();
+	Proactor.reset();
+	if(received != send_size){
+		LOG; ++fail;
+	}
+	//minus burst, 512 KiB at 256 KiB/s should take at least 1.5 seconds
+	if(ms < 1400){
+		LOG << ms << "ms"; ++fail;
+	}
+}
+
+int main()
+{
+	unit_test::timeout();
+	rate_limit_test(net::select::select_backend, true);
+	rate_limit_test(net::select::epoll_backend, true);
+	rate_limit_test(net::select::epoll_backend, false);
+	rate_limit_test(net::select::io_uring_backend, false);
+	return fail;
+}
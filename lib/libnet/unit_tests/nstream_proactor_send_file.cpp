@@ -0,0 +1,138 @@
+//include
+#include <net/net.hpp>
+#include <unit_test.hpp>
+
+//standard
+#include <cstdio>
+
+int fail(0);
+const char * file_name = "nstream_proactor_send_file.test";
+const unsigned file_size = 1024 * 1024;
+const unsigned buf_cnt = 256;
+boost::shared_ptr<net::nstream_proactor> Proactor;
+boost::mutex mutex;
+boost::condition_variable_any cond;
+int file_FD(-1);
+net::buffer expected;
+net::buffer received;
+unsigned largest_recv(0);
+bool done(false);
+net::nstream_proactor::tran_t tran(net::nstream_proactor::nstream_tran);
+
+void connect_call_back(net::nstream_proactor::connect_event CE)
+{
+	if(CE.info->tran != tran){
+		return;
+	}
+	if(CE.info->dir == net::nstream_proactor::incoming_dir){
+		//file range should be sent in order with buffers
+		for(unsigned x=0; x<buf_cnt; ++x){
+			net::buffer buf(std::string(x + 1, 'A' + x % 26));
+			Proactor->send(CE.info->conn_ID, buf);
+			assert(buf.empty());
+		}
+		Proactor->send_file(CE.info->conn_ID, net::nstream_proactor::file_range(
+			file_FD, 3, file_size - 3));
+		net::buffer buf("XYZ");
+		Proactor->send(CE.info->conn_ID, buf, true);
+	}
+}
+
+void disconnect_call_back(net::nstream_proactor::disconnect_event DE)
+{
+	if(DE.info->tran == tran
+		&& DE.info->dir == net::nstream_proactor::outgoing_dir)
+	{
+		boost::mutex::scoped_lock lock(mutex);
+		done = true;
+		cond.notify_one();
+	}
+}
+
+void recv_call_back(net::nstream_proactor::recv_event RE)
+{
+	boost::mutex::scoped_lock lock(mutex);
+	received.append(RE.buf);
+	if(RE.buf.size() > largest_recv){
+		largest_recv = RE.buf.size();
+	}
+}
+
+void send_call_back(net::nstream_proactor::send_event SE)
+{
+
+}
+
+void send_file_test(const net::select::backend_t backend,
+	const unsigned max_recv = net::nstream_proactor::default_max_recv,
+	const net::nstream_proactor::tran_t tran_in = net::nstream_proactor::nstream_tran)
+{
+	tran = tran_in;
+	received.clear();
+	largest_recv = 0;
+	done = false;
+	Proactor.reset(new net::nstream_proactor(
+		&connect_call_back,
+		&disconnect_call_back,
+		&recv_call_back,
+		&send_call_back,
+		backend,
+		net::nstream_proactor::default_dispatch_shards,
+		max_recv
+	));
+	std::set<net::endpoint> E = net::get_endpoint("127.0.0.1", "0");
+	assert(!E.empty());
+	boost::optional<net::endpoint> ep = *Proactor->listen(*E.begin(), tran);
+	if(!ep){
+		LOG; exit(1);
+	}
+	Proactor->connect(*ep, tran);
+	{//BEGIN lock scope
+	boost::mutex::scoped_lock lock(mutex);
+	while(!done){
+		cond.wait(mutex);
+	}
+	}//END lock scope
+	Proactor.reset();
+	if(received != expected){
+		LOG; ++fail;
+	}
+	//reads are coalesced but never past max_recv
+	if(largest_recv == 0 || largest_recv > max_recv){
+		LOG; ++fail;
+	}
+}
+
+int main()
+{
+	unit_test::timeout();
+
+	//create file to send
+	std::string file_buf;
+	for(unsigned x=0; x<file_size; ++x){
+		file_buf += static_cast<char>(x % 251);
+	}
+	std::fstream fout(file_name, std::ios::out | std::ios::binary | std::ios::trunc);
+	fout.write(file_buf.data(), file_buf.size());
+	fout.close();
+	file_FD = open(file_name, O_RDONLY);
+	if(file_FD == -1){
+		LOG << strerror(errno); exit(1);
+	}
+	for(unsigned x=0; x<buf_cnt; ++x){
+		expected.append(std::string(x + 1, 'A' + x % 26));
+	}
+	expected.append(file_buf.substr(3));
+	expected.append("XYZ");
+
+	send_file_test(net::select::select_backend);
+	send_file_test(net::select::epoll_backend);
+	send_file_test(net::select::io_uring_backend);
+	send_file_test(net::select::select_backend, net::socket_base::MTU);
+	send_file_test(net::select::epoll_backend, 4096);
+	send_file_test(net::select::epoll_backend, 4096,
+		net::nstream_proactor::ndgram_stream_tran);
+	close(file_FD);
+	std::remove(file_name);
+	return fail;
+}
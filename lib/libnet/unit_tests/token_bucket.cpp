@@ -0,0 +1,60 @@
+//include
+#include <net/net.hpp>
+#include <unit_test.hpp>
+
+int fail(0);
+
+int main()
+{
+	unit_test::timeout();
+
+	{//unlimited
+	net::token_bucket TB;
+	if(TB.available() != std::numeric_limits<unsigned>::max()){
+		LOG; ++fail;
+	}
+	TB.consume(1000000);
+	if(TB.available() != std::numeric_limits<unsigned>::max()){
+		LOG; ++fail;
+	}
+	if(TB.wait_ms() != 0){
+		LOG; ++fail;
+	}
+	}
+
+	{//limited, starts with burst
+	net::token_bucket TB(4000);
+	unsigned available = TB.available();
+	if(available == 0 || available > 1000){
+		LOG; ++fail;
+	}
+	TB.consume(available + 4000);
+	if(TB.available() != 0){
+		LOG; ++fail;
+	}
+	//debt of 4000 bytes at 4000 B/s takes about a second to pay off
+	unsigned wait = TB.wait_ms();
+	if(wait < 900 || wait > 1001){
+		LOG; ++fail;
+	}
+	}
+
+	{//refills over time
+	net::token_bucket TB(100000);
+	TB.consume(TB.available());
+	boost::this_thread::sleep(boost::posix_time::milliseconds(50));
+	if(TB.available() == 0){
+		LOG; ++fail;
+	}
+	}
+
+	{//rate change
+	net::token_bucket TB(1000);
+	TB.set_rate(0);
+	if(TB.rate() != 0 || TB.available() != std::numeric_limits<unsigned>::max()){
+		LOG; ++fail;
+	}
+	}
+
+	return fail;
+}
@@ -33,7 +33,9 @@ block_request::block_request(const boost::uint64_t block_count_in):
 	block_count(block_count_in),
 	local_blocks(0),
 	local(block_count),
-	approved(block_count)
+	approved(block_count),
+	complete_hosts(0),
+	Avail(block_count, 0)
 {
 
 }
@@ -44,10 +46,12 @@ void block_request::add_block_local(const boost::uint64_t block)
 	assert(Upload.empty());
 	if(!local.empty()){
 		assert(local[block] == false);
+		rarity_erase(block);
 		local[block] = true;
 		++local_blocks;
 		if(local.all_set()){
 			local.clear();
+			Rarity.clear();
 		}
 	}
 }
@@ -59,11 +63,13 @@ void block_request::add_block_local(const int connection_ID, const boost::uint64
 	if(!local.empty()){
 		if(local[block] == false){
 			send_have = true;
+			rarity_erase(block);
 		}
 		local[block] = true;
 		++local_blocks;
 		if(local.all_set()){
 			local.clear();
+			Rarity.clear();
 		}
 	}
 	Request.erase(block);
@@ -95,6 +101,7 @@ void block_request::add_block_local_all()
 	boost::mutex::scoped_lock lock(Mutex);
 	local.clear();
 	Request.clear();
+	Rarity.clear();
 	local_blocks = block_count;
 }
 
@@ -104,9 +111,15 @@ void block_request::add_block_remote(const int connection_ID,
 	boost::mutex::scoped_lock lock(Mutex);
 	std::map<int, download_element>::iterator d_it = Download.find(connection_ID);
 	assert(d_it != Download.end());
-	if(!d_it->second.block_BF.empty()){
+	if(!d_it->second.block_BF.empty() && d_it->second.block_BF[block] == false){
+		rarity_erase(block);
 		d_it->second.block_BF[block] = true;
+		++Avail[block];
+		rarity_insert(block);
 		if(d_it->second.block_BF.all_set()){
+			//host now has all blocks, count it as complete host
+			avail_add(d_it->second.block_BF, -1);
+			++complete_hosts;
 			d_it->second.block_BF.clear();
 		}
 	}
@@ -115,8 +128,9 @@ void block_request::add_block_remote(const int connection_ID,
 void block_request::approve_block(const boost::uint64_t block)
 {
 	boost::mutex::scoped_lock lock(Mutex);
-	if(!approved.empty()){
+	if(!approved.empty() && approved[block] == false){
 		approved[block] = true;
+		rarity_insert(block);
 		if(approved.all_set()){
 			approved.clear();
 		}
@@ -126,7 +140,28 @@ void block_request::approve_block(const boost::uint64_t block)
 void block_request::approve_block_all()
 {
 	boost::mutex::scoped_lock lock(Mutex);
+	if(approved.empty()){
+		return;
+	}
+	bit_field prev_approved = approved;
 	approved.clear();
+	for(boost::uint64_t block = 0; block < block_count; ++block){
+		if(prev_approved[block] == false){
+			rarity_insert(block);
+		}
+	}
+}
+
+void block_request::avail_add(const bit_field & BF, const int delta)
+{
+	assert(!BF.empty());
+	for(boost::uint64_t block = 0; block < block_count; ++block){
+		if(BF[block]){
+			rarity_erase(block);
+			Avail[block] += delta;
+			rarity_insert(block);
+		}
+	}
 }
 
 boost::uint64_t block_request::bytes()
@@ -158,18 +193,34 @@ void block_request::download_reg(const int connection_ID,
 	std::pair<std::map<int, download_element>::iterator, bool>
 		ret = Download.insert(std::make_pair(connection_ID, download_element(BF)));
 	assert(ret.second);
+	if(BF.empty()){
+		++complete_hosts;
+	}else{
+		avail_add(BF, 1);
+	}
 }
 
 void block_request::download_unreg(const int connection_ID)
 {
 	boost::mutex::scoped_lock lock(Mutex);
-	Download.erase(connection_ID);
+	std::map<int, download_element>::iterator d_it = Download.find(connection_ID);
+	if(d_it != Download.end()){
+		if(d_it->second.block_BF.empty()){
+			--complete_hosts;
+		}else{
+			avail_add(d_it->second.block_BF, -1);
+		}
+		Download.erase(d_it);
+	}
 	for(std::map<boost::uint64_t, std::set<int> >::iterator it_cur = Request.begin();
 		it_cur != Request.end();)
 	{
 		it_cur->second.erase(connection_ID);
 		if(it_cur->second.empty()){
+			//block no longer requested, it can be requested again
+			boost::uint64_t block = it_cur->first;
 			Request.erase(it_cur++);
+			rarity_insert(block);
 		}else{
 			++it_cur;
 		}
@@ -184,53 +235,30 @@ boost::optional<boost::uint64_t> block_request::find_next_rarest(const int conne
 		//we are waiting on a bit_field from the remote host most likely
 		return boost::optional<boost::uint64_t>();
 	}
-	boost::uint64_t rare_block;           //most rare block
-	boost::uint64_t rare_block_hosts = 0; //number of hosts that have rare_block
-	for(boost::uint64_t block = 0; block < local.size(); ++block){
-		if(local[block]){
-			//we already have this block
-			continue;
-		}
-		if(!approved.empty() && !approved[block]){
-			//block is not approved
-			continue;
-		}
-		if(!d_it->second.block_BF.empty() && d_it->second.block_BF[block] == false){
-			//remote host doesn't have this block
+	/*
+	Blocks in the first bucket are only available from complete hosts. If there
+	are none we can skip the bucket since nobody has those blocks.
+	*/
+	for(std::vector<std::set<boost::uint64_t> >::size_type
+		x = (complete_hosts == 0 ? 1 : 0); x < Rarity.size(); ++x)
+	{
+		if(d_it->second.block_BF.empty()){
+			//host has all blocks, first block in least available bucket is rarest
+			if(!Rarity[x].empty()){
+				return *Rarity[x].begin();
+			}
 			continue;
 		}
-
-		//check rarity
-		boost::uint32_t hosts = 0;
-		for(std::map<int, download_element>::iterator it_cur = Download.begin(),
-			it_end = Download.end(); it_cur != it_end; ++it_cur)
+		for(std::set<boost::uint64_t>::iterator it_cur = Rarity[x].begin(),
+			it_end = Rarity[x].end(); it_cur != it_end; ++it_cur)
 		{
-			if(it_cur->second.block_BF.empty() || it_cur->second.block_BF[block]){
-				++hosts;
-			}
-		}
-		if(hosts == 1){
-			//block with maximum rarity found
-			if(Request.find(block) == Request.end()){
-				//block not already requested
-				return block;
-			}
-		}else if(hosts < rare_block_hosts || rare_block_hosts == 0){
-			//a new most-rare block found
-			if(Request.find(block) == Request.end()){
-				//block not already requested, consider requesting this block
-				rare_block = block;
-				rare_block_hosts = hosts;
+			if(d_it->second.block_BF[*it_cur]){
+				return *it_cur;
 			}
 		}
 	}
-	if(rare_block_hosts == 0){
-		//host has no blocks we need
-		return boost::optional<boost::uint64_t>();
-	}else{
-		//a block was found that we need
-		return rare_block;
-	}
+	//host has no blocks we need
+	return boost::optional<boost::uint64_t>();
 }
 
 bool block_request::have_block(const boost::uint64_t block)
@@ -289,6 +317,7 @@ boost::optional<boost::uint64_t> block_request::next_request(const int connectio
 		std::pair<std::map<boost::uint64_t, std::set<int> >::iterator, bool>
 			r_ret = Request.insert(std::make_pair(*block, std::set<int>()));
 		assert(r_ret.second);
+		rarity_erase(*block);
 		std::pair<std::set<int>::iterator, bool> c_ret = r_ret.first->second.insert(connection_ID);
 		assert(c_ret.second);
 		return block;
@@ -352,6 +381,30 @@ unsigned block_request::percent_complete()
 	}
 }
 
+bool block_request::rarity_eligible(const boost::uint64_t block)
+{
+	return !local.empty() && local[block] == false
+		&& (approved.empty() || approved[block] == true)
+		&& Request.find(block) == Request.end();
+}
+
+void block_request::rarity_erase(const boost::uint64_t block)
+{
+	if(Avail[block] < Rarity.size()){
+		Rarity[Avail[block]].erase(block);
+	}
+}
+
+void block_request::rarity_insert(const boost::uint64_t block)
+{
+	if(rarity_eligible(block)){
+		if(Avail[block] >= Rarity.size()){
+			Rarity.resize(Avail[block] + 1);
+		}
+		Rarity[Avail[block]].insert(block);
+	}
+}
+
 unsigned block_request::upload_hosts()
 {
 	boost::mutex::scoped_lock lock(Mutex);
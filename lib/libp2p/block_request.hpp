@@ -14,6 +14,7 @@
 #include <map>
 #include <queue>
 #include <set>
+#include <vector>
 
 /*
 The block_request class keeps track of what blocks we have and what blocks
@@ -133,6 +134,20 @@ private:
 	//block number associated with connection_ID requested from
 	std::map<boost::uint64_t, std::set<int> > Request;
 
+	/*
+	Rarity index. The availability of a block is the number of hosts which have
+	every block (complete_hosts) plus the number of hosts with a partial
+	bit_field that have the block (Avail). Because complete_hosts applies to all
+	blocks equally only Avail is used to order blocks.
+
+	Rarity[n] contains blocks with Avail[block] == n that we need, are approved,
+	and have not been requested. The rarest block a host has is found by
+	checking buckets starting from the lowest.
+	*/
+	boost::uint64_t complete_hosts;
+	std::vector<unsigned> Avail;
+	std::vector<std::set<boost::uint64_t> > Rarity;
+
 	class download_element
 	{
 	public:
@@ -161,9 +176,22 @@ private:
 	std::map<int, upload_element> Upload;
 
 	/*
+	avail_add:
+		Add (or remove if delta negative) a partial host as source for all
+		blocks set in BF.
 	find_next_rarest:
 		Returns next rarest block we need to request.
+	rarity_eligible:
+		Returns true if block belongs in the rarity index.
+	rarity_erase:
+		Remove block from rarity index if it is in it.
+	rarity_insert:
+		Insert block in to rarity index if it is eligible.
 	*/
+	void avail_add(const bit_field & BF, const int delta);
 	boost::optional<boost::uint64_t> find_next_rarest(const int connection_ID);
+	bool rarity_eligible(const boost::uint64_t block);
+	void rarity_erase(const boost::uint64_t block);
+	void rarity_insert(const boost::uint64_t block);
 };
 #endif
@@ -82,7 +82,7 @@ void connection_manager::connect_call_back(net::connection_info & CI)
 	boost::mutex::scoped_lock lock(Connect_mutex);
 
 //DEBUG, disable blacklist
-db::pool::singleton()->get()->query("DELETE FROM blacklist");
+db::table::blacklist::clear();
 
 	if(CI.direction == net::outgoing){
 		Connecting.erase(CI.ep);
@@ -173,6 +173,7 @@ void connection_manager::remove_priv(const std::string hash)
 		one is using the file).
 		*/
 		db::table::share::remove(S_iter->path());
+		file_cache::singleton()->erase(S_iter->path());
 		boost::filesystem::remove(S_iter->path());
 	}
 }
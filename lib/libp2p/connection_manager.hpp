@@ -3,6 +3,7 @@
 
 //custom
 #include "connection.hpp"
+#include "file_cache.hpp"
 #include "kad.hpp"
 
 //include
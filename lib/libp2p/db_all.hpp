@@ -1,5 +1,6 @@
 //includes entire database namespace
 #include <db.hpp>
+#include "db_batch.hpp"
 #include "db_init.hpp"
 #include "db_pool.hpp"
 #include "db_table_blacklist.hpp"
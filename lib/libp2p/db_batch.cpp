@@ -0,0 +1,187 @@
+#include "db_batch.hpp"
+
+//BEGIN info
+db::batch::info::info():
+	batches(0),
+	updates(0),
+	failed(0),
+	last_batch_size(0),
+	max_batch_size(0),
+	last_commit_ms(0),
+	max_commit_ms(0)
+{
+
+}
+//END info
+
+db::batch::batch():
+	Pool(pool::singleton()),
+	queued(0),
+	committed(0),
+	flush_to(0),
+	reported(0),
+	flushing(0),
+	stopping(false)
+{
+	commit_thread = boost::thread(boost::bind(&batch::commit_loop, this));
+}
+
+db::batch::~batch()
+{
+	{//BEGIN lock scope
+	boost::mutex::scoped_lock lock(Mutex);
+	stopping = true;
+	}//END lock scope
+	Cond.notify_all();
+	commit_thread.join();
+}
+
+void db::batch::add(const boost::function<void (db::pool::proxy)> & func)
+{
+	{//BEGIN lock scope
+	boost::mutex::scoped_lock lock(Mutex);
+	if(Queue.empty()){
+		oldest = boost::get_system_time();
+	}
+	Queue.push_back(func);
+	++queued;
+	if(Queue.size() != 1 && Queue.size() < settings::DATABASE_BATCH_ROWS){
+		//commit thread already waiting for oldest update to time out
+		return;
+	}
+	}//END lock scope
+	Cond.notify_all();
+}
+
+void db::batch::commit(std::vector<boost::function<void (db::pool::proxy)> > & Job)
+{
+	boost::posix_time::ptime start = boost::posix_time::microsec_clock::universal_time();
+	db::pool::proxy DB = Pool->get();
+	//index in Job of updates that failed
+	std::vector<std::size_t> lost;
+	if(!transaction(DB, Job.begin(), Job.end())){
+		//one bad update shouldn't lose the others
+		LOG << "failed to commit " << Job.size() << " updates, retrying one at a time";
+		for(std::size_t x=0; x<Job.size(); ++x){
+			if(!transaction(DB, Job.begin() + x, Job.begin() + x + 1)){
+				lost.push_back(x);
+			}
+		}
+	}
+	unsigned ms = (boost::posix_time::microsec_clock::universal_time() - start)
+		.total_milliseconds();
+
+	{//BEGIN lock scope
+	boost::mutex::scoped_lock lock(Mutex);
+	for(std::vector<std::size_t>::iterator it_cur = lost.begin(),
+		it_end = lost.end(); it_cur != it_end; ++it_cur)
+	{
+		Failed.insert(committed + *it_cur + 1);
+	}
+	committed += Job.size();
+	++Info.batches;
+	Info.updates += Job.size() - lost.size();
+	Info.failed += lost.size();
+	Info.last_batch_size = Job.size();
+	if(Info.last_batch_size > Info.max_batch_size){
+		Info.max_batch_size = Info.last_batch_size;
+	}
+	Info.last_commit_ms = ms;
+	if(ms > Info.max_commit_ms){
+		Info.max_commit_ms = ms;
+	}
+	}//END lock scope
+	Cond.notify_all();
+	Job.clear();
+}
+
+void db::batch::commit_loop()
+{
+	std::vector<boost::function<void (db::pool::proxy)> > Job;
+	while(true){
+		{//BEGIN lock scope
+		boost::mutex::scoped_lock lock(Mutex);
+		while(true){
+			if(Queue.empty()){
+				if(stopping){
+					return;
+				}
+				Cond.wait(Mutex);
+				continue;
+			}
+			boost::system_time timeout = oldest
+				+ boost::posix_time::milliseconds(settings::DATABASE_BATCH_MS);
+			if(stopping || flush_to > committed
+				|| Queue.size() >= settings::DATABASE_BATCH_ROWS
+				|| boost::get_system_time() >= timeout)
+			{
+				break;
+			}
+			Cond.timed_wait(Mutex, timeout);
+		}
+		if(Queue.size() <= settings::DATABASE_BATCH_ROWS){
+			Job.swap(Queue);
+		}else{
+			//updates queued during last commit, rest committed next loop
+			Job.assign(Queue.begin(), Queue.begin() + settings::DATABASE_BATCH_ROWS);
+			Queue.erase(Queue.begin(), Queue.begin() + settings::DATABASE_BATCH_ROWS);
+		}
+		}//END lock scope
+		commit(Job);
+	}
+}
+
+bool db::batch::flush()
+{
+	boost::mutex::scoped_lock lock(Mutex);
+	if(queued > flush_to){
+		flush_to = queued;
+	}
+	const boost::uint64_t from = reported;
+	const boost::uint64_t target = queued;
+	Cond.notify_all();
+	++flushing;
+	while(committed < target){
+		Cond.wait(Mutex);
+	}
+	--flushing;
+	std::set<boost::uint64_t>::iterator it = Failed.upper_bound(from);
+	bool good = it == Failed.end() || *it > target;
+	if(target > reported){
+		reported = target;
+	}
+	if(flushing == 0){
+		//no flush waiting that could need these
+		Failed.erase(Failed.begin(), Failed.upper_bound(reported));
+	}
+	return good;
+}
+
+bool db::batch::transaction(db::pool::proxy & DB,
+	std::vector<boost::function<void (db::pool::proxy)> >::iterator begin,
+	std::vector<boost::function<void (db::pool::proxy)> >::iterator end)
+{
+	bool in_transaction = DB->query("BEGIN TRANSACTION") == 0;
+	if(!in_transaction){
+		//updates still run, each in its own transaction
+		LOG << "failed to begin transaction";
+	}
+	for(; begin != end; ++begin){
+		try{
+			(*begin)(DB);
+		}catch(const std::exception & e){
+			LOG << e.what();
+		}
+	}
+	if(in_transaction && DB->query("COMMIT") != 0){
+		DB->query("ROLLBACK");
+		return false;
+	}
+	return true;
+}
+
+db::batch::info db::batch::stats()
+{
+	boost::mutex::scoped_lock lock(Mutex);
+	return Info;
+}
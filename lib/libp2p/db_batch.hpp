@@ -0,0 +1,111 @@
+/*
+Write-behind queue for table updates. Updates are queued and a thread commits
+them in one transaction when settings::DATABASE_BATCH_ROWS updates are queued or
+the oldest update has waited settings::DATABASE_BATCH_MS, whichever comes
+first. This avoids a fsync per update when many updates happen at once (share
+scan, DHT storing sources).
+
+Example:
+	db::batch::singleton()->add(boost::bind(&db::table::source::add, ID, hash, _1));
+
+Note: Updates are not visible to other connections until committed. Call flush
+before reading something that might still be queued.
+*/
+#ifndef H_DB_BATCH
+#define H_DB_BATCH
+
+//custom
+#include "db_pool.hpp"
+#include "settings.hpp"
+
+//include
+#include <boost/bind.hpp>
+#include <boost/cstdint.hpp>
+#include <boost/function.hpp>
+#include <boost/thread.hpp>
+#include <logger.hpp>
+#include <singleton.hpp>
+
+//standard
+#include <set>
+#include <vector>
+
+namespace db{
+class batch : public singleton_base<batch>
+{
+	friend class singleton_base<batch>;
+public:
+	~batch();
+
+	class info
+	{
+	public:
+		info();
+		boost::uint64_t batches;      //transactions committed
+		boost::uint64_t updates;      //updates committed
+		boost::uint64_t failed;       //updates lost because they couldn't commit
+		unsigned last_batch_size;     //updates in last transaction
+		unsigned max_batch_size;      //most updates in one transaction
+		unsigned last_commit_ms;      //time to run and commit last transaction
+		unsigned max_commit_ms;       //longest time to run and commit
+	};
+
+	/*
+	add:
+		Queue update. The function is called with a connection that is inside
+		a transaction. If the transaction can't commit the updates in it are
+		retried one per transaction, so the function may be called twice.
+	flush:
+		Blocks until all updates queued before the call are committed. Returns
+		false if an update queued before the call, and after the previous flush
+		returned, could not be committed.
+	stats:
+		Returns batch size and commit latency statistics.
+	*/
+	void add(const boost::function<void (db::pool::proxy)> & func);
+	bool flush();
+	info stats();
+
+private:
+	batch();
+
+	//stops db::pool from being destroyed before us, see singleton.hpp
+	const boost::shared_ptr<pool> Pool;
+
+	/*
+	Mutex locks everything below. Cond is notified when an update is queued,
+	a flush is requested, or a transaction is committed.
+	*/
+	boost::mutex Mutex;
+	boost::condition_variable_any Cond;
+	std::vector<boost::function<void (db::pool::proxy)> > Queue;
+	boost::system_time oldest;  //time first update in Queue was queued
+	boost::uint64_t queued;     //number of updates ever queued
+	boost::uint64_t committed;  //number of updates ever committed (or failed)
+	boost::uint64_t flush_to;   //commit immediately until committed >= flush_to
+	boost::uint64_t reported;   //failures up to this update reported by flush
+	unsigned flushing;          //threads waiting in flush
+	std::set<boost::uint64_t> Failed; //update numbers (1 is first) that failed
+	bool stopping;              //set by dtor, commit remaining updates and exit
+	info Info;
+
+	/*
+	commit:
+		Runs updates in one transaction. If it fails runs each update in its
+		own transaction.
+	commit_loop:
+		Thread waits in this function for updates to commit.
+	transaction:
+		Runs updates in [begin, end) in one transaction. Returns false if the
+		transaction was rolled back.
+	*/
+	void commit(std::vector<boost::function<void (db::pool::proxy)> > & Job);
+	void commit_loop();
+	static bool transaction(db::pool::proxy & DB,
+		std::vector<boost::function<void (db::pool::proxy)> >::iterator begin,
+		std::vector<boost::function<void (db::pool::proxy)> >::iterator end);
+
+	boost::thread commit_thread;
+};
+}//end namespace db
+#endif
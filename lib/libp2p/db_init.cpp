@@ -9,11 +9,12 @@ void db::init::create_all()
 	DB->query("CREATE TABLE IF NOT EXISTS blacklist(IP TEXT)");
 	DB->query("CREATE UNIQUE INDEX IF NOT EXISTS blacklist_index ON blacklist(IP)");
 
-	//hash
+	//hash, tree column only used by older versions, see hash::migrate
 	DB->query("CREATE TABLE IF NOT EXISTS hash(key INTEGER PRIMARY KEY, hash TEXT, "
 		"state INTEGER, tree BLOB)");
 	DB->query("CREATE UNIQUE INDEX IF NOT EXISTS hash_hash_index ON hash(hash)");
 	DB->query("DELETE FROM hash WHERE state = 0");
+	db::table::hash::migrate(DB);
 
 	//peer
 	DB->query("CREATE TABLE IF NOT EXISTS peer(ID TEXT, IP TEXT, port TEXT)");
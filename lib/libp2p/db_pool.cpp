@@ -1,9 +1,9 @@
 #include "db_pool.hpp"
 
 //BEGIN pool::proxy
-db::pool::proxy::proxy():
-	Connection(singleton()->pool_get()),
-	This(this, boost::bind(&proxy::deleter, this, Connection))
+db::pool::proxy::proxy(const bool read_only):
+	Connection(singleton()->pool_get(read_only)),
+	This(this, boost::bind(&proxy::deleter, this, Connection, read_only))
 {
 
 }
@@ -13,38 +13,67 @@ boost::shared_ptr<db::connection> & db::pool::proxy::operator -> ()
 	return Connection;
 }
 
-void db::pool::proxy::deleter(boost::shared_ptr<db::connection> Connection)
+db::connection & db::pool::proxy::operator * ()
 {
-	singleton()->pool_put(Connection);
+	return *Connection;
+}
+
+void db::pool::proxy::deleter(boost::shared_ptr<db::connection> Connection,
+	const bool read_only)
+{
+	singleton()->pool_put(Connection, read_only);
 }
 //END pool::proxy
 
-db::pool::pool()
+db::pool::pool():
+	Writer(new connection(path::db_file(), false, settings::DATABASE_MMAP_SIZE))
 {
+	//read only connections can't create the database, writer must connect first
+	Writer->connect();
 	for(int x=0; x<settings::DATABASE_POOL_SIZE; ++x){
-		Pool.push(boost::shared_ptr<connection>(new connection(path::db_file())));
+		Reader.push(boost::shared_ptr<connection>(new connection(path::db_file(),
+			true, settings::DATABASE_MMAP_SIZE)));
 	}
 }
 
-boost::shared_ptr<db::connection> db::pool::pool_get()
+boost::shared_ptr<db::connection> db::pool::pool_get(const bool read_only)
 {
 	boost::mutex::scoped_lock lock(Mutex);
-	while(Pool.empty()){
-		Cond.wait(Mutex);
+	boost::shared_ptr<connection> Connection;
+	if(read_only){
+		while(Reader.empty()){
+			Cond.wait(Mutex);
+		}
+		Connection = Reader.top();
+		Reader.pop();
+	}else{
+		while(!Writer){
+			Cond.wait(Mutex);
+		}
+		Connection.swap(Writer);
 	}
-	boost::shared_ptr<connection> Connection = Pool.top();
-	Pool.pop();
 	return Connection;
 }
 
 db::pool::proxy db::pool::get()
 {
-	return proxy();
+	return proxy(false);
 }
 
-void db::pool::pool_put(boost::shared_ptr<db::connection> & Connection)
+db::pool::proxy db::pool::get_reader()
+{
+	return proxy(true);
+}
+
+void db::pool::pool_put(boost::shared_ptr<db::connection> & Connection,
+	const bool read_only)
 {
 	boost::mutex::scoped_lock lock(Mutex);
-	Pool.push(Connection);
-	Cond.notify_one();
+	if(read_only){
+		Reader.push(Connection);
+	}else{
+		Writer = Connection;
+	}
+	//notify all, waiters may be waiting for different kind of connection
+	Cond.notify_all();
 }
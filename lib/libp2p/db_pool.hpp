@@ -30,34 +30,44 @@ public:
 		*/
 		boost::shared_ptr<connection> & operator -> ();
 
+		//used to construct db::statement
+		connection & operator * ();
+
 	private:
 		//only db::pool can instantiate proxy
-		proxy();
+		proxy(const bool read_only);
 
 		boost::shared_ptr<connection> Connection;
 		boost::shared_ptr<proxy> This;
 
-		//when new_connection = false this deleter returns the connection to pool
-		void deleter(boost::shared_ptr<connection> Connection);
+		//this deleter returns the connection to pool
+		void deleter(boost::shared_ptr<connection> Connection, const bool read_only);
 	};
 
 	/*
 	get:
-		Get database object. This is the only way to get one.
+		Get read/write connection. There is only one so writes never wait on
+		locks held by other writes in this process.
+		Note: Don't call get() while holding a proxy from get(), it will deadlock.
+		Pass the proxy instead.
+	get_reader:
+		Get read only connection. Reads don't contend with the writer when sqlite
+		supports WAL.
 	*/
 	proxy get();
+	proxy get_reader();
 
 private:
 	pool();
 
 	/*
-	The Pool container holds available database connections. When there are no
-	available connections threads will wait on the Cond. The Mutex
-	locks access to the Pool.
+	When a connection is not available threads will wait on Cond. The Mutex
+	locks access to Writer and Reader.
 	*/
 	boost::mutex Mutex;
 	boost::condition_variable_any Cond;
-	std::stack<boost::shared_ptr<connection> > Pool;
+	boost::shared_ptr<connection> Writer; //empty when in use
+	std::stack<boost::shared_ptr<connection> > Reader;
 
 	/*
 	pool_get:
@@ -65,8 +75,8 @@ private:
 	pool_put:
 		Function to return connection to pool.
 	*/
-	boost::shared_ptr<connection> pool_get();
-	void pool_put(boost::shared_ptr<connection> & Connection);
+	boost::shared_ptr<connection> pool_get(const bool read_only);
+	void pool_put(boost::shared_ptr<connection> & Connection, const bool read_only);
 };
 }//end namespace database
 #endif
@@ -1,39 +1,178 @@
 #include "db_table_blacklist.hpp"
 
+//BEGIN snapshot
+bool db::table::blacklist::snapshot::add(const std::string & IP)
+{
+	std::string bin;
+	int prefix;
+	if(!parse(IP, bin, prefix)){
+		return false;
+	}
+	Range.insert(key(bin, prefix));
+	if(bin.size() == 4){
+		Prefix_v4.insert(prefix);
+	}else{
+		Prefix_v6.insert(prefix);
+	}
+	return true;
+}
+
+bool db::table::blacklist::snapshot::contains(const std::string & IP) const
+{
+	std::string bin;
+	int prefix;
+	if(!parse(IP, bin, prefix)){
+		return false;
+	}
+	const std::set<int, std::greater<int> > & Prefix = bin.size() == 4 ?
+		Prefix_v4 : Prefix_v6;
+	for(std::set<int, std::greater<int> >::const_iterator it_cur = Prefix.begin(),
+		it_end = Prefix.end(); it_cur != it_end; ++it_cur)
+	{
+		if(*it_cur <= prefix && Range.find(key(bin, *it_cur)) != Range.end()){
+			return true;
+		}
+	}
+	return false;
+}
+
+std::string db::table::blacklist::snapshot::key(const std::string & bin,
+	const int prefix)
+{
+	std::string tmp = bin;
+	for(int x=0; x<static_cast<int>(tmp.size()); ++x){
+		int bits = prefix - x * 8;
+		if(bits <= 0){
+			tmp[x] = 0;
+		}else if(bits < 8){
+			tmp[x] &= static_cast<char>(0xFF << (8 - bits));
+		}
+	}
+	tmp += static_cast<char>(prefix);
+	return tmp;
+}
+
+bool db::table::blacklist::snapshot::parse(const std::string & IP,
+	std::string & bin, int & prefix)
+{
+	std::string addr = IP;
+	prefix = -1;
+	std::string::size_type pos = IP.find('/');
+	if(pos != std::string::npos){
+		addr = IP.substr(0, pos);
+		try{
+			prefix = boost::lexical_cast<int>(IP.substr(pos + 1));
+		}catch(const boost::bad_lexical_cast & e){
+			return false;
+		}
+		if(prefix < 0){
+			return false;
+		}
+	}
+	unsigned char buf[16];
+	if(inet_pton(AF_INET, addr.c_str(), buf) == 1){
+		bin.assign(reinterpret_cast<char *>(buf), 4);
+	}else if(inet_pton(AF_INET6, addr.c_str(), buf) == 1){
+		bin.assign(reinterpret_cast<char *>(buf), 16);
+	}else{
+		return false;
+	}
+	int max_prefix = bin.size() * 8;
+	if(prefix == -1){
+		prefix = max_prefix;
+	}
+	return prefix <= max_prefix;
+}
+//END snapshot
+
+//BEGIN wrap
+db::table::blacklist::wrap::wrap():
+	blacklist_state(0)
+{
+	boost::shared_ptr<snapshot> S(new snapshot());
+	bool empty = true;
+	{//BEGIN lock scope
+	db::pool::proxy DB = db::pool::singleton()->get_reader();
+	db::statement Stmt(*DB, "SELECT IP FROM blacklist");
+	while(Stmt.step()){
+		std::string IP = Stmt.column_text(0);
+		if(S->add(IP)){
+			empty = false;
+		}else{
+			LOG << "invalid blacklist entry \"" << IP << "\"";
+		}
+	}
+	}//END lock scope
+	Snapshot = S;
+	if(!empty){
+		//make users check connected hosts against existing blacklist
+		blacklist_state = 1;
+	}
+}
+
+const db::table::blacklist::snapshot & db::table::blacklist::wrap::get()
+{
+	std::pair<int, boost::shared_ptr<const snapshot> > * L = Local.get();
+	if(L == NULL || L->first != blacklist_state.load(boost::memory_order_acquire)){
+		boost::mutex::scoped_lock lock(Mutex);
+		if(L == NULL){
+			L = new std::pair<int, boost::shared_ptr<const snapshot> >();
+			Local.reset(L);
+		}
+		L->first = blacklist_state;
+		L->second = Snapshot;
+	}
+	return *L->second;
+}
+
+void db::table::blacklist::wrap::publish(const boost::shared_ptr<const snapshot> & S)
+{
+	Snapshot = S;
+	int state = blacklist_state + 1;
+	if(state == 0){
+		//0 reserved for unmodified blacklist
+		++state;
+	}
+	blacklist_state.store(state, boost::memory_order_release);
+}
+//END wrap
+
 void db::table::blacklist::add(const std::string & IP, db::pool::proxy DB)
 {
-	std::stringstream ss;
-	ss << "INSERT OR IGNORE INTO blacklist VALUES ('" << IP << "')";
-	DB->query(ss.str());
-	++wrap::singleton()->blacklist_state;
-	if(wrap::singleton()->blacklist_state == 0){
-		++wrap::singleton()->blacklist_state;
+	{//BEGIN lock scope
+	db::statement Stmt(*DB, "INSERT OR IGNORE INTO blacklist VALUES(?)");
+	Stmt.bind(1, IP);
+	Stmt.step();
+	}//END lock scope
+	const boost::shared_ptr<wrap> & W = wrap::singleton();
+	boost::mutex::scoped_lock lock(W->Mutex);
+	boost::shared_ptr<snapshot> S(new snapshot(*W->Snapshot));
+	if(!S->add(IP)){
+		LOG << "invalid blacklist entry \"" << IP << "\"";
 	}
+	W->publish(S);
 }
 
-static int is_blacklisted_call_back(int columns, char ** response,
-	char ** column_name, bool & found)
+void db::table::blacklist::clear(db::pool::proxy DB)
 {
-	found = true;
-	return 0;
+	DB->query("DELETE FROM blacklist");
+	const boost::shared_ptr<wrap> & W = wrap::singleton();
+	boost::mutex::scoped_lock lock(W->Mutex);
+	W->publish(boost::shared_ptr<const snapshot>(new snapshot()));
 }
 
-bool db::table::blacklist::is_blacklisted(const std::string & IP,
-	db::pool::proxy DB)
+bool db::table::blacklist::is_blacklisted(const std::string & IP)
 {
-	bool found = false;
-	std::stringstream ss;
-	ss << "SELECT 1 FROM blacklist WHERE IP = '" << IP << "'";
-	DB->query(ss.str(), boost::bind(&is_blacklisted_call_back, _1, _2, _3, boost::ref(found)));
-	return found;
+	return wrap::singleton()->get().contains(IP);
 }
 
 bool db::table::blacklist::modified(int & last_state_seen)
 {
-	if(last_state_seen == wrap::singleton()->blacklist_state){
+	int state = wrap::singleton()->blacklist_state;
+	if(last_state_seen == state){
 		return false;
 	}else{
-		last_state_seen = wrap::singleton()->blacklist_state;
+		last_state_seen = state;
 		return true;
 	}
 }
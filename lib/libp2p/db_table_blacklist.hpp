@@ -7,13 +7,17 @@
 #include "settings.hpp"
 
 //include
-#include <atomic_int.hpp>
-#include <boost/ref.hpp>
-#include <boost/tuple/tuple.hpp>
+#include <boost/atomic.hpp>
+#include <boost/lexical_cast.hpp>
+#include <boost/shared_ptr.hpp>
+#include <boost/thread.hpp>
+#include <boost/unordered_set.hpp>
+#include <portable.hpp>
 
 //standard
-#include <iostream>
-#include <sstream>
+#include <cstring>
+#include <functional>
+#include <set>
 #include <string>
 
 namespace db{
@@ -23,9 +27,12 @@ class blacklist
 public:
 	/*
 	add:
-		Add IP to blacklist.
+		Add IP or CIDR range (ex: "10.0.0.0/8", "2001:db8::/32") to blacklist.
+	clear:
+		Remove everything from blacklist.
 	is_blacklisted:
-		Returns true if IP is blacklisted.
+		Returns true if IP is blacklisted or in a blacklisted range. This checks
+		an in-memory snapshot of the blacklist table, there is no database access.
 	modified:
 		Returns true if last_state_seen doesn't match the current blacklist_state.
 		Note: To not check the blacklist the first call initialize last_state_seen
@@ -34,22 +41,80 @@ public:
 	*/
 	static void add(const std::string & IP,
 		db::pool::proxy DB = db::pool::singleton()->get());
-	static bool is_blacklisted(const std::string & IP,
-		db::pool::proxy DB = db::pool::singleton()->get());
+	static void clear(db::pool::proxy DB = db::pool::singleton()->get());
+	static bool is_blacklisted(const std::string & IP);
 	static bool modified(int & last_state_seen);
 
 private:
 	blacklist(){}
 
+	//immutable once published, replaced (not modified) when blacklist changes
+	class snapshot
+	{
+	public:
+		/*
+		add:
+			Add IP or CIDR range. Returns false if it couldn't be parsed.
+		contains:
+			Returns true if IP is in snapshot. Cost is one hash lookup per
+			distinct prefix length in the snapshot.
+		*/
+		bool add(const std::string & IP);
+		bool contains(const std::string & IP) const;
+
+	private:
+		//masked addresses, see key()
+		boost::unordered_set<std::string> Range;
+
+		//prefix lengths in Range for each address family, longest first
+		std::set<int, std::greater<int> > Prefix_v4;
+		std::set<int, std::greater<int> > Prefix_v6;
+
+		/*
+		key:
+			Returns binary address masked to prefix bits with prefix appended.
+		parse:
+			Parses IP with optional "/prefix" in to binary address (4 bytes for
+			IPv4, 16 for IPv6). Prefix defaults to full address. Returns false
+			if IP can't be parsed.
+		*/
+		static std::string key(const std::string & bin, const int prefix);
+		static bool parse(const std::string & IP, std::string & bin, int & prefix);
+	};
+
 	class wrap : public singleton_base<wrap>
 	{
 		friend class singleton_base<wrap>;
 	public:
 		/*
-		Incremented whenever IP added to blacklist. This makes it possible to
+		Incremented whenever the snapshot is replaced. This makes it possible to
 		determine if blacklist has changed without doing a database query.
 		*/
-		atomic_int<int> blacklist_state;
+		boost::atomic<int> blacklist_state;
+
+		/*
+		Readers keep a thread local copy of the snapshot and only lock Mutex to
+		get a new one when blacklist_state changes.
+		*/
+		boost::mutex Mutex;
+		boost::shared_ptr<const snapshot> Snapshot;
+		boost::thread_specific_ptr<std::pair<int, boost::shared_ptr<const snapshot> > > Local;
+
+		/*
+		get:
+			Returns snapshot. No locking unless the snapshot has changed since the
+			calling thread last got it. The reference is valid until the calling
+			thread calls get() again.
+		publish:
+			Replace snapshot and increment blacklist_state.
+			Precondition: Mutex locked.
+		*/
+		const snapshot & get();
+		void publish(const boost::shared_ptr<const snapshot> & S);
+
+	private:
+		//loads snapshot from database
+		wrap();
 	};
 };
 }//end of namespace table
@@ -1,54 +1,101 @@
 #include "db_table_hash.hpp"
 
-bool db::table::hash::add(const std::string & hash,
-	const boost::uint64_t tree_size, db::pool::proxy DB)
+bool db::table::hash::add(const std::string & hash, db::pool::proxy DB)
 {
-	if(tree_size == 0 || tree_size > 2147483647ULL){
-		return false;
-	}else{
-		std::stringstream ss;
-		ss << "INSERT INTO hash(key, hash, state, tree) VALUES(NULL, '"
-			<< hash << "', " << reserved << ", ?)";
-		return DB->blob_allocate(ss.str(), tree_size);
+	std::stringstream ss;
+	ss << "INSERT INTO hash(key, hash, state) VALUES(NULL, '"
+		<< hash << "', " << reserved << ")";
+	//0 is SQLITE_OK
+	return DB->query(ss.str()) == 0;
+}
+
+boost::shared_ptr<db::table::hash::info> db::table::hash::find(
+	const std::string & hash, db::pool::proxy DB)
+{
+	boost::shared_ptr<info> Info;
+	db::statement Stmt(*DB, "SELECT state FROM hash WHERE hash = ? LIMIT 1");
+	Stmt.bind(1, hash);
+	if(Stmt.step()){
+		Info.reset(new info());
+		Info->hash = hash;
+		Info->tree_state = static_cast<state>(Stmt.column_int64(0));
 	}
+	return Info;
 }
 
-static int find_call_back(int columns, char ** response, char ** column_name,
-	boost::shared_ptr<db::table::hash::info> & Info)
+static int migrate_call_back(int columns, char ** response, char ** column_name,
+	std::vector<std::pair<boost::int64_t, std::string> > & Blob)
 {
 	assert(columns == 2);
 	assert(std::strcmp(column_name[0], "key") == 0);
-	assert(std::strcmp(column_name[1], "state") == 0);
-	Info.reset(new db::table::hash::info());
+	assert(std::strcmp(column_name[1], "hash") == 0);
 	try{
-		Info->blob.rowid = boost::lexical_cast<boost::int64_t>(response[0]);
-		int temp = boost::lexical_cast<int>(response[1]);
-		Info->tree_state = reinterpret_cast<db::table::hash::state &>(temp);
+		Blob.push_back(std::make_pair(boost::lexical_cast<boost::int64_t>(response[0]),
+			std::string(response[1])));
 	}catch(const std::exception & e){
 		LOG << e.what();
-		Info.reset();
 	}
 	return 0;
 }
 
-boost::shared_ptr<db::table::hash::info> db::table::hash::find(
-	const std::string & hash, db::pool::proxy DB)
+static int hash_call_back(int columns, char ** response, char ** column_name,
+	std::set<std::string> & Tree_File)
 {
-	boost::shared_ptr<info> Info;
-	std::stringstream ss;
-	ss << "SELECT key, state FROM hash WHERE hash = '" << hash << "' LIMIT 1";
-	DB->query(ss.str(), boost::bind(&find_call_back, _1, _2, _3, boost::ref(Info)));
-	if(Info){
-		Info->hash = hash;
-		Info->blob.table = "hash";
-		Info->blob.column = "tree";
-	}else{
-		return boost::shared_ptr<info>();
+	assert(columns == 1);
+	assert(std::strcmp(column_name[0], "hash") == 0);
+	Tree_File.insert(tree_store::file(response[0]));
+	return 0;
+}
+
+void db::table::hash::migrate(db::pool::proxy DB)
+{
+	//copy trees stored in blobs to tree files
+	std::vector<std::pair<boost::int64_t, std::string> > Blob;
+	DB->query("SELECT key, hash FROM hash WHERE tree IS NOT NULL",
+		boost::bind(&migrate_call_back, _1, _2, _3, boost::ref(Blob)));
+	std::vector<char> buf(1024 * 1024);
+	for(std::vector<std::pair<boost::int64_t, std::string> >::iterator
+		it_cur = Blob.begin(), it_end = Blob.end(); it_cur != it_end; ++it_cur)
+	{
+		db::blob B("hash", "tree", it_cur->first);
+		boost::uint64_t size;
+		boost::shared_ptr<tree_store> Tree;
+		if(DB->blob_size(B, size) && size != 0){
+			Tree = tree_store::create(it_cur->second, size);
+		}
+		for(boost::uint64_t offset=0; Tree && offset<size; offset += buf.size()){
+			int read_size = size - offset < buf.size() ? size - offset : buf.size();
+			if(!DB->blob_read(B, &buf[0], read_size, offset)
+				|| !Tree->write(&buf[0], read_size, offset))
+			{
+				Tree.reset();
+			}
+		}
+		if(Tree){
+			std::stringstream ss;
+			ss << "UPDATE hash SET tree = NULL WHERE key = " << it_cur->first;
+			DB->query(ss.str());
+		}else{
+			//blob left in database so migration retried next program start
+			LOG << "failed to migrate tree " << it_cur->second;
+			tree_store::remove(it_cur->second);
+		}
 	}
-	if(DB->blob_size(Info->blob, Info->tree_size)){
-		return Info;
-	}else{
-		return boost::shared_ptr<info>();
+
+	//remove tree files without a record
+	std::set<std::string> Tree_File;
+	DB->query("SELECT hash FROM hash", boost::bind(&hash_call_back, _1, _2, _3,
+		boost::ref(Tree_File)));
+	try{
+		for(boost::filesystem::directory_iterator it_cur(path::tree_dir()), it_end;
+			it_cur != it_end; ++it_cur)
+		{
+			if(Tree_File.find(it_cur->path().string()) == Tree_File.end()){
+				boost::filesystem::remove(it_cur->path());
+			}
+		}
+	}catch(const std::exception & e){
+		LOG << e.what();
 	}
 }
 
@@ -58,6 +105,7 @@ void db::table::hash::remove(const std::string & hash,
 	std::stringstream ss;
 	ss << "DELETE FROM hash WHERE hash = '" << hash << "'";
 	DB->query(ss.str());
+	tree_store::remove(hash);
 }
 
 void db::table::hash::set_state(const std::string & hash,
@@ -5,15 +5,19 @@
 #include "db_all.hpp"
 #include "path.hpp"
 #include "settings.hpp"
+#include "tree_store.hpp"
 
 //include
+#include <boost/filesystem.hpp>
 #include <boost/lexical_cast.hpp>
 #include <boost/ref.hpp>
 #include <boost/thread.hpp>
 
 //standard
 #include <cstring>
+#include <set>
 #include <sstream>
+#include <vector>
 
 namespace db{
 namespace table{
@@ -30,28 +34,32 @@ public:
 	{
 	public:
 		std::string hash;
-		boost::uint64_t tree_size;
 		state tree_state;
-		db::blob blob;
 	};
 
 	/*
+	The tree itself is stored by tree_store, this table only holds metadata.
+
 	add:
-		Allocates blob of specified size for hash tree. The set_state function
-		must be called for the hash tree to not be deleted on next program start.
-		False returned if error allocating space.
+		Adds record for hash tree. The set_state function must be called for the
+		hash tree to not be deleted on next program start. False returned if the
+		record already exists.
 	find:
 		Returns a shared_ptr with information for the tree. Empty shared_ptr is
 		returned if the tree doesn't exist.
+	migrate:
+		Moves trees stored as blobs (by older versions) to tree_store files and
+		removes tree files which have no record. Called on program start.
 	remove:
-		Remove the hash tree with the specified hash.
+		Remove the hash tree with the specified hash, and it's tree file.
 	set_state:
 		Sets the state of the hash tree.
 	*/
-	static bool add(const std::string & hash, const boost::uint64_t tree_size,
+	static bool add(const std::string & hash,
 		db::pool::proxy DB = db::pool::singleton()->get());
 	static boost::shared_ptr<info> find(const std::string & hash,
-		db::pool::proxy DB = db::pool::singleton()->get());
+		db::pool::proxy DB = db::pool::singleton()->get_reader());
+	static void migrate(db::pool::proxy DB = db::pool::singleton()->get());
 	static void remove(const std::string & hash,
 		db::pool::proxy DB = db::pool::singleton()->get());
 	static void set_state(const std::string & hash, const state tree_state,
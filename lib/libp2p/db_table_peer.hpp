@@ -47,7 +47,7 @@ public:
 	static void remove(const std::string ID,
 		db::pool::proxy DB = db::pool::singleton()->get());
 	static std::vector<info> resume(
-		db::pool::proxy DB = db::pool::singleton()->get());
+		db::pool::proxy DB = db::pool::singleton()->get_reader());
 
 private:
 	peer(){}
@@ -59,7 +59,7 @@ private:
 			if(CE->value.empty()){
 				std::stringstream ss;
 				ss << "SELECT value FROM prefs WHERE key = '" << key << "'";
-				DBP_Singleton->get()->query(ss.str(),
+				DBP_Singleton->get_reader()->query(ss.str(),
 					boost::bind(&call_back, _1, _2, _3, boost::ref(value)));
 				assert(!value.empty());
 				CE->value = value;
@@ -3,11 +3,14 @@
 void db::table::share::add(const info & Info,
 	db::pool::proxy DB)
 {
-	std::stringstream ss;
-	ss << "INSERT INTO share(hash, path, file_size, last_write_time, state) VALUES('"
-		<< Info.hash << "', '" << db::escape(Info.path) << "', '" << Info.file_size
-		<< "', '" << Info.last_write_time << "', " << Info.file_state << ")";
-	DB->query(ss.str());
+	db::statement Stmt(*DB, "INSERT INTO share(hash, path, file_size, "
+		"last_write_time, state) VALUES(?, ?, ?, ?, ?)");
+	Stmt.bind(1, Info.hash);
+	Stmt.bind(2, Info.path);
+	Stmt.bind(3, static_cast<boost::int64_t>(Info.file_size));
+	Stmt.bind(4, static_cast<boost::int64_t>(Info.last_write_time));
+	Stmt.bind(5, static_cast<boost::int64_t>(Info.file_state));
+	Stmt.step();
 }
 
 //Note: throws exception if bad data
@@ -55,10 +58,9 @@ boost::shared_ptr<db::table::share::info> db::table::share::find(
 void db::table::share::remove(const std::string & path,
 	db::pool::proxy DB)
 {
-	std::string path_escaped = db::escape(path);
-	std::stringstream ss;
-	ss << "DELETE FROM share WHERE path = '" << path_escaped << "'";
-	DB->query(ss.str());
+	db::statement Stmt(*DB, "DELETE FROM share WHERE path = ?");
+	Stmt.bind(1, path);
+	Stmt.step();
 }
 
 static int resume_call_back(int columns, char ** response, char ** column_name,
@@ -98,8 +100,8 @@ void db::table::share::set_state(const std::string & hash,
 void db::table::share::update_file_size(const std::string & path,
 	const boost::uint64_t file_size, db::pool::proxy DB)
 {
-	std::stringstream ss;
-	ss << "UPDATE OR IGNORE share SET file_size = '" << file_size
-		<< "' WHERE path = '" << db::escape(path) << "'";
-	DB->query(ss.str()); 
+	db::statement Stmt(*DB, "UPDATE OR IGNORE share SET file_size = ? WHERE path = ?");
+	Stmt.bind(1, static_cast<boost::int64_t>(file_size));
+	Stmt.bind(2, path);
+	Stmt.step();
 }
@@ -72,10 +72,10 @@ public:
 	static void add(const info & FI,
 		db::pool::proxy DB = db::pool::singleton()->get());
 	static boost::shared_ptr<info> find(const std::string & hash,
-		db::pool::proxy DB = db::pool::singleton()->get());
+		db::pool::proxy DB = db::pool::singleton()->get_reader());
 	static void remove(const std::string & path,
 		db::pool::proxy DB = db::pool::singleton()->get());
-	static std::deque<info> resume(db::pool::proxy DB = db::pool::singleton()->get());
+	static std::deque<info> resume(db::pool::proxy DB = db::pool::singleton()->get_reader());
 	static void set_state(const std::string & hash, const state file_state,
 		db::pool::proxy DB = db::pool::singleton()->get());
 	static void update_file_size(const std::string & path, const boost::uint64_t file_size,
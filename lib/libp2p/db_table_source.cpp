@@ -3,9 +3,10 @@
 void db::table::source::add(const std::string & remote_ID,
 	const std::string hash, db::pool::proxy DB)
 {
-	std::stringstream ss;
-	ss << "INSERT OR IGNORE INTO source VALUES('" << remote_ID << "', '" << hash << "')";
-	DB->query(ss.str());
+	db::statement Stmt(*DB, "INSERT OR IGNORE INTO source VALUES(?, ?)");
+	Stmt.bind(1, remote_ID);
+	Stmt.bind(2, hash);
+	Stmt.step();
 }
 
 static int get_ID_call_back(int columns, char ** response, char ** column_name,
@@ -26,7 +26,7 @@ public:
 	static void add(const std::string & remote_ID, const std::string hash,
 		db::pool::proxy DB = db::pool::singleton()->get());
 	static std::list<std::string> get_ID(const std::string & hash,
-		db::pool::proxy DB = db::pool::singleton()->get());
+		db::pool::proxy DB = db::pool::singleton()->get_reader());
 
 private:
 	source(){}
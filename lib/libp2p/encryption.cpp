@@ -1,8 +1,84 @@
 #include "encryption.hpp"
 
+namespace{
+//XOR size bytes of key in to buf, a word at a time
+void xor_block(unsigned char * buf, const unsigned char * key, std::size_t size)
+{
+#ifdef __GNUC__
+	typedef unsigned char vec_t __attribute__((vector_size(16)));
+	for(; size >= sizeof(vec_t); size -= sizeof(vec_t),
+		buf += sizeof(vec_t), key += sizeof(vec_t))
+	{
+		//memcpy because buffers may not be aligned, compiles to unaligned loads
+		vec_t b, k;
+		std::memcpy(&b, buf, sizeof(vec_t));
+		std::memcpy(&k, key, sizeof(vec_t));
+		b ^= k;
+		std::memcpy(buf, &b, sizeof(vec_t));
+	}
+#endif
+	for(std::size_t x=0; x<size; ++x){
+		buf[x] ^= key[x];
+	}
+}
+}//end of unnamed namespace
+
+//BEGIN keystream
+encryption::keystream::keystream():
+	cipher(protocol_tcp::cipher_RC4),
+	block_used(block_size)
+{
+
+}
+
+void encryption::keystream::crypt(unsigned char * buf, std::size_t size)
+{
+	while(size){
+		if(block_used == block_size){
+			if(cipher == protocol_tcp::cipher_ChaCha20){
+				PRNG_ChaCha20.keystream(block, block_size);
+			}else{
+				PRNG_RC4.keystream(block, block_size);
+			}
+			block_used = 0;
+		}
+		std::size_t n = size < block_size - block_used ? size : block_size - block_used;
+		xor_block(buf, block + block_used, n);
+		block_used += n;
+		buf += n;
+		size -= n;
+	}
+}
+
+void encryption::keystream::seed_ChaCha20(const std::string & shared_key,
+	const unsigned char nonce)
+{
+	//key is SHA1(0 + k) followed by first 12 bytes of SHA1(1 + k)
+	unsigned char key[ChaCha20::key_size];
+	std::string tmp = '\0' + shared_key;
+	std::memcpy(key, SHA1(tmp.data(), tmp.size()).bin(), SHA1::bin_size);
+	tmp[0] = 1;
+	std::memcpy(key + SHA1::bin_size, SHA1(tmp.data(), tmp.size()).bin(),
+		ChaCha20::key_size - SHA1::bin_size);
+	unsigned char nonce_buf[ChaCha20::nonce_size] = {nonce};
+	PRNG_ChaCha20.seed(key, nonce_buf);
+	cipher = protocol_tcp::cipher_ChaCha20;
+	block_used = block_size;
+}
+
+void encryption::keystream::seed_RC4(const std::string & shared_key)
+{
+	PRNG_RC4.seed(reinterpret_cast<const unsigned char *>(shared_key.data()),
+		shared_key.size());
+	cipher = protocol_tcp::cipher_RC4;
+	block_used = block_size;
+}
+//END keystream
+
 encryption::encryption():
 	g("2"),
-	s(mpa::random(protocol_tcp::DH_key_size))
+	s(mpa::random(protocol_tcp::DH_key_size)),
+	cipher(protocol_tcp::cipher_RC4)
 {
 	set_enable_false();
 	enable_send_p_rA = true;
@@ -12,17 +88,15 @@ encryption::encryption():
 void encryption::crypt_recv(net::buffer & recv_buff, const int index)
 {
 	assert(enable_crypt);
-	for(int x=index; x<recv_buff.size(); ++x){
-		recv_buff[x] ^= PRNG_recv.byte();
-	}
+	assert(index <= recv_buff.size());
+	Recv.crypt(recv_buff.data() + index, recv_buff.size() - index);
 }
 
 void encryption::crypt_send(net::buffer & send_buff, const int index)
 {
 	assert(enable_crypt);
-	for(int x=index; x<send_buff.size(); ++x){
-		send_buff[x] ^= PRNG_send.byte();
-	}
+	assert(index <= send_buff.size());
+	Send.crypt(send_buff.data() + index, send_buff.size() - index);
 }
 
 bool encryption::ready()
@@ -36,34 +110,58 @@ bool encryption::recv_p_rA(const net::buffer & buf)
 	set_enable_false();
 	enable_send_rB = true;
 
-	assert(buf.size() == protocol_tcp::DH_key_size * 2);
+	assert(buf.size() == protocol_tcp::key_exchange_p_rA_size);
 	p = mpa::mpint(buf.data(), protocol_tcp::DH_key_size);
 	if(!mpa::is_prime(p)){
 		return false;
 	}
+	//choose best cipher offered
+	unsigned char offered = buf[protocol_tcp::DH_key_size * 2];
+	if(settings::CHACHA20 && (offered & protocol_tcp::cipher_ChaCha20)){
+		cipher = protocol_tcp::cipher_ChaCha20;
+	}else if(offered & protocol_tcp::cipher_RC4){
+		cipher = protocol_tcp::cipher_RC4;
+	}else{
+		return false;
+	}
 	remote_result = mpa::mpint(buf.data() + protocol_tcp::DH_key_size, protocol_tcp::DH_key_size);
 	local_result = mpa::exptmod(g, s, p);
 	shared_key = mpa::exptmod(remote_result, s, p);
-
-	std::string bin = shared_key.bin(protocol_tcp::DH_key_size);
-	PRNG_send.seed(reinterpret_cast<const unsigned char *>(bin.data()), bin.size());
-	PRNG_recv.seed(reinterpret_cast<const unsigned char *>(bin.data()), bin.size());
+	seed(false);
 	return true;
 }
 
-void encryption::recv_rB(const net::buffer & buf)
+bool encryption::recv_rB(const net::buffer & buf)
 {
 	assert(enable_recv_rB);
 	set_enable_false();
 	enable_crypt = true;
 
-	assert(buf.size() == protocol_tcp::DH_key_size);
+	assert(buf.size() == protocol_tcp::key_exchange_rB_size);
+	cipher = buf[protocol_tcp::DH_key_size];
+	if(cipher != protocol_tcp::cipher_RC4 && (cipher != protocol_tcp::cipher_ChaCha20
+		|| !settings::CHACHA20))
+	{
+		//chose cipher we didn't offer
+		return false;
+	}
 	remote_result = mpa::mpint(buf.data(), protocol_tcp::DH_key_size);
 	shared_key = mpa::exptmod(remote_result, s, p);
+	seed(true);
+	return true;
+}
 
+void encryption::seed(const bool initiator)
+{
 	std::string bin = shared_key.bin(protocol_tcp::DH_key_size);
-	PRNG_send.seed(reinterpret_cast<const unsigned char *>(bin.data()), bin.size());
-	PRNG_recv.seed(reinterpret_cast<const unsigned char *>(bin.data()), bin.size());
+	if(cipher == protocol_tcp::cipher_ChaCha20){
+		//nonce 0 for initiator -> responder, 1 for responder -> initiator
+		Send.seed_ChaCha20(bin, initiator ? 0 : 1);
+		Recv.seed_ChaCha20(bin, initiator ? 1 : 0);
+	}else{
+		Send.seed_RC4(bin);
+		Recv.seed_RC4(bin);
+	}
 }
 
 net::buffer encryption::send_p_rA()
@@ -77,6 +175,9 @@ net::buffer encryption::send_p_rA()
 	buf.append(p.bin(protocol_tcp::DH_key_size));
 	local_result = mpa::exptmod(g, s, p);
 	buf.append(local_result.bin(protocol_tcp::DH_key_size));
+	//ciphers we support
+	buf.append(protocol_tcp::cipher_RC4
+		| (settings::CHACHA20 ? protocol_tcp::cipher_ChaCha20 : 0));
 	return buf;
 }
 
@@ -88,6 +189,7 @@ net::buffer encryption::send_rB()
 
 	net::buffer buf;
 	buf.append(local_result.bin(protocol_tcp::DH_key_size));
+	buf.append(cipher);
 	return buf;
 }
 
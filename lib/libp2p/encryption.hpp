@@ -8,10 +8,13 @@
 #include "settings.hpp"
 
 //include
+#include <boost/cstdint.hpp>
 #include <boost/utility.hpp>
+#include <ChaCha20.hpp>
 #include <RC4.hpp>
 #include <mpa.hpp>
 #include <net/net.hpp>
+#include <SHA1.hpp>
 
 //std
 #include <cassert>
@@ -26,12 +29,14 @@ public:
 
 	/*
 	See protocol documentation for more information.
-	Note: recv_p_rA returns false if invalid prime received.
+	Note: recv_p_rA returns false if invalid prime received or no cipher in
+		common.
+	Note: recv_rB returns false if remote host chose cipher we didn't offer.
 	*/
 	net::buffer send_p_rA();
 	bool recv_p_rA(const net::buffer & buf);
 	net::buffer send_rB();
-	void recv_rB(const net::buffer & buf);
+	bool recv_rB(const net::buffer & buf);
 
 	/*
 	Used to encrypt/decrypt buffers.
@@ -53,9 +58,44 @@ private:
 	mpa::mpint remote_result; //result of remote host g^s % p
 	mpa::mpint shared_key;    //agreed upon key (used as seed for PRNG)
 
-	//stream cypher
-	RC4 PRNG_send;
-	RC4 PRNG_recv;
+	/*
+	Keystream for one direction. Keystream is generated a block at a time and
+	XOR'd against buffers.
+	*/
+	class keystream
+	{
+	public:
+		keystream();
+
+		/*
+		crypt:
+			XOR size bytes of buf with keystream.
+		seed_ChaCha20:
+			Use ChaCha20 with key derived from shared key. The nonce must differ
+			for each direction.
+		seed_RC4:
+			Use RC4 seeded with shared key.
+		*/
+		void crypt(unsigned char * buf, std::size_t size);
+		void seed_ChaCha20(const std::string & shared_key, const unsigned char nonce);
+		void seed_RC4(const std::string & shared_key);
+
+	private:
+		//bytes of keystream generated at once
+		static const unsigned block_size = 16 * 1024;
+
+		unsigned char cipher; //protocol_tcp::cipher_*
+		RC4 PRNG_RC4;
+		ChaCha20 PRNG_ChaCha20;
+		unsigned char block[block_size];
+		unsigned block_used; //bytes of block already used
+	};
+
+	keystream Send;
+	keystream Recv;
+
+	//cipher chosen during key exchange, protocol_tcp::cipher_*
+	unsigned char cipher;
 
 	//used to assert functions not called out of order
 	bool enable_send_p_rA;
@@ -64,7 +104,14 @@ private:
 	bool enable_recv_rB;
 	bool enable_crypt;
 
-	//sets all of the enable_* flags to false
+	/*
+	seed:
+		Seed keystreams from shared_key. The initiator is the host that sent
+		p_rA.
+	set_enable_false:
+		Sets all of the enable_* flags to false.
+	*/
+	void seed(const bool initiator);
 	void set_enable_false();
 };
 #endif
@@ -179,7 +179,9 @@ bool exchange_tcp::recv_p_rA(const net::buffer & buf,
 
 bool exchange_tcp::recv_rB(const net::buffer & buf, net::connection_info & CI)
 {
-	Encryption.recv_rB(buf);
+	if(!Encryption.recv_rB(buf)){
+		return false;
+	}
 	//unencrypt any remaining buffer
 	Encryption.crypt_recv(CI.recv_buf);
 	send_buffered();
@@ -3,22 +3,19 @@
 //BEGIN expect_response_element
 exchange_udp::expect_response_element::expect_response_element(
 	boost::shared_ptr<message_udp::recv::base> message_in,
-	boost::function<void()> timeout_call_back_in
+	boost::function<void()> timeout_call_back_in,
+	const timer_wheel::handle & Timer_in
 ):
 	message(message_in),
 	timeout_call_back(timeout_call_back_in),
-	time_first_expected(std::time(NULL))
+	Timer(Timer_in)
 {
 
 }
-
-bool exchange_udp::expect_response_element::timed_out()
-{
-	return std::time(NULL) - time_first_expected > protocol_udp::response_timeout;
-}
 //END expect_response_element
 
-exchange_udp::exchange_udp()
+exchange_udp::exchange_udp(timer_wheel & Timer_Wheel_in):
+	Timer_Wheel(Timer_Wheel_in)
 {
 	//setup UDP listener
 	std::set<net::endpoint> E = net::get_endpoint(
@@ -28,22 +25,10 @@ exchange_udp::exchange_udp()
 	assert(!E.empty());
 	ndgram.open(*E.begin());
 	assert(ndgram.is_open());
-}
-
-void exchange_udp::check_timeouts()
-{
-	for(std::multimap<net::endpoint, expect_response_element>::iterator
-		it_cur = Expect_Response.begin(), it_end = Expect_Response.end();
-		it_cur != it_end;)
-	{
-		if(it_cur->second.timed_out()){
-			if(it_cur->second.timeout_call_back){
-				it_cur->second.timeout_call_back();
-			}
-			Expect_Response.erase(it_cur++);
-		}else{
-			++it_cur;
-		}
+	//tick drains socket until no datagram to recv
+	if(!ndgram.set_non_blocking(true)){
+		LOG << "failed to set non-blocking";
+		exit(1);
 	}
 }
 
@@ -75,45 +60,44 @@ void exchange_udp::expect_response(boost::shared_ptr<message_udp::recv::base> M,
 	const net::endpoint & endpoint,
 	boost::function<void()> timeout_call_back)
 {
-	Expect_Response.insert(std::make_pair(endpoint,
-		expect_response_element(M, timeout_call_back)));
+	Expect_Response.insert(std::make_pair(endpoint, expect_response_element(M,
+		timeout_call_back, Timer_Wheel.arm(protocol_udp::response_timeout * 1000,
+		boost::bind(&exchange_udp::timeout, this, endpoint, M)))));
 }
 
-void exchange_udp::tick()
+void exchange_udp::flush()
 {
-	//wait for message to arrive
-	std::set<int> read, write;
-	read.insert(ndgram.socket());
-	select(read, write, 1000);
-
-	if(read.empty()){
-		//nothing received
-		check_timeouts();
-		return;
-	}
-
-	//recv message
-	boost::optional<net::endpoint> from;
-	net::buffer recv_buf;
-	int n_bytes = ndgram.recv(recv_buf, from);
-	if(n_bytes > 0){
-		Download.add(n_bytes);
-	}else{
-		LOG << "recv error";
-		exit(1);
+	while(!Send_Queue.empty()){
+		int n_msg = ndgram.send(Send_Queue);
+		if(n_msg > 0){
+			unsigned n_bytes = 0;
+			for(int x=0; x<n_msg; ++x){
+				n_bytes += Send_Queue[x].buf.size();
+			}
+			Upload.add(n_bytes);
+			Send_Queue.erase(Send_Queue.begin(), Send_Queue.begin() + n_msg);
+		}else if(ndgram.is_open()){
+			//OS buffers full, tick will wait for socket to be writeable
+			break;
+		}else{
+			LOG << "UDP send error";
+			exit(1);
+		}
 	}
-	assert(from);
+}
 
+void exchange_udp::recv(const net::buffer & recv_buf, const net::endpoint & from)
+{
 	//check if expected response
 	std::pair<std::multimap<net::endpoint, expect_response_element>::iterator,
 		std::multimap<net::endpoint, expect_response_element>::iterator >
-		range = Expect_Response.equal_range(*from);
+		range = Expect_Response.equal_range(from);
 	for(; range.first != range.second; ++range.first){
-		if(range.first->second.message->recv(recv_buf, *from)){
+		if(range.first->second.message->recv(recv_buf, from)){
+			Timer_Wheel.cancel(range.first->second.Timer);
 			Expect_Response.erase(range.first);
 			return;
 		}
-
 	}
 
 	//check if expected anytime
@@ -121,51 +105,73 @@ void exchange_udp::tick()
 		it_cur = Expect_Anytime.begin(), it_end = Expect_Anytime.end();
 		it_cur != it_end; ++it_cur)
 	{
-		if((*it_cur)->recv(recv_buf, *from)){
+		if((*it_cur)->recv(recv_buf, from)){
 			return;
 		}
 	}
+}
+
+void exchange_udp::send(boost::shared_ptr<message_udp::send::base> M,
+	const net::endpoint & ep)
+{
+	assert(!M->buf.empty());
+	Send_Queue.push_back(net::ndgram::datagram(ep));
+	Send_Queue.back().buf.swap(M->buf);
+}
 
-	check_timeouts();
+void exchange_udp::tick()
+{
+	//send messages queued since last tick
+	flush();
 
-	//try to send any unsent messages
-	while(!Send_Queue.empty()){
-		int n_bytes = ndgram.send(Send_Queue.front().first->buf, Send_Queue.front().second);
-		if(n_bytes > 0){
-			Upload.add(n_bytes);
-			Send_Queue.pop_front();
-		}else{
-			if(ndgram.is_open()){
-				LOG << "OS buffers full";
+	//wait for message to arrive, or for room in OS buffer
+	std::set<int> read, write;
+	read.insert(ndgram.socket());
+	if(!Send_Queue.empty()){
+		write.insert(ndgram.socket());
+	}
+	select(read, write, Timer_Wheel.next_ms(1000));
+
+	if(!read.empty()){
+		//drain received messages, a batch per system call
+		std::deque<net::ndgram::datagram> batch;
+		for(unsigned x=0; x<max_recv_batches; ++x){
+			if(ndgram.recv(batch) <= 0){
+				if(!ndgram.is_open()){
+					LOG << "recv error";
+					exit(1);
+				}
 				break;
-			}else{
-				LOG << "UDP send error";
-				exit(1);
 			}
-		}
-
-		if(n_bytes <= 0){
-
-		}else{
-
+			for(std::deque<net::ndgram::datagram>::iterator it_cur = batch.begin(),
+				it_end = batch.end(); it_cur != it_end; ++it_cur)
+			{
+				Download.add(it_cur->buf.size());
+				recv(it_cur->buf, it_cur->ep);
+			}
+			batch.clear();
 		}
 	}
+
+	//send responses to messages received
+	flush();
 }
 
-void exchange_udp::send(boost::shared_ptr<message_udp::send::base> M,
-	const net::endpoint & ep)
+void exchange_udp::timeout(const net::endpoint ep,
+	const boost::shared_ptr<message_udp::recv::base> M)
 {
-	assert(!M->buf.empty());
-	int n_bytes = ndgram.send(M->buf, ep);
-	if(n_bytes > 0){
-		Upload.add(n_bytes);
-	}else{
-		if(ndgram.is_open()){
-			LOG << "OS buffers full";
-			Send_Queue.push_back(std::make_pair(M, ep));
-		}else{
-			LOG << "UDP send error";
-			exit(1);
+	std::pair<std::multimap<net::endpoint, expect_response_element>::iterator,
+		std::multimap<net::endpoint, expect_response_element>::iterator >
+		range = Expect_Response.equal_range(ep);
+	for(; range.first != range.second; ++range.first){
+		if(range.first->second.message == M){
+			boost::function<void()> timeout_call_back
+				= range.first->second.timeout_call_back;
+			Expect_Response.erase(range.first);
+			if(timeout_call_back){
+				timeout_call_back();
+			}
+			return;
 		}
 	}
 }
@@ -7,16 +7,18 @@
 
 //include
 #include <boost/utility.hpp>
+#include <timer_wheel.hpp>
 
 class exchange_udp : private boost::noncopyable
 {
 public:
-	exchange_udp();
+	explicit exchange_udp(timer_wheel & Timer_Wheel_in);
 
 	/*
 	tick:
-		Called to recv messages and do other tasks. Blocks for a short time if no
-		messages to recv.
+		Called to recv messages and do other tasks. Blocks until a message is
+		received, the next timer expires, or one second, whichever is soonest.
+		Queued messages are sent, and received messages drained, in batches.
 	*/
 	void tick();
 
@@ -28,9 +30,9 @@ public:
 	expect_response:
 		After sending a message that expects a response this function should be
 		called with the message expected. Optionally, a timeout call back can be
-		specified.
+		specified. The timeout is a timer in the timer_wheel.
 	send:
-		Sends a message.
+		Queues a message to send. Queued messages are sent on the next tick.
 	*/
 	void expect_anytime(boost::shared_ptr<message_udp::recv::base> M);
 	void expect_anytime_remove(boost::shared_ptr<message_udp::send::base> M);
@@ -50,6 +52,7 @@ public:
 	unsigned upload_rate();
 
 private:
+	timer_wheel & Timer_Wheel;
 	net::ndgram ndgram;
 	net::select select;
 	net::speed_calc Download, Upload;
@@ -59,14 +62,13 @@ private:
 	public:
 		expect_response_element(
 			boost::shared_ptr<message_udp::recv::base> message_in,
-			boost::function<void()> timeout_call_back_in
+			boost::function<void()> timeout_call_back_in,
+			const timer_wheel::handle & Timer_in
 		);
 		boost::shared_ptr<message_udp::recv::base> message;
 		boost::function<void()> timeout_call_back;
-		//returns true if timed out
-		bool timed_out();
-	private:
-		std::time_t time_first_expected;
+		//canceled when response received
+		timer_wheel::handle Timer;
 	};
 
 	/*
@@ -76,16 +78,28 @@ private:
 	Expect_Anytime:
 		Incoming messages that we expect anytime. These are not responses.
 	Send_Queue:
-		If OS buffer becomes full messages to send are queued.
+		Messages to send. Flushed with as few system calls as possible.
 	*/
 	std::multimap<net::endpoint, expect_response_element> Expect_Response;
 	std::list<boost::shared_ptr<message_udp::recv::base> > Expect_Anytime;
-	std::list<std::pair<boost::shared_ptr<message_udp::send::base>, net::endpoint> > Send_Queue;
+	std::deque<net::ndgram::datagram> Send_Queue;
+
+	//max batches to recv per tick, so timers aren't starved by a flood
+	static const unsigned max_recv_batches = 16;
 
 	/*
-	check_timeouts:
-		Checks for timeouts and does timeout call backs.
+	flush:
+		Sends messages in Send_Queue until empty or OS buffer full.
+	recv:
+		Passes received message to expected response or expected anytime
+		message.
+	timeout:
+		Timer call back for expected response that wasn't received. Removes
+		expected response and does timeout call back.
 	*/
-	void check_timeouts();
+	void flush();
+	void recv(const net::buffer & recv_buf, const net::endpoint & from);
+	void timeout(const net::endpoint ep,
+		const boost::shared_ptr<message_udp::recv::base> M);
 };
 #endif
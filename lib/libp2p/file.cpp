@@ -40,44 +40,57 @@ boost::uint64_t file::calc_file_block_count(const boost::uint64_t file_size)
 
 bool file::read_block(const boost::uint64_t block_num, net::buffer & buf)
 {
-	std::fstream fin(path.c_str(), std::ios::in | std::ios::out | std::ios::binary);
-	fin.seekg(block_num * protocol_tcp::file_block_size);
-	if(fin.is_open()){
-		unsigned size = block_size(block_num);
-		buf.tail_reserve(size);
-		fin.read(reinterpret_cast<char *>(buf.tail_start()), size);
-		if(fin.gcount() == size){
-			buf.tail_resize(size);
-			return true;
-		}else{
-			buf.tail_reserve(0);
-			return false;
-		}
+	boost::shared_ptr<file_cache::descriptor> D = file_cache::singleton()->open(path);
+	if(!D){
+		return false;
+	}
+	unsigned size = block_size(block_num);
+	buf.tail_reserve(size);
+	if(D->read(reinterpret_cast<char *>(buf.tail_start()), size,
+		block_num * protocol_tcp::file_block_size))
+	{
+		buf.tail_resize(size);
+		return true;
 	}else{
-		LOG << "failed to open " << path;
+		buf.tail_reserve(0);
 		return false;
 	}
 }
 
-bool file::write_block(const boost::uint64_t block_num, const net::buffer & buf)
+bool file::read_blocks(const boost::uint64_t block_num,
+	std::vector<net::buffer> & bufs)
 {
-	std::fstream fout(path.c_str(), std::ios::in | std::ios::out | std::ios::binary);
-	if(!fout.is_open()){
-		//try to create
-		LOG << "create file \"" << path << "\"";
-		fout.open(path.c_str(), std::ios::out | std::ios::binary);
-		fout.close();
-		fout.open(path.c_str(), std::ios::in | std::ios::out | std::ios::binary);
-		if(!fout.is_open()){
-			LOG << "failed to create \"" << path << "\"";
-			return false;
+	assert(block_num + bufs.size() <= file_block_count);
+	boost::shared_ptr<file_cache::descriptor> D = file_cache::singleton()->open(path);
+	if(!D){
+		return false;
+	}
+	std::vector<iovec> iov(bufs.size());
+	for(std::size_t x=0; x<bufs.size(); ++x){
+		unsigned size = block_size(block_num + x);
+		bufs[x].tail_reserve(size);
+		iov[x].iov_base = bufs[x].tail_start();
+		iov[x].iov_len = size;
+	}
+	bool good = iov.empty() || D->readv(&iov[0], iov.size(),
+		block_num * protocol_tcp::file_block_size);
+	for(std::size_t x=0; x<bufs.size(); ++x){
+		if(good){
+			bufs[x].tail_resize(block_size(block_num + x));
+		}else{
+			bufs[x].tail_reserve(0);
 		}
 	}
-	fout.seekp(block_num * protocol_tcp::file_block_size);
-	fout.write(reinterpret_cast<const char *>(buf.data()), buf.size());
-	if(!fout.is_open()){
-		LOG << "failed to open " << path;
+	return good;
+}
+
+bool file::write_block(const boost::uint64_t block_num, const net::buffer & buf)
+{
+	boost::shared_ptr<file_cache::descriptor> D = file_cache::singleton()->open(
+		path, true, settings::FILE_PREALLOCATE ? file_size : 0);
+	if(!D){
 		return false;
 	}
-	return true;
+	return D->write(reinterpret_cast<const char *>(buf.data()), buf.size(),
+		block_num * protocol_tcp::file_block_size);
 }
@@ -4,6 +4,7 @@
 //custom
 #include "block_request.hpp"
 #include "db_all.hpp"
+#include "file_cache.hpp"
 #include "file_info.hpp"
 #include "protocol_tcp.hpp"
 
@@ -13,6 +14,7 @@
 
 //standard
 #include <string>
+#include <vector>
 
 class file : private boost::noncopyable
 {
@@ -31,12 +33,18 @@ public:
 	read_block:
 		Reads file block and appends it to buf. Returns true if read succeeded,
 		false if read failed.
+	read_blocks:
+		Reads bufs.size() consecutive file blocks, starting at block_num, with a
+		single vectored read. Each block is appended to the corresponding buffer.
+		Returns true if read succeeded, false if read failed.
+		Precondition: block_num + bufs.size() <= file_block_count
 	write_block:
 		Write block to file. Returns true if write succeeded, false if write
 		failed.
 	*/
 	unsigned block_size(const boost::uint64_t block_num);
 	bool read_block(const boost::uint64_t block_num, net::buffer & buf);
+	bool read_blocks(const boost::uint64_t block_num, std::vector<net::buffer> & bufs);
 	bool write_block(const boost::uint64_t block_num, const net::buffer & buf);
 
 	/*
@@ -0,0 +1,181 @@
+#include "file_cache.hpp"
+
+//BEGIN descriptor
+file_cache::descriptor::descriptor(const int FD_in, const bool writeable_in):
+	FD(FD_in),
+	_writeable(writeable_in)
+{
+
+}
+
+file_cache::descriptor::~descriptor()
+{
+	if(::close(FD) == -1){
+		LOG << strerror(errno);
+	}
+}
+
+bool file_cache::descriptor::read(char * buf, const std::size_t size,
+	const boost::uint64_t offset)
+{
+	std::size_t done = 0;
+	while(done < size){
+		ssize_t n_bytes = ::pread(FD, buf + done, size - done, offset + done);
+		if(n_bytes == -1){
+			if(errno == EINTR){
+				continue;
+			}
+			LOG << strerror(errno);
+			return false;
+		}else if(n_bytes == 0){
+			//end of file
+			return false;
+		}
+		done += n_bytes;
+	}
+	return true;
+}
+
+bool file_cache::descriptor::readv(iovec * iov, int iov_cnt,
+	boost::uint64_t offset)
+{
+	while(iov_cnt > 0){
+		ssize_t n_bytes = ::preadv(FD, iov, iov_cnt, offset);
+		if(n_bytes == -1){
+			if(errno == EINTR){
+				continue;
+			}
+			LOG << strerror(errno);
+			return false;
+		}else if(n_bytes == 0){
+			//end of file
+			return false;
+		}
+		offset += n_bytes;
+		//skip filled buffers, adjust partially filled buffer
+		while(iov_cnt > 0 && static_cast<std::size_t>(n_bytes) >= iov->iov_len){
+			n_bytes -= iov->iov_len;
+			++iov;
+			--iov_cnt;
+		}
+		if(iov_cnt > 0){
+			iov->iov_base = static_cast<char *>(iov->iov_base) + n_bytes;
+			iov->iov_len -= n_bytes;
+		}
+	}
+	return true;
+}
+
+void file_cache::descriptor::sequential()
+{
+#ifdef POSIX_FADV_SEQUENTIAL
+	int err = ::posix_fadvise(FD, 0, 0, POSIX_FADV_SEQUENTIAL);
+	if(err != 0){
+		LOG << strerror(err);
+	}
+#endif
+}
+
+bool file_cache::descriptor::writeable() const
+{
+	return _writeable;
+}
+
+bool file_cache::descriptor::write(const char * buf, const std::size_t size,
+	const boost::uint64_t offset)
+{
+	std::size_t done = 0;
+	while(done < size){
+		ssize_t n_bytes = ::pwrite(FD, buf + done, size - done, offset + done);
+		if(n_bytes == -1){
+			if(errno == EINTR){
+				continue;
+			}
+			LOG << strerror(errno);
+			return false;
+		}
+		done += n_bytes;
+	}
+	return true;
+}
+//END descriptor
+
+file_cache::file_cache()
+{
+
+}
+
+void file_cache::erase(const std::string & path)
+{
+	boost::mutex::scoped_lock lock(Mutex);
+	std::map<std::string, lru_t::iterator>::iterator it = Path.find(path);
+	if(it != Path.end()){
+		LRU.erase(it->second);
+		Path.erase(it);
+	}
+}
+
+boost::shared_ptr<file_cache::descriptor> file_cache::open(
+	const std::string & path, const bool writeable,
+	const boost::uint64_t allocate_size)
+{
+	{//BEGIN lock scope
+	boost::mutex::scoped_lock lock(Mutex);
+	std::map<std::string, lru_t::iterator>::iterator it = Path.find(path);
+	if(it != Path.end() && (!writeable || it->second->second->writeable())){
+		//move to front of LRU
+		LRU.splice(LRU.begin(), LRU, it->second);
+		return LRU.front().second;
+	}
+	}//END lock scope
+
+	//open without lock held so other files aren't blocked by slow open
+	int FD;
+	bool created = false;
+	if(writeable){
+		FD = ::open(path.c_str(), O_RDWR | O_CREAT | O_EXCL, 0644);
+		if(FD != -1){
+			LOG << "create file \"" << path << "\"";
+			created = true;
+		}else if(errno == EEXIST){
+			FD = ::open(path.c_str(), O_RDWR);
+		}
+	}else{
+		FD = ::open(path.c_str(), O_RDONLY);
+	}
+	if(FD == -1){
+		LOG << "failed to open \"" << path << "\": " << strerror(errno);
+		return boost::shared_ptr<descriptor>();
+	}
+	#ifdef __linux__
+	if(created && allocate_size != 0){
+		//failure not fatal, file will be extended as blocks written
+		int ret = posix_fallocate(FD, 0, allocate_size);
+		if(ret != 0){
+			LOG << "failed to allocate \"" << path << "\": " << strerror(ret);
+		}
+	}
+	#endif
+	boost::shared_ptr<descriptor> D(new descriptor(FD, writeable));
+
+	boost::mutex::scoped_lock lock(Mutex);
+	std::map<std::string, lru_t::iterator>::iterator it = Path.find(path);
+	if(it != Path.end()){
+		if(!writeable || it->second->second->writeable()){
+			//another thread opened file while we were, use theirs
+			LRU.splice(LRU.begin(), LRU, it->second);
+			return LRU.front().second;
+		}
+		//replace read-only descriptor with writeable one
+		LRU.erase(it->second);
+		Path.erase(it);
+	}
+	LRU.push_front(std::make_pair(path, D));
+	Path.insert(std::make_pair(path, LRU.begin()));
+	while(LRU.size() > settings::FILE_CACHE_SIZE){
+		//descriptors still in use are closed when the last user is done
+		Path.erase(LRU.back().first);
+		LRU.pop_back();
+	}
+	return D;
+}
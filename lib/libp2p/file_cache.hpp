@@ -0,0 +1,93 @@
+/*
+Caches open file descriptors so reading/writing a block doesn't require the
+file to be opened and closed. Reads/writes are positional so one descriptor can
+be shared by multiple threads.
+*/
+#ifndef H_FILE_CACHE
+#define H_FILE_CACHE
+
+//custom
+#include "settings.hpp"
+
+//include
+#include <boost/cstdint.hpp>
+#include <boost/shared_ptr.hpp>
+#include <boost/thread.hpp>
+#include <boost/utility.hpp>
+#include <logger.hpp>
+#include <portable.hpp>
+#include <singleton.hpp>
+
+//standard
+#include <list>
+#include <map>
+#include <string>
+
+class file_cache : public singleton_base<file_cache>
+{
+	friend class singleton_base<file_cache>;
+public:
+	/*
+	An open file. The file is closed when the last shared_ptr to it is
+	destroyed, even if it has already been evicted from the cache.
+	*/
+	class descriptor : private boost::noncopyable
+	{
+		friend class file_cache;
+	public:
+		~descriptor();
+
+		/*
+		read:
+			Read size bytes at offset in to buf. Returns false if all bytes could
+			not be read.
+		readv:
+			Read bytes at offset in to iov_cnt buffers (one syscall per run of
+			buffers). Returns false if all buffers could not be filled.
+			Precondition: iov_cnt <= IOV_MAX.
+		sequential:
+			Hint that the file will be read sequentially so the OS reads ahead
+			more aggressively. Does nothing where not supported.
+		writeable:
+			Returns true if the file was opened for writing.
+		write:
+			Write size bytes from buf at offset. Returns false if all bytes could
+			not be written.
+		*/
+		bool read(char * buf, const std::size_t size, const boost::uint64_t offset);
+		bool readv(iovec * iov, int iov_cnt, boost::uint64_t offset);
+		void sequential();
+		bool writeable() const;
+		bool write(const char * buf, const std::size_t size, const boost::uint64_t offset);
+
+	private:
+		descriptor(const int FD_in, const bool writeable_in);
+
+		const int FD;
+		const bool _writeable;
+	};
+
+	/*
+	erase:
+		Remove the descriptor for path from the cache. Must be called when a
+		file is removed or replaced so a stale descriptor isn't used.
+	open:
+		Returns descriptor for path, or empty shared_ptr if file couldn't be
+		opened. If writeable is true the file is opened read/write and created if
+		it doesn't exist. If the file is created and allocate_size is non-zero
+		disk space is reserved for the whole file.
+	*/
+	void erase(const std::string & path);
+	boost::shared_ptr<descriptor> open(const std::string & path,
+		const bool writeable = false, const boost::uint64_t allocate_size = 0);
+
+private:
+	file_cache();
+
+	typedef std::list<std::pair<std::string, boost::shared_ptr<descriptor> > > lru_t;
+
+	boost::mutex Mutex;                        //locks all data members
+	lru_t LRU;                                 //most recently used at front
+	std::map<std::string, lru_t::iterator> Path; //path mapped to element in LRU
+};
+#endif
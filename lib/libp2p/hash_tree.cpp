@@ -1,10 +1,96 @@
 #include "hash_tree.hpp"
 
+namespace{
+//pieces hashed by one Hash_Pool job (640KiB of file blocks)
+const unsigned chunk_pieces = 64;
+
+//chunk of pieces read by create() and hashed by Hash_Pool
+class hash_chunk
+{
+public:
+	hash_chunk(const boost::uint64_t piece_in, const unsigned pieces_in):
+		piece(piece_in),
+		pieces(pieces_in),
+		size(0),
+		buf(pieces_in * protocol_tcp::file_block_size),
+		hash(pieces_in * SHA1::bin_size),
+		done(false)
+	{}
+
+	const boost::uint64_t piece; //number of first piece in row
+	const unsigned pieces;       //number of pieces in chunk
+	unsigned size;               //bytes read in to buf
+	std::vector<char> buf;       //pieces to hash
+	std::vector<char> hash;      //hash of each piece
+	bool done;                   //true when hash filled, locked by mutex
+
+	//hash all pieces, last piece may be partial
+	void run(boost::mutex & mutex, boost::condition_variable_any & cond)
+	{
+		const char * piece_buf[chunk_pieces];
+		std::size_t piece_size[chunk_pieces];
+		for(unsigned x=0; x<pieces; ++x){
+			unsigned offset = x * protocol_tcp::file_block_size;
+			piece_buf[x] = &buf[offset];
+			piece_size[x] = size - offset < protocol_tcp::file_block_size ?
+				size - offset : protocol_tcp::file_block_size;
+		}
+		SHA1::multi(piece_buf, piece_size, pieces, &hash[0]);
+		boost::mutex::scoped_lock lock(mutex);
+		done = true;
+		cond.notify_all();
+	}
+};
+
+//returns copying if file grows while hashing, checked once per second
+class check_copying
+{
+public:
+	check_copying(const file_info & FI_in):
+		FI(FI_in),
+		time(0)
+	{}
+
+	hash_tree::status operator () ()
+	{
+		if(std::time(NULL) != time){
+			try{
+				if(FI.file_size < boost::filesystem::file_size(FI.path)){
+					LOG << "copying " << FI.path;
+					return hash_tree::copying;
+				}
+				time = std::time(NULL);
+			}catch(const std::exception & e){
+				LOG << "error reading " << FI.path;
+				return hash_tree::io_error;
+			}
+		}
+		return hash_tree::good;
+	}
+
+private:
+	const file_info FI;
+	std::time_t time;
+};
+
+//read_func for hashing a row of the tmp file
+bool read_tmp(std::fstream & tmp, char * buf, const unsigned size,
+	const boost::uint64_t offset)
+{
+	tmp.seekg(offset, std::ios::beg);
+	tmp.read(buf, size);
+	return tmp.gcount() == size;
+}
+}//end of unnamed namespace
+
 //BEGIN static_wrap
 boost::once_flag hash_tree::static_wrap::once_flag = BOOST_ONCE_INIT;
 
 hash_tree::static_wrap::static_objects::static_objects():
-	stopped(false)
+	stopped(false),
+	hash_threads(boost::thread::hardware_concurrency() == 0 ?
+		1 : boost::thread::hardware_concurrency()),
+	Hash_Pool(hash_threads)
 {
 
 }
@@ -29,12 +115,17 @@ hash_tree::hash_tree(const file_info & FI):
 	boost::shared_ptr<db::table::hash::info> info = db::table::hash::find(TI.hash);
 	if(info){
 		//opened existing hash tree
-		boost::uint64_t size;
-		if(!db::pool::singleton()->get()->blob_size(info->blob, size)){
-			throw std::runtime_error("error checking tree size");
+		Tree = tree_store::open(TI.hash);
+		if(!Tree){
+			//tree file missing, download tree again
+			Tree = tree_store::create(TI.hash, TI.tree_size);
+			if(!Tree){
+				throw std::runtime_error("failed hash tree allocate");
+			}
+			db::table::hash::set_state(TI.hash, db::table::hash::downloading);
 		}
 		//only open tree if the size is what we expect
-		if(TI.tree_size != size){
+		if(TI.tree_size != Tree->size()){
 			/*
 			It is possible someone might encounter two files of different sizes
 			that have the same hash. We don't account for this because it's so
@@ -42,17 +133,15 @@ hash_tree::hash_tree(const file_info & FI):
 			*/
 			throw std::runtime_error("incorrect tree size");
 		}
-		const_cast<db::blob &>(blob) = info->blob;
 	}else{
 		//allocate space to reconstruct hash tree
-		if(db::table::hash::add(TI.hash, TI.tree_size)){
-			db::table::hash::set_state(TI.hash, db::table::hash::downloading);
-			info = db::table::hash::find(TI.hash);
-			if(info){
-				const_cast<db::blob &>(blob) = info->blob;
-			}else{
-				throw std::runtime_error("failed hash tree open");
+		if(db::table::hash::add(TI.hash)){
+			Tree = tree_store::create(TI.hash, TI.tree_size);
+			if(!Tree){
+				db::table::hash::remove(TI.hash);
+				throw std::runtime_error("failed hash tree allocate");
 			}
+			db::table::hash::set_state(TI.hash, db::table::hash::downloading);
 		}else{
 			throw std::runtime_error("failed hash tree allocate");
 		}
@@ -85,15 +174,13 @@ hash_tree::status hash_tree::check() const
 hash_tree::status hash_tree::check_file_block(const boost::uint64_t file_block_num,
 	const net::buffer & buf) const
 {
-	char parent_buf[SHA1::bin_size];
-	if(!db::pool::singleton()->get()->blob_read(blob, parent_buf,
-		SHA1::bin_size, TI.file_hash_offset + file_block_num * SHA1::bin_size))
-	{
+	boost::uint64_t parent = TI.file_hash_offset + file_block_num * SHA1::bin_size;
+	if(parent + SHA1::bin_size > Tree->size()){
 		return io_error;
 	}
 	SHA1 SHA(reinterpret_cast<const char *>(buf.data()),
 		buf.size());
-	if(std::memcmp(parent_buf, SHA.bin(), SHA1::bin_size) == 0){
+	if(std::memcmp(Tree->data() + parent, SHA.bin(), SHA1::bin_size) == 0){
 		return good;
 	}else{
 		return bad;
@@ -124,11 +211,10 @@ hash_tree::status hash_tree::check_tree_block(const boost::uint64_t block_num,
 		SHA1 SHA(reinterpret_cast<const char *>(buf.data()),
 			buf.size());
 		//verify parent hash is a hash of the children
-		char parent_hash[SHA1::bin_size];
-		if(!db::pool::singleton()->get()->blob_read(blob, parent_hash, SHA1::bin_size, parent)){
+		if(parent + SHA1::bin_size > Tree->size()){
 			return io_error;
 		}
-		if(std::memcmp(parent_hash, SHA.bin(), SHA1::bin_size) == 0){
+		if(std::memcmp(Tree->data() + parent, SHA.bin(), SHA1::bin_size) == 0){
 			return good;
 		}else{
 			return bad;
@@ -142,8 +228,8 @@ hash_tree::status hash_tree::create(file_info & FI)
 	assert(TI.hash.empty());
 
 	//open file to generate hash tree for
-	std::fstream file(FI.path.c_str(), std::ios::in | std::ios::binary);
-	if(!file.is_open()){
+	boost::shared_ptr<file_cache::descriptor> file = file_cache::singleton()->open(FI.path);
+	if(!file){
 		LOG << "error opening " << FI.path;
 		return io_error;
 	}
@@ -159,127 +245,125 @@ hash_tree::status hash_tree::create(file_info & FI)
 		return io_error;
 	}
 
-	char buf[protocol_tcp::file_block_size];
-	SHA1 SHA;
-
 	//do file hashes
-	std::time_t time(0);
-	for(boost::uint64_t x=0; x<TI.row.back(); ++x){
-		//check once per second to make sure file not copying
-		if(std::time(NULL) != time){
-			try{
-				if(TI.file_size < boost::filesystem::file_size(FI.path)){
-					LOG << "copying " << FI.path;
-					return copying;
-				}
-				time = std::time(NULL);
-			}catch(const std::exception & e){
-				LOG << "error reading " << FI.path;
-				return io_error;
-			}
-		}
-
-		if(static_wrap::get().stopped){
-			return io_error;
-		}
-		file.read(buf, protocol_tcp::file_block_size);
-		if(file.gcount() == 0){
-			LOG << "error reading " << FI.path;
-			return io_error;
-		}
-		SHA.init();
-		SHA.load(buf, file.gcount());
-		SHA.end();
-		tmp.seekp(TI.file_hash_offset + x * SHA1::bin_size, std::ios::beg);
-		tmp.write(SHA.bin(), SHA1::bin_size);
-		if(!tmp.good()){
-			LOG << "error writing tmp file";
-			return io_error;
-		}
+	file->sequential();
+	status Status = hash_row(boost::bind(&file_cache::descriptor::read, file.get(),
+		_1, _2, _3), 0, TI.file_size, TI.row.back(), tmp, TI.file_hash_offset,
+		check_copying(FI));
+	if(Status != good){
+		return Status;
 	}
 
-	//do all other tree hashes
-	for(boost::uint64_t x=TI.tree_block_count - 1; x>0; --x){
-		std::pair<boost::uint64_t, unsigned> info;
-		boost::uint64_t parent;
-		if(!TI.block_info(x, info, parent)){
-			LOG << "invalid block";
-			exit(1);
-		}
-		tmp.seekg(info.first, std::ios::beg);
-		tmp.read(buf, info.second);
-		if(tmp.gcount() != info.second){
-			LOG << "error reading tmp file";
-			return io_error;
-		}
-		SHA.init();
-		SHA.load(buf, info.second);
-		SHA.end();
-		tmp.seekp(parent, std::ios::beg);
-		tmp.write(SHA.bin(), SHA1::bin_size);
-		if(!tmp.good()){
-			LOG << "error writing tmp file";
-			return io_error;
+	//do all other tree hashes, rows are stored top row first
+	boost::uint64_t row_offset = TI.file_hash_offset;
+	for(int x=TI.row.size() - 1; x>0; --x){
+		boost::uint64_t parent_offset = row_offset - TI.row[x-1] * SHA1::bin_size;
+		Status = hash_row(boost::bind(&read_tmp, boost::ref(tmp), _1, _2, _3),
+			row_offset, TI.row[x] * SHA1::bin_size, TI.row[x-1], tmp, parent_offset,
+			boost::function<status ()>());
+		if(Status != good){
+			return Status;
 		}
+		row_offset = parent_offset;
 	}
 
 	//calculate hash
+	char buf[SHA1::bin_size + 8];
 	std::memcpy(buf, convert::int_to_bin(TI.file_size).data(), 8);
-	std::memcpy(buf + 8, SHA.bin(), SHA1::bin_size);
-	SHA.init();
-	SHA.load(buf, SHA1::bin_size + 8);
-	SHA.end();
+	if(!read_tmp(tmp, buf + 8, SHA1::bin_size, 0)){
+		LOG << "error reading tmp file";
+		return io_error;
+	}
+	SHA1 SHA(buf, SHA1::bin_size + 8);
 	FI.hash = SHA.hex();
 
-	/*
-	Copy hash tree in to database. No transaction is used because it this can
-	tie up the database for too long when copying a large hash tree. The
-	writes are already quite large so a transaction doesn't make much
-	performance difference.
-	*/
-
 	//check if tree already exists
 	if(db::table::hash::find(FI.hash)){
 		return good;
 	}
-
-	//tree doesn't exist, allocate space for it
-	if(!db::table::hash::add(FI.hash, TI.tree_size)){
+	if(!db::table::hash::add(FI.hash)){
 		LOG << "error adding hash tree";
 		return io_error;
 	}
 
-	//copy tree to database using large buffer for performance
-	boost::shared_ptr<db::table::hash::info> Info = db::table::hash::find(FI.hash);
+	//tmp file is complete tree, move it to tree_store instead of copying it
+	tmp.close();
+	try{
+		boost::filesystem::rename(path::tree_file(), tree_store::file(FI.hash));
+	}catch(const std::exception & e){
+		LOG << e.what();
+		db::table::hash::remove(FI.hash);
+		return io_error;
+	}
+	return good;
+}
 
-	tmp.seekg(0, std::ios::beg);
-	boost::uint64_t offset = 0, bytes_remaining = TI.tree_size, read_size;
-	while(bytes_remaining){
-		if(boost::this_thread::interruption_requested()){
-			db::table::hash::remove(FI.hash);
-			return io_error;
+hash_tree::status hash_tree::hash_row(
+	const boost::function<bool (char *, const unsigned, const boost::uint64_t)> & read_func,
+	const boost::uint64_t offset,
+	const boost::uint64_t size,
+	const boost::uint64_t piece_cnt,
+	std::fstream & tmp,
+	const boost::uint64_t tmp_offset,
+	const boost::function<status ()> & check_func)
+{
+	boost::mutex mutex;
+	boost::condition_variable_any cond;
+	//enough chunks in flight to keep all threads busy while we read
+	const unsigned max_chunks = static_wrap::get().hash_threads * 2;
+	std::deque<boost::shared_ptr<hash_chunk> > Chunk; //oldest at front
+	status Status = good;
+	boost::uint64_t piece = 0;
+	while(true){
+		//read chunks and hand them to Hash_Pool
+		while(Status == good && piece < piece_cnt && Chunk.size() < max_chunks){
+			if(static_wrap::get().stopped){
+				Status = io_error;
+				break;
+			}
+			if(!check_func.empty()){
+				Status = check_func();
+				if(Status != good){
+					break;
+				}
+			}
+			boost::shared_ptr<hash_chunk> HC(new hash_chunk(piece,
+				piece_cnt - piece < chunk_pieces ? piece_cnt - piece : chunk_pieces));
+			boost::uint64_t start = piece * protocol_tcp::file_block_size;
+			HC->size = size - start < HC->buf.size() ? size - start : HC->buf.size();
+			if(!read_func(&HC->buf[0], HC->size, offset + start)){
+				LOG << "error reading";
+				Status = io_error;
+				break;
+			}
+			if(!static_wrap::get().Hash_Pool.enqueue(boost::bind(&hash_chunk::run,
+				HC, boost::ref(mutex), boost::ref(cond))))
+			{
+				HC->run(mutex, cond);
+			}
+			Chunk.push_back(HC);
+			piece += HC->pieces;
 		}
-		if(bytes_remaining > protocol_tcp::file_block_size){
-			read_size = protocol_tcp::file_block_size;
-		}else{
-			read_size = bytes_remaining;
+		if(Chunk.empty()){
+			return Status;
 		}
-		tmp.read(buf, read_size);
-		if(tmp.gcount() != read_size){
-			LOG << "error reading tmp file";
-			db::table::hash::remove(TI.hash);
-			return io_error;
-		}else{
-			if(!db::pool::singleton()->get()->blob_write(Info->blob, buf, read_size, offset)){
-				LOG << "error writing blob";
-				db::table::hash::remove(FI.hash);
-				return io_error;
+		//write hashes of oldest chunk, always wait so no job references mutex
+		{//BEGIN lock scope
+		boost::mutex::scoped_lock lock(mutex);
+		while(!Chunk.front()->done){
+			cond.wait(mutex);
+		}
+		}//END lock scope
+		if(Status == good){
+			tmp.seekp(tmp_offset + Chunk.front()->piece * SHA1::bin_size, std::ios::beg);
+			tmp.write(&Chunk.front()->hash[0], Chunk.front()->hash.size());
+			if(!tmp.good()){
+				LOG << "error writing tmp file";
+				Status = io_error;
 			}
-			offset += read_size;
-			bytes_remaining -= read_size;
 		}
+		Chunk.pop_front();
 	}
-	return good;
 }
 
 hash_tree::status hash_tree::read_block(const boost::uint64_t block_num,
@@ -287,14 +371,11 @@ hash_tree::status hash_tree::read_block(const boost::uint64_t block_num,
 {
 	std::pair<boost::uint64_t, unsigned> info;
 	if(TI.block_info(block_num, info)){
-		buf.tail_reserve(info.second);
-		if(!db::pool::singleton()->get()->blob_read(blob, reinterpret_cast<char *>(buf.tail_start()),
-			info.second, info.first))
-		{
-			buf.tail_resize(0);
+		if(info.first + info.second > Tree->size()){
 			return io_error;
 		}
-		buf.tail_resize(info.second);
+		buf.append(reinterpret_cast<const unsigned char *>(Tree->data() + info.first),
+			info.second);
 		return good;
 	}else{
 		LOG << "invalid block";
@@ -306,7 +387,7 @@ boost::optional<std::string> hash_tree::root_hash() const
 {
 	char buf[8 + SHA1::bin_size];
 	std::memcpy(buf, convert::int_to_bin(TI.file_size).data(), 8);
-	if(!db::pool::singleton()->get()->blob_read(blob, buf+8, SHA1::bin_size, 0)){
+	if(!Tree->read(buf+8, SHA1::bin_size, 0)){
 		return boost::optional<std::string>();
 	}
 	SHA1 SHA(buf, 8 + SHA1::bin_size);
@@ -329,18 +410,17 @@ hash_tree::status hash_tree::write_block(const boost::uint64_t block_num,
 	if(TI.block_info(block_num, info, parent)){
 		assert(info.second == buf.size());
 		if(block_num != 0){
-			char parent_buf[SHA1::bin_size];
-			if(!db::pool::singleton()->get()->blob_read(blob, parent_buf, SHA1::bin_size, parent)){
+			if(parent + SHA1::bin_size > Tree->size()){
 				return io_error;
 			}
 			SHA1 SHA(reinterpret_cast<const char *>(buf.data()),
 				info.second);
-			if(std::memcmp(parent_buf, SHA.bin(), SHA1::bin_size) != 0){
+			if(std::memcmp(Tree->data() + parent, SHA.bin(), SHA1::bin_size) != 0){
 				return bad;
 			}
 		}
-		if(!db::pool::singleton()->get()->blob_write(blob,
-			reinterpret_cast<const char *>(buf.data()), buf.size(), info.first))
+		if(!Tree->write(reinterpret_cast<const char *>(buf.data()), buf.size(),
+			info.first))
 		{
 			return io_error;
 		}
@@ -8,11 +8,13 @@ this class is exactly like a file.
 //custom
 #include "block_request.hpp"
 #include "db_all.hpp"
+#include "file_cache.hpp"
 #include "file_info.hpp"
 #include "path.hpp"
 #include "protocol_tcp.hpp"
 #include "settings.hpp"
 #include "tree_info.hpp"
+#include "tree_store.hpp"
 
 //include
 #include <atomic_bool.hpp>
@@ -100,8 +102,8 @@ public:
 	static void stop_create();
 
 private:
-	//blob handle for hash tree in database
-	const db::blob blob;
+	//mapped hash tree
+	boost::shared_ptr<tree_store> Tree;
 
 	class static_wrap
 	{
@@ -113,6 +115,10 @@ private:
 
 			//true if create() should be interrupted
 			atomic_bool stopped;
+
+			//hashes chunks for all create() calls, one thread per core
+			const unsigned hash_threads;
+			thread_pool Hash_Pool;
 		};
 
 		//get access to static objects
@@ -121,5 +127,25 @@ private:
 		static boost::once_flag once_flag;
 		static static_objects & _get();
 	};
+
+	/*
+	hash_row:
+		Hashes piece_cnt pieces of a row. Pieces are protocol_tcp::file_block_size
+		except the last which may be smaller. The row is size bytes read with
+		read_func starting at offset. Hashes of the pieces are written to tmp
+		starting at tmp_offset. The calling thread reads chunks while Hash_Pool
+		hashes the chunks previously read. The check_func (if not empty) is called
+		before each chunk is read, if it returns anything other than good that
+		status is returned.
+	*/
+	static status hash_row(
+		const boost::function<bool (char *, const unsigned, const boost::uint64_t)> & read_func,
+		const boost::uint64_t offset,
+		const boost::uint64_t size,
+		const boost::uint64_t piece_cnt,
+		std::fstream & tmp,
+		const boost::uint64_t tmp_offset,
+		const boost::function<status ()> & check_func
+	);
 };
 #endif
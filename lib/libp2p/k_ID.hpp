@@ -0,0 +1,174 @@
+#ifndef H_K_ID
+#define H_K_ID
+
+//include
+#include <boost/cstdint.hpp>
+#include <convert.hpp>
+#include <SHA1.hpp>
+
+//standard
+#include <cassert>
+#include <string>
+
+/*
+160 bit node ID (also used for file hashes we search for). Stored as five 32
+bit words, most significant word first, so comparing words in order compares
+the IDs as numbers. This is a POD so it can be copied, compared, and XOR'd
+without allocating.
+*/
+class k_ID
+{
+public:
+	static const unsigned words = SHA1::bin_size / 4;
+	boost::uint32_t word[SHA1::bin_size / 4];
+
+	/*
+	from_bin:
+		Returns ID from SHA1::bin_size bytes.
+	from_hex:
+		Returns ID from SHA1::hex_size hex characters.
+	max:
+		Returns the largest ID (all bits set).
+	zero:
+		Returns ID with no bits set.
+	*/
+	static k_ID from_bin(const unsigned char * bin)
+	{
+		k_ID ID;
+		for(unsigned x=0; x<words; ++x){
+			ID.word[x] = (static_cast<boost::uint32_t>(bin[x*4]) << 24)
+				| (static_cast<boost::uint32_t>(bin[x*4+1]) << 16)
+				| (static_cast<boost::uint32_t>(bin[x*4+2]) << 8)
+				| static_cast<boost::uint32_t>(bin[x*4+3]);
+		}
+		return ID;
+	}
+
+	static k_ID from_hex(const std::string & hex)
+	{
+		assert(hex.size() == SHA1::hex_size);
+		std::string bin = convert::hex_to_bin(hex);
+		return from_bin(reinterpret_cast<const unsigned char *>(bin.data()));
+	}
+
+	static k_ID max()
+	{
+		k_ID ID;
+		for(unsigned x=0; x<words; ++x){
+			ID.word[x] = 0xFFFFFFFF;
+		}
+		return ID;
+	}
+
+	static k_ID zero()
+	{
+		k_ID ID;
+		for(unsigned x=0; x<words; ++x){
+			ID.word[x] = 0;
+		}
+		return ID;
+	}
+
+	/*
+	bin:
+		Returns SHA1::bin_size byte binary ID.
+	hex:
+		Returns SHA1::hex_size character hex ID.
+	is_zero:
+		Returns true if no bits set.
+	leading_zeros:
+		Returns number of leading zero bits, 160 if ID is zero.
+	*/
+	std::string bin() const
+	{
+		std::string tmp;
+		tmp.reserve(SHA1::bin_size);
+		for(unsigned x=0; x<words; ++x){
+			tmp += static_cast<char>(word[x] >> 24);
+			tmp += static_cast<char>(word[x] >> 16);
+			tmp += static_cast<char>(word[x] >> 8);
+			tmp += static_cast<char>(word[x]);
+		}
+		return tmp;
+	}
+
+	std::string hex() const
+	{
+		return convert::bin_to_hex(bin());
+	}
+
+	bool is_zero() const
+	{
+		for(unsigned x=0; x<words; ++x){
+			if(word[x] != 0){
+				return false;
+			}
+		}
+		return true;
+	}
+
+	unsigned leading_zeros() const
+	{
+		for(unsigned x=0; x<words; ++x){
+			if(word[x] != 0){
+#ifdef __GNUC__
+				return x * 32 + __builtin_clz(word[x]);
+#else
+				unsigned cnt = x * 32;
+				for(boost::uint32_t mask = 0x80000000; !(word[x] & mask); mask >>= 1){
+					++cnt;
+				}
+				return cnt;
+#endif
+			}
+		}
+		return words * 32;
+	}
+
+	//XOR distance between IDs
+	k_ID operator ^ (const k_ID & rval) const
+	{
+		k_ID ID;
+		for(unsigned x=0; x<words; ++x){
+			ID.word[x] = word[x] ^ rval.word[x];
+		}
+		return ID;
+	}
+
+	//subtract one, zero wraps to max
+	k_ID & operator -- ()
+	{
+		for(int x=words - 1; x>=0; --x){
+			if(word[x]-- != 0){
+				break;
+			}
+		}
+		return *this;
+	}
+
+	bool operator < (const k_ID & rval) const
+	{
+		for(unsigned x=0; x<words; ++x){
+			if(word[x] != rval.word[x]){
+				return word[x] < rval.word[x];
+			}
+		}
+		return false;
+	}
+
+	bool operator == (const k_ID & rval) const
+	{
+		for(unsigned x=0; x<words; ++x){
+			if(word[x] != rval.word[x]){
+				return false;
+			}
+		}
+		return true;
+	}
+
+	bool operator != (const k_ID & rval) const
+	{
+		return !(*this == rval);
+	}
+};
+#endif
@@ -3,7 +3,7 @@
 //BEGIN bucket_element
 k_bucket::bucket_element::bucket_element(
 	const net::endpoint & endpoint_in,
-	const std::string & remote_ID_in,
+	const k_ID & remote_ID_in,
 	const k_contact & contact_in
 ):
 	endpoint(endpoint_in),
@@ -24,7 +24,7 @@ k_bucket::bucket_element::bucket_element(const bucket_element & BE):
 
 k_bucket::k_bucket(
 	atomic_int<unsigned> & active_cnt_in,
-	const boost::function<void (const net::endpoint &, const std::string &)> & route_table_call_back_in
+	const boost::function<void (const net::endpoint &, const k_ID &)> & route_table_call_back_in
 ):
 	active_cnt(active_cnt_in),
 	route_table_call_back(route_table_call_back_in)
@@ -32,12 +32,12 @@ k_bucket::k_bucket(
 
 }
 
-void k_bucket::add_reserve(const net::endpoint & ep, const std::string remote_ID)
+void k_bucket::add_reserve(const net::endpoint & ep, const k_ID & remote_ID)
 {
 	if(exists(ep)){
 		return;
 	}
-	//LOG << "reserve: " << ep.IP() << " " << ep.port() << " " << convert::abbr(remote_ID);
+	//LOG << "reserve: " << ep.IP() << " " << ep.port() << " " << convert::abbr(remote_ID.hex());
 	Bucket_Reserve.push_back(bucket_element(ep, remote_ID,
 		k_contact(protocol_udp::bucket_timeout)));
 }
@@ -61,26 +61,24 @@ bool k_bucket::exists(const net::endpoint & ep)
 	return false;
 }
 
-void k_bucket::find_node(const std::string & ID_to_find,
-	std::multimap<mpa::mpint, net::endpoint> & hosts)
+void k_bucket::find_node(const k_ID & ID_to_find,
+	std::multimap<k_ID, net::endpoint> & hosts)
 {
 	for(std::list<bucket_element>::iterator it_cur = Bucket_Active.begin(),
 		it_end = Bucket_Active.end(); it_cur != it_end; ++it_cur)
 	{
-		mpa::mpint dist = k_func::distance(ID_to_find, it_cur->remote_ID);
 		hosts.insert(std::make_pair(k_func::distance(ID_to_find, it_cur->remote_ID),
 			it_cur->endpoint));
 	}
 }
 
-void k_bucket::find_node(const net::endpoint & from, const std::string & ID_to_find,
-	std::multimap<mpa::mpint, net::endpoint> & hosts)
+void k_bucket::find_node(const net::endpoint & from, const k_ID & ID_to_find,
+	std::multimap<k_ID, net::endpoint> & hosts)
 {
 	for(std::list<bucket_element>::iterator it_cur = Bucket_Active.begin(),
 		it_end = Bucket_Active.end(); it_cur != it_end; ++it_cur)
 	{
 		if(it_cur->endpoint != from){
-			mpa::mpint dist = k_func::distance(ID_to_find, it_cur->remote_ID);
 			hosts.insert(std::make_pair(k_func::distance(ID_to_find, it_cur->remote_ID),
 				it_cur->endpoint));
 		}
@@ -122,7 +120,7 @@ boost::optional<net::endpoint> k_bucket::ping()
 	return boost::optional<net::endpoint>();
 }
 
-void k_bucket::recv_pong(const net::endpoint & from, const std::string & remote_ID)
+void k_bucket::recv_pong(const net::endpoint & from, const k_ID & remote_ID)
 {
 	//if node active then touch it
 	for(std::list<bucket_element>::iterator it_cur = Bucket_Active.begin(),
@@ -165,7 +163,7 @@ void k_bucket::recv_pong(const net::endpoint & from, const std::string & remote_
 	//not in active or reserve, response message that counts as pong
 	if(Bucket_Active.size() < protocol_udp::bucket_size){
 		//add to routing table
-		//LOG << "active: " << from.IP() << " " << from.port() << " " << convert::abbr(remote_ID);
+		//LOG << "active: " << from.IP() << " " << from.port() << " " << convert::abbr(remote_ID.hex());
 		++active_cnt;
 		Bucket_Active.push_front(bucket_element(from, remote_ID,
 			k_contact(protocol_udp::bucket_timeout)));
@@ -173,7 +171,7 @@ void k_bucket::recv_pong(const net::endpoint & from, const std::string & remote_
 		return;
 	}else{
 		//add to reserve
-		//LOG << "reserve: " << from.IP() << " " << from.port() << " " << convert::abbr(remote_ID);
+		//LOG << "reserve: " << from.IP() << " " << from.port() << " " << convert::abbr(remote_ID.hex());
 		Bucket_Reserve.push_back(bucket_element(from, remote_ID,
 			k_contact(protocol_udp::bucket_timeout)));
 		return;
@@ -9,7 +9,6 @@
 //include
 #include <atomic_int.hpp>
 #include <boost/optional.hpp>
-#include <mpa.hpp>
 #include <net/net.hpp>
 
 //standard
@@ -23,7 +22,7 @@ class k_bucket : private boost::noncopyable
 public:
 	k_bucket(
 		atomic_int<unsigned> & active_cnt_in,
-		const boost::function<void (const net::endpoint &, const std::string &)> & route_table_call_back_in
+		const boost::function<void (const net::endpoint &, const k_ID &)> & route_table_call_back_in
 	);
 
 	/*
@@ -43,14 +42,14 @@ public:
 	recv_pong:
 		Called when pong received.
 	*/
-	void add_reserve(const net::endpoint & ep, const std::string remote_ID);
+	void add_reserve(const net::endpoint & ep, const k_ID & remote_ID);
 	bool exists(const net::endpoint & ep);
-	void find_node(const std::string & ID_to_find,
-		std::multimap<mpa::mpint, net::endpoint> & hosts);
-	void find_node(const net::endpoint & from, const std::string & ID_to_find,
-		std::multimap<mpa::mpint, net::endpoint> & hosts);
+	void find_node(const k_ID & ID_to_find,
+		std::multimap<k_ID, net::endpoint> & hosts);
+	void find_node(const net::endpoint & from, const k_ID & ID_to_find,
+		std::multimap<k_ID, net::endpoint> & hosts);
 	boost::optional<net::endpoint> ping();
-	void recv_pong(const net::endpoint & from, const std::string & remote_ID);
+	void recv_pong(const net::endpoint & from, const k_ID & remote_ID);
 
 	/* Timed Functions
 	tick:
@@ -60,20 +59,20 @@ public:
 
 private:
 	atomic_int<unsigned> & active_cnt;
-	const boost::function<void (const net::endpoint &, const std::string &)> route_table_call_back;
+	const boost::function<void (const net::endpoint &, const k_ID &)> route_table_call_back;
 
 	class bucket_element
 	{
 	public:
 		bucket_element(
 			const net::endpoint & endpoint_in,
-			const std::string & remote_ID_in,
+			const k_ID & remote_ID_in,
 			const k_contact & contact_in
 		);
 		bucket_element(const bucket_element & BE);
 
 		const net::endpoint endpoint;
-		const std::string remote_ID;
+		const k_ID remote_ID;
 		k_contact contact;
 	};
 
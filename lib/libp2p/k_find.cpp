@@ -1,83 +1,122 @@
 #include "k_find.hpp"
 
-void k_find::add_to_all(const net::endpoint & ep, const std::string & remote_ID)
+//BEGIN cache_element
+k_find::cache_element::cache_element(
+	const std::multimap<k_ID, net::endpoint> & found_in,
+	const timer_wheel::handle & Timer_in
+):
+	found(found_in),
+	Timer(Timer_in)
 {
-	for(std::map<std::string, boost::shared_ptr<k_find_job> >::iterator
-		it_cur = Find.begin(), it_end = Find.end(); it_cur != it_end; ++it_cur)
-	{
-		mpa::mpint dist = k_func::distance(remote_ID, it_cur->first);
-		it_cur->second->add(ep, dist);
-	}
+
 }
 
-void k_find::node(const std::string & ID,
-	const std::multimap<mpa::mpint, net::endpoint> & hosts,
-	const boost::function<void (const net::endpoint &)> & call_back)
+k_find::cache_element::cache_element(const cache_element & CE):
+	found(CE.found),
+	Timer(CE.Timer)
 {
-	std::map<std::string, boost::shared_ptr<k_find_job> >::iterator it = Find.find(ID);
-	if(it == Find.end()){
-		//add new job
-		boost::shared_ptr<k_find_job> job(new k_find_job(hosts));
-		job->register_call_back(call_back, k_find_job::exact_match);
-		Find.insert(std::make_pair(ID, job));
-	}else{
-		//register call back with existing job
-		it->second->register_call_back(call_back, k_find_job::exact_match);
-	}
+
 }
+//END cache_element
 
-void k_find::recv_host_list(const net::endpoint & from, const std::string & remote_ID,
-	const std::list<net::endpoint> & hosts, const std::string & ID_to_find)
+k_find::k_find(timer_wheel & Timer_Wheel_in):
+	Timer_Wheel(Timer_Wheel_in)
 {
-	std::map<std::string, boost::shared_ptr<k_find_job> >::iterator it = Find.find(ID_to_find);
-	if(it != Find.end()){
-		mpa::mpint dist = k_func::distance(remote_ID, ID_to_find);
-		it->second->recv_host_list(from, hosts, dist);
-	}
+
 }
 
-std::list<std::pair<net::endpoint, std::string> > k_find::send_find_node()
+void k_find::add_to_all(const net::endpoint & ep, const k_ID & remote_ID)
 {
-	std::list<std::pair<net::endpoint, std::string> > jobs;
-	for(std::map<std::string, boost::shared_ptr<k_find_job> >::iterator
+	for(std::map<k_ID, boost::shared_ptr<k_find_job> >::iterator
 		it_cur = Find.begin(), it_end = Find.end(); it_cur != it_end; ++it_cur)
 	{
-		std::list<net::endpoint> tmp = it_cur->second->find_node();
-		for(std::list<net::endpoint>::iterator t_it_cur = tmp.begin(),
-			t_it_end = tmp.end(); t_it_cur != t_it_end; ++t_it_cur)
-		{
-			jobs.push_back(std::make_pair(*t_it_cur, it_cur->first));
-		}
+		it_cur->second->add(ep, k_func::distance(remote_ID, it_cur->first));
 	}
-	return jobs;
 }
 
-void k_find::set(const std::string & ID,
-	const std::multimap<mpa::mpint, net::endpoint> & hosts,
-	const boost::function<void (const net::endpoint &)> & call_back)
+void k_find::cache_timeout(const k_ID ID)
+{
+	Cache.erase(ID);
+}
+
+void k_find::find(const k_ID & ID, const std::multimap<k_ID, net::endpoint> & hosts,
+	const boost::function<void (const net::endpoint &)> & call_back,
+	const k_find_job::call_back_t type)
 {
-	std::map<std::string, boost::shared_ptr<k_find_job> >::iterator it = Find.find(ID);
+	std::map<k_ID, cache_element>::iterator c_it = Cache.find(ID);
+	if(c_it != Cache.end()){
+		//copy because call back might start find that changes Cache
+		std::multimap<k_ID, net::endpoint> found = c_it->second.found;
+		for(std::multimap<k_ID, net::endpoint>::iterator it_cur = found.begin(),
+			it_end = found.end(); it_cur != it_end; ++it_cur)
+		{
+			if(type == k_find_job::any_will_do || it_cur->first.is_zero()){
+				call_back(it_cur->second);
+			}
+		}
+		return;
+	}
+	std::map<k_ID, boost::shared_ptr<k_find_job> >::iterator it = Find.find(ID);
 	if(it == Find.end()){
 		//add new job
-		boost::shared_ptr<k_find_job> job(new k_find_job(hosts));
-		job->register_call_back(call_back, k_find_job::any_will_do);
+		boost::shared_ptr<k_find_job> job(new k_find_job(Timer_Wheel, RTT, hosts));
+		job->register_call_back(call_back, type);
 		Find.insert(std::make_pair(ID, job));
 	}else{
 		//register call back with existing job
-		it->second->register_call_back(call_back, k_find_job::any_will_do);
+		it->second->register_call_back(call_back, type);
+	}
+}
+
+void k_find::node(const k_ID & ID,
+	const std::multimap<k_ID, net::endpoint> & hosts,
+	const boost::function<void (const net::endpoint &)> & call_back)
+{
+	find(ID, hosts, call_back, k_find_job::exact_match);
+}
+
+void k_find::recv_host_list(const net::endpoint & from, const k_ID & remote_ID,
+	const std::list<net::endpoint> & hosts, const k_ID & ID_to_find)
+{
+	std::map<k_ID, boost::shared_ptr<k_find_job> >::iterator it = Find.find(ID_to_find);
+	if(it != Find.end()){
+		//job kept alive in case call back changes Find
+		boost::shared_ptr<k_find_job> job = it->second;
+		job->recv_host_list(from, hosts, k_func::distance(remote_ID, ID_to_find));
 	}
 }
 
-void k_find::tick()
+std::list<std::pair<net::endpoint, k_ID> > k_find::send_find_node()
 {
-	//check timeouts
-	for(std::map<std::string, boost::shared_ptr<k_find_job> >::iterator
+	std::list<std::pair<net::endpoint, k_ID> > jobs;
+	for(std::map<k_ID, boost::shared_ptr<k_find_job> >::iterator
 		it_cur = Find.begin(); it_cur != Find.end();)
 	{
-		if(it_cur->second->timeout()){
+		if(it_cur->second->done()){
+			//cache result
+			Cache.insert(std::make_pair(it_cur->first, cache_element(
+				it_cur->second->found(), Timer_Wheel.arm(
+				protocol_udp::find_cache_timeout * 1000, boost::bind(
+				&k_find::cache_timeout, this, it_cur->first)))));
+			Find.erase(it_cur++);
+		}else if(it_cur->second->expired()){
 			Find.erase(it_cur++);
 		}else{
+			std::list<net::endpoint> tmp = it_cur->second->find_node();
+			for(std::list<net::endpoint>::iterator t_it_cur = tmp.begin(),
+				t_it_end = tmp.end(); t_it_cur != t_it_end; ++t_it_cur)
+			{
+				jobs.push_back(std::make_pair(*t_it_cur, it_cur->first));
+			}
 			++it_cur;
 		}
 	}
+	return jobs;
+}
+
+void k_find::set(const k_ID & ID,
+	const std::multimap<k_ID, net::endpoint> & hosts,
+	const boost::function<void (const net::endpoint &)> & call_back)
+{
+	find(ID, hosts, call_back, k_find_job::any_will_do);
 }
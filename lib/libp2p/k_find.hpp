@@ -4,10 +4,17 @@
 //custom
 #include "k_find_job.hpp"
 
+//include
+#include <timer_wheel.hpp>
+
 class k_find : private boost::noncopyable
 {
 public:
+	explicit k_find(timer_wheel & Timer_Wheel_in);
+
 	/* Find
+	Results of finished finds are cached for protocol_udp::find_cache_timeout.
+	If there is a cached result the call backs are done immediately.
 	node:
 		Find a specific node. Found endpoints are returned with call_back.
 		Note: The call_back may be used multiple times if multiple hosts claim to
@@ -16,11 +23,11 @@ public:
 		Find closest protocol_udp::max_store nodes to ID. Found endpoints are
 		returned with call_back.
 	*/
-	void node(const std::string & ID,
-		const std::multimap<mpa::mpint, net::endpoint> & hosts,
+	void node(const k_ID & ID,
+		const std::multimap<k_ID, net::endpoint> & hosts,
 		const boost::function<void (const net::endpoint &)> & call_back);
-	void set(const std::string & ID,
-		const std::multimap<mpa::mpint, net::endpoint> & hosts,
+	void set(const k_ID & ID,
+		const std::multimap<k_ID, net::endpoint> & hosts,
 		const boost::function<void (const net::endpoint &)> & call_back);
 
 	/*
@@ -31,20 +38,46 @@ public:
 		Called when host list received.
 		Note: ID is the ID returned from find_node().
 	send_find_node:
-		Returns info for find_node requests that need to be sent.
+		Returns info for find_node requests that need to be sent. Finished jobs
+		are removed. This should be called whenever there may be new requests
+		to send (after a host_list is received or a timer expires).
 	*/
-	void add_to_all(const net::endpoint & ep, const std::string & remote_ID);
-	void recv_host_list(const net::endpoint & from, const std::string & remote_ID,
-		const std::list<net::endpoint> & hosts, const std::string & ID_to_find);
-	std::list<std::pair<net::endpoint, std::string> > send_find_node();
-
-	/* Timed Functions
-	tick:
-		Called once per second to process timeouts.
-	*/
-	void tick();
+	void add_to_all(const net::endpoint & ep, const k_ID & remote_ID);
+	void recv_host_list(const net::endpoint & from, const k_ID & remote_ID,
+		const std::list<net::endpoint> & hosts, const k_ID & ID_to_find);
+	std::list<std::pair<net::endpoint, k_ID> > send_find_node();
 
 private:
-	std::map<std::string, boost::shared_ptr<k_find_job> > Find;
+	timer_wheel & Timer_Wheel;
+	k_rtt RTT;
+	std::map<k_ID, boost::shared_ptr<k_find_job> > Find;
+
+	class cache_element
+	{
+	public:
+		cache_element(
+			const std::multimap<k_ID, net::endpoint> & found_in,
+			const timer_wheel::handle & Timer_in
+		);
+		cache_element(const cache_element & CE);
+		const std::multimap<k_ID, net::endpoint> found;
+		//removes cache element when it times out
+		timer_wheel::handle Timer;
+	};
+
+	//results of finished find jobs
+	std::map<k_ID, cache_element> Cache;
+
+	/*
+	cache_timeout:
+		Timer call back to remove cached result.
+	find:
+		Does call backs from cache if there's a cached result. Otherwise starts
+		a find job or registers call back with existing job.
+	*/
+	void cache_timeout(const k_ID ID);
+	void find(const k_ID & ID, const std::multimap<k_ID, net::endpoint> & hosts,
+		const boost::function<void (const net::endpoint &)> & call_back,
+		const k_find_job::call_back_t type);
 };
 #endif
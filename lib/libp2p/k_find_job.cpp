@@ -2,18 +2,19 @@
 
 //BEGIN store_element
 k_find_job::store_element::store_element(
-	const net::endpoint & endpoint_in,
-	const k_contact & contact_in
+	const net::endpoint & endpoint_in
 ):
 	endpoint(endpoint_in),
-	contact(contact_in)
+	state(waiting_state)
 {
 
 }
 
 k_find_job::store_element::store_element(const store_element & SE):
 	endpoint(SE.endpoint),
-	contact(SE.contact)
+	state(SE.state),
+	sent(SE.sent),
+	Timer(SE.Timer)
 {
 
 }
@@ -38,35 +39,51 @@ k_find_job::call_back_element::call_back_element(const call_back_element & CBE):
 }
 //END call_back_element
 
-k_find_job::k_find_job(const std::multimap<mpa::mpint, net::endpoint> & hosts):
-	time(std::time(NULL) + protocol_udp::find_timeout)
+k_find_job::k_find_job(
+	timer_wheel & Timer_Wheel_in,
+	k_rtt & RTT_in,
+	const std::multimap<k_ID, net::endpoint> & hosts
+):
+	Timer_Wheel(Timer_Wheel_in),
+	RTT(RTT_in),
+	in_flight(0),
+	timed_out(false)
 {
-	unsigned delay = 0;
-	int no_delay_cnt = protocol_udp::no_delay_count;
-	for(std::multimap<mpa::mpint, net::endpoint>::const_iterator
+	for(std::multimap<k_ID, net::endpoint>::const_iterator
 		it_cur = hosts.begin(), it_end = hosts.end(); it_cur != it_end; ++it_cur)
 	{
-		Memoize.insert(it_cur->second);
-		Store.insert(std::make_pair(it_cur->first,
-			store_element(it_cur->second, k_contact(0, no_delay_cnt-- > 0 ? 0 : delay++))));
+		add(it_cur->second, it_cur->first);
 	}
+	Expire_Timer = Timer_Wheel.arm(protocol_udp::find_timeout * 1000,
+		boost::bind(&k_find_job::expire, this));
 }
 
-void k_find_job::add(const net::endpoint & ep, const mpa::mpint & dist)
+k_find_job::~k_find_job()
+{
+	//timers have pointer to this
+	Timer_Wheel.cancel(Expire_Timer);
+	for(std::multimap<k_ID, store_element>::iterator it_cur = Store.begin(),
+		it_end = Store.end(); it_cur != it_end; ++it_cur)
+	{
+		Timer_Wheel.cancel(it_cur->second.Timer);
+	}
+}
+
+void k_find_job::add(const net::endpoint & ep, const k_ID & dist)
 {
 	if(Memoize.find(ep) == Memoize.end()){
 		Memoize.insert(ep);
-		Store.insert(std::make_pair(dist, store_element(ep, k_contact())));
+		Store.insert(std::make_pair(dist, store_element(ep)));
 	}
 }
 
-void k_find_job::call_back(const net::endpoint & ep, const mpa::mpint & dist)
+void k_find_job::call_back(const net::endpoint & ep, const k_ID & dist)
 {
 	for(std::list<call_back_element>::iterator it_cur = Call_Back.begin(),
 		it_end = Call_Back.end(); it_cur != it_end; ++it_cur)
 	{
 		if(it_cur->type == exact_match){
-			if(dist == "0"){
+			if(dist.is_zero()){
 				it_cur->call_back(ep);
 			}
 		}else{
@@ -75,67 +92,95 @@ void k_find_job::call_back(const net::endpoint & ep, const mpa::mpint & dist)
 	}
 }
 
-std::list<net::endpoint> k_find_job::find_node()
+bool k_find_job::done()
 {
-	//check timeouts
-	std::list<store_element> timeout;
-	for(std::multimap<mpa::mpint, store_element>::iterator it_cur = Store.begin();
-		it_cur != Store.end();)
+	unsigned responded = 0;
+	for(std::multimap<k_ID, store_element>::iterator it_cur = Store.begin(),
+		it_end = Store.end(); it_cur != it_end; ++it_cur)
 	{
-		if(it_cur->second.contact.timeout()
-			&& it_cur->second.contact.timeout_count() > protocol_udp::retransmit_limit){
-			timeout.push_back(it_cur->second);
-			Store.erase(it_cur++);
-		}else{
-			++it_cur;
-		}
-	}
-	if(!timeout.empty()){
-		//insert timed out contacts at end by setting distance to maximum
-		mpa::mpint max(std::string(SHA1::hex_size, 'F'), 16);
-		for(std::list<store_element>::iterator it_cur = timeout.begin(),
-			it_end = timeout.end(); it_cur != it_end; ++it_cur)
-		{
-			LOG << "retransmit limit reached " << it_cur->endpoint.IP()
-				<< " " << it_cur->endpoint.port();
-			Store.insert(std::make_pair(max, *it_cur));
+		if(it_cur->second.state == responded_state){
+			if(++responded == protocol_udp::max_store){
+				//closest contacts responded
+				return true;
+			}
+		}else if(it_cur->second.state != stalled_state){
+			//closer contact waiting or in flight
+			return false;
 		}
 	}
-	//check for endpoint to send find_node to
+	/*
+	No contacts left to try. If nothing responded keep going until expired
+	because contacts may be added with add().
+	*/
+	return !Found.empty();
+}
+
+void k_find_job::expire()
+{
+	timed_out = true;
+}
+
+bool k_find_job::expired()
+{
+	return timed_out;
+}
+
+std::list<net::endpoint> k_find_job::find_node()
+{
 	std::list<net::endpoint> jobs;
-	for(std::multimap<mpa::mpint, store_element>::iterator
-		it_cur = Store.begin(), it_end = Store.end(); it_cur != it_end; ++it_cur)
+	for(std::multimap<k_ID, store_element>::iterator it_cur = Store.begin(),
+		it_end = Store.end(); it_cur != it_end && in_flight < protocol_udp::find_alpha;
+		++it_cur)
 	{
-		if(it_cur->second.contact.send()){
-			//LOG << it_cur->second.endpoint.IP() << " " << it_cur->second.endpoint.port();
+		if(it_cur->second.state == waiting_state){
+			it_cur->second.state = in_flight_state;
+			++in_flight;
+			it_cur->second.sent = boost::posix_time::microsec_clock::universal_time();
+			it_cur->second.Timer = Timer_Wheel.arm(RTT.timeout(it_cur->second.endpoint),
+				boost::bind(&k_find_job::stall, this, it_cur->second.endpoint));
 			jobs.push_back(it_cur->second.endpoint);
 		}
 	}
 	return jobs;
 }
 
-const std::multimap<mpa::mpint, net::endpoint> & k_find_job::found()
+const std::multimap<k_ID, net::endpoint> & k_find_job::found()
 {
 	return Found;
 }
 
 void k_find_job::recv_host_list(const net::endpoint & from,
-	const std::list<net::endpoint> & hosts, const mpa::mpint & dist)
+	const std::list<net::endpoint> & hosts, const k_ID & dist)
 {
 	call_back(from, dist);
 
-	//erase endpoint that sent host_list and add it to found collection
-	for(std::multimap<mpa::mpint, store_element>::iterator
+	//move endpoint that sent host_list to it's real distance, add it to found
+	for(std::multimap<k_ID, store_element>::iterator
 		it_cur = Store.begin(), it_end = Store.end(); it_cur != it_end; ++it_cur)
 	{
 		if(it_cur->second.endpoint == from){
+			if(it_cur->second.state == responded_state){
+				//duplicate
+				return;
+			}
+			if(it_cur->second.state == in_flight_state){
+				--in_flight;
+			}
+			if(it_cur->second.state != waiting_state){
+				RTT.add(from, (boost::posix_time::microsec_clock::universal_time()
+					- it_cur->second.sent).total_milliseconds());
+			}
+			Timer_Wheel.cancel(it_cur->second.Timer);
+			store_element SE = it_cur->second;
+			SE.state = responded_state;
+			Store.erase(it_cur);
+			Store.insert(std::make_pair(dist, SE));
 			Found.insert(std::make_pair(dist, from));
 			while(Found.size() > protocol_udp::max_store){
-				std::multimap<mpa::mpint, net::endpoint>::iterator iter = Found.end();
+				std::multimap<k_ID, net::endpoint>::iterator iter = Found.end();
 				--iter;
 				Found.erase(iter);
 			}
-			Store.erase(it_cur);
 			break;
 		}
 	}
@@ -143,7 +188,10 @@ void k_find_job::recv_host_list(const net::endpoint & from,
 	Add endpoints that remote host sent. We don't know the distance of the
 	endpoints to the ID to find so we assume they're one closer.
 	*/
-	mpa::mpint new_dist = (dist == "0" ? "0" : dist - "1");
+	k_ID new_dist = dist;
+	if(!new_dist.is_zero()){
+		--new_dist;
+	}
 	for(std::list<net::endpoint>::const_iterator it_cur = hosts.begin(),
 		it_end = hosts.end(); it_cur != it_end; ++it_cur)
 	{
@@ -157,7 +205,7 @@ void k_find_job::register_call_back(
 {
 	Call_Back.push_back(call_back_element(call_back, type));
 	if(type == any_will_do){
-		for(std::multimap<mpa::mpint, net::endpoint>::iterator it_cur = Found.begin(),
+		for(std::multimap<k_ID, net::endpoint>::iterator it_cur = Found.begin(),
 			it_end = Found.end(); it_cur != it_end; ++it_cur)
 		{
 			call_back(it_cur->second);
@@ -165,7 +213,15 @@ void k_find_job::register_call_back(
 	}
 }
 
-bool k_find_job::timeout()
+void k_find_job::stall(const net::endpoint ep)
 {
-	return std::time(NULL) > time;
+	for(std::multimap<k_ID, store_element>::iterator it_cur = Store.begin(),
+		it_end = Store.end(); it_cur != it_end; ++it_cur)
+	{
+		if(it_cur->second.endpoint == ep && it_cur->second.state == in_flight_state){
+			it_cur->second.state = stalled_state;
+			--in_flight;
+			return;
+		}
+	}
 }
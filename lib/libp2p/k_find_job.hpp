@@ -2,14 +2,15 @@
 #define H_K_FIND_JOB
 
 //custom
-#include "k_contact.hpp"
 #include "k_func.hpp"
+#include "k_rtt.hpp"
 #include "protocol_udp.hpp"
 
 //include
+#include <boost/date_time/posix_time/posix_time.hpp>
 #include <boost/utility.hpp>
-#include <mpa.hpp>
 #include <net/net.hpp>
+#include <timer_wheel.hpp>
 
 //standard
 #include <algorithm>
@@ -17,7 +18,12 @@
 class k_find_job : private boost::noncopyable
 {
 public:
-	k_find_job(const std::multimap<mpa::mpint, net::endpoint> & hosts);
+	k_find_job(
+		timer_wheel & Timer_Wheel_in,
+		k_rtt & RTT_in,
+		const std::multimap<k_ID, net::endpoint> & hosts
+	);
+	~k_find_job();
 
 	enum call_back_t{
 		exact_match, //call back only done for exact match
@@ -27,8 +33,14 @@ public:
 	/*
 	add:
 		Add endpoint where we know the distance it is from ID to find.
+	done:
+		Returns true if the protocol_udp::max_store closest contacts have
+		responded, or there are no contacts left to try.
+	expired:
+		Returns true if job has run for protocol_udp::find_timeout.
 	find_node:
-		Returns list of endpoints that find_node needs to be sent to.
+		Returns list of endpoints that find_node needs to be sent to. At most
+		protocol_udp::find_alpha requests are in flight at once.
 	found:
 		Returns reference to nodes that have been found.
 	recv_host_list:
@@ -39,56 +51,67 @@ public:
 		Note: This can be called multiple times.
 		Note: If exact_match = false this function uses the call back for all
 			endpoints in Found immediately.
-	timeout:
-		Returns true if the k_find_job has expired.
 	*/
-	void add(const net::endpoint & ep, const mpa::mpint & dist);
+	void add(const net::endpoint & ep, const k_ID & dist);
+	bool done();
+	bool expired();
 	std::list<net::endpoint> find_node();
-	const std::multimap<mpa::mpint, net::endpoint> & found();
+	const std::multimap<k_ID, net::endpoint> & found();
 	void recv_host_list(const net::endpoint & from,
-		const std::list<net::endpoint> & hosts, const mpa::mpint & dist);
+		const std::list<net::endpoint> & hosts, const k_ID & dist);
 	void register_call_back(const boost::function<void (const net::endpoint &)> & call_back,
 		const call_back_t type);
-	bool timeout();
 
 private:
-	//time at which instantiated
-	std::time_t time;
+	timer_wheel & Timer_Wheel;
+	k_rtt & RTT;
+
+	enum state_t{
+		waiting_state,   //find_node not yet sent
+		in_flight_state, //find_node sent, counts against find_alpha
+		stalled_state,   //response took longer than RTT timeout
+		responded_state  //host_list received
+	};
 
 	class store_element
 	{
 	public:
-		store_element(
-			const net::endpoint & endpoint_in,
-			const k_contact & contact_in
-		);
+		store_element(const net::endpoint & endpoint_in);
 		store_element(const store_element & SE);
 
 		const net::endpoint endpoint;
-		k_contact contact;
+		state_t state;
+		//time find_node sent, used for RTT sample
+		boost::posix_time::ptime sent;
+		//moves contact to stalled_state if response not received in time
+		timer_wheel::handle Timer;
 	};
 
 	/*
 	Sorts contacts by distance. We add to this when we receive a host_list.
 	Note: We don't know the distance of endpoints in a host list so we assume
-		they're one less than the host that sent the host_list.
-	Note: If a contact times out we set it's distance to maximum, effectively
-		deprioritizing it.
+		they're one less than the host that sent the host_list. When the host
+		responds it is moved to it's real distance.
 	*/
-	std::multimap<mpa::mpint, store_element> Store;
+	std::multimap<k_ID, store_element> Store;
 
 	/*
 	After we receive a host_list we add the endpoint which sent it to this
 	container. This container is kept sized to max number of endpoints we will
 	send store messages to.
-	Note: The distance of the endpoint is recalculated because it may not be
-		accurate (see Store documentation).
 	*/
-	std::multimap<mpa::mpint, net::endpoint> Found;
+	std::multimap<k_ID, net::endpoint> Found;
 
 	//memoize endpoints to eliminate duplicate find_node requests
 	std::set<net::endpoint> Memoize;
 
+	//number of contacts in in_flight_state
+	unsigned in_flight;
+
+	//set to true after protocol_udp::find_timeout
+	bool timed_out;
+	timer_wheel::handle Expire_Timer;
+
 	class call_back_element
 	{
 	public:
@@ -107,7 +130,15 @@ private:
 	/*
 	call_back:
 		Do any call backs which need to be done for endpoint.
+	expire:
+		Timer call back for protocol_udp::find_timeout.
+	stall:
+		Timer call back when endpoint takes longer than it's RTT timeout to
+		respond. The endpoint no longer counts against find_alpha but a late
+		response will still be used.
 	*/
-	void call_back(const net::endpoint & ep, const mpa::mpint & dist);
+	void call_back(const net::endpoint & ep, const k_ID & dist);
+	void expire();
+	void stall(const net::endpoint ep);
 };
 #endif
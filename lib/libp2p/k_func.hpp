@@ -2,32 +2,30 @@
 #define H_K_FUNC
 
 //custom
+#include "k_ID.hpp"
 #include "protocol_udp.hpp"
 
-//include
-#include <bit_field.hpp>
-#include <convert.hpp>
-#include <mpa.hpp>
-
 namespace k_func
 {
 /*
 bucket_num:
-	Returns what bucket a ID belongs in. The bucket numbers are symmetric so it
-	doesn't matter what order the IDs are in.
+	Returns what bucket a ID belongs in. This is the index of the highest bit
+	that differs between the IDs. The bucket numbers are symmetric so it doesn't
+	matter what order the IDs are in.
 	Note: One of the IDs should be local, and one remote.
 distance:
 	Returns the distance from one ID to another. Distance is symmetric so it
 	doesn't matter what order the IDs are in.
-ID_to_bit_field:
-	Converts a ID to a bit_field.
-ID_to_mpint:
-	Converts a ID to a mpint.
 */
-extern unsigned bucket_num(const std::string & ID_0,
-	const std::string & ID_1);
-extern mpa::mpint distance(const std::string & ID_0, const std::string & ID_1);
-extern bit_field ID_to_bit_field(const std::string & ID);
-extern mpa::mpint ID_to_mpint(const std::string & ID);
+inline unsigned bucket_num(const k_ID & ID_0, const k_ID & ID_1)
+{
+	unsigned lz = (ID_0 ^ ID_1).leading_zeros();
+	return lz == protocol_udp::bucket_count ? 0 : protocol_udp::bucket_count - 1 - lz;
+}
+
+inline k_ID distance(const k_ID & ID_0, const k_ID & ID_1)
+{
+	return ID_0 ^ ID_1;
+}
 }//end of namespace k_func
 #endif
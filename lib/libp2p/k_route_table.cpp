@@ -2,9 +2,9 @@
 
 k_route_table::k_route_table(
 	atomic_int<unsigned> & active_cnt,
-	const boost::function<void (const net::endpoint &, const std::string &)> & route_table_call_back
+	const boost::function<void (const net::endpoint &, const k_ID &)> & route_table_call_back
 ):
-	local_ID(db::table::prefs::get_ID())
+	local_ID(k_ID::from_hex(db::table::prefs::get_ID()))
 {
 	for(unsigned x=0; x<protocol_udp::bucket_count; ++x){
 		Bucket_4[x].reset(new k_bucket(active_cnt, route_table_call_back));
@@ -12,55 +12,56 @@ k_route_table::k_route_table(
 	}
 }
 
-void k_route_table::add_reserve(const net::endpoint & ep, const std::string & remote_ID)
+void k_route_table::add_reserve(const net::endpoint & ep)
 {
-	if(remote_ID.empty()){
-		for(unsigned x=0; x<protocol_udp::bucket_count; ++x){
-			if(Bucket_4[x]->exists(ep)){
-				return;
-			}
-			if(Bucket_6[x]->exists(ep)){
-				return;
-			}
-		}
-		if(Unknown_Reserve.find(ep) != Unknown_Reserve.end()
-			|| Unknown_Active.find(ep) != Unknown_Active.end())
-		{
+	for(unsigned x=0; x<protocol_udp::bucket_count; ++x){
+		if(Bucket_4[x]->exists(ep)){
 			return;
 		}
-		//LOG << "add unknown: " << ep.IP() << " " << ep.port();
-		Unknown_Reserve.insert(ep);
-	}else{
-		Unknown_Reserve.erase(ep);
-		if(Unknown_Active.find(ep) != Unknown_Active.end()){
+		if(Bucket_6[x]->exists(ep)){
 			return;
 		}
-		unsigned bucket_num = k_func::bucket_num(local_ID, remote_ID);
-		if(ep.version() == net::IPv4){
-			Bucket_4[bucket_num]->add_reserve(ep, remote_ID);
-		}else{
-			Bucket_6[bucket_num]->add_reserve(ep, remote_ID);
-		}
+	}
+	if(Unknown_Reserve.find(ep) != Unknown_Reserve.end()
+		|| Unknown_Active.find(ep) != Unknown_Active.end())
+	{
+		return;
+	}
+	//LOG << "add unknown: " << ep.IP() << " " << ep.port();
+	Unknown_Reserve.insert(ep);
+}
+
+void k_route_table::add_reserve(const net::endpoint & ep, const k_ID & remote_ID)
+{
+	Unknown_Reserve.erase(ep);
+	if(Unknown_Active.find(ep) != Unknown_Active.end()){
+		return;
+	}
+	unsigned bucket_num = k_func::bucket_num(local_ID, remote_ID);
+	if(ep.version() == net::IPv4){
+		Bucket_4[bucket_num]->add_reserve(ep, remote_ID);
+	}else{
+		Bucket_6[bucket_num]->add_reserve(ep, remote_ID);
 	}
 }
 
 std::list<net::endpoint> k_route_table::find_node(const net::endpoint & from,
-	const std::string & ID_to_find)
+	const k_ID & ID_to_find)
 {
 	struct func_local{
 	//trim to host_list size
-	static void trim(std::multimap<mpa::mpint, net::endpoint> & hosts)
+	static void trim(std::multimap<k_ID, net::endpoint> & hosts)
 	{
 		while(hosts.size() > protocol_udp::host_list_elements / 2){
-			std::multimap<mpa::mpint, net::endpoint>::iterator iter = hosts.end();
+			std::multimap<k_ID, net::endpoint>::iterator iter = hosts.end();
 			--iter;
 			hosts.erase(iter);
 		}
 	}
 	};
 	//get nodes which are closer
-	std::multimap<mpa::mpint, net::endpoint> hosts_4;
-	std::multimap<mpa::mpint, net::endpoint> hosts_6;
+	std::multimap<k_ID, net::endpoint> hosts_4;
+	std::multimap<k_ID, net::endpoint> hosts_6;
 	for(unsigned x=0; x<protocol_udp::bucket_count; ++x){
 		Bucket_4[x]->find_node(from, ID_to_find, hosts_4);
 		func_local::trim(hosts_4);
@@ -68,11 +69,11 @@ std::list<net::endpoint> k_route_table::find_node(const net::endpoint & from,
 		func_local::trim(hosts_6);
 	}
 	//combine IPv4 and IPv6
-	std::multimap<mpa::mpint, net::endpoint> hosts;
+	std::multimap<k_ID, net::endpoint> hosts;
 	hosts.insert(hosts_4.begin(), hosts_4.end());
 	hosts.insert(hosts_6.begin(), hosts_6.end());
 	std::list<net::endpoint> hosts_final;
-	for(std::multimap<mpa::mpint, net::endpoint>::iterator it_cur = hosts.begin(),
+	for(std::multimap<k_ID, net::endpoint>::iterator it_cur = hosts.begin(),
 		it_end = hosts.end(); it_cur != it_end; ++it_cur)
 	{
 		hosts_final.push_back(it_cur->second);
@@ -80,18 +81,18 @@ std::list<net::endpoint> k_route_table::find_node(const net::endpoint & from,
 	return hosts_final;
 }
 
-std::multimap<mpa::mpint, net::endpoint> k_route_table::find_node_local(
-	const std::string & ID_to_find)
+std::multimap<k_ID, net::endpoint> k_route_table::find_node_local(
+	const k_ID & ID_to_find)
 {
 	//get all nodes
-	std::multimap<mpa::mpint, net::endpoint> hosts_4;
-	std::multimap<mpa::mpint, net::endpoint> hosts_6;
+	std::multimap<k_ID, net::endpoint> hosts_4;
+	std::multimap<k_ID, net::endpoint> hosts_6;
 	for(unsigned x=0; x<protocol_udp::bucket_count; ++x){
 		Bucket_4[x]->find_node(ID_to_find, hosts_4);
 		Bucket_6[x]->find_node(ID_to_find, hosts_6);
 	}
 	//combine IPv4 and IPv6
-	std::multimap<mpa::mpint, net::endpoint> hosts;
+	std::multimap<k_ID, net::endpoint> hosts;
 	hosts.insert(hosts_4.begin(), hosts_4.end());
 	hosts.insert(hosts_6.begin(), hosts_6.end());
 	return hosts;
@@ -135,7 +136,7 @@ boost::optional<net::endpoint> k_route_table::ping()
 }
 
 void k_route_table::recv_pong(const net::endpoint & from,
-	const std::string & remote_ID)
+	const k_ID & remote_ID)
 {
 	Unknown_Active.erase(from);
 	Unknown_Reserve.erase(from);
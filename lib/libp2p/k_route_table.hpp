@@ -23,11 +23,14 @@ public:
 	*/
 	k_route_table(
 		atomic_int<unsigned> & active_cnt,
-		const boost::function<void (const net::endpoint &, const std::string &)> & route_table_call_back
+		const boost::function<void (const net::endpoint &, const k_ID &)> & route_table_call_back
 	);
 
 	/*
-	add_reserve:
+	add_reserve (one parameter):
+		Add endpoint with unknown ID to reserve. It will be pinged to find out
+		what bucket it belongs in.
+	add_reserve (two parameters):
 		Add endpoint to reserve. Nodes that go in to a k_bucket start in reserve.
 	find_node:
 		Returns endpoints closest to ID_to_find. The returned list is suitable to
@@ -41,12 +44,13 @@ public:
 		Call back used when pinging endpoint in Unknown. This call back determines
 		what bucket the endpoint belongs in.
 	*/
-	void add_reserve(const net::endpoint & ep, const std::string & remote_ID = "");
+	void add_reserve(const net::endpoint & ep);
+	void add_reserve(const net::endpoint & ep, const k_ID & remote_ID);
 	std::list<net::endpoint> find_node(const net::endpoint & from,
-		const std::string & ID_to_find);
-	std::multimap<mpa::mpint, net::endpoint> find_node_local(const std::string & ID_to_find);
+		const k_ID & ID_to_find);
+	std::multimap<k_ID, net::endpoint> find_node_local(const k_ID & ID_to_find);
 	boost::optional<net::endpoint> ping();
-	void recv_pong(const net::endpoint & from, const std::string & remote_ID);
+	void recv_pong(const net::endpoint & from, const k_ID & remote_ID);
 
 	/* Timed Functions
 	tick:
@@ -55,7 +59,7 @@ public:
 	void tick();
 
 private:
-	const std::string local_ID;
+	const k_ID local_ID;
 
 	//k_buckets for IPv4 and IPv6
 	boost::scoped_ptr<k_bucket> Bucket_4[protocol_udp::bucket_count];
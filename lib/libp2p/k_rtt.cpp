@@ -0,0 +1,43 @@
+#include "k_rtt.hpp"
+
+//BEGIN estimate
+k_rtt::estimate::estimate(const unsigned ms):
+	srtt(ms),
+	rttvar(ms / 2)
+{
+
+}
+//END estimate
+
+void k_rtt::add(const net::endpoint & ep, const unsigned ms)
+{
+	std::map<net::endpoint, estimate>::iterator it = Estimate.find(ep);
+	if(it == Estimate.end()){
+		Estimate.insert(std::make_pair(ep, estimate(ms)));
+		Order.push_back(ep);
+		if(Order.size() > protocol_udp::rtt_max_contacts){
+			Estimate.erase(Order.front());
+			Order.pop_front();
+		}
+	}else{
+		unsigned delta = it->second.srtt > ms ? it->second.srtt - ms
+			: ms - it->second.srtt;
+		it->second.rttvar = (3 * it->second.rttvar + delta) / 4;
+		it->second.srtt = (7 * it->second.srtt + ms) / 8;
+	}
+}
+
+unsigned k_rtt::timeout(const net::endpoint & ep)
+{
+	std::map<net::endpoint, estimate>::iterator it = Estimate.find(ep);
+	if(it == Estimate.end()){
+		return protocol_udp::rtt_initial;
+	}
+	unsigned ms = it->second.srtt + 4 * it->second.rttvar;
+	if(ms < protocol_udp::rtt_min){
+		return protocol_udp::rtt_min;
+	}else if(ms > protocol_udp::response_timeout * 1000){
+		return protocol_udp::response_timeout * 1000;
+	}
+	return ms;
+}
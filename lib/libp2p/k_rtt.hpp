@@ -0,0 +1,52 @@
+#ifndef H_K_RTT
+#define H_K_RTT
+
+//custom
+#include "protocol_udp.hpp"
+
+//include
+#include <boost/utility.hpp>
+#include <net/net.hpp>
+
+//standard
+#include <list>
+#include <map>
+
+/*
+Round trip time estimates for contacts. Used to decide how long to wait for a
+response before giving up on a contact and sending the request to another.
+The estimate is the same as TCP uses (RFC 6298).
+*/
+class k_rtt : private boost::noncopyable
+{
+public:
+	/*
+	add:
+		Add RTT sample (milliseconds) for endpoint.
+	timeout:
+		Returns milliseconds to wait for a response from endpoint. This is
+		protocol_udp::rtt_initial if we have no estimate for the endpoint.
+	*/
+	void add(const net::endpoint & ep, const unsigned ms);
+	unsigned timeout(const net::endpoint & ep);
+
+private:
+	class estimate
+	{
+	public:
+		explicit estimate(const unsigned ms);
+		unsigned srtt;   //smoothed RTT (ms)
+		unsigned rttvar; //RTT variation (ms)
+	};
+
+	/*
+	Estimate:
+		Estimate for each endpoint.
+	Order:
+		Endpoints in the order they were added to Estimate. When there are more
+		than protocol_udp::rtt_max_contacts the oldest is removed.
+	*/
+	std::map<net::endpoint, estimate> Estimate;
+	std::list<net::endpoint> Order;
+};
+#endif
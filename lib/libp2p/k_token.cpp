@@ -3,26 +3,27 @@
 //BEGIN token
 k_token::token::token(
 	const net::buffer & random_in,
-	const unsigned timeout
+	const timer_wheel::handle & Timer_in
 ):
 	random(random_in),
-	time(std::time(NULL) + timeout)
+	Timer(Timer_in)
 {
 
 }
 
 k_token::token::token(const token & T):
 	random(T.random),
-	time(T.time)
+	Timer(T.Timer)
 {
 
 }
+//END token
 
-bool k_token::token::timeout()
+k_token::k_token(timer_wheel & Timer_Wheel_in):
+	Timer_Wheel(Timer_Wheel_in)
 {
-	return std::time(NULL) > time;
+
 }
-//END token
 
 boost::optional<net::buffer> k_token::get_token(const net::endpoint & ep)
 {
@@ -48,35 +49,36 @@ bool k_token::has_been_issued(const net::endpoint & ep,
 
 void k_token::issue(const net::endpoint & ep, const net::buffer & random)
 {
-	issued_token.insert(std::make_pair(ep, token(random,
-		protocol_udp::store_token_issued_timeout)));
+	issued_token.insert(std::make_pair(ep, token(random, Timer_Wheel.arm(
+		protocol_udp::store_token_issued_timeout * 1000,
+		boost::bind(&k_token::issued_timeout, this, ep, random)))));
 }
 
-void k_token::receive(const net::endpoint & ep, const net::buffer & random)
+void k_token::issued_timeout(const net::endpoint ep, const net::buffer random)
 {
-	received_token.erase(ep);
-	received_token.insert(std::make_pair(ep, token(random,
-		protocol_udp::store_token_received_timeout)));
+	typedef std::multimap<net::endpoint, token>::iterator it_t;
+	std::pair<it_t, it_t> p = issued_token.equal_range(ep);
+	for(; p.first != p.second; ++p.first){
+		if(p.first->second.random == random){
+			issued_token.erase(p.first);
+			return;
+		}
+	}
 }
 
-void k_token::tick()
+void k_token::receive(const net::endpoint & ep, const net::buffer & random)
 {
-	for(std::multimap<net::endpoint, token>::iterator it_cur = issued_token.begin();
-		it_cur != issued_token.end();)
-	{
-		if(it_cur->second.timeout()){
-			issued_token.erase(it_cur++);
-		}else{
-			++it_cur;
-		}
-	}
-	for(std::map<net::endpoint, token>::iterator it_cur = received_token.begin();
-		it_cur != received_token.end();)
-	{
-		if(it_cur->second.timeout()){
-			received_token.erase(it_cur++);
-		}else{
-			++it_cur;
-		}
+	std::map<net::endpoint, token>::iterator it = received_token.find(ep);
+	if(it != received_token.end()){
+		Timer_Wheel.cancel(it->second.Timer);
+		received_token.erase(it);
 	}
+	received_token.insert(std::make_pair(ep, token(random, Timer_Wheel.arm(
+		protocol_udp::store_token_received_timeout * 1000,
+		boost::bind(&k_token::received_timeout, this, ep)))));
+}
+
+void k_token::received_timeout(const net::endpoint ep)
+{
+	received_token.erase(ep);
 }
@@ -7,13 +7,16 @@
 //include
 #include <boost/optional.hpp>
 #include <net/net.hpp>
+#include <timer_wheel.hpp>
 
 //standard
 #include <map>
 
-class k_token
+class k_token : private boost::noncopyable
 {
 public:
+	explicit k_token(timer_wheel & Timer_Wheel_in);
+
 	/* Tokens we issue.
 	has_been_issued:
 		Returns true if we have issued the specified token.
@@ -32,27 +35,21 @@ public:
 	boost::optional<net::buffer> get_token(const net::endpoint & ep);
 	void receive(const net::endpoint & ep, const net::buffer & random);
 
-	/* Timed Functions
-	tick:
-		Called once per second to time out tokens.
-	*/
-	void tick();
-
 private:
+	timer_wheel & Timer_Wheel;
+
 	class token
 	{
 	public:
 		token(
 			const net::buffer & random_in,
-			const unsigned timeout
+			const timer_wheel::handle & Timer_in
 		);
 		token(const token & T);
 		//token (random bytes send in pong)
 		const net::buffer random;
-		//returns true if token timed out
-		bool timeout();
-	private:
-		std::time_t time;
+		//removes token when it times out
+		timer_wheel::handle Timer;
 	};
 
 	//keep all tokens
@@ -60,5 +57,14 @@ private:
 
 	//only keep the newest token
 	std::map<net::endpoint, token> received_token;
+
+	/*
+	issued_timeout:
+		Timer call back to remove token we issued.
+	received_timeout:
+		Timer call back to remove token issued to us.
+	*/
+	void issued_timeout(const net::endpoint ep, const net::buffer random);
+	void received_timeout(const net::endpoint ep);
 };
 #endif
@@ -1,9 +1,12 @@
 #include "kad.hpp"
 
 kad::kad():
-	local_ID(db::table::prefs::get_ID()),
+	local_ID(k_ID::from_hex(db::table::prefs::get_ID())),
 	active_cnt(0),
+	Exchange(Timer_Wheel),
+	Find(Timer_Wheel),
 	Route_Table(active_cnt, boost::bind(&kad::route_table_call_back, this, _1, _2)),
+	Token(Timer_Wheel),
 	send_ping_called(false)
 {
 	//messages to expect anytime
@@ -60,8 +63,9 @@ void kad::find_file_relay(const std::string hash,
 	boost::shared_ptr<std::set<std::string> > node_list_memoize(new std::set<std::string>());
 
 	//find closest nodes to hash
-	std::multimap<mpa::mpint, net::endpoint> hosts = Route_Table.find_node_local(hash);
-	Find.set(hash, hosts, boost::bind(&kad::find_file_call_back_0, this, _1,
+	k_ID ID = k_ID::from_hex(hash);
+	std::multimap<k_ID, net::endpoint> hosts = Route_Table.find_node_local(ID);
+	Find.set(ID, hosts, boost::bind(&kad::find_file_call_back_0, this, _1,
 		hash, call_back, node_list_memoize));
 }
 
@@ -81,7 +85,7 @@ void kad::find_file_call_back_0(const net::endpoint & ep,
 }
 
 void kad::find_file_call_back_1(const net::endpoint & from,
-	const net::buffer & random, const std::string & remote_ID,
+	const net::buffer & random, const k_ID & remote_ID,
 	const std::list<std::string> & nodes,
 	const boost::function<void (const net::endpoint &)> call_back,
 	boost::shared_ptr<std::set<std::string> > node_list_memoize)
@@ -93,8 +97,9 @@ void kad::find_file_call_back_1(const net::endpoint & from,
 	{
 		if(node_list_memoize->find(*it_cur) == node_list_memoize->end()){
 			node_list_memoize->insert(*it_cur);
-			std::multimap<mpa::mpint, net::endpoint> hosts = Route_Table.find_node_local(*it_cur);
-			Find.set(*it_cur, hosts, call_back);
+			k_ID ID = k_ID::from_hex(*it_cur);
+			std::multimap<k_ID, net::endpoint> hosts = Route_Table.find_node_local(ID);
+			Find.set(ID, hosts, call_back);
 		}
 	}
 }
@@ -109,8 +114,9 @@ void kad::find_node(const std::string & ID,
 void kad::find_node_relay(const std::string ID,
 	const boost::function<void (const net::endpoint &)> call_back)
 {
-	std::multimap<mpa::mpint, net::endpoint> hosts = Route_Table.find_node_local(ID);
-	Find.node(ID, hosts, call_back);
+	k_ID ID_to_find = k_ID::from_hex(ID);
+	std::multimap<k_ID, net::endpoint> hosts = Route_Table.find_node_local(ID_to_find);
+	Find.node(ID_to_find, hosts, call_back);
 }
 
 void kad::network_loop()
@@ -124,7 +130,7 @@ void kad::network_loop()
 		if(E.empty()){
 			LOG << "failed \"" << hosts.back().IP << "\" " << hosts.back().port;
 		}else{
-			Route_Table.add_reserve(*E.begin(), hosts.back().ID);
+			Route_Table.add_reserve(*E.begin(), k_ID::from_hex(hosts.back().ID));
 		}
 		hosts.pop_back();
 	}
@@ -135,11 +141,8 @@ void kad::network_loop()
 	while(true){
 		boost::this_thread::interruption_point();
 		if(std::time(NULL) > second_timeout){
-			send_find_node();
 			send_ping();
-			Find.tick();
 			Route_Table.tick();
-			Token.tick();
 			second_timeout = std::time(NULL) + 1;
 		}
 		if(std::time(NULL) > hour_timeout){
@@ -147,7 +150,10 @@ void kad::network_loop()
 			hour_timeout = std::time(NULL) + 60 * 60;
 		}
 		Exchange.tick();
+		Timer_Wheel.expire();
 		process_relay_job();
+		//responses, timeouts, and relay jobs may allow more find_node to be sent
+		send_find_node();
 	}
 }
 
@@ -168,10 +174,10 @@ void kad::process_relay_job()
 }
 
 void kad::recv_find_node(const net::endpoint & from,
-	const net::buffer & random, const std::string & remote_ID,
-	const std::string & ID_to_find)
+	const net::buffer & random, const k_ID & remote_ID,
+	const k_ID & ID_to_find)
 {
-	//LOG << from.IP() << " " << from.port() << " find: " << convert::abbr(ID_to_find);
+	//LOG << from.IP() << " " << from.port() << " find: " << convert::abbr(ID_to_find.hex());
 	Route_Table.add_reserve(from, remote_ID);
 	std::list<net::endpoint> hosts;
 	hosts = Route_Table.find_node(from, ID_to_find);
@@ -180,10 +186,10 @@ void kad::recv_find_node(const net::endpoint & from,
 }
 
 void kad::recv_host_list(const net::endpoint & from,
-	const std::string & remote_ID, const std::list<net::endpoint> & hosts,
-	const std::string ID_to_find)
+	const k_ID & remote_ID, const std::list<net::endpoint> & hosts,
+	const k_ID ID_to_find)
 {
-	//LOG << from.IP() << " " << from.port() << " " << convert::abbr(remote_ID);
+	//LOG << from.IP() << " " << from.port() << " " << convert::abbr(remote_ID.hex());
 	Route_Table.recv_pong(from, remote_ID);
 	for(std::list<net::endpoint>::const_iterator it_cur = hosts.begin(),
 		it_end = hosts.end(); it_cur != it_end; ++it_cur)
@@ -194,7 +200,7 @@ void kad::recv_host_list(const net::endpoint & from,
 }
 
 void kad::recv_ping(const net::endpoint & from,
-	const net::buffer & random, const std::string & remote_ID)
+	const net::buffer & random, const k_ID & remote_ID)
 {
 	Route_Table.add_reserve(from, remote_ID);
 	Token.issue(from, random);
@@ -203,14 +209,14 @@ void kad::recv_ping(const net::endpoint & from,
 }
 
 void kad::recv_pong(const net::endpoint & from, const net::buffer & random,
-	const std::string & remote_ID)
+	const k_ID & remote_ID)
 {
 	Token.receive(from, random);
 	Route_Table.recv_pong(from, remote_ID);
 }
 
 void kad::recv_query_file(const net::endpoint & from, const net::buffer & random,
-	const std::string & remote_ID, const std::string & hash)
+	const k_ID & remote_ID, const std::string & hash)
 {
 	//LOG << from.IP() << " " << from.port() << " " << convert::abbr(hash);
 	Route_Table.add_reserve(from, remote_ID);
@@ -230,38 +236,40 @@ void kad::recv_query_file(const net::endpoint & from, const net::buffer & random
 }
 
 void kad::recv_store_file(const net::endpoint & from, const net::buffer & random,
-	const std::string & remote_ID, const std::string & hash)
+	const k_ID & remote_ID, const std::string & hash)
 {
 	Route_Table.add_reserve(from, remote_ID);
 	if(Token.has_been_issued(from, random)){
-		//LOG << from.IP() << " " << from.port() << " " << convert::abbr(remote_ID)
+		//LOG << from.IP() << " " << from.port() << " " << convert::abbr(remote_ID.hex())
 			//<< " " << convert::abbr(hash);
-		db::table::source::add(remote_ID, hash);
+		db::batch::singleton()->add(boost::bind(&db::table::source::add,
+			remote_ID.hex(), hash, _1));
 	}else{
 		LOG << "invalid token: " << from.IP() << " " << from.port() << " " << convert::abbr(hash);
 	}
 }
 
 void kad::recv_store_node(const net::endpoint & from, const net::buffer & random,
-	const std::string & remote_ID)
+	const k_ID & remote_ID)
 {
 	if(Token.has_been_issued(from, random)){
-		//LOG << from.IP() << " " << from.port() << " " << convert::abbr(remote_ID);
-		db::table::peer::add(db::table::peer::info(remote_ID, from.IP(), from.port()));
+		//LOG << from.IP() << " " << from.port() << " " << convert::abbr(remote_ID.hex());
+		db::batch::singleton()->add(boost::bind(&db::table::peer::add,
+			db::table::peer::info(remote_ID.hex(), from.IP(), from.port()), _1));
 	}else{
-		LOG << "invalid token: " << from.IP() << " " << from.port() << convert::abbr(remote_ID);
+		LOG << "invalid token: " << from.IP() << " " << from.port() << convert::abbr(remote_ID.hex());
 	}
 }
 
-void kad::route_table_call_back(const net::endpoint & ep, const std::string & remote_ID)
+void kad::route_table_call_back(const net::endpoint & ep, const k_ID & remote_ID)
 {
 	Find.add_to_all(ep, remote_ID);
 }
 
 void kad::send_find_node()
 {
-	std::list<std::pair<net::endpoint, std::string> > jobs = Find.send_find_node();
-	for(std::list<std::pair<net::endpoint, std::string> >::iterator
+	std::list<std::pair<net::endpoint, k_ID> > jobs = Find.send_find_node();
+	for(std::list<std::pair<net::endpoint, k_ID> >::iterator
 		it_cur = jobs.begin(), it_end = jobs.end(); it_cur != it_end; ++it_cur)
 	{
 		net::buffer random(portable::urandom(4));
@@ -293,7 +301,7 @@ void kad::send_ping()
 
 void kad::send_store_node()
 {
-	std::multimap<mpa::mpint, net::endpoint> hosts = Route_Table.find_node_local(local_ID);
+	std::multimap<k_ID, net::endpoint> hosts = Route_Table.find_node_local(local_ID);
 	Find.set(local_ID, hosts, boost::bind(&kad::send_store_node_call_back_0, this, _1));
 }
 
@@ -318,7 +326,7 @@ void kad::send_store_node_call_back_0(const net::endpoint & ep)
 }
 
 void kad::send_store_node_call_back_1(const net::endpoint & from,
-	const net::buffer & random, const std::string & remote_ID)
+	const net::buffer & random, const k_ID & remote_ID)
 {
 	recv_pong(from, random, remote_ID);
 	//LOG << "store_node: " << from.IP() << " " << from.port();
@@ -340,7 +348,7 @@ void kad::store_file(const std::string & hash)
 
 void kad::store_file_relay(const std::string hash)
 {
-	std::multimap<mpa::mpint, net::endpoint> hosts = Route_Table.find_node_local(local_ID);
+	std::multimap<k_ID, net::endpoint> hosts = Route_Table.find_node_local(local_ID);
 	Find.set(local_ID, hosts, boost::bind(&kad::store_file_call_back_0, this, _1, hash));
 }
 
@@ -365,7 +373,7 @@ void kad::store_file_call_back_0(const net::endpoint & ep, const std::string has
 }
 
 void kad::store_file_call_back_1(const net::endpoint & from,
-	const net::buffer & random, const std::string & remote_ID,
+	const net::buffer & random, const k_ID & remote_ID,
 	const std::string hash)
 {
 	recv_pong(from, random, remote_ID);
@@ -14,6 +14,7 @@
 #include <atomic_int.hpp>
 #include <bit_field.hpp>
 #include <net/net.hpp>
+#include <timer_wheel.hpp>
 
 //standard
 #include <algorithm>
@@ -59,8 +60,9 @@ public:
 
 private:
 	boost::thread network_thread;
-	const std::string local_ID;      //our node ID
+	const k_ID local_ID;             //our node ID
 	atomic_int<unsigned> active_cnt; //number of active contacts in k_buckets
+	timer_wheel Timer_Wheel;         //timeouts for Exchange, Find, and Token
 	exchange_udp Exchange;
 	k_find Find;
 	k_route_table Route_Table;
@@ -116,25 +118,26 @@ private:
 		const boost::function<void (const net::endpoint &)> call_back,
 		boost::shared_ptr<std::set<std::string> > node_list_memoize);
 	void find_file_call_back_1(const net::endpoint & from,
-		const net::buffer & random, const std::string & remote_ID,
+		const net::buffer & random, const k_ID & remote_ID,
 		const std::list<std::string> & nodes,
 		const boost::function<void (const net::endpoint &)> call_back,
 		boost::shared_ptr<std::set<std::string> > node_list_memoize);
 	void network_loop();
 	void process_relay_job();
-	void route_table_call_back(const net::endpoint & ep, const std::string & remote_ID);
+	void route_table_call_back(const net::endpoint & ep, const k_ID & remote_ID);
 	void send_store_node_call_back_0(const net::endpoint & ep);
 	void send_store_node_call_back_1(const net::endpoint & from,
-		const net::buffer & random, const std::string & remote_ID);
+		const net::buffer & random, const k_ID & remote_ID);
 	void store_file_call_back_0(const net::endpoint & ep, const std::string hash);
 	void store_file_call_back_1(const net::endpoint & from,
-		const net::buffer & random, const std::string & remote_ID,
+		const net::buffer & random, const k_ID & remote_ID,
 		const std::string hash);
 
 	/* Timed Functions
 	Called by network_thread on regular time intervals.
 	send_find_node:
-		Send find_node messages.
+		Send find_node messages. Called every loop iteration so find jobs send
+		as soon as a response or timeout allows.
 	send_ping:
 		Send ping messages.
 	send_store_node:
@@ -150,20 +153,20 @@ private:
 	Functions named after the message they receive.
 	*/
 	void recv_find_node(const net::endpoint & from,
-		const net::buffer & random, const std::string & remote_ID,
-		const std::string & ID_to_find);
+		const net::buffer & random, const k_ID & remote_ID,
+		const k_ID & ID_to_find);
 	void recv_host_list(const net::endpoint & from,
-		const std::string & remote_ID, const std::list<net::endpoint> & hosts,
-		const std::string ID_to_find);
+		const k_ID & remote_ID, const std::list<net::endpoint> & hosts,
+		const k_ID ID_to_find);
 	void recv_ping(const net::endpoint & from, const net::buffer & random,
-		const std::string & remote_ID);
+		const k_ID & remote_ID);
 	void recv_pong(const net::endpoint & from, const net::buffer & random,
-		const std::string & remote_ID);
+		const k_ID & remote_ID);
 	void recv_query_file(const net::endpoint & from, const net::buffer & random,
-		const std::string & remote_ID, const std::string & hash);
+		const k_ID & remote_ID, const std::string & hash);
 	void recv_store_file(const net::endpoint & from, const net::buffer & random,
-		const std::string & remote_ID, const std::string & hash);
+		const k_ID & remote_ID, const std::string & hash);
 	void recv_store_node(const net::endpoint & from, const net::buffer & random,
-		const std::string & remote_ID);
+		const k_ID & remote_ID);
 };
 #endif
@@ -336,10 +336,10 @@ bool message_tcp::recv::key_exchange_p_rA::expect(const net::buffer & recv_buf)
 message_tcp::recv::status message_tcp::recv::key_exchange_p_rA::recv(net::buffer & recv_buf)
 {
 	assert(!recv_buf.empty());
-	if(recv_buf.size() >= protocol_tcp::DH_key_size * 2){
+	if(recv_buf.size() >= protocol_tcp::key_exchange_p_rA_size){
 		net::buffer buf;
-		buf.append(recv_buf.data(), protocol_tcp::DH_key_size * 2);
-		recv_buf.erase(0, protocol_tcp::DH_key_size * 2);
+		buf.append(recv_buf.data(), protocol_tcp::key_exchange_p_rA_size);
+		recv_buf.erase(0, protocol_tcp::key_exchange_p_rA_size);
 		if(func(buf)){
 			return complete;
 		}else{
@@ -369,10 +369,10 @@ bool message_tcp::recv::key_exchange_rB::expect(const net::buffer & recv_buf)
 message_tcp::recv::status message_tcp::recv::key_exchange_rB::recv(net::buffer & recv_buf)
 {
 	assert(!recv_buf.empty());
-	if(recv_buf.size() >= protocol_tcp::DH_key_size){
+	if(recv_buf.size() >= protocol_tcp::key_exchange_rB_size){
 		net::buffer buf;
-		buf.append(recv_buf.data(), protocol_tcp::DH_key_size);
-		recv_buf.erase(0, protocol_tcp::DH_key_size);
+		buf.append(recv_buf.data(), protocol_tcp::key_exchange_rB_size);
+		recv_buf.erase(0, protocol_tcp::key_exchange_rB_size);
 		if(func(buf)){
 			return complete;
 		}else{
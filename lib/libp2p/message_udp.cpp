@@ -25,10 +25,8 @@ bool message_udp::recv::find_node::recv(const net::buffer & recv_buf,
 		return false;
 	}
 	net::buffer random(recv_buf.data()+1, 4);
-	std::string remote_ID(convert::bin_to_hex(std::string(
-		reinterpret_cast<const char *>(recv_buf.data())+5, 20)));
-	std::string ID_to_find(convert::bin_to_hex(std::string(
-		reinterpret_cast<const char *>(recv_buf.data())+25, 20)));
+	k_ID remote_ID = k_ID::from_bin(recv_buf.data()+5);
+	k_ID ID_to_find = k_ID::from_bin(recv_buf.data()+25);
 	func(endpoint, random, remote_ID, ID_to_find);
 	return true;
 }
@@ -90,8 +88,7 @@ bool message_udp::recv::host_list::recv(const net::buffer & recv_buf,
 	if(!expect(recv_buf)){
 		return false;
 	}
-	std::string remote_ID(convert::bin_to_hex(std::string(
-		reinterpret_cast<const char *>(recv_buf.data())+5, 20)));
+	k_ID remote_ID = k_ID::from_bin(recv_buf.data()+5);
 	bit_field BF(recv_buf.data()+25, 2, 16);
 	std::list<net::endpoint> hosts;
 	unsigned offset = protocol_udp::host_list_size;
@@ -141,8 +138,7 @@ bool message_udp::recv::ping::recv(const net::buffer & recv_buf,
 		return false;
 	}
 	net::buffer random(recv_buf.data()+1, 4);
-	std::string remote_ID(convert::bin_to_hex(std::string(
-		reinterpret_cast<const char *>(recv_buf.data())+5, 20)));
+	k_ID remote_ID = k_ID::from_bin(recv_buf.data()+5);
 	func(endpoint, random, remote_ID);
 	return true;
 }
@@ -177,8 +173,7 @@ bool message_udp::recv::pong::recv(const net::buffer & recv_buf,
 		return false;
 	}
 	net::buffer random(recv_buf.data()+1, 4);
-	std::string remote_ID(convert::bin_to_hex(std::string(
-		reinterpret_cast<const char *>(recv_buf.data())+5, 20)));
+	k_ID remote_ID = k_ID::from_bin(recv_buf.data()+5);
 	func(endpoint, random, remote_ID);
 	return true;
 }
@@ -211,8 +206,7 @@ bool message_udp::recv::store_node::recv(const net::buffer & recv_buf,
 		return false;
 	}
 	net::buffer random(recv_buf.data()+1, 4);
-	std::string remote_ID(convert::bin_to_hex(std::string(
-		reinterpret_cast<const char *>(recv_buf.data())+5, 20)));
+	k_ID remote_ID = k_ID::from_bin(recv_buf.data()+5);
 	func(endpoint, random, remote_ID);
 	return true;
 }
@@ -245,8 +239,7 @@ bool message_udp::recv::store_file::recv(const net::buffer & recv_buf,
 		return false;
 	}
 	net::buffer random(recv_buf.data()+1, 4);
-	std::string remote_ID(convert::bin_to_hex(std::string(
-		reinterpret_cast<const char *>(recv_buf.data())+5, 20)));
+	k_ID remote_ID = k_ID::from_bin(recv_buf.data()+5);
 	std::string hash(convert::bin_to_hex(std::string(
 		reinterpret_cast<const char *>(recv_buf.data())+25, 20)));
 	func(endpoint, random, remote_ID, hash);
@@ -281,8 +274,7 @@ bool message_udp::recv::query_file::recv(const net::buffer & recv_buf,
 		return false;
 	}
 	net::buffer random(recv_buf.data()+1, 4);
-	std::string remote_ID(convert::bin_to_hex(std::string(
-		reinterpret_cast<const char *>(recv_buf.data())+5, 20)));
+	k_ID remote_ID = k_ID::from_bin(recv_buf.data()+5);
 	std::string hash(convert::bin_to_hex(std::string(
 		reinterpret_cast<const char *>(recv_buf.data())+25, 20)));
 	func(endpoint, random, remote_ID, hash);
@@ -322,8 +314,7 @@ bool message_udp::recv::node_list::recv(const net::buffer & recv_buf,
 		return false;
 	}
 	net::buffer random(recv_buf.data()+1, 4);
-	std::string remote_ID(convert::bin_to_hex(std::string(
-		reinterpret_cast<const char *>(recv_buf.data())+5, 20)));
+	k_ID remote_ID = k_ID::from_bin(recv_buf.data()+5);
 	std::list<std::string> nodes;
 	unsigned offset = protocol_udp::node_list_size;
 	for(unsigned x=0; x<16 && offset != recv_buf.size(); ++x){
@@ -338,21 +329,19 @@ bool message_udp::recv::node_list::recv(const net::buffer & recv_buf,
 
 //BEGIN send::find_node
 message_udp::send::find_node::find_node(const net::buffer & random,
-	const std::string & local_ID, const std::string & ID_to_find)
+	const k_ID & local_ID, const k_ID & ID_to_find)
 {
 	assert(random.size() == 4);
-	assert(local_ID.size() == SHA1::hex_size);
-	assert(ID_to_find.size() == SHA1::hex_size);
 	buf.append(protocol_udp::find_node)
 		.append(random)
-		.append(convert::hex_to_bin(local_ID))
-		.append(convert::hex_to_bin(ID_to_find));
+		.append(local_ID.bin())
+		.append(ID_to_find.bin());
 }
 //END send::find_node
 
 //BEGIN send::host_list
 message_udp::send::host_list::host_list(const net::buffer & random,
-	const std::string & local_ID,
+	const k_ID & local_ID,
 	const std::list<net::endpoint> & hosts)
 {
 	assert(random.size() == 4);
@@ -371,7 +360,7 @@ message_udp::send::host_list::host_list(const net::buffer & random,
 	}
 	buf.append(protocol_udp::host_list)
 		.append(random)
-		.append(convert::hex_to_bin(local_ID))
+		.append(local_ID.bin())
 		.append(BF.get_buf());
 	//append addresses
 	for(std::list<net::endpoint>::const_iterator it_cur = hosts.begin(),
@@ -385,78 +374,72 @@ message_udp::send::host_list::host_list(const net::buffer & random,
 
 //BEGIN send::ping
 message_udp::send::ping::ping(const net::buffer & random,
-	const std::string & local_ID)
+	const k_ID & local_ID)
 {
 	assert(random.size() == 4);
-	assert(local_ID.size() == SHA1::hex_size);
 	buf.append(protocol_udp::ping)
 		.append(random)
-		.append(convert::hex_to_bin(local_ID));
+		.append(local_ID.bin());
 }
 //END send::ping
 
 //BEGIN send::pong
 message_udp::send::pong::pong(const net::buffer & random,
-	const std::string & local_ID)
+	const k_ID & local_ID)
 {
 	assert(random.size() == 4);
-	assert(local_ID.size() == SHA1::hex_size);
 	buf.append(protocol_udp::pong)
 		.append(random)
-		.append(convert::hex_to_bin(local_ID));
+		.append(local_ID.bin());
 }
 //END send::pong
 
 //BEGIN send::store_node
 message_udp::send::store_node::store_node(const net::buffer & random,
-	const std::string & local_ID)
+	const k_ID & local_ID)
 {
 	assert(random.size() == 4);
-	assert(local_ID.size() == SHA1::hex_size);
 	buf.append(protocol_udp::store_node)
 		.append(random)
-		.append(convert::hex_to_bin(local_ID));
+		.append(local_ID.bin());
 }
 //END send::store_node
 
 //BEGIN send::store_file
 message_udp::send::store_file::store_file(const net::buffer & random,
-	const std::string & local_ID, const std::string & hash)
+	const k_ID & local_ID, const std::string & hash)
 {
 	assert(random.size() == 4);
-	assert(local_ID.size() == SHA1::hex_size);
 	assert(hash.size() == SHA1::hex_size);
 	buf.append(protocol_udp::store_file)
 		.append(random)
-		.append(convert::hex_to_bin(local_ID))
+		.append(local_ID.bin())
 		.append(convert::hex_to_bin(hash));
 }
 //END send::store_file
 
 //BEGIN send::query_file
 message_udp::send::query_file::query_file(const net::buffer & random,
-	const std::string & local_ID, const std::string & hash)
+	const k_ID & local_ID, const std::string & hash)
 {
 	assert(random.size() == 4);
-	assert(local_ID.size() == SHA1::hex_size);
 	assert(hash.size() == SHA1::hex_size);
 	buf.append(protocol_udp::query_file)
 		.append(random)
-		.append(convert::hex_to_bin(local_ID))
+		.append(local_ID.bin())
 		.append(convert::hex_to_bin(hash));
 }
 //END send::query_file
 
 //BEGIN send::node_list
 message_udp::send::node_list::node_list(const net::buffer & random,
-	const std::string & local_ID, const std::list<std::string> & nodes)
+	const k_ID & local_ID, const std::list<std::string> & nodes)
 {
 	assert(random.size() == 4);
-	assert(local_ID.size() == SHA1::hex_size);
 	assert(nodes.size() <= protocol_udp::node_list_elements);
 	buf.append(protocol_udp::node_list)
 		.append(random)
-		.append(convert::hex_to_bin(local_ID));
+		.append(local_ID.bin());
 	for(std::list<std::string>::const_iterator it_cur = nodes.begin(),
 		it_end = nodes.end(); it_cur != it_end; ++it_cur)
 	{
@@ -2,6 +2,7 @@
 #define H_MESSAGE_UDP
 
 //custom
+#include "k_ID.hpp"
 #include "protocol_udp.hpp"
 
 //include
@@ -31,7 +32,7 @@ class ping : public base
 {
 public:
 	typedef boost::function<void (const net::endpoint & from,
-		const net::buffer & random, const std::string & remote_ID)> handler;
+		const net::buffer & random, const k_ID & remote_ID)> handler;
 	ping(handler func_in);
 	virtual bool expect(const net::buffer & recv_buf);
 	virtual bool recv(const net::buffer & recv_buf,
@@ -44,7 +45,7 @@ class pong : public base
 {
 public:
 	typedef boost::function<void (const net::endpoint & from,
-		const net::buffer & random, const std::string & remote_ID)> handler;
+		const net::buffer & random, const k_ID & remote_ID)> handler;
 	pong(handler func_in, const net::buffer & random_in);
 	virtual bool expect(const net::buffer & recv_buf);
 	virtual bool recv(const net::buffer & recv_buf,
@@ -58,8 +59,8 @@ class find_node : public base
 {
 public:
 	typedef boost::function<void (const net::endpoint & from,
-		const net::buffer & random, const std::string & remote_ID,
-		const std::string & ID_to_find)> handler;
+		const net::buffer & random, const k_ID & remote_ID,
+		const k_ID & ID_to_find)> handler;
 	find_node(handler func_in);
 	virtual bool expect(const net::buffer & recv_buf);
 	virtual bool recv(const net::buffer & recv_buf,
@@ -72,7 +73,7 @@ class host_list : public base
 {
 public:
 	typedef boost::function<void (const net::endpoint & from,
-		const std::string & remote_ID, const std::list<net::endpoint> & hosts)> handler;
+		const k_ID & remote_ID, const std::list<net::endpoint> & hosts)> handler;
 	host_list(handler func_in, const net::buffer & random_in);
 	virtual bool expect(const net::buffer & recv_buf);
 	virtual bool recv(const net::buffer & recv_buf,
@@ -86,7 +87,7 @@ class store_node : public base
 {
 public:
 	typedef boost::function<void (const net::endpoint & from,
-		const net::buffer & random, const std::string & remote_ID)> handler;
+		const net::buffer & random, const k_ID & remote_ID)> handler;
 	store_node(handler func_in);
 	virtual bool expect(const net::buffer & recv_buf);
 	virtual bool recv(const net::buffer & recv_buf,
@@ -99,7 +100,7 @@ class store_file : public base
 {
 public:
 	typedef boost::function<void (const net::endpoint & from,
-		const net::buffer & random, const std::string & remote_ID,
+		const net::buffer & random, const k_ID & remote_ID,
 		const std::string & hash)> handler;
 	store_file(handler func_in);
 	virtual bool expect(const net::buffer & recv_buf);
@@ -113,7 +114,7 @@ class query_file : public base
 {
 public:
 	typedef boost::function<void (const net::endpoint & from,
-		const net::buffer & random, const std::string & remote_ID,
+		const net::buffer & random, const k_ID & remote_ID,
 		const std::string & hash)> handler;
 	query_file(handler func_in);
 	virtual bool expect(const net::buffer & recv_buf);
@@ -127,7 +128,7 @@ class node_list : public base
 {
 public:
 	typedef boost::function<void (const net::endpoint & from,
-		const net::buffer & random, const std::string & remote_ID,
+		const net::buffer & random, const k_ID & remote_ID,
 		const std::list<std::string> & nodes)> handler;
 	node_list(handler func_in, const net::buffer & random_in);
 	virtual bool expect(const net::buffer & recv_buf);
@@ -152,53 +153,53 @@ public:
 class ping : public base
 {
 public:
-	ping(const net::buffer & random, const std::string & local_ID);
+	ping(const net::buffer & random, const k_ID & local_ID);
 };
 
 class pong : public base
 {
 public:
-	pong(const net::buffer & random, const std::string & local_ID);
+	pong(const net::buffer & random, const k_ID & local_ID);
 };
 
 class find_node : public base
 {
 public:
 	find_node(const net::buffer & random,
-		const std::string & local_ID, const std::string & ID_to_find);
+		const k_ID & local_ID, const k_ID & ID_to_find);
 };
 
 class host_list : public base
 {
 public:
-	host_list(const net::buffer & random, const std::string & local_ID,
+	host_list(const net::buffer & random, const k_ID & local_ID,
 		const std::list<net::endpoint> & hosts);
 };
 
 class store_node : public base
 {
 public:
-	store_node(const net::buffer & random, const std::string & local_ID);
+	store_node(const net::buffer & random, const k_ID & local_ID);
 };
 
 class store_file : public base
 {
 public:
-	store_file(const net::buffer & random, const std::string & local_ID,
+	store_file(const net::buffer & random, const k_ID & local_ID,
 		const std::string & hash);
 };
 
 class query_file : public base
 {
 public:
-	query_file(const net::buffer & random, const std::string & local_ID,
+	query_file(const net::buffer & random, const k_ID & local_ID,
 		const std::string & hash);
 };
 
 class node_list : public base
 {
 public:
-	node_list(const net::buffer & random, const std::string & local_ID,
+	node_list(const net::buffer & random, const k_ID & local_ID,
 		const std::list<std::string> & nodes);
 };
 
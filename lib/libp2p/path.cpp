@@ -50,6 +50,7 @@ void path::create_dirs()
 		boost::filesystem::create_directory(load_bad_dir());
 		boost::filesystem::create_directory(share_dir());
 		boost::filesystem::create_directory(tmp_dir());
+		boost::filesystem::create_directory(tree_dir());
 	}catch(const std::exception & e){
 		LOG << e.what();
 		exit(1);
@@ -134,6 +135,13 @@ std::string path::tmp_dir()
 	return static_wrap::get().program_dir + "tmp/";
 }
 
+std::string path::tree_dir()
+{
+	boost::recursive_mutex::scoped_lock lock(static_wrap::get().mutex);
+	static_wrap::get().non_set_func_called = true;
+	return static_wrap::get().program_dir + "tree/";
+}
+
 std::string path::tree_file()
 {
 	boost::recursive_mutex::scoped_lock lock(static_wrap::get().mutex);
@@ -48,6 +48,8 @@ public:
 		Path to share directory.
 	tmp_dir:
 		Path to temporary file directory.
+	tree_dir:
+		Directory hash trees are stored in, one file per tree named by hash.
 	tree_file:
 		Path to temporary hash tree file.
 		Note: Thread ID appended for uniqueness.
@@ -58,6 +60,7 @@ public:
 	static std::string load_bad_dir();
 	static std::string share_dir();
 	static std::string tmp_dir();
+	static std::string tree_dir();
 	static std::string tree_file();
 
 private:
@@ -12,7 +12,7 @@
 #include <boost/utility.hpp>
 #include <mpa.hpp>
 #include <RC4.hpp>
-#include <thread_pool.hpp>
+#include <work_stealing_pool.hpp>
 
 //standard
 #include <cstdlib>
@@ -57,6 +57,6 @@ private:
 	It's not very necessary to use it here anyways since there will only be one
 	prime_generator instantiated.
 	*/
-	thread_pool Thread_Pool;
+	work_stealing_pool Thread_Pool;
 };
 #endif
@@ -12,7 +12,13 @@ const unsigned DH_key_size = 16;       //size exchanged key in Diffie-Hellman-Me
 const unsigned hash_block_size = 512;  //number of hashes in hash block
 const unsigned file_block_size = hash_block_size * SHA1::bin_size;
 
+//ciphers negotiated during key exchange (bit flags)
+const unsigned char cipher_RC4 = 1;      //RC4-drop768, always supported
+const unsigned char cipher_ChaCha20 = 2; //ChaCha20 (64 bit nonce)
+
 //commands and message sizes
+const unsigned key_exchange_p_rA_size = DH_key_size * 2 + 1;
+const unsigned key_exchange_rB_size = DH_key_size + 1;
 const unsigned initial_ID_size = SHA1::bin_size;
 const unsigned initial_port_size = 2;
 const unsigned char error = 0;
@@ -15,18 +15,28 @@ bucket_size:
 contact_timeout:
 	Set timeout such that if all buckets full we have enough time to ping every
 	contact before timeout.
+find_alpha:
+	Maximum find_node requests in flight for a find job. Setting this high will
+	make finds work faster but waste more bandwidth and contact more hosts.
+find_cache_timeout:
+	How long the result of a finished find job is reused.
 find_timeout:
 	Maximum time to spend on a iterative find job.
 max_store:
-	Maximum number of endpoints to send store command to.
-no_delay_count:
-	The number of requests to make immediately when starting to find a node.
-	Setting this high will make finds work faster but waste more bandwidth and
-	contact more hosts.
+	Maximum number of endpoints to send store command to. A find job is
+	finished when this many of the closest contacts have responded.
 response_timeout:
 	How long to wait for a response to a request.
 retransmit_limit:
 	Maximum limit for retransmission.
+rtt_initial:
+	Time (ms) to wait for a find_node response from a contact we have no RTT
+	estimate for before sending to another contact.
+rtt_max_contacts:
+	Maximum number of contacts to keep RTT estimates for.
+rtt_min:
+	Minimum time (ms) to wait for a find_node response before sending to
+	another contact.
 store_token_issued_timeout:
 	Time limit on store tokens a remote host has given us.
 	Note: This is kept shorter than outgoing timeout so that the store token
@@ -37,11 +47,15 @@ store_token_received_timeout:
 const unsigned bucket_count = SHA1::bin_size * 8;
 const unsigned bucket_size = 16;
 const unsigned bucket_timeout = bucket_count * bucket_size * 2;
+const unsigned find_alpha = 3;
+const unsigned find_cache_timeout = 60 * 5;
 const unsigned find_timeout = 60;
 const unsigned max_store = 16;
-const unsigned no_delay_count = 2;
 const unsigned response_timeout = 30;
 const unsigned retransmit_limit = 2;
+const unsigned rtt_initial = 2000;
+const unsigned rtt_max_contacts = 4096;
+const unsigned rtt_min = 200;
 const unsigned store_token_issued_timeout = 60 * 8;
 const unsigned store_token_received_timeout = store_token_issued_timeout - 60;
 
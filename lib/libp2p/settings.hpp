@@ -14,7 +14,14 @@ const unsigned MAX_UPLOAD_RATE = 0;   //no limit
 
 //hard settings, not changable at runtime
 const int PRIME_CACHE = 64;         //minimum number of primes to keep in cache
-const int DATABASE_POOL_SIZE = 8;   //size of database connection pool
+const int DATABASE_POOL_SIZE = 8;   //read only database connections (plus one writer)
+const unsigned DATABASE_MMAP_SIZE = 64 * 1024 * 1024; //bytes of database to mmap
 const int SHARE_BUFFER_SIZE = 1024; //size of buffers between share pipeline stages
+const int FILE_CACHE_SIZE = 64;     //max open file descriptors kept by file_cache
+const bool FILE_PREALLOCATE = true; //allocate space for downloads on first write
+const int SHARE_HASH_FILES = 2;     //max files hashed concurrently by share_scanner
+const bool CHACHA20 = true;         //offer/accept ChaCha20 during key exchange
+const unsigned DATABASE_BATCH_MS = 100;    //max time update waits in db::batch
+const unsigned DATABASE_BATCH_ROWS = 1000; //max updates in one db::batch transaction
 }//end of namespace settings
 #endif
@@ -3,6 +3,7 @@
 share_scanner::share_scanner(connection_manager & Connection_Manager_in):
 	Connection_Manager(Connection_Manager_in),
 	started(false),
+	Hash_Pool(settings::SHARE_HASH_FILES),
 	Thread_Pool(1)
 {
 	//default share
@@ -14,31 +15,37 @@ share_scanner::~share_scanner()
 	hash_tree::stop_create();
 }
 
-void share_scanner::hash_file(boost::filesystem::recursive_directory_iterator it)
+void share_scanner::hash_file(const std::string path)
 {
-	if(share::singleton()->find_path(it->path().string()) == share::singleton()->end_file()){
+	if(share::singleton()->find_path(path) == share::singleton()->end_file()){
 		file_info FI;
-		FI.path = it->path().string();
+		FI.path = path;
 		try{
-			FI.file_size = boost::filesystem::file_size(it->path());
-			FI.last_write_time = boost::filesystem::last_write_time(it->path());
+			FI.file_size = boost::filesystem::file_size(path);
+			FI.last_write_time = boost::filesystem::last_write_time(path);
 		}catch(const std::exception & e){
+			//next scan will retry file
 			LOG << e.what();
-			start_scan();
-			return;
+			FI.path.clear();
 		}
-		hash_tree::status Status = hash_tree::create(FI);
-		if(Status == hash_tree::good){
-			share::singleton()->insert(FI);
-			db::table::share::add(db::table::share::info(FI.hash, FI.path,
-				FI.file_size, FI.last_write_time, db::table::share::complete));
-			db::table::hash::set_state(FI.hash, db::table::hash::complete);
-			Connection_Manager.add(FI.hash);
-		}else{
-			share::singleton()->erase(FI.path);
+		if(!FI.path.empty()){
+			hash_tree::status Status = hash_tree::create(FI);
+			if(Status == hash_tree::good){
+				share::singleton()->insert(FI);
+				//batched, scan adds many files at once
+				db::batch::singleton()->add(boost::bind(&db::table::share::add,
+					db::table::share::info(FI.hash, FI.path, FI.file_size,
+					FI.last_write_time, db::table::share::complete), _1));
+				db::batch::singleton()->add(boost::bind(&db::table::hash::set_state,
+					FI.hash, db::table::hash::complete, _1));
+				Connection_Manager.add(FI.hash);
+			}else{
+				share::singleton()->erase(FI.path);
+			}
 		}
 	}
-	Thread_Pool.enqueue(boost::bind(&share_scanner::scan, this, ++it));
+	boost::mutex::scoped_lock lock(hashing_mutex);
+	Hashing.erase(path);
 }
 
 void share_scanner::remove_missing(share::const_file_iterator it)
@@ -52,7 +59,10 @@ void share_scanner::remove_missing(share::const_file_iterator it)
 			&& !share::singleton()->is_downloading(it->path))
 		{
 			share::singleton()->erase(it->path);
-			db::table::share::remove(it->path);
+			//queued so it can't run before a queued share::add of the path
+			db::batch::singleton()->add(boost::bind(&db::table::share::remove,
+				it->path, _1));
+			file_cache::singleton()->erase(it->path);
 		}
 		Thread_Pool.enqueue(boost::bind(&share_scanner::remove_missing, this, ++it), scan_delay_ms);
 	}
@@ -84,7 +94,21 @@ void share_scanner::scan(boost::filesystem::recursive_directory_iterator it)
 			if((!exists_in_share && !recently_modified)
 				|| (!downloading && modified && !recently_modified))
 			{
-				Thread_Pool.enqueue(boost::bind(boost::bind(&share_scanner::hash_file, this, it)));
+				boost::mutex::scoped_lock lock(hashing_mutex);
+				if(Hashing.find(it->path().string()) != Hashing.end()){
+					//already hashing file
+					Thread_Pool.enqueue(boost::bind(&share_scanner::scan, this, ++it), scan_delay_ms);
+				}else if(Hashing.size() >= settings::SHARE_HASH_FILES){
+					//wait for a file to finish hashing
+					Thread_Pool.enqueue(boost::bind(&share_scanner::scan, this, it), scan_delay_ms);
+				}else{
+					//file may have been replaced, don't hash stale descriptor
+					file_cache::singleton()->erase(it->path().string());
+					Hashing.insert(it->path().string());
+					Hash_Pool.enqueue(boost::bind(&share_scanner::hash_file, this,
+						it->path().string()));
+					Thread_Pool.enqueue(boost::bind(&share_scanner::scan, this, ++it));
+				}
 			}else{
 				Thread_Pool.enqueue(boost::bind(&share_scanner::scan, this, ++it), scan_delay_ms);
 			}
@@ -3,6 +3,7 @@
 
 //custom
 #include "connection_manager.hpp"
+#include "file_cache.hpp"
 #include "file_info.hpp"
 #include "hash_tree.hpp"
 #include "share.hpp"
@@ -20,6 +21,7 @@
 #include <cassert>
 #include <deque>
 #include <map>
+#include <set>
 #include <string>
 
 class share_scanner : private boost::noncopyable
@@ -46,9 +48,18 @@ private:
 	boost::mutex shared_mutex;
 	std::list<std::string> shared;
 
+	/*
+	Paths of files being hashed by Hash_Pool. Used to avoid hashing the same
+	file twice and to limit the number of files hashed at once to
+	settings::SHARE_HASH_FILES.
+	*/
+	boost::mutex hashing_mutex;
+	std::set<std::string> Hashing;
+
 	/*
 	hash_file:
-		Threads wait in this function for files to hash.
+		Hashes file and adds it to share. Runs in Hash_Pool so the scan can
+		continue while large files are hashed.
 	remove_missing:
 		Removes missing files from share.
 	scan:
@@ -57,11 +68,13 @@ private:
 		Starts scanning shared directory. This is called by start() and also when
 		we catch a filesystem exception.
 	*/
-	void hash_file(boost::filesystem::recursive_directory_iterator it);
+	void hash_file(const std::string path);
 	void remove_missing(share::const_file_iterator it);
 	void scan(boost::filesystem::recursive_directory_iterator it);
 	void start_scan();
 
-	thread_pool Thread_Pool;
+	thread_pool Hash_Pool;   //hashes files, one thread per file
+	thread_pool Thread_Pool; //scans share, destroyed first
+
 };
 #endif
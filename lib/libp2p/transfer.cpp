@@ -30,6 +30,11 @@ transfer::transfer(const file_info & FI):
 {
 	assert(FI.file_size != 0);
 
+	//share_scanner batches share and hash updates, make sure they're committed
+	if(!db::batch::singleton()->flush()){
+		LOG << "queued database update failed";
+	}
+
 	//see if tree complete
 	boost::shared_ptr<db::table::hash::info>
 		hash_info = db::table::hash::find(FI.hash);
@@ -98,21 +103,51 @@ void transfer::check()
 		}
 	}
 
-	//only check file blocks with good hash tree parents
-	for(boost::uint64_t block_num=0; block_num<Hash_Tree.TI.file_block_count; ++block_num){
+	/*
+	Only check file blocks with good hash tree parents. Runs of adjacent
+	approved blocks are read with one vectored read.
+	*/
+	std::vector<net::buffer> bufs;
+	boost::uint64_t block_num = 0;
+	while(block_num < Hash_Tree.TI.file_block_count){
 		boost::this_thread::interruption_point();
 		if(!File_Block.is_approved(block_num)){
+			++block_num;
 			continue;
 		}
-		buf.clear();
-		File.read_block(block_num, buf);
-		hash_tree::status status = Hash_Tree.check_file_block(block_num, buf);
-		if(status == hash_tree::good){
-			bytes_received += buf.size();
-			File_Block.add_block_local(block_num);
-		}else if(status == hash_tree::io_error){
-			LOG << "stub: handle io_error when hash checking";
-			exit(1);
+		boost::uint64_t end = block_num + 1;
+		while(end < Hash_Tree.TI.file_block_count && end - block_num < check_run
+			&& File_Block.is_approved(end))
+		{
+			++end;
+		}
+		bufs.resize(end - block_num);
+		for(std::vector<net::buffer>::iterator it_cur = bufs.begin(),
+			it_end = bufs.end(); it_cur != it_end; ++it_cur)
+		{
+			it_cur->clear();
+		}
+		if(!File.read_blocks(block_num, bufs)){
+			/*
+			Short read, file not preallocated (or partly downloaded before it was).
+			Read blocks one at a time so good blocks before EOF are still found.
+			*/
+			for(std::size_t x=0; x<bufs.size(); ++x){
+				bufs[x].clear();
+				File.read_block(block_num + x, bufs[x]);
+			}
+		}
+		for(std::vector<net::buffer>::iterator it_cur = bufs.begin(),
+			it_end = bufs.end(); it_cur != it_end; ++it_cur, ++block_num)
+		{
+			hash_tree::status status = Hash_Tree.check_file_block(block_num, *it_cur);
+			if(status == hash_tree::good){
+				bytes_received += it_cur->size();
+				File_Block.add_block_local(block_num);
+			}else if(status == hash_tree::io_error){
+				LOG << "stub: handle io_error when hash checking";
+				exit(1);
+			}
 		}
 	}
 }
@@ -161,6 +161,9 @@ public:
 	speed_composite upload_speed_composite(const int connection_ID);
 
 private:
+	//max number of adjacent file blocks check() reads at once
+	static const unsigned check_run = 16;
+
 	hash_tree Hash_Tree;
 	file File;
 	block_request Tree_Block;
@@ -0,0 +1,127 @@
+#include "tree_store.hpp"
+
+tree_store::tree_store(char * map_in, const boost::uint64_t map_size_in):
+	map(map_in),
+	map_size(map_size_in)
+{
+
+}
+
+tree_store::~tree_store()
+{
+	if(::munmap(map, map_size) == -1){
+		LOG << strerror(errno);
+	}
+}
+
+boost::shared_ptr<tree_store> tree_store::create(const std::string & hash,
+	const boost::uint64_t size)
+{
+	assert(size != 0);
+	int FD = ::open(file(hash).c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+	if(FD == -1){
+		LOG << "failed to create \"" << file(hash) << "\": " << strerror(errno);
+		return boost::shared_ptr<tree_store>();
+	}
+	#ifdef __linux__
+	/*
+	Space must be allocated up front. Writing to a hole in a mapping when the
+	disk is full raises SIGBUS instead of returning an error.
+	*/
+	int ret = posix_fallocate(FD, 0, size);
+	if(ret != 0){
+		LOG << "failed to allocate \"" << file(hash) << "\": " << strerror(ret);
+		::close(FD);
+		remove(hash);
+		return boost::shared_ptr<tree_store>();
+	}
+	#else
+	if(::ftruncate(FD, size) == -1){
+		LOG << strerror(errno);
+		::close(FD);
+		remove(hash);
+		return boost::shared_ptr<tree_store>();
+	}
+	#endif
+	return map_file(FD, size);
+}
+
+const char * tree_store::data() const
+{
+	return map;
+}
+
+std::string tree_store::file(const std::string & hash)
+{
+	return path::tree_dir() + hash;
+}
+
+boost::shared_ptr<tree_store> tree_store::map_file(const int FD,
+	const boost::uint64_t size)
+{
+	void * ptr = ::mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, FD, 0);
+	if(ptr == MAP_FAILED){
+		LOG << strerror(errno);
+		::close(FD);
+		return boost::shared_ptr<tree_store>();
+	}
+	//mapping stays valid after FD closed
+	if(::close(FD) == -1){
+		LOG << strerror(errno);
+	}
+	return boost::shared_ptr<tree_store>(new tree_store(static_cast<char *>(ptr), size));
+}
+
+boost::shared_ptr<tree_store> tree_store::open(const std::string & hash)
+{
+	int FD = ::open(file(hash).c_str(), O_RDWR);
+	if(FD == -1){
+		if(errno != ENOENT){
+			LOG << "failed to open \"" << file(hash) << "\": " << strerror(errno);
+		}
+		return boost::shared_ptr<tree_store>();
+	}
+	struct stat buf;
+	if(::fstat(FD, &buf) == -1){
+		LOG << strerror(errno);
+		::close(FD);
+		return boost::shared_ptr<tree_store>();
+	}
+	if(buf.st_size == 0){
+		::close(FD);
+		return boost::shared_ptr<tree_store>();
+	}
+	return map_file(FD, buf.st_size);
+}
+
+bool tree_store::read(char * buf, const boost::uint64_t size,
+	const boost::uint64_t offset) const
+{
+	if(offset > map_size || size > map_size - offset){
+		return false;
+	}
+	std::memcpy(buf, map + offset, size);
+	return true;
+}
+
+void tree_store::remove(const std::string & hash)
+{
+	if(::unlink(file(hash).c_str()) == -1 && errno != ENOENT){
+		LOG << strerror(errno);
+	}
+}
+
+boost::uint64_t tree_store::size() const
+{
+	return map_size;
+}
+
+bool tree_store::write(const char * buf, const boost::uint64_t size,
+	const boost::uint64_t offset)
+{
+	if(offset > map_size || size > map_size - offset){
+		return false;
+	}
+	std::memcpy(map + offset, buf, size);
+	return true;
+}
@@ -0,0 +1,76 @@
+/*
+Hash trees are stored in flat files in path::tree_dir(), one file per tree
+named by the root hash. The file layout is the same as the tree (offsets from
+tree_info). The file is memory mapped so checking a block against the tree is
+a memcmp against mapped memory. The database only keeps metadata for the tree.
+*/
+#ifndef H_TREE_STORE
+#define H_TREE_STORE
+
+//custom
+#include "path.hpp"
+
+//include
+#include <boost/cstdint.hpp>
+#include <boost/shared_ptr.hpp>
+#include <boost/utility.hpp>
+#include <logger.hpp>
+#include <portable.hpp>
+
+//standard
+#include <cassert>
+#include <cstring>
+#include <string>
+
+class tree_store : private boost::noncopyable
+{
+public:
+	~tree_store();
+
+	/*
+	create:
+		Creates tree file of size bytes filled with zeros. An existing file is
+		replaced. Returns empty shared_ptr on error.
+	file:
+		Returns path of tree file for hash.
+	open:
+		Maps existing tree file. Returns empty shared_ptr if the file doesn't
+		exist or can't be mapped.
+	remove:
+		Removes tree file. Existing mappings stay valid until destroyed.
+	*/
+	static boost::shared_ptr<tree_store> create(const std::string & hash,
+		const boost::uint64_t size);
+	static std::string file(const std::string & hash);
+	static boost::shared_ptr<tree_store> open(const std::string & hash);
+	static void remove(const std::string & hash);
+
+	/*
+	data:
+		Returns pointer to the mapped tree.
+	read:
+		Copy size bytes at offset in to buf. Returns false if out of range.
+	size:
+		Returns size of the tree (bytes).
+	write:
+		Copy size bytes from buf to offset. Returns false if out of range.
+		Note: Concurrent writes to the same range are not safe.
+	*/
+	const char * data() const;
+	bool read(char * buf, const boost::uint64_t size, const boost::uint64_t offset) const;
+	boost::uint64_t size() const;
+	bool write(const char * buf, const boost::uint64_t size, const boost::uint64_t offset);
+
+private:
+	tree_store(char * map_in, const boost::uint64_t map_size_in);
+
+	char * const map;
+	const boost::uint64_t map_size;
+
+	/*
+	map_file:
+		Maps file open as FD, closes FD. Returns empty shared_ptr on error.
+	*/
+	static boost::shared_ptr<tree_store> map_file(const int FD, const boost::uint64_t size);
+};
+#endif
@@ -71,11 +71,49 @@ void all_partial()
 	}
 }
 
+void rarest_first()
+{
+	boost::uint64_t block_count = 64;
+	block_request BR(block_count);
+	BR.approve_block_all();
+
+	//host 0 has all blocks, hosts 1 and 2 have none
+	BR.download_reg(0, bit_field());
+	for(int x=1; x<3; ++x){
+		bit_field BF(block_count);
+		BR.download_reg(x, BF);
+	}
+
+	//block 40 available from 3 hosts, block 20 from 2, every other block from 1
+	BR.add_block_remote(1, 40);
+	BR.add_block_remote(2, 40);
+	BR.add_block_remote(2, 20);
+
+	//host 2 should be asked for the rarer of the blocks it has
+	boost::optional<boost::uint64_t> block_num = BR.next_request(2);
+	if(!block_num || *block_num != 20){
+		LOG; ++fail;
+	}
+	//host 0 should be asked for a block only it has
+	block_num = BR.next_request(0);
+	if(!block_num || *block_num != 0){
+		LOG; ++fail;
+	}
+
+	//after host 0 leaves its requested block can be requested again
+	BR.download_unreg(0);
+	block_num = BR.next_request(1);
+	if(!block_num || *block_num != 40){
+		LOG; ++fail;
+	}
+}
+
 int main()
 {
 	unit_test::timeout();
 
 	all_complete();
 	all_partial();
+	rarest_first();
 	return fail;
 }
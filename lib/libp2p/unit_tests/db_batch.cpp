@@ -0,0 +1,80 @@
+//custom
+#include "../db_all.hpp"
+
+//include
+#include <unit_test.hpp>
+
+//standard
+#include <sstream>
+
+int fail(0);
+
+//ends the transaction it's run in so the COMMIT fails
+void rollback(db::pool::proxy DB)
+{
+	DB->query("ROLLBACK");
+}
+
+int main()
+{
+	unit_test::timeout();
+
+	//setup database and make sure tables clear
+	path::set_db_file_name("database_batch.db");
+	path::set_program_dir("");
+	db::init::drop_all();
+	db::init::create_all();
+
+	//more updates than fit in one transaction
+	std::string hash("2222222222222222222222222222222222222222");
+	const unsigned updates = settings::DATABASE_BATCH_ROWS * 2 + 1;
+	for(unsigned x=0; x<updates; ++x){
+		std::stringstream ss;
+		ss << x;
+		db::batch::singleton()->add(boost::bind(&db::table::source::add,
+			ss.str(), hash, _1));
+	}
+	db::batch::singleton()->flush();
+	if(db::table::source::get_ID(hash).size() != updates){
+		LOG; ++fail;
+	}
+	db::batch::info Info = db::batch::singleton()->stats();
+	if(Info.updates != updates || Info.batches < 3
+		|| Info.max_batch_size > settings::DATABASE_BATCH_ROWS)
+	{
+		LOG; ++fail;
+	}
+
+	//committed without flush after timeout
+	std::string other_hash("3333333333333333333333333333333333333333");
+	db::batch::singleton()->add(boost::bind(&db::table::source::add,
+		std::string("1111111111111111111111111111111111111111"), other_hash, _1));
+	boost::this_thread::sleep(boost::posix_time::milliseconds(
+		settings::DATABASE_BATCH_MS * 5));
+	if(db::table::source::get_ID(other_hash).size() != 1){
+		LOG; ++fail;
+	}
+
+	//update that can't commit doesn't lose the others, flush reports it
+	std::string fail_hash("4444444444444444444444444444444444444444");
+	db::batch::singleton()->add(boost::bind(&db::table::source::add,
+		std::string("1111111111111111111111111111111111111111"), fail_hash, _1));
+	db::batch::singleton()->add(boost::bind(&rollback, _1));
+	db::batch::singleton()->add(boost::bind(&db::table::source::add,
+		std::string("2222222222222222222222222222222222222222"), fail_hash, _1));
+	if(db::batch::singleton()->flush()){
+		LOG; ++fail;
+	}
+	if(db::table::source::get_ID(fail_hash).size() != 2){
+		LOG; ++fail;
+	}
+	if(db::batch::singleton()->stats().failed != 1){
+		LOG; ++fail;
+	}
+
+	//flush with nothing queued returns, earlier failure already reported
+	if(!db::batch::singleton()->flush()){
+		LOG; ++fail;
+	}
+	return fail;
+}
@@ -44,5 +44,41 @@ int main()
 	if(db::table::blacklist::is_blacklisted("2.2.2.2")){
 		LOG; ++fail;
 	}
+
+	//IPv4 CIDR range
+	db::table::blacklist::add("10.0.0.0/8");
+	if(!db::table::blacklist::modified(state)){
+		LOG; ++fail;
+	}
+	if(!db::table::blacklist::is_blacklisted("10.1.2.3")){
+		LOG; ++fail;
+	}
+	if(db::table::blacklist::is_blacklisted("11.0.0.1")){
+		LOG; ++fail;
+	}
+
+	//IPv6 CIDR range, and IPv6 address that doesn't need a range
+	db::table::blacklist::add("2001:db8::/33");
+	db::table::blacklist::add("::1");
+	if(!db::table::blacklist::is_blacklisted("2001:db8:7fff::1")){
+		LOG; ++fail;
+	}
+	if(db::table::blacklist::is_blacklisted("2001:db8:8000::1")){
+		LOG; ++fail;
+	}
+	if(!db::table::blacklist::is_blacklisted("::1")){
+		LOG; ++fail;
+	}
+
+	//clearing blacklist removes everything
+	db::table::blacklist::clear();
+	if(!db::table::blacklist::modified(state)){
+		LOG; ++fail;
+	}
+	if(db::table::blacklist::is_blacklisted("1.1.1.1")
+		|| db::table::blacklist::is_blacklisted("10.1.2.3"))
+	{
+		LOG; ++fail;
+	}
 	return fail;
 }
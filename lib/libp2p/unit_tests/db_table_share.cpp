@@ -19,7 +19,7 @@ int main()
 	//test info
 	db::table::share::info SI;
 	SI.hash = "ABC";
-	SI.path = "/foo/bar";
+	SI.path = "/foo/bar's"; //quote must not need escaping
 	SI.file_size = 123;
 	SI.last_write_time = 123;
 	SI.file_state = db::table::share::downloading;
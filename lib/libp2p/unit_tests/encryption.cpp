@@ -22,7 +22,9 @@ int main()
 		LOG; ++fail;
 	}
 	buf = Encryption_B.send_rB();
-	Encryption_A.recv_rB(buf);
+	if(!Encryption_A.recv_rB(buf)){
+		LOG; ++fail;
+	}
 
 	if(!Encryption_A.ready()){
 		LOG; ++fail;
@@ -48,5 +50,22 @@ int main()
 	if(buf != message){
 		LOG; ++fail;
 	}
+
+	//test messages that span keystream blocks, encrypted with varying offsets
+	std::string large;
+	for(unsigned x=0; x<100000; ++x){
+		large += static_cast<char>(x % 251);
+	}
+	for(unsigned x=0; x<8; ++x){
+		buf = large;
+		Encryption_A.crypt_send(buf, x * 3);
+		if(buf == large){
+			LOG; ++fail;
+		}
+		Encryption_B.crypt_recv(buf, x * 3);
+		if(buf != large){
+			LOG; ++fail;
+		}
+	}
 	return fail;
 }
@@ -0,0 +1,97 @@
+//custom
+#include "../file_cache.hpp"
+
+//include
+#include <boost/filesystem.hpp>
+#include <logger.hpp>
+#include <unit_test.hpp>
+
+//standard
+#include <cstring>
+#include <sstream>
+
+int fail(0);
+
+int main()
+{
+	unit_test::timeout();
+
+	const std::string path = "file_cache.test";
+	boost::filesystem::remove(path);
+
+	//read only open of missing file fails
+	if(file_cache::singleton()->open(path)){
+		LOG; ++fail;
+	}
+
+	//writeable open creates file
+	boost::shared_ptr<file_cache::descriptor> D = file_cache::singleton()->open(path, true, 16);
+	if(!D || !D->writeable()){
+		LOG; ++fail;
+		return fail;
+	}
+	if(boost::filesystem::file_size(path) != 16){
+		LOG; ++fail;
+	}
+
+	//positional write/read
+	if(!D->write("ABCDEFGH", 8, 4)){
+		LOG; ++fail;
+	}
+	char buf[8];
+	if(!D->read(buf, 4, 8) || std::memcmp(buf, "EFGH", 4) != 0){
+		LOG; ++fail;
+	}
+
+	//read past end of file fails
+	if(D->read(buf, 8, 12)){
+		LOG; ++fail;
+	}
+
+	//cached descriptor returned, writeable satisfies read only request
+	if(file_cache::singleton()->open(path) != D){
+		LOG; ++fail;
+	}
+
+	//vectored read
+	char buf_1[2], buf_2[3];
+	iovec iov[2];
+	iov[0].iov_base = buf_1;
+	iov[0].iov_len = sizeof(buf_1);
+	iov[1].iov_base = buf_2;
+	iov[1].iov_len = sizeof(buf_2);
+	if(!D->readv(iov, 2, 5) || std::memcmp(buf_1, "BC", 2) != 0
+		|| std::memcmp(buf_2, "DEF", 3) != 0)
+	{
+		LOG; ++fail;
+	}
+
+	//erased descriptor not returned
+	file_cache::singleton()->erase(path);
+	boost::shared_ptr<file_cache::descriptor> R = file_cache::singleton()->open(path);
+	if(!R || R == D || R->writeable()){
+		LOG; ++fail;
+	}
+
+	//LRU eviction
+	for(int x=0; x<settings::FILE_CACHE_SIZE; ++x){
+		std::stringstream ss;
+		ss << path << "." << x;
+		file_cache::singleton()->open(ss.str(), true);
+	}
+	if(file_cache::singleton()->open(path) == R){
+		//least recently used descriptor should have been evicted
+		LOG; ++fail;
+	}
+	for(int x=0; x<settings::FILE_CACHE_SIZE; ++x){
+		std::stringstream ss;
+		ss << path << "." << x;
+		file_cache::singleton()->erase(ss.str());
+		boost::filesystem::remove(ss.str());
+	}
+	D.reset();
+	R.reset();
+	file_cache::singleton()->erase(path);
+	boost::filesystem::remove(path);
+	return fail;
+}
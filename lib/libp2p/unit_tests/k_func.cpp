@@ -12,22 +12,56 @@ int main()
 
 	std::string ID_0 = "DEADBEEFDEADBEEFDEADBEEFDEADBEEFDEADBEEF";
 	std::string ID_1 = "DEADBEEFDEADBEEFDEADBEEFDEADBEEFDEADBEEE";
+	std::string ID_2 = "5EADBEEFDEADBEEFDEADBEEFDEADBEEFDEADBEEF";
 
-	//ID_to_mpint
-	mpa::mpint m_ID = k_func::ID_to_mpint(ID_0);
-	if(m_ID.str(16) != ID_0){
+	//from_hex, hex
+	k_ID K_0 = k_ID::from_hex(ID_0);
+	k_ID K_1 = k_ID::from_hex(ID_1);
+	k_ID K_2 = k_ID::from_hex(ID_2);
+	if(K_0.hex() != ID_0){
 		LOG; ++fail;
 	}
 
 	//distance to self
-	if(k_func::distance(ID_0, ID_0) != "0"){
+	if(!k_func::distance(K_0, K_0).is_zero()){
 		LOG; ++fail;
 	}
 
 	//distance to neighbor
-	if(k_func::distance(ID_0, ID_1) != "1"){
+	if(k_func::distance(K_0, K_1).hex() != "0000000000000000000000000000000000000001"){
 		LOG; ++fail;
 	}
 
+	//distance ordering matches numeric ordering
+	if(!(k_func::distance(K_0, K_1) < k_func::distance(K_0, K_2))){
+		LOG; ++fail;
+	}
+
+	//bucket is index of highest bit that differs
+	if(k_func::bucket_num(K_0, K_0) != 0){
+		LOG; ++fail;
+	}
+	if(k_func::bucket_num(K_0, K_1) != 0){
+		LOG; ++fail;
+	}
+	if(k_func::bucket_num(K_0, K_2) != protocol_udp::bucket_count - 1){
+		LOG; ++fail;
+	}
+
+	//leading_zeros
+	if(k_ID::zero().leading_zeros() != protocol_udp::bucket_count){
+		LOG; ++fail;
+	}
+	if(k_func::distance(K_0, K_1).leading_zeros() != protocol_udp::bucket_count - 1){
+		LOG; ++fail;
+	}
+
+	//decrement borrows across words
+	k_ID K_3 = k_ID::from_hex("0000000000000000000000010000000000000000");
+	--K_3;
+	if(K_3.hex() != "000000000000000000000000FFFFFFFFFFFFFFFF"){
+		LOG << K_3.hex(); ++fail;
+	}
+
 	return fail;
 }
@@ -8,14 +8,14 @@
 
 int fail(0);
 const net::buffer test_random(portable::urandom(4));
-const std::string test_ID("0123456789012345678901234567890123456789");
+const k_ID test_ID(k_ID::from_hex("0123456789012345678901234567890123456789"));
 boost::shared_ptr<net::endpoint> endpoint;
 std::list<net::endpoint> test_hosts;
 const std::string test_hash("1111111111111111111111111111111111111111");
 std::list<std::string> test_nodes;
 
 void ping_call_back(const net::endpoint & from,
-	const net::buffer & random, const std::string & remote_ID)
+	const net::buffer & random, const k_ID & remote_ID)
 {
 	if(from != *endpoint){
 		LOG; ++fail;
@@ -29,7 +29,7 @@ void ping_call_back(const net::endpoint & from,
 }
 
 void pong_call_back(const net::endpoint & from,
-	const net::buffer & random, const std::string & remote_ID)
+	const net::buffer & random, const k_ID & remote_ID)
 {
 	if(from != *endpoint){
 		LOG; ++fail;
@@ -43,8 +43,8 @@ void pong_call_back(const net::endpoint & from,
 }
 
 void find_node_call_back(const net::endpoint & from,
-	const net::buffer & random, const std::string & remote_ID,
-	const std::string & ID_to_find)
+	const net::buffer & random, const k_ID & remote_ID,
+	const k_ID & ID_to_find)
 {
 	if(from != *endpoint){
 		LOG; ++fail;
@@ -61,7 +61,7 @@ void find_node_call_back(const net::endpoint & from,
 }
 
 void host_list_call_back(const net::endpoint & from,
-	const std::string & remote_ID, const std::list<net::endpoint> & hosts)
+	const k_ID & remote_ID, const std::list<net::endpoint> & hosts)
 {
 	if(from != *endpoint){
 		LOG; ++fail;
@@ -75,7 +75,7 @@ void host_list_call_back(const net::endpoint & from,
 }
 
 void store_node_call_back(const net::endpoint & from,
-	const net::buffer & random, const std::string & remote_ID)
+	const net::buffer & random, const k_ID & remote_ID)
 {
 	if(from != *endpoint){
 		LOG; ++fail;
@@ -89,7 +89,7 @@ void store_node_call_back(const net::endpoint & from,
 }
 
 void store_file_call_back(const net::endpoint & from, const net::buffer & random,
-	const std::string & remote_ID, const std::string & hash)
+	const k_ID & remote_ID, const std::string & hash)
 {
 	if(from != *endpoint){
 		LOG; ++fail;
@@ -106,7 +106,7 @@ void store_file_call_back(const net::endpoint & from, const net::buffer & random
 }
 
 void query_file_call_back(const net::endpoint & from, const net::buffer & random,
-	const std::string & remote_ID, const std::string & hash)
+	const k_ID & remote_ID, const std::string & hash)
 {
 	if(from != *endpoint){
 		LOG; ++fail;
@@ -123,7 +123,7 @@ void query_file_call_back(const net::endpoint & from, const net::buffer & random
 }
 
 void node_list_call_back(const net::endpoint & from, const net::buffer & random,
-	const std::string & remote_ID, const std::list<std::string> & nodes)
+	const k_ID & remote_ID, const std::list<std::string> & nodes)
 {
 	if(from != *endpoint){
 		LOG; ++fail;
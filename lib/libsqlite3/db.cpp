@@ -27,9 +27,13 @@ db::blob::blob(const blob & Blob):
 
 //BEGIN connection
 db::connection::connection(
-	const std::string & path_in
+	const std::string & path_in,
+	const bool read_only_in,
+	const boost::uint64_t mmap_size_in
 ):
 	path(path_in),
+	read_only(read_only_in),
+	mmap_size(mmap_size_in),
 	connected(false)
 {
 
@@ -37,6 +41,12 @@ db::connection::connection(
 
 db::connection::~connection()
 {
+	for(std::list<std::pair<std::string, sqlite3_stmt *> >::iterator
+		it_cur = Statement_LRU.begin(), it_end = Statement_LRU.end();
+		it_cur != it_end; ++it_cur)
+	{
+		sqlite3_finalize(it_cur->second);
+	}
 	if(connected){
 		if(sqlite3_close(DB_handle) != SQLITE_OK){
 			LOG << sqlite3_errmsg(DB_handle);
@@ -48,6 +58,7 @@ bool db::connection::blob_allocate(const std::string & query, const int size)
 {
 	boost::recursive_mutex::scoped_lock lock(Recursive_Mutex);
 	connect();
+	int busy = 0;
 	while(true){
 		/*
 		Go back to the beginning of the process whenever a SQLITE_BUSY is
@@ -66,7 +77,7 @@ bool db::connection::blob_allocate(const std::string & query, const int size)
 		);
 		if(ret == SQLITE_BUSY){
 			sqlite3_finalize(prepared_statement);
-			boost::this_thread::yield();
+			backoff(busy++);
 			continue;
 		}else if(ret != SQLITE_OK){
 			sqlite3_finalize(prepared_statement);
@@ -76,7 +87,7 @@ bool db::connection::blob_allocate(const std::string & query, const int size)
 		ret = sqlite3_bind_zeroblob(prepared_statement, 1, size);
 		if(ret == SQLITE_BUSY){
 			sqlite3_finalize(prepared_statement);
-			boost::this_thread::yield();
+			backoff(busy++);
 			continue;
 		}else if(ret != SQLITE_OK){
 			sqlite3_finalize(prepared_statement);
@@ -88,7 +99,7 @@ bool db::connection::blob_allocate(const std::string & query, const int size)
 		if(ret == SQLITE_DONE){
 			return true;
 		}else if(ret == SQLITE_BUSY){
-			boost::this_thread::yield();
+			backoff(busy++);
 			continue;
 		}else{
 			return false;
@@ -145,11 +156,11 @@ int db::connection::query(const std::string & query,
 {
 	boost::recursive_mutex::scoped_lock lock(Recursive_Mutex);
 	connect();
-	int code;
+	int code, busy = 0;
 	while((code = sqlite3_exec(DB_handle, query.c_str(), call_back_wrapper,
 		(void *)&func, NULL)) == SQLITE_BUSY)
 	{
-		boost::this_thread::yield();
+		backoff(busy++);
 	}
 	if(code != SQLITE_OK){
 		LOG << sqlite3_errmsg(DB_handle) << ", query \"" << query << "\"";
@@ -161,42 +172,74 @@ void db::connection::connect()
 {
 	boost::recursive_mutex::scoped_lock lock(Recursive_Mutex);
 	if(!connected){
-		if(sqlite3_open_v2(path.c_str(), &DB_handle,
-			SQLITE_OPEN_READWRITE | SQLITE_OPEN_CREATE | SQLITE_OPEN_NOMUTEX,
+		if(sqlite3_open_v2(path.c_str(), &DB_handle, (read_only ? SQLITE_OPEN_READONLY
+			: SQLITE_OPEN_READWRITE | SQLITE_OPEN_CREATE) | SQLITE_OPEN_NOMUTEX,
 			0) != SQLITE_OK)
 		{
 			LOG << sqlite3_errmsg(DB_handle);
 			exit(1);
 		}
 
-		//timeout in ms, this should not be zero with concurrency
-		if(sqlite3_busy_timeout(DB_handle, 4000) != SQLITE_OK){
+		//wait for locks with backoff instead of returning SQLITE_BUSY
+		if(sqlite3_busy_handler(DB_handle, &busy_handler, NULL) != SQLITE_OK){
 			LOG << sqlite3_errmsg(DB_handle);
 			exit(1);
 		}
 
-		//move free pages to EOF and truncate at every commit
-		int code;
-		while((code = sqlite3_exec(DB_handle, "PRAGMA auto_vacuum = full;",
-			NULL, NULL, NULL)) != SQLITE_OK)
-		{
-			if(code == SQLITE_BUSY){
-				boost::this_thread::yield();
-			}else{
-				LOG << code << ": " << sqlite3_errmsg(DB_handle);
-				exit(1);
-			}
+		if(!read_only){
+			//move free pages to EOF and truncate at every commit
+			pragma("PRAGMA auto_vacuum = full;");
+#if SQLITE_VERSION_NUMBER >= 3007000
+			//readers don't block writer and writer doesn't block readers
+			pragma("PRAGMA journal_mode = WAL;");
+#endif
 		}
+#if SQLITE_VERSION_NUMBER >= 3007017
+		if(mmap_size != 0){
+			std::stringstream ss;
+			ss << "PRAGMA mmap_size = " << mmap_size << ";";
+			pragma(ss.str());
+		}
+#endif
 		connected = true;
 	}
 }
 
+void db::connection::backoff(const int count)
+{
+	//1ms doubling to 64ms
+	boost::this_thread::sleep(boost::posix_time::milliseconds(1 << (count < 6 ? count : 6)));
+}
+
+int db::connection::busy_handler(void * ptr, int count)
+{
+	backoff(count);
+	//never give up, SQLITE_BUSY still returned if waiting would deadlock
+	return 1;
+}
+
+void db::connection::pragma(const std::string & query)
+{
+	int code, busy = 0;
+	while((code = sqlite3_exec(DB_handle, query.c_str(), NULL, NULL, NULL)) != SQLITE_OK){
+		if(code == SQLITE_BUSY){
+			backoff(busy++);
+		}else{
+			LOG << code << ": " << sqlite3_errmsg(DB_handle);
+			exit(1);
+		}
+	}
+}
+
 int db::connection::call_back_wrapper(void * ptr, int columns, char ** response,
 	char ** column_name)
 {
 	boost::function<int (int, char **, char **)> &
 		func = *reinterpret_cast<boost::function<int (int, char **, char **)> *>(ptr);
-	return func(columns, response, column_name);
+	if(func){
+		return func(columns, response, column_name);
+	}
+	return 0;
 }
 
 bool db::connection::blob_close(sqlite3_blob * blob_handle)
@@ -213,7 +256,7 @@ bool db::connection::blob_close(sqlite3_blob * blob_handle)
 bool db::connection::blob_open(const blob & Blob, const bool writeable, sqlite3_blob *& blob_handle)
 {
 	boost::recursive_mutex::scoped_lock lock(Recursive_Mutex);
-	int code;
+	int code, busy = 0;
 	while((code = sqlite3_blob_open(
 		DB_handle,
 		"main",              //DB name ("main" is default)
@@ -224,7 +267,7 @@ bool db::connection::blob_open(const blob & Blob, const bool writeable, sqlite3_
 		&blob_handle
 	)) != SQLITE_OK){
 		if(code == SQLITE_BUSY){
-			boost::this_thread::yield();
+			backoff(busy++);
 		}else{
 			LOG << code << ": " << sqlite3_errmsg(DB_handle);
 			return false;
@@ -232,14 +275,170 @@ bool db::connection::blob_open(const blob & Blob, const bool writeable, sqlite3_
 	}
 	return true;
 }
+
+sqlite3_stmt * db::connection::statement_get(const std::string & query)
+{
+	boost::recursive_mutex::scoped_lock lock(Recursive_Mutex);
+	connect();
+	std::map<std::string, std::list<std::pair<std::string, sqlite3_stmt *> >::iterator>::iterator
+		iter = Statement_Cache.find(query);
+	if(iter != Statement_Cache.end()){
+		//removed from cache while in use so nested use prepares another
+		sqlite3_stmt * stmt = iter->second->second;
+		Statement_LRU.erase(iter->second);
+		Statement_Cache.erase(iter);
+		return stmt;
+	}
+	int busy = 0;
+	while(true){
+		sqlite3_stmt * stmt = NULL;
+		int code = sqlite3_prepare_v2(
+			DB_handle,
+			query.c_str(),
+			query.size(),
+			&stmt,
+			0 //not needed unless multiple statements
+		);
+		if(code == SQLITE_OK){
+			return stmt;
+		}
+		sqlite3_finalize(stmt);
+		if(code == SQLITE_BUSY){
+			backoff(busy++);
+		}else{
+			LOG << sqlite3_errmsg(DB_handle) << ", query \"" << query << "\"";
+			return NULL;
+		}
+	}
+}
+
+void db::connection::statement_put(const std::string & query, sqlite3_stmt * stmt)
+{
+	boost::recursive_mutex::scoped_lock lock(Recursive_Mutex);
+	sqlite3_reset(stmt);
+	sqlite3_clear_bindings(stmt);
+	if(Statement_Cache.find(query) != Statement_Cache.end()){
+		//nested use of same query, keep the one already cached
+		sqlite3_finalize(stmt);
+		return;
+	}
+	Statement_LRU.push_front(std::make_pair(query, stmt));
+	Statement_Cache.insert(std::make_pair(query, Statement_LRU.begin()));
+	if(Statement_LRU.size() > statement_cache_size){
+		sqlite3_finalize(Statement_LRU.back().second);
+		Statement_Cache.erase(Statement_LRU.back().first);
+		Statement_LRU.pop_back();
+	}
+}
 //END connection
 
-//BEGIN free functions
-std::string db::escape(const std::string & str)
+//BEGIN statement
+db::statement::statement(connection & Connection_in, const std::string & query_in):
+	Connection(Connection_in),
+	lock(Connection.Recursive_Mutex),
+	query(query_in),
+	stmt(Connection.statement_get(query)),
+	err(stmt == NULL),
+	stepped(false)
 {
-	char * sqlite3_path = sqlite3_mprintf("%q", str.c_str());
-	std::string tmp(sqlite3_path);
-	sqlite3_free(sqlite3_path);
-	return tmp;
+
+}
+
+db::statement::~statement()
+{
+	if(stmt != NULL){
+		Connection.statement_put(query, stmt);
+	}
+}
+
+bool db::statement::bind(const int index, const boost::int64_t value)
+{
+	if(err){
+		return false;
+	}
+	if(sqlite3_bind_int64(stmt, index, value) != SQLITE_OK){
+		LOG << sqlite3_errmsg(Connection.DB_handle);
+		err = true;
+	}
+	return !err;
+}
+
+bool db::statement::bind(const int index, const std::string & value)
+{
+	if(err){
+		return false;
+	}
+	if(sqlite3_bind_text(stmt, index, value.data(), value.size(),
+		SQLITE_TRANSIENT) != SQLITE_OK)
+	{
+		LOG << sqlite3_errmsg(Connection.DB_handle);
+		err = true;
+	}
+	return !err;
+}
+
+bool db::statement::bind_blob(const int index, const char * buf, const int size)
+{
+	if(err){
+		return false;
+	}
+	if(sqlite3_bind_blob(stmt, index, buf, size, SQLITE_TRANSIENT) != SQLITE_OK){
+		LOG << sqlite3_errmsg(Connection.DB_handle);
+		err = true;
+	}
+	return !err;
+}
+
+std::string db::statement::column_blob(const int index)
+{
+	assert(stepped);
+	const char * buf = static_cast<const char *>(sqlite3_column_blob(stmt, index));
+	//size must be gotten after data, see sqlite3 docs
+	int size = sqlite3_column_bytes(stmt, index);
+	return buf == NULL ? std::string() : std::string(buf, size);
+}
+
+boost::int64_t db::statement::column_int64(const int index)
+{
+	assert(stepped);
+	return sqlite3_column_int64(stmt, index);
+}
+
+std::string db::statement::column_text(const int index)
+{
+	assert(stepped);
+	const char * buf = reinterpret_cast<const char *>(sqlite3_column_text(stmt, index));
+	int size = sqlite3_column_bytes(stmt, index);
+	return buf == NULL ? std::string() : std::string(buf, size);
+}
+
+bool db::statement::error() const
+{
+	return err;
+}
+
+bool db::statement::step()
+{
+	if(err){
+		return false;
+	}
+	int busy = 0;
+	while(true){
+		int code = sqlite3_step(stmt);
+		if(code == SQLITE_ROW){
+			stepped = true;
+			return true;
+		}else if(code == SQLITE_DONE){
+			return false;
+		}else if(code == SQLITE_BUSY && !stepped){
+			//safe to retry because no rows have been returned
+			sqlite3_reset(stmt);
+			connection::backoff(busy++);
+		}else{
+			LOG << sqlite3_errmsg(Connection.DB_handle) << ", query \"" << query << "\"";
+			err = true;
+			return false;
+		}
+	}
 }
-//END free functions
+//END statement